@@ -50,6 +50,7 @@ typedef off_t OFFSET;
 #define FS_LOCKSINGLE		0x00004000
 #define FS_LOCKNOWAIT		0x00008000
 #define FS_NOEXTENSION		0x00010000
+#define FS_READAHEAD		0x00020000
 
 extern int fsgetgreeting(char *server, int port, int encryptionflag, char *authfile, char *msg, int msglength);
 
@@ -37,10 +37,26 @@ struct keydef {
 /* local declarations */
 static struct atab *a;		/* working pointer to atab */
 static UCHAR casemap[256];
+static UCHAR firstflg = TRUE;	/* set up casemap from the fio options on the next aioopen */
+
+#if defined(__GNUC__)
+#define AIOLOWBIT(c) __builtin_ctz(c)
+#define AIOHIGHBIT(c) (31 - __builtin_clz(c))
+#else
+#define AIOLOWBIT(c) aiolowbit(c)
+#define AIOHIGHBIT(c) aiohighbit(c)
+#endif
 
 /* local routine declarations */
 static void aioxhash(INT, INT, INT, UCHAR *);
 static void aioxpurge(INT);
+static void aioand(UCHAR *, UCHAR *, INT);
+static INT aiofirstbyte(UCHAR *, INT, INT);
+static INT aiolastbyte(UCHAR *, INT, INT);
+#if !defined(__GNUC__)
+static INT aiolowbit(INT);
+static INT aiohighbit(INT);
+#endif
 
 
 /* AIOOPEN */
@@ -49,7 +65,6 @@ static void aioxpurge(INT);
 INT aioopen(CHAR *name, INT opts, INT reclen, OFFSET *txtpos, CHAR *txtname, INT *fixflg, CHAR *keyinfo,
 	INT dstnctflg, INT matchc)
 {
-	static UCHAR firstflg = TRUE;
 	INT i1, i2, i3, fnum, from, len, nkeys, version, zvalue;
 	OFFSET offset;
 	CHAR filename[MAX_NAMESIZE + 1], *ptr;
@@ -342,6 +357,13 @@ INT aioopen(CHAR *name, INT opts, INT reclen, OFFSET *txtpos, CHAR *txtname, INT
 	return(fnum);
 }
 
+/* AIOEXIT */
+/* forget the case map, the next aioopen takes it from the fio options again */
+void aioexit()
+{
+	firstflg = TRUE;
+}
+
 /* AIOCLOSE */
 /* close aim file */
 INT aioclose(INT fnum)
@@ -537,9 +559,9 @@ INT aiokey(INT fnum, UCHAR *key, INT len)
 /* return record number of next potential record that matches key */
 INT aionext(INT fnum, INT flag)
 {
-	INT i1, i2, i3, inc, andi, andsize, hashsize, nonzero, size;
+	INT i1, i2, i3, i4, inc, andi, andsize, hashsize, nonzero, size;
 	OFFSET offwork = 0, slot0pos = 0, slotsize = 0;
-	UCHAR firstflg, buf28[28], *hashbits, *where, *andbuf, *workbuf = NULL, **workptr;
+	UCHAR firstflg, buf28[28], *hashbits, *where, *andbuf, *workbuf = NULL, **workptr, *mptr;
 	UCHAR **aptr;
 
 	/* initialize structure pointers */
@@ -612,22 +634,34 @@ INT aionext(INT fnum, INT flag)
 	andi = (INT)((a->recnum - a->anfrec) / 8);  /* result can be negative */
 	andsize = (INT)((a->anlrec - a->anfrec) >> 3);
 	for ( ; ; ) {
-		while (andi >= 0 && andi < andsize) {  /* check for any bits on */
-			if (andbuf[andi]) {
-				i3 = andbuf[andi];
-				offwork = a->anfrec + (OFFSET)(andi << 3);
-				if (flag == AIONEXT_NEXT && offwork >= a->recnum) i1 = 0;
-				else if (flag == AIONEXT_PREV && offwork + 7 <= a->recnum) i1 = 7;
-				else i1 = (INT)(a->recnum - offwork);
-				while (i1 >= 0 && i1 < 8) {
-					if (i3 & (1 << i1)) {
-						*a->precnum = a->recnum = offwork + i1;
+		if (andi >= 0 && andi < andsize) {  /* check for any bits on, starting at byte andi */
+			offwork = a->recnum - a->anfrec;
+			if (inc == 1) {  /* first bit on at or after recnum */
+				i1 = andi << 3;
+				if (offwork > i1) i1 = (offwork < (OFFSET)(andsize << 3)) ? (INT) offwork : andsize << 3;
+				if (i1 < andsize << 3) {
+					i2 = i1 >> 3;
+					i3 = andbuf[i2] & (0xFF << (i1 & 0x07));
+					if (!i3 && (i2 = aiofirstbyte(andbuf, i2 + 1, andsize)) < andsize) i3 = andbuf[i2];
+					if (i3) {
+						*a->precnum = a->recnum = a->anfrec + ((OFFSET) i2 << 3) + AIOLOWBIT(i3);
+						goto aionext3;
+					}
+				}
+			}
+			else {  /* last bit on at or before recnum */
+				i1 = (andi << 3) + 7;
+				if (offwork < i1) i1 = (offwork >= 0) ? (INT) offwork : -1;
+				if (i1 >= 0) {
+					i2 = i1 >> 3;
+					i3 = andbuf[i2] & (0xFF >> (7 - (i1 & 0x07)));
+					if (!i3 && (i2 = aiolastbyte(andbuf, 0, i2)) >= 0) i3 = andbuf[i2];
+					if (i3) {
+						*a->precnum = a->recnum = a->anfrec + ((OFFSET) i2 << 3) + AIOHIGHBIT(i3);
 						goto aionext3;
 					}
-					i1 += inc;
 				}
 			}
-			andi += inc;
 		}
 
 		/* need to get a new AND buffer */
@@ -734,19 +768,28 @@ INT aionext(INT fnum, INT flag)
 			offwork = slot0pos + slotsize * (OFFSET)(i2 << 3);
 			do {
 				if (i3 & 0x01) {  /* found a slot that is on */
-					i1 = fioread(fnum, offwork + nonzero, &where[nonzero], size - nonzero);
-					if (i1 < size - nonzero) {
-						if (i1 < 0) goto aionext2;
-						goto aionext1;
+					i4 = size - nonzero;
+					mptr = fiomap(fnum, offwork + nonzero, &i4);
+					if (mptr != NULL) {  /* AND directly from the mapped slot */
+						if (i4 < size - nonzero) goto aionext1;
+						if (firstflg) memcpy(&andbuf[nonzero], mptr, i4);
+						else aioand(&andbuf[nonzero], mptr, size - nonzero);
+					}
+					else {
+						i1 = fioread(fnum, offwork + nonzero, &where[nonzero], size - nonzero);
+						if (i1 < size - nonzero) {
+							if (i1 < 0) goto aionext2;
+							goto aionext1;
+						}
+						if (!firstflg) aioand(&andbuf[nonzero], &workbuf[nonzero], size - nonzero);
 					}
 					if (firstflg) {
 						firstflg = FALSE;
 						where = workbuf;
 					}
-					else for (i1 = nonzero; i1 < size; i1++) andbuf[i1] &= workbuf[i1];
-					while (nonzero < size && !andbuf[nonzero]) nonzero++;
+					nonzero = aiofirstbyte(andbuf, nonzero, size);
 					if (nonzero == size) break;
-					while (size > nonzero && !andbuf[size - 1]) size--;
+					size = aiolastbyte(andbuf, nonzero, size) + 1;
 				}
 				offwork += slotsize;
 			} while (i3 >>= 1);
@@ -781,6 +824,69 @@ aionext3:
 	return(i1);
 }
 
+/* AIOAND */
+/* and len bytes of src into dest, a word at a time */
+static void aioand(UCHAR *dest, UCHAR *src, INT len)
+{
+	UINT64 word1, word2;
+
+	for ( ; len >= 8; len -= 8, dest += 8, src += 8) {
+		memcpy(&word1, dest, 8);
+		memcpy(&word2, src, 8);
+		word1 &= word2;
+		memcpy(dest, &word1, 8);
+	}
+	while (len-- > 0) *dest++ &= *src++;
+}
+
+/* AIOFIRSTBYTE */
+/* return the position of the first non-zero byte in buf[first] to buf[end - 1], end if none */
+static INT aiofirstbyte(UCHAR *buf, INT first, INT end)
+{
+	UINT64 word;
+
+	for ( ; first + 8 <= end; first += 8) {
+		memcpy(&word, buf + first, 8);
+		if (word) break;
+	}
+	while (first < end && !buf[first]) first++;
+	return(first);
+}
+
+/* AIOLASTBYTE */
+/* return the position of the last non-zero byte in buf[first] to buf[end - 1], first - 1 if none */
+static INT aiolastbyte(UCHAR *buf, INT first, INT end)
+{
+	UINT64 word;
+
+	for ( ; end - 8 >= first; end -= 8) {
+		memcpy(&word, buf + end - 8, 8);
+		if (word) break;
+	}
+	while (end > first && !buf[end - 1]) end--;
+	return(end - 1);
+}
+
+#if !defined(__GNUC__)
+/* AIOLOWBIT */
+static INT aiolowbit(INT c)
+{
+	INT i1;
+
+	for (i1 = 0; !(c & (1 << i1)); i1++);
+	return(i1);
+}
+
+/* AIOHIGHBIT */
+static INT aiohighbit(INT c)
+{
+	INT i1;
+
+	for (i1 = 7; !(c & (1 << i1)); i1--);
+	return(i1);
+}
+#endif
+
 /* AIOINSERT */
 /* insert key information into the .aim file */
 INT aioinsert(INT fnum, UCHAR *rec)
@@ -1043,6 +1149,48 @@ INT aiochkrec(INT fnum, UCHAR *record, INT recsize)
 	return(0);
 }
 
+/* AIOSTATS */
+/* sample up to maxslots slots spread evenly through the first extent, */
+/* looking at no more than the first numrecs records of each one */
+/* *bits is returned with the number of record bits that were on and */
+/* *total with the number of record bits that were looked at */
+/* return 0 if successful, else return negative error */
+INT aiostats(INT fnum, INT maxslots, OFFSET numrecs, OFFSET *bits, OFFSET *total)
+{
+	INT i1, i2, i3, len, slot, step;
+	UCHAR c1, **aptr, work[1024];
+	OFFSET offwork, slotsize, slotread;
+
+	*bits = *total = 0;
+	aptr = fiogetwptr(fnum);
+	if (aptr == NULL) return(ERR_NOTOP);
+	a = (struct atab *) *aptr;
+	if (a->type != 'A') return(ERR_NOTOP);
+
+	slotsize = a->fxnrec >> 3;
+	if (numrecs > a->fxnrec) numrecs = a->fxnrec;
+	slotread = (numrecs + 7) >> 3;
+	if (slotread > (OFFSET) sizeof(work) * 4) slotread = (OFFSET) sizeof(work) * 4;
+	if (maxslots < 1) maxslots = 1;
+	step = a->slots / maxslots;
+	if (step < 1) step = 1;
+
+	for (slot = 0; slot < a->slots && maxslots--; slot += step) {
+		offwork = a->hdrsize + slotsize * slot;
+		for (i1 = 0; (OFFSET) i1 < slotread; i1 += len) {
+			len = sizeof(work);
+			if ((OFFSET)(i1 + len) > slotread) len = (INT)(slotread - i1);
+			i2 = fioread(fnum, offwork + i1, work, len);
+			if (i2 < 0) return(i2);
+			if (i2 != len) return(ERR_BADIX);
+			for (i3 = 0; i3 < len; i3++)
+				for (c1 = work[i3]; c1; c1 &= c1 - 1) (*bits)++;
+		}
+		*total += (OFFSET) slotread << 3;
+	}
+	return(0);
+}
+
 /* AIOGETREC */
 /* return record position where new record may be written */
 INT aiogetrec(INT fnum)
@@ -52,8 +52,14 @@ struct memdef {
 	INT membptr;	/* -1 for memalloc, >=0 for membuffer */
 	struct memdef *prev;
 	struct memdef *next;
+	UINT hole;		/* unused bytes between the previous block (or membuf) and this block */
+	struct memdef *holeprev;	/* hole list links, only valid if hole != 0 */
+	struct memdef *holenext;
 };
 
+/* holes are kept in lists by size class, class n holds holes of 16 << n bytes or larger */
+#define MEMHOLECLASSES 24
+
 struct membdef {
 	struct memdef *memptr;
 	INT prev;
@@ -80,10 +86,13 @@ static UINT memmax;
 static UINT_PTR memsize;
 
 static UCHAR allocflg = FALSE;
-static UINT memhole;
+static struct memdef *memholetab[MEMHOLECLASSES];
+static UINT memholebytes;	/* total of all the holes */
+static MEMSTATS memstat;
 static INT meminitsize;
 static UINT memmaxsize;
 static INT meminitnbufs;
+UINT memgeneration;		/* incremented whenever memory blocks may have moved or been freed */
 
 /* variables for prp functions */
 static ELEMENT *prptree, *prppos;
@@ -115,6 +124,13 @@ static INT debugelock = FALSE;
 static INT membufremove(UINT);
 static struct memdef *memchkptr(UCHAR **);
 static UCHAR *memoryalloc(UINT, struct memdef **, struct memdef **);
+static INT memtail(UINT);
+static void memholeupdate(struct memdef *);
+static void memholeunlink(struct memdef *);
+static INT memholeclass(UINT);
+static void memcompactpart(UINT);
+static void memstall(UINT64);
+static UINT64 memclock(void);
 
 #if 0
 static void logMemcompactEvent(CHAR * optionalInfo);
@@ -266,7 +282,8 @@ INT meminit(UINT maxsize, UINT size, INT nbufs)
 	membmax = 0;
 	firstmembtab = lastmembtab = freemembtab = -1;
 	memsize = 0;
-	memhole = 0;
+	memset(memholetab, 0, sizeof(memholetab));
+	memholebytes = 0;
 	allocflg = TRUE;
 	return(0);
 }
@@ -332,6 +349,7 @@ UCHAR **memalloc(INT size, INT flags)
 			if (ptr != membuf) {  /* memory moved */
 				i2 = ptr - membuf;
 				membuf = ptr;
+				memgeneration++;
 				memptr = lastmemtab;
 				while (memptr != NULL) {
 					memptr->bufptr += i2;
@@ -361,12 +379,14 @@ UCHAR **memalloc(INT size, INT flags)
 	memptr->bufptr = ptr;
 	memptr->size = size;
 	memptr->membptr = -1;
+	memptr->hole = 0;
 	memptr->prev = leftptr;
 	memptr->next = rightptr;
 	if (leftptr != NULL) leftptr->next = memptr;
 	else firstmemtab = memptr;
 	if (rightptr != NULL) rightptr->prev = memptr;
 	else lastmemtab = memptr;
+	memholeupdate(rightptr);
 	return(&memptr->bufptr);
 }
 
@@ -393,83 +413,78 @@ UINT walkmemory() {
  */
 INT memchange(UCHAR **pptr, UINT size, INT flags)
 {
-	UINT_PTR i1, i2;
+	UINT i1;
 	UCHAR *ptr;
 	struct memdef *memptr, *leftptr1, *rightptr1, *leftptr2, *rightptr2;
 
 	memptr = memchkptr(pptr);
 	if (memptr == NULL || memptr->membptr != -1) return RC_ERROR;
 
-	leftptr1 = memptr->prev;
-	rightptr1 = memptr->next;
 	if (!size) size = 0x10;
 	size = (size + 0x0F) & ~0x0F;
 
 	if (size == memptr->size) return(0);
 	if (size > memptr->size) {
-		if (rightptr1 == NULL) i1 = memmax - memsize;
-		else i1 = (rightptr1->bufptr - memptr->bufptr) - memptr->size;
+		if (memptr->next == NULL) i1 = memmax - (UINT)memsize;
+		else i1 = memptr->next->hole;
 		if (size > memptr->size + i1) {
-			if (leftptr1 == NULL) ptr = membuf;
-			else ptr = leftptr1->bufptr + leftptr1->size;
-			i2 = memptr->bufptr - ptr;
-			if (size <= memptr->size + i1 + i2) {
-				memmove(ptr, memptr->bufptr, memptr->size);
-				memptr->bufptr = ptr;
-				i1 += i2;
+			if (size <= memptr->size + i1 + memptr->hole) {
+				/* slide into the hole in front of the block */
+				memmove(memptr->bufptr - memptr->hole, memptr->bufptr, memptr->size);
+				memptr->bufptr -= memptr->hole;
+				memgeneration++;
+				memholeupdate(memptr);
 			}
-			else if (rightptr1 == NULL) {
-				memcompact();
-				i1 = memmax - memsize;
+			else if (memptr->next == NULL) {
+				/* last block, make room at the end of memory */
+				if (memtail(size - memptr->size) == RC_ERROR) return RC_ERROR;
 			}
+			else goto relocate;
 		}
+		if (flags & MEMFLAGS_ZEROFILL) memset(memptr->bufptr + memptr->size, 0, size - memptr->size);
 	}
-	else i1 = 0;
-	if (size <= memptr->size + i1) {
-		if ((flags & MEMFLAGS_ZEROFILL) && size > memptr->size) {
-			memset(memptr->bufptr + memptr->size, 0, size - memptr->size);
-		}
-		if (memptr == lastmemtab) {
-			if (size >= memptr->size) memsize += size - memptr->size;
-			else memsize -= memptr->size - size;
-		}
-		else if (size < memptr->size && memptr->size - size > memhole) memhole = memptr->size - size;
-		memptr->size = size;
-		return(0);
-	}
+	memptr->size = size;
+	if (memptr->next == NULL) memsize = (memptr->bufptr - membuf) + size;
+	else memholeupdate(memptr->next);
+	return(0);
 
+relocate:
 	ptr = memoryalloc(size, &leftptr2, &rightptr2);
 	if (ptr == NULL) return RC_ERROR;
-	if ((flags & MEMFLAGS_ZEROFILL) && size > memptr->size) memset(ptr + memptr->size, 0, size - memptr->size);
-
-	if (rightptr1 == NULL && size <= memptr->size + memmax - memsize) {
-		/* memoryalloc alloc'd more memory, otherwise it would return null */
-		memsize += size - memptr->size;
-		memptr->size = size;
-		return(0);
-	}
+	/* memoryalloc may have compacted, but the order of the blocks is unchanged */
+	leftptr1 = memptr->prev;
+	rightptr1 = memptr->next;
 
 	/* error if rightptr1 = null or new pointers = old pointers */
-	if (rightptr1 == NULL || leftptr1 == leftptr2 || rightptr1 == rightptr2) {
+	if (rightptr1 == NULL || leftptr2 == memptr || rightptr2 == memptr) {
 		fputs("MEMCHANGE INTERNAL ERROR 1\n", stderr);
 		exit(1);
 	}
 	/* unlink old memory pointer */
+	if (memptr->hole) {
+		memholeunlink(memptr);
+		memholebytes -= memptr->hole;
+		memptr->hole = 0;
+	}
 	rightptr1->prev = leftptr1;
 	if (leftptr1 != NULL) leftptr1->next = rightptr1;
 	else firstmemtab = rightptr1;
-	if (memptr->size > memhole) memhole = memptr->size;
 
 	/* transfer memory to new position and insert pointer into linked list */
 	memcpy(ptr, memptr->bufptr, memptr->size);
+	if (flags & MEMFLAGS_ZEROFILL) memset(ptr + memptr->size, 0, size - memptr->size);
 	memptr->bufptr = ptr;
 	memptr->size = size;
+	memgeneration++;
 	memptr->prev = leftptr2;
 	memptr->next = rightptr2;
 	if (leftptr2 != NULL) leftptr2->next = memptr;
 	else firstmemtab = memptr;
 	if (rightptr2 != NULL) rightptr2->prev = memptr;
 	else lastmemtab = memptr;
+	memholeupdate(rightptr1);
+	memholeupdate(memptr);
+	memholeupdate(rightptr2);
 	return(0);
 }
 
@@ -487,22 +502,23 @@ void memfree(UCHAR **pptr)
 #endif
 	leftptr = memptr->prev;
 	rightptr = memptr->next;
+	if (memptr->hole) {
+		memholeunlink(memptr);
+		memholebytes -= memptr->hole;
+	}
 	memptr->bufptr = (UCHAR *) freememtab;
 	freememtab = memptr;
-	if (rightptr != NULL) {
-		rightptr->prev = leftptr;
-		if (memptr->size > memhole) memhole = memptr->size;
-	}
+	memgeneration++;  /* the handle may be reused for a different block */
+	if (rightptr != NULL) rightptr->prev = leftptr;
 	else {
 		lastmemtab = leftptr;
-		if (leftptr == NULL) {
-			memsize = 0;
-			memhole = 0;
-		}
+		if (leftptr == NULL) memsize = 0;
 		else memsize = (leftptr->bufptr - membuf) + leftptr->size;
 	}
 	if (leftptr != NULL) leftptr->next = rightptr;
 	else firstmemtab = rightptr;
+	/* the freed block and its hole become part of the next block's hole */
+	memholeupdate(rightptr);
 #if OS_WIN32
 	pviend();
 #endif
@@ -607,9 +623,10 @@ static INT membufremove(UINT size)
 void memcompact()
 {
 	INT i1;
+	UINT64 start;
 	struct memdef *memptr;
 
-	if (!allocflg || !memhole) {
+	if (!allocflg || !memholebytes) {
 #if 0
 		if (keepCircularEventLog) logMemcompactEvent("-NoOp");
 #endif
@@ -622,23 +639,155 @@ void memcompact()
 #if OS_WIN32
 	pvistart();
 #endif
-	memhole = 0;
+	start = memclock();
+	memgeneration++;
 	i1 = 0;
 	memptr = firstmemtab;
 	while (memptr != NULL) {
 		if (memptr->bufptr != &membuf[i1]) {
 			memmove(&membuf[i1], memptr->bufptr, memptr->size);
 			memptr->bufptr = &membuf[i1];
+			memstat.bytesmoved += memptr->size;
 		}
+		memptr->hole = 0;
 		i1 += memptr->size;
 		memptr = memptr->next;
 	}
 	memsize = i1;
+	memset(memholetab, 0, sizeof(memholetab));
+	memholebytes = 0;
+	memstat.compacts++;
+	memstall(start);
 #if OS_WIN32
 	pviend();
 #endif
 }
 
+/*
+ * MEMCOMPACTPART
+ * Make size bytes available at the end of memory by compacting only the
+ * fewest blocks at the end of memory whose holes provide enough room,
+ * instead of moving every block in memory
+ */
+static void memcompactpart(UINT size)
+{
+	UINT i1;
+	UINT64 start;
+	UCHAR *ptr;
+	struct memdef *memptr;
+
+	if (memsize > memmax || memmax - memsize + memholebytes < size) return;
+	/* recover at least half of the holes so the next compaction is not right away */
+	if (size < (memholebytes >> 1)) size = memholebytes >> 1;
+	for (i1 = memmax - (UINT)memsize, memptr = lastmemtab; memptr != NULL && i1 < size; memptr = memptr->prev) {
+		if (memptr->hole && (i1 += memptr->hole) >= size) break;
+	}
+	if (memptr == NULL) return;
+
+#if OS_WIN32
+	pvistart();
+#endif
+	start = memclock();
+	memgeneration++;
+	ptr = memptr->bufptr - memptr->hole;
+	for ( ; memptr != NULL; memptr = memptr->next) {
+		if (memptr->hole) {
+			memholeunlink(memptr);
+			memholebytes -= memptr->hole;
+			memptr->hole = 0;
+		}
+		if (memptr->bufptr != ptr) {
+			memmove(ptr, memptr->bufptr, memptr->size);
+			memptr->bufptr = ptr;
+			memstat.bytesmoved += memptr->size;
+		}
+		ptr += memptr->size;
+	}
+	memsize = ptr - membuf;
+	memstat.partials++;
+	memstall(start);
+#if OS_WIN32
+	pviend();
+#endif
+}
+
+/* MEMHOLEUPDATE */
+/* recalculate the hole in front of a block and move the block to the matching hole list */
+static void memholeupdate(struct memdef *memptr)
+{
+	INT i1;
+	UINT hole;
+
+	if (memptr == NULL) return;
+	if (memptr->prev == NULL) hole = (UINT)(memptr->bufptr - membuf);
+	else hole = (UINT)(memptr->bufptr - (memptr->prev->bufptr + memptr->prev->size));
+	if (hole == memptr->hole) return;
+
+	if (memptr->hole) memholeunlink(memptr);
+	memholebytes = memholebytes - memptr->hole + hole;
+	memptr->hole = hole;
+	if (hole) {
+		i1 = memholeclass(hole);
+		memptr->holeprev = NULL;
+		memptr->holenext = memholetab[i1];
+		if (memholetab[i1] != NULL) memholetab[i1]->holeprev = memptr;
+		memholetab[i1] = memptr;
+	}
+}
+
+/* MEMHOLEUNLINK */
+static void memholeunlink(struct memdef *memptr)
+{
+	if (memptr->holenext != NULL) memptr->holenext->holeprev = memptr->holeprev;
+	if (memptr->holeprev != NULL) memptr->holeprev->holenext = memptr->holenext;
+	else memholetab[memholeclass(memptr->hole)] = memptr->holenext;
+}
+
+/* MEMHOLECLASS */
+static INT memholeclass(UINT size)
+{
+	INT i1;
+
+	for (i1 = 0, size >>= 5; size && i1 < MEMHOLECLASSES - 1; size >>= 1) i1++;
+	return(i1);
+}
+
+/* MEMSTALL */
+/* record the time spent in a compaction that began at start */
+static void memstall(UINT64 start)
+{
+	UINT64 stall;
+
+	stall = memclock() - start;
+	memstat.stalltime += stall;
+	if (stall > memstat.maxstall) memstat.maxstall = (UINT) stall;
+}
+
+/* MEMCLOCK */
+/* return a time in microseconds */
+static UINT64 memclock()
+{
+#if OS_WIN32
+	LARGE_INTEGER count, freq;
+
+	if (!QueryPerformanceFrequency(&freq) || !QueryPerformanceCounter(&count)) return(0);
+	return((UINT64)(count.QuadPart / freq.QuadPart) * 1000000
+		+ (UINT64)(count.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart);
+#else
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return((UINT64) tv.tv_sec * 1000000 + tv.tv_usec);
+#endif
+}
+
+/* MEMSTATS */
+void memstats(MEMSTATS *stats)
+{
+	memstat.holebytes = memholebytes;
+	*stats = memstat;
+}
+
 /* MEMBASE */
 void membase(UCHAR **base, UINT *size, INT *asize)
 {
@@ -698,48 +847,48 @@ INT isValidHandle(UCHAR **pptr)
 /* MEMORYALLOC */
 static UCHAR *memoryalloc(UINT size, struct memdef **leftptr, struct memdef **rightptr)
 {
-	UINT_PTR minsize;
-	ULONG i1;
-	ptrdiff_t i2;
+	INT i1;
 	UCHAR *ptr;
 	struct memdef *memptr;
 
-/*** CODE ENHANCEMENT:  MAYBE KEEP A LINKED LIST OF HOLES ***/
-/*** COULD YOU GAPS IN MEMORY TO BE ELEMENTS OF LINKED LIST ***/
-/*** ADDRESS IN MEMORY IS WHERE THE HOLE IS ***/
-/*** 8 BYTES FOR ADDRESS OF NEXT LINKED LIST ***/
-/*** 4 BYTES FOR SIZE OF HOLE ***/
-#ifdef MEMFILL
-	INT newmemhole;
-	struct memdef *memptr1, *memptr2;
-#endif
-
-#ifdef MEMFILL
-	/* try to fill holes in memory */
-	if (size <= memhole) {
-		newmemhole = 0;
-		memptr1 = lastmemtab;
-		while (memptr1 != NULL) {
-			memptr2 = memptr1->prev;
-			if (memptr2 == NULL) ptr = membuf;
-			else ptr = memptr2->bufptr + memptr2->size;
-			i1 = memptr1->bufptr - ptr;
-			if (size <= i1) break;
-			if (i1 > newmemhole) newmemhole = i1;
-			memptr1 = memptr2;
-		}
-		if (memptr1 != NULL) {
-			*leftptr = memptr2;
-			*rightptr = memptr1;
-			return(ptr);
+	/* try to fill a hole, first fit within the size class, then the next larger class */
+	if (size <= memholebytes) {
+		for (i1 = memholeclass(size); i1 < MEMHOLECLASSES; i1++) {
+			for (memptr = memholetab[i1]; memptr != NULL && memptr->hole < size; memptr = memptr->holenext);
+			if (memptr != NULL) {
+				memstat.holefills++;
+				*leftptr = memptr->prev;
+				*rightptr = memptr;
+				return(memptr->bufptr - memptr->hole);
+			}
 		}
-		memhole = newmemhole;
 	}
-#endif
 
-	/* try to get memory from end of memory */
+	/* get memory from end of memory */
+	if (memtail(size) == RC_ERROR) return(NULL);
+	ptr = membuf + memsize;
+	memsize += size;
+	*leftptr = lastmemtab;
+	*rightptr = NULL;
+	return(ptr);
+}
+
+/*
+ * MEMTAIL
+ * Make at least size bytes available after the last block by compacting,
+ * removing buffers or growing memory.  Blocks keep their order.
+ */
+static INT memtail(UINT size)
+{
+	UINT_PTR minsize;
+	ULONG i1;
+	ptrdiff_t i2;
+	UCHAR *ptr;
+	struct memdef *memptr;
+
 	if (memsize > memmax || size > memmax - memsize) {
-		memcompact();
+		memcompactpart(size);
+		if (memsize > memmax || size > memmax - memsize) memcompact();
 		if (memsize > memmax || size > memmax - memsize) {
 			if (membufremove(size - (memmax - (UINT)memsize)) != -1) memcompact();
 			if (memsize > memmax || size > memmax - memsize) {
@@ -762,7 +911,7 @@ static UCHAR *memoryalloc(UINT size, struct memdef **leftptr, struct memdef **ri
 #if OS_WIN32
 					pviend();
 #endif
-					return(NULL);
+					return RC_ERROR;
 				}
 				if ((i2 = ((UINT_PTR)mallocptr & 0x0FU) - ((UINT_PTR)ptr & 0x0FU))) {
 					/* new address does not have the same 4 bit offset */
@@ -779,6 +928,7 @@ static UCHAR *memoryalloc(UINT size, struct memdef **leftptr, struct memdef **ri
 				if (ptr != membuf) {  /* memory moved */
 					i2 = ptr - membuf;
 					membuf = ptr;
+					memgeneration++;
 					memptr = lastmemtab;
 					while (memptr != NULL) {
 						memptr->bufptr += i2;
@@ -793,11 +943,7 @@ static UCHAR *memoryalloc(UINT size, struct memdef **leftptr, struct memdef **ri
 		}
 	}
 
-	ptr = membuf + memsize;
-	memsize += size;
-	*leftptr = lastmemtab;
-	*rightptr = NULL;
-	return(ptr);
+	return(0);
 }
 
 /**
@@ -52,6 +52,8 @@ static UINT lastuse;		/* last use counter */
 
 static INT flags;			/* flags from fioparms structure */
 static INT openlimit;		/* maximum number of operating system files to be open */
+static INT indexcache;		/* xio block cache size in megabytes */
+static CHAR **indexcachelog = NULL;	/* xio block cache statistics file */
 static INT filetimeout;		/* filepi timeout in seconds */
 static INT rectimeout;		/* record lock timeout in seconds */
 static OFFSET maxoffset = 0x7FFFFFFF;  /* decare here so optimizer won't produce overflow warning */
@@ -78,6 +80,7 @@ static INT fiolibsrch(FHANDLE, CHAR *, OFFSET *, OFFSET *);
 static INT fiolibmod(FHANDLE, CHAR *, OFFSET, OFFSET, INT);
 static CHAR *fioinitprops(FIOPARMS *);
 static INT fioinitcvtvol(CHAR *, CHAR ***);
+static void fiomapcheck(struct htab *);
 
 /* FIOINITCFG */
 /* initialize using a prefix and from a .cfg file */
@@ -207,6 +210,12 @@ CHAR *fioinit(FIOPARMS *parms, INT initialized)
 			memcpy(*collatemap, parms->collatemap, UCHAR_MAX + 1);
 		}
 		cvtvolfnc = parms->cvtvolfnc;
+		indexcache = parms->indexcache;
+		if (parms->indexcachelog[0]) {
+			i2 = (INT)strlen(parms->indexcachelog);
+			indexcachelog = (CHAR **) memalloc(i2 + 1, 0);
+			strcpy(*indexcachelog, parms->indexcachelog);
+		}
 	}
 	else flags = 0;
 
@@ -244,10 +253,18 @@ void fioexit()
 	imgpath = NULL;
 	memfree((UCHAR **) cftpath);
 	cftpath = NULL;
+	memfree((UCHAR **) indexcachelog);
+	indexcachelog = NULL;
 	memfree(casemap);
 	casemap = NULL;
 	memfree(collatemap);
 	collatemap = NULL;
+	if (findpath != NULL) {
+		memfree((UCHAR **) findpath);
+		findpath = NULL;
+		memfree((UCHAR **) findfile);
+		findfile = NULL;
+	}
 	memfree(ftable);
 	ftable = NULL;
 	ftabmax = ftabhi = 0;
@@ -265,6 +282,19 @@ INT fiogetflags()
 	return(flags);
 }
 
+/*
+ * FIOGETINDEXCACHE
+ *
+ * Return the xio block cache size in megabytes, zero if not specified.
+ * The name of the statistics file, or NULL, is returned at logname
+ */
+INT fiogetindexcache(CHAR **logname)
+{
+	if (indexcachelog != NULL) *logname = *indexcachelog;
+	else *logname = NULL;
+	return(indexcache);
+}
+
 /*
  * FIOSETOPT
  *
@@ -546,6 +576,8 @@ INT fioopen(CHAR *name, INT opts)  /* open a file */
 		h->lpos = 0L;
 		h->luse = ++lastuse;
 		h->pptr = NULL;
+		h->mptr = NULL;
+		h->msiz = 0;
 		memcpy(h->fnam, filename, i1 + 1);
 	}
 	f[fnum].hptr = hptr;
@@ -725,6 +757,7 @@ INT fioclose(INT fnum)  /* close fnum */
 			i1 = fioaclose(h->hndl);
 			opencnt--;
 		}
+		fioaunmap(h->mptr, h->msiz);
 		memfree(f[fnum].hptr);
 	}
 	f[fnum].hptr = NULL;
@@ -766,6 +799,8 @@ INT fiokill(INT fnum)  /* close fnum and delete file */
 			i1 = fioaclose(h->hndl);
 			opencnt--;
 		}
+		fioaunmap(h->mptr, h->msiz);
+		h->mptr = NULL;
 		if (f[fnum].lptr == NULL) i1 = fioadelete(ptr);  /* delete if not a library */
 		memfree(f[fnum].hptr);
 	}
@@ -878,6 +913,7 @@ INT fioread(INT fnum, OFFSET fpos, UCHAR *buffer, INT count)
 	INT i1, i2;
 	FHANDLE handle;
 	OFFSET pos;
+	UCHAR *mptr;
 	struct ftab *f;
 	struct htab *h;
 	struct ltab *lib;
@@ -897,8 +933,19 @@ INT fioread(INT fnum, OFFSET fpos, UCHAR *buffer, INT count)
 		fpos += lib->filepos;
 	}
 
+	if (flags & FIO_FLAG_MMAP) {
+		i2 = count;
+		mptr = fiomap(fnum + 1, fpos, &i2);
+		if (mptr != NULL) {
+			memcpy(buffer, mptr, i2);
+			return i2;
+		}
+	}
+
 	pos = fpos;
+#if !OS_UNIX
 	if (pos == h->npos) pos = -1;
+#endif
 
 	i1 = fioaread(handle, buffer, count, pos, &i2);
 	if (i1) {
@@ -912,6 +959,64 @@ INT fioread(INT fnum, OFFSET fpos, UCHAR *buffer, INT count)
 	return i2;
 }
 
+/**
+ * FIOMAP
+ * Return a pointer to the bytes at fpos in a read only memory mapping of
+ * the file, or NULL if the file is not or can not be mapped, in which case
+ * the caller should use fioread.  *count is reduced to the number of bytes
+ * that can be referenced, zero at end of file.
+ * Only used when dbcdx.file.mmap=on, for files opened ERO or EXC, and for
+ * files opened SRO while this process holds the file lock.  fiotrunc takes
+ * the file lock, so another process can not truncate an SRO file under the
+ * mapping, and the mapping is checked against the file size each time the
+ * lock is taken (fiomapcheck).  Otherwise a read of a stale mapping past
+ * the end of the file would fault (SIGBUS) instead of failing.
+ * The pointer is valid until the next fio call for this file.
+ */
+UCHAR *fiomap(INT fnum, OFFSET fpos, INT *count)
+{
+	INT i1;
+	struct ftab *f;
+	struct htab *h;
+
+	if (!(flags & FIO_FLAG_MMAP)) return(NULL);
+	f = (struct ftab *) *ftable;
+	if (fnum < 1 || fnum > ftabhi || f[fnum - 1].hptr == NULL) return(NULL);
+	if (f[fnum - 1].lptr != NULL) return(NULL);  /* library member */
+	h = (struct htab *) *f[fnum - 1].hptr;
+	if (h->mode == FIO_M_SRO) {
+		if (!h->lckflg && !(flags & FIO_FLAG_SINGLEUSER)) return(NULL);
+	}
+	else if (h->mode != FIO_M_ERO && h->mode != FIO_M_EXC) return(NULL);
+
+	if (h->mptr == NULL || fpos + *count > h->msiz) {  /* map file or pick up growth */
+		if (fiotouch(fnum)) return(NULL);
+		h = (struct htab *) *f[fnum - 1].hptr;
+		i1 = fioamap(h->hndl, &h->mptr, &h->msiz);
+		if (i1 || h->mptr == NULL) return(NULL);
+	}
+	else h->luse = ++lastuse;
+
+	if (fpos >= h->msiz) *count = 0;
+	else if (fpos + *count > h->msiz) *count = (INT)(h->msiz - fpos);
+	return(h->mptr + fpos);
+}
+
+/**
+ * Called when the file lock of an SRO file has just been taken.  Another
+ * process may have changed the size of the file while it was not locked,
+ * keep the mapping only if the size is the same, else map the file again.
+ */
+static void fiomapcheck(struct htab *h)
+{
+	if (h->mode != FIO_M_SRO || h->mptr == NULL) return;
+	if (fioamap(h->hndl, &h->mptr, &h->msiz)) {
+		fioaunmap(h->mptr, h->msiz);
+		h->mptr = NULL;
+		h->msiz = 0;
+	}
+}
+
 /* FIOWRITE */
 INT fiowrite(INT fnum, OFFSET fpos, UCHAR *buffer, size_t count)
 {
@@ -939,7 +1044,9 @@ INT fiowrite(INT fnum, OFFSET fpos, UCHAR *buffer, size_t count)
 	}
 
 	pos = fpos;
+#if !OS_UNIX
 	if (pos == h->npos) pos = -1;
+#endif
 
 	i1 = fioawrite(handle, buffer, count, pos, &i2);
 	if (i1) return(i1);
@@ -1102,7 +1209,7 @@ INT fioflush(INT fnum)
 /* truncate file */
 INT fiotrunc(INT fnum, OFFSET size)
 {
-	INT i1;
+	INT i1, lockflg;
 	struct ftab *f;
 	struct htab *h;
 
@@ -1111,9 +1218,22 @@ INT fiotrunc(INT fnum, OFFSET size)
 	f = (struct ftab *) *ftable;
 	h = (struct htab *) *f[fnum - 1].hptr;
 
+	/* keep out readers that have an SRO file mapped while they hold the file lock */
+	lockflg = !h->lckflg;
+	if (lockflg) {
+		i1 = fioflck(fnum);
+		if (i1) return(i1);
+		h = (struct htab *) *f[fnum - 1].hptr;
+	}
+	if (h->mptr != NULL) {  /* mapping may extend past the new end of file */
+		fioaunmap(h->mptr, h->msiz);
+		h->mptr = NULL;
+		h->msiz = 0;
+	}
 	i1 = fioatrunc(h->hndl, size);
 	if (!i1) h->fsiz = h->npos = size;
 	else h->npos = -1;
+	if (lockflg) fiofulk(fnum);
 	return(i1);
 }
 
@@ -1247,6 +1367,7 @@ INT fiolock(INT *flist)  /* lock files */
 			return(i1);
 		}
 		h1->lckflg |= FIOX_HLK;
+		fiomapcheck(h1);
 	}
 	return(0);
 }
@@ -1320,6 +1441,7 @@ INT fioflck(INT fnum)
 	}
 	if (i1) return(i1);
 	h->lckflg |= FIOX_LLK;
+	fiomapcheck(h);
 	return(0);
 }
 
@@ -1781,6 +1903,14 @@ static CHAR *fioinitprops(FIOPARMS *parms)
 		i1 = atoi(ptr);
 		if (i1 > 0) parms->openlimit = i1;
 	}
+	if (!prpget("file", "mmap", NULL, NULL, &ptr, PRP_LOWER) && !strcmp(ptr, "on")) parms->flags |= FIO_FLAG_MMAP;
+	if (!prpget("file", "indexcache", NULL, NULL, &ptr, 0)) {
+		i1 = atoi(ptr);
+		if (i1 > 0) parms->indexcache = i1;
+	}
+	if (!prpget("file", "indexcachelog", NULL, NULL, &ptr, 0)) {
+		strncpy(parms->indexcachelog, ptr, sizeof(parms->indexcachelog) - 1);
+	}
 	if (!prpget("file", "filetime", NULL, NULL, &ptr, 0)) {
 		i1 = atoi(ptr);
 		if (i1 >= -1) {
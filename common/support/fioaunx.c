@@ -31,6 +31,7 @@
 #include <fcntl.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <dirent.h>
 #include <sys/ipc.h>
 #if defined(__MACOSX)
@@ -264,8 +265,9 @@ INT fioaread(FHANDLE handle, UCHAR *buffer, INT nbyte, OFFSET offset, INT *bytes
 {
 	INT i1;
 
-	if (offset != -1 && (i1 = fioalseek(handle, offset, 0, NULL))) return(i1);
-	i1 = read(handle, (CHAR *) buffer, nbyte);
+	/* pread does not move the file position, so a read at an offset is a single system call */
+	if (offset != -1) i1 = (INT) pread(handle, (CHAR *) buffer, nbyte, offset);
+	else i1 = (INT) read(handle, (CHAR *) buffer, nbyte);
 	if (i1 == -1) {
 		fioarderr = errno;
 		return(ERR_RDERR);
@@ -285,9 +287,8 @@ INT fioawrite(FHANDLE handle, UCHAR *buffer, size_t nbyte, OFFSET offset, size_t
 	if (!nbyte) return(0);
 
 	if (bytes != NULL) *bytes = 0;
-	if (offset != -1 && (i1 = fioalseek(handle, offset, 0, NULL))) return(i1);
-
-	i1 = write(handle, (CHAR *) buffer, nbyte);
+	if (offset != -1) i1 = (INT) pwrite(handle, (CHAR *) buffer, nbyte, offset);
+	else i1 = (INT) write(handle, (CHAR *) buffer, nbyte);
 	if (i1 == -1) {
 		fioawrerr = errno;
 		return(ERR_WRERR);
@@ -295,7 +296,8 @@ INT fioawrite(FHANDLE handle, UCHAR *buffer, size_t nbyte, OFFSET offset, size_t
 	if (bytes != NULL) *bytes = i1;
 	if (i1 != (INT)nbyte) {
 #if defined(__osf__) && defined(__alpha)
-		write(handle, (CHAR *) buffer, nbyte);
+		if (offset != -1) pwrite(handle, (CHAR *) buffer, nbyte, offset);
+		else write(handle, (CHAR *) buffer, nbyte);
 		fioawrerr = errno;
 #else
 		fioawrerr = -1;
@@ -524,6 +526,130 @@ INT fioatrunc(FHANDLE handle, OFFSET size)
 	return(0);
 }
 
+/**
+ * Map the whole file read only.  If *ptr is already a mapping of *size
+ * bytes and the file has not changed size, it is kept, otherwise it is
+ * replaced.  *ptr is set to NULL for an empty file.
+ * Returns ERR_RDERR if the file can not be mapped
+ */
+INT fioamap(FHANDLE handle, UCHAR **ptr, OFFSET *size)
+{
+	struct stat statbuf;
+	void *map;
+
+	if (fstat(handle, &statbuf) == -1) {
+		fioarderr = errno;
+		return(ERR_RDERR);
+	}
+	if (*ptr != NULL) {
+		if (statbuf.st_size == *size) return(0);
+		munmap(*ptr, (size_t) *size);
+		*ptr = NULL;
+	}
+	*size = 0;
+	if (statbuf.st_size <= 0) return(0);
+	map = mmap(NULL, (size_t) statbuf.st_size, PROT_READ, MAP_SHARED, handle, 0);
+	if (map == MAP_FAILED) {
+		fioarderr = errno;
+		return(ERR_RDERR);
+	}
+	*ptr = (UCHAR *) map;
+	*size = statbuf.st_size;
+	return(0);
+}
+
+void fioaunmap(UCHAR *ptr, OFFSET size)
+{
+	if (ptr != NULL) munmap(ptr, (size_t) size);
+}
+
+/**
+ * Map a whole file copy on write.  Its pages are shared with every other
+ * process that maps the file until a process writes to one of them.
+ * Returns ERR_FNOTF if the file does not exist, ERR_RDERR if it is not
+ * size bytes or can not be mapped
+ */
+INT fioamapfile(CHAR *filename, OFFSET size, UCHAR **ptr)
+{
+	INT handle;
+	struct stat statbuf;
+	void *map;
+
+	handle = open(filename, O_RDONLY);
+	if (handle == -1) {
+		fioaoperr = errno;
+		if (errno == ENOENT) return(ERR_FNOTF);
+		return(ERR_RDERR);
+	}
+	if (fstat(handle, &statbuf) == -1 || statbuf.st_size != size || size <= 0) {
+		close(handle);
+		return(ERR_RDERR);
+	}
+	map = mmap(NULL, (size_t) size, PROT_READ | PROT_WRITE, MAP_PRIVATE, handle, 0);
+	close(handle);
+	if (map == MAP_FAILED) {
+		fioarderr = errno;
+		return(ERR_RDERR);
+	}
+	*ptr = (UCHAR *) map;
+	return(0);
+}
+
+/**
+ * Write a whole file under a temporary name and rename it into place,
+ * so another process never maps it partly written
+ */
+INT fioasavefile(CHAR *filename, UCHAR *buffer, INT size)
+{
+	INT handle;
+	ssize_t i1;
+	CHAR workname[MAX_NAMESIZE + 8];
+
+	if (strlen(filename) + 7 > MAX_NAMESIZE) return(ERR_BADNM);
+	strcpy(workname, filename);
+	strcat(workname, ".XXXXXX");
+	handle = mkstemp(workname);
+	if (handle == -1) {
+		fioaoperr = errno;
+		return(ERR_OPERR);
+	}
+	fchmod(handle, 0644);
+	while (size) {
+		i1 = write(handle, buffer, (size_t) size);
+		if (i1 <= 0) {
+			fioawrerr = errno;
+			close(handle);
+			unlink(workname);
+			return(ERR_WRERR);
+		}
+		buffer += i1;
+		size -= (INT) i1;
+	}
+	close(handle);
+	if (rename(workname, filename) == -1) {
+		fioawrerr = errno;
+		unlink(workname);
+		return(ERR_WRERR);
+	}
+	return(0);
+}
+
+/**
+ * Return the size and last modification time of an open file
+ */
+INT fioastat(FHANDLE handle, OFFSET *size, OFFSET *mtime)
+{
+	struct stat statbuf;
+
+	if (fstat(handle, &statbuf) == -1) {
+		fioarderr = errno;
+		return(ERR_RDERR);
+	}
+	*size = statbuf.st_size;
+	*mtime = statbuf.st_mtime;
+	return(0);
+}
+
 INT fioadelete(CHAR *filename)
 {
 	INT i1;
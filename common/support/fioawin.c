@@ -312,6 +312,74 @@ INT fioatrunc(FHANDLE handle, OFFSET size)
 	return(0);
 }
 
+/**
+ * Memory mapped reads are not supported, fio always falls back to fioaread
+ */
+INT fioamap(FHANDLE handle, UCHAR **ptr, OFFSET *size)
+{
+	return(ERR_RDERR);
+}
+
+void fioaunmap(UCHAR *ptr, OFFSET size)
+{
+}
+
+/**
+ * Shared program images are not supported, the loader reads the program
+ */
+INT fioamapfile(CHAR *filename, OFFSET size, UCHAR **ptr)
+{
+	return(ERR_RDERR);
+}
+
+/**
+ * Write a whole file under a temporary name and rename it into place,
+ * so another process never reads it partly written
+ */
+INT fioasavefile(CHAR *filename, UCHAR *buffer, INT size)
+{
+	INT i1;
+	DWORD cnt;
+	HANDLE handle;
+	CHAR workname1[MAX_NAMESIZE + 1], workname2[MAX_NAMESIZE + 16];
+
+	if (strlen(filename) + 12 > MAX_NAMESIZE) return(ERR_BADNM);
+	for (i1 = 0; filename[i1]; i1++) {
+		if (filename[i1] == '/') workname1[i1] = '\\';
+		else workname1[i1] = filename[i1];
+	}
+	workname1[i1] = 0;
+	sprintf(workname2, "%s.%08X", workname1, (unsigned int) GetCurrentProcessId());
+
+	handle = CreateFile((LPCSTR) workname2, GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (handle == INVALID_HANDLE_VALUE) {
+		fioaoperr = GetLastError();
+		return(ERR_OPERR);
+	}
+	while (size) {
+		if (!WriteFile(handle, (LPVOID) buffer, (DWORD) size, &cnt, NULL) || !cnt) {
+			fioawrerr = GetLastError();
+			CloseHandle(handle);
+			DeleteFile((LPCTSTR) workname2);
+			return(ERR_WRERR);
+		}
+		buffer += cnt;
+		size -= (INT) cnt;
+	}
+	CloseHandle(handle);
+	if (!MoveFileEx((LPCTSTR) workname2, (LPCTSTR) workname1, MOVEFILE_REPLACE_EXISTING)) {
+		fioawrerr = GetLastError();
+		DeleteFile((LPCTSTR) workname2);
+		return(ERR_WRERR);
+	}
+	return(0);
+}
+
+INT fioastat(FHANDLE handle, OFFSET *size, OFFSET *mtime)
+{
+	return(ERR_RDERR);
+}
+
 INT fioadelete(CHAR *filename)
 {
 	INT i1;
@@ -196,6 +196,10 @@ typedef double DOUBLE;
 #define FS_MAXREADSIZE	65536
 #define FS_MAXWRITESIZE	65536
 
+#define READAHEAD_COUNT	256
+#define READAHEAD_SIZE	(FS_MAXREADSIZE + 1024)
+#define READAHEAD_NOTSUPPORTED	-1003	/* server returns bad function */
+
 #ifndef _DEBUG
 #define CONNECTION_TIMEOUT 10
 #else
@@ -217,6 +221,14 @@ typedef struct {
 	int inuse;
 	int fshandle;
 	char fsid[FSID_SIZE];
+	int readahead;		/* unlocked next reads are read ahead */
+	int aheadtype;		/* read function of the records in aheadbuf, 0 = none */
+	int aheadcount;		/* records in aheadbuf not yet used */
+	int aheadend;		/* read ahead stopped at end of file */
+	int aheadpos;		/* offset of next record in aheadbuf */
+	int aheadlast;		/* offset of last record used in aheadbuf */
+	int aheadkeylen;	/* length of the index key of each record in aheadbuf */
+	char *aheadbuf;
 } FILETABLESTRUCT;
 
 static int fstablehi, fstablesize;
@@ -230,7 +242,10 @@ static int startupcnt;
 #endif
 
 static int newfileentry(int, FILETABLESTRUCT **, CONNECTTABLESTRUCT **);
+static int findfileentry(int, FILETABLESTRUCT **, CONNECTTABLESTRUCT **);
 static int getfileentry(int, FILETABLESTRUCT **, CONNECTTABLESTRUCT **);
+static int readahead(FILETABLESTRUCT *, CONNECTTABLESTRUCT *, int, char *, int);
+static int dropahead(FILETABLESTRUCT *, CONNECTTABLESTRUCT *);
 static int communicate(SOCKET, int, char *, char *, char *, char *, int, char *, int, char *, int *);
 static void fsntooff(unsigned char *, OFFSET *, int);
 static int fsofftoa(OFFSET, char *);
@@ -680,6 +695,7 @@ int fsopen(int connecthandle, char *txtfilename, int options, int recsize)
 	}
 
 	memcpy(file->fsid, buf, FSID_SIZE);
+	if ((options & (FS_READAHEAD | FS_LOCKAUTO)) == FS_READAHEAD) file->readahead = TRUE;
 	file->inuse = TRUE;
 	return filehandle;
 }
@@ -851,6 +867,7 @@ int fsopenisi(int connecthandle, char *isifilename, int options, int recsize, in
 	}
 
 	memcpy(file->fsid, buf, FSID_SIZE);
+	if ((options & (FS_READAHEAD | FS_LOCKAUTO)) == FS_READAHEAD) file->readahead = TRUE;
 	file->inuse = TRUE;
 	return filehandle;
 }
@@ -1036,6 +1053,7 @@ int fsopenaim(int connecthandle, char *aimfilename, int options, int recsize, ch
 	}
 
 	memcpy(file->fsid, buf, FSID_SIZE);
+	if ((options & (FS_READAHEAD | FS_LOCKAUTO)) == FS_READAHEAD) file->readahead = TRUE;
 	file->inuse = TRUE;
 	return filehandle;
 }
@@ -1250,10 +1268,15 @@ int fsclose(int filehandle)
 	FILETABLESTRUCT *file;
 
 	fserrstr[0] = 0;
-	if (getfileentry(filehandle, &file, &connect) == -1) return -1;
+	if (findfileentry(filehandle, &file, &connect) == -1) return -1;
 
 	i1 = communicate(connect->sockethandle, connect->tcpflags, connect->cnid, file->fsid, FUNC_CLOSE, NULL, 0, NULL, 0, NULL, NULL);
 	file->inuse = FALSE;
+	if (file->aheadbuf != NULL) {
+		free(file->aheadbuf);
+		file->aheadbuf = NULL;
+	}
+	file->aheadtype = 0;
 	if (i1 < 0) return i1;
 	return 0;
 }
@@ -1266,13 +1289,18 @@ int fsclosedelete(int filehandle)
 	FILETABLESTRUCT *file;
 
 	fserrstr[0] = 0;
-	if (getfileentry(filehandle, &file, &connect) == -1) return -1;
+	if (findfileentry(filehandle, &file, &connect) == -1) return -1;
 
 	strcpy(function, FUNC_CLOSE);
 	function[5] = 'D';
 
 	i1 = communicate(connect->sockethandle, connect->tcpflags, connect->cnid, file->fsid, function, NULL, 0, NULL, 0, NULL, NULL);
 	file->inuse = FALSE;
+	if (file->aheadbuf != NULL) {
+		free(file->aheadbuf);
+		file->aheadbuf = NULL;
+	}
+	file->aheadtype = 0;
 	if (i1 < 0) return i1;
 	return 0;
 }
@@ -1396,7 +1424,11 @@ int fsreadnext(int filehandle, char *record, int length)
 	FILETABLESTRUCT *file;
 
 	fserrstr[0] = 0;
-	if (getfileentry(filehandle, &file, &connect) == -1) return -1;
+	if (findfileentry(filehandle, &file, &connect) == -1) return -1;
+	if (file->readahead) {
+		i1 = readahead(file, connect, 'S', record, length);
+		if (file->readahead) return i1;
+	}
 
 	strcpy(function, FUNC_READ);
 	function[4] = 'S';
@@ -1570,7 +1602,11 @@ int fsreadkeynext(int filehandle, char *record, int length)
 	FILETABLESTRUCT *file;
 
 	fserrstr[0] = 0;
-	if (getfileentry(filehandle, &file, &connect) == -1) return -1;
+	if (findfileentry(filehandle, &file, &connect) == -1) return -1;
+	if (file->readahead) {
+		i1 = readahead(file, connect, 'N', record, length);
+		if (file->readahead) return i1;
+	}
 
 	strcpy(function, FUNC_READ);
 	function[4] = 'N';
@@ -1800,7 +1836,11 @@ int fsreadaimnext(int filehandle, char *record, int length)
 	FILETABLESTRUCT *file;
 
 	fserrstr[0] = 0;
-	if (getfileentry(filehandle, &file, &connect) == -1) return -1;
+	if (findfileentry(filehandle, &file, &connect) == -1) return -1;
+	if (file->readahead) {
+		i1 = readahead(file, connect, 'O', record, length);
+		if (file->readahead) return i1;
+	}
 
 	strcpy(function, FUNC_READ);
 	function[4] = 'O';
@@ -2334,11 +2374,14 @@ static int newfileentry(int connecthandle, FILETABLESTRUCT **file, CONNECTTABLES
 	*connect = &fstable[connecthandle];
 	*file = &filetable[filehandle];
 	(*file)->fshandle = connecthandle;
+	(*file)->readahead = FALSE;
+	(*file)->aheadtype = 0;
+	(*file)->aheadbuf = NULL;
 	if (filehandle == filetablehi) filetablehi++;
 	return filehandle + FILEHANDLE_BASE;
 }
 
-static int getfileentry(int filehandle, FILETABLESTRUCT **file, CONNECTTABLESTRUCT **connect)
+static int findfileentry(int filehandle, FILETABLESTRUCT **file, CONNECTTABLESTRUCT **connect)
 {
 	filehandle -= FILEHANDLE_BASE;
 	if (filehandle < 0 || filehandle > filetablehi || !filetable[filehandle].inuse) {
@@ -2350,6 +2393,96 @@ static int getfileentry(int filehandle, FILETABLESTRUCT **file, CONNECTTABLESTRU
 	return 0;
 }
 
+static int getfileentry(int filehandle, FILETABLESTRUCT **file, CONNECTTABLESTRUCT **connect)
+{
+	if (findfileentry(filehandle, file, connect) == -1) return -1;
+	/* any other operation must see the server where the client last read */
+	if ((*file)->aheadtype && dropahead(*file, *connect) < 0) return -1;
+	return 0;
+}
+
+/*
+ * serve an unlocked next read from the records read ahead, reading more when
+ * they run out.  type is the read function, S (text), N (index) or O (aim)
+ */
+static int readahead(FILETABLESTRUCT *file, CONNECTTABLESTRUCT *connect, int type, char *record, int length)
+{
+	int i1, buflen, reclen, reslen;
+	char buf[32], function[FUNC_SIZE + 1];
+
+	for ( ; ; ) {
+		if (file->aheadtype == type) {
+			if (file->aheadcount) {
+				/* each record follows its length, position and key */
+				file->aheadlast = file->aheadpos;
+				tcpntoi((unsigned char *) file->aheadbuf + file->aheadpos, 8, &reclen);
+				file->aheadpos += 20 + file->aheadkeylen;
+				memcpy(record, file->aheadbuf + file->aheadpos, (reclen < length) ? reclen : length);
+				file->aheadpos += reclen;
+				file->aheadcount--;
+				return reclen;
+			}
+			/* all used, so the server is where reading the last one left it */
+			file->aheadtype = 0;
+			if (file->aheadend) return -3;
+		}
+		else if (file->aheadtype) {
+			i1 = dropahead(file, connect);
+			if (i1 < 0) return i1;
+		}
+
+		if (file->aheadbuf == NULL) {
+			file->aheadbuf = (char *) malloc(READAHEAD_SIZE);
+			if (file->aheadbuf == NULL) {
+				strcpy(fserrstr, "insufficient memory to allocate for read ahead buffer");
+				return -1;
+			}
+		}
+		strcpy(function, FUNC_READ);
+		function[4] = (char) type;
+		function[5] = 'M';
+		buflen = tcpitoa(READAHEAD_COUNT, buf);
+		buf[buflen++] = ' ';
+		buflen += tcpitoa(READAHEAD_SIZE, buf + buflen);
+		reslen = READAHEAD_SIZE;
+		i1 = communicate(connect->sockethandle, connect->tcpflags, connect->cnid, file->fsid, function, buf, buflen, NULL, 0, file->aheadbuf, &reslen);
+		if (i1 < 0) {
+			/* older server or a file that locks every read, caller reads normally */
+			if (i1 == READAHEAD_NOTSUPPORTED) file->readahead = FALSE;
+			return i1;
+		}
+		if (i1 == COMMUNICATE_NOREC) return -3;
+		if (i1 == COMMUNICATE_LOCKED) return -2;
+		if (reslen < 24 || reslen > READAHEAD_SIZE) {
+			strcpy(fserrstr, "communication error with server, invalid return read ahead packet");
+			return -1;
+		}
+		tcpntoi((unsigned char *) file->aheadbuf, 8, &file->aheadcount);
+		file->aheadend = !memcmp(file->aheadbuf + 8, "END", 3);
+		tcpntoi((unsigned char *) file->aheadbuf + 16, 8, &file->aheadkeylen);
+		file->aheadpos = 24;
+		file->aheadtype = type;
+	}
+}
+
+/* give back the records read ahead and not used, so the server returns to the */
+/* position and key of the last record the client used */
+static int dropahead(FILETABLESTRUCT *file, CONNECTTABLESTRUCT *connect)
+{
+	int i1;
+	char function[FUNC_SIZE + 1];
+
+	strcpy(function, FUNC_READ);
+	function[4] = (char) file->aheadtype;
+	function[5] = 'U';
+	file->aheadtype = 0;
+	if (!file->aheadcount && !file->aheadend) return 0;
+	i1 = communicate(connect->sockethandle, connect->tcpflags, connect->cnid, file->fsid, function,
+		file->aheadbuf + file->aheadlast + 8, 12 + file->aheadkeylen, NULL, 0, NULL, NULL);
+	if (i1 < 0) return i1;
+	return 0;
+}
+
 static int communicate(SOCKET sockethandle, int tcpflags, char *cnid, char *fsid, char *func,
 	char *data1, int datalen1, char *data2, int datalen2, char *result, int *resultlen)
 {
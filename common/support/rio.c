@@ -149,6 +149,19 @@ INT riologend()
 	return i1;
 }
 
+/*
+ * RIOEXIT
+ * release the rio work buffer, call before the memory it was allocated from is released
+ */
+void rioexit()
+{
+	if (riobufsiz) {
+		memfree(riobuf);
+		riobuf = NULL;
+		riobufsiz = 0;
+	}
+}
+
 /*
  * RIOOPEN
  * open name for record i/o processing
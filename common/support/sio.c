@@ -32,6 +32,7 @@
 #if OS_UNIX
 #include <sys/types.h>
 #include <unistd.h>
+#include <pthread.h>
 #endif
 
 #define DEATH_INTERRUPT		0
@@ -53,287 +54,292 @@ static char *errormsg[] = {
 /*** CODE: THIS IS ONLY SUPPORTING 2G RECORDS, ORDER NEEDS TO BE INCREASED TO OFFSET ***/
 #define FLAGBIT (~(UINT) INT_MAX)
 
-typedef struct mrgdef_struct {
-	UCHAR *ptr;
-	INT bpos;
-	INT bsize;
-	OFFSET fpos;
-	OFFSET fsize;
-} MERGEINFO;
-
 #define MERGESIZ (64 << 10)
 #define MAXMERGE 34
+/* minimum number of records for each sort thread */
+#define THREADMIN 4096
+
+#if SIO_MAXTHREADS > MAXMERGE
+#error SIO_MAXTHREADS must not be larger than MAXMERGE
+#endif
+
+/* state of one thread sorting part of the buffer */
+typedef struct siosort_struct {
+	SIO *sio;
+	INT lo;							/* first entry of order to sort */
+	INT hi;							/* last entry of order to sort */
+	INT key;						/* current key */
+	INT keypos;						/* current record position of key */
+	INT count[UCHAR_MAX + 1];		/* count of similar chararacters */
+} SIOSORT;
+
+typedef INT (*SIOLESS)(SIO *, INT, INT);
 
-static UCHAR sioflags;
 static CHAR eraseline[] = { "\r                         " };
 
-static UCHAR priority[UCHAR_MAX + 1];	/* holds priority of characters */
-static INT count[UCHAR_MAX + 1];		/* count of similar chararacters */
-
-static UCHAR *buffer;			/* sort buffer */
-static UINT *order = NULL;		/* order of records */
-static UCHAR *numtype;			/* results of numinfo */
-
-static INT keycnt;				/* number of keys */
-static INT key;					/* current key */
-static INT keypos;				/* current record position of key */
-static SIOKEY *keyptr;			/* key structure */
-static SIOKEY **keyptrptr;
-static UCHAR collateflag;
-static INT mergecnt;
-static INT sortedflag;
-static INT firstgetflag;
-
-static INT maxrec;				/* maximum number of records in buffer */
-static INT reclen;				/* length of record */
-static INT reccnt;				/* number of records in buffer */
-static UCHAR *nextrec, *lastrec;/* pointers into buffer used by sioput */
-
-static INT memsize;				/* memory allocated */
-static OFFSET writepos;			/* current position to write to work file */
-
-static UCHAR *mergebuf;
-static MERGEINFO *mrginfo;
-static INT mergebufsize;
-
-static INT workhandle = -1;		/* work file handle */
-static CHAR workdir[MAX_NAMESIZE];
-static CHAR workname[MAX_NAMESIZE];
-
-static void (*dspcallback)(CHAR *);
-
-static void process(void);
-static void dispadrsort(INT, INT);
-static void insertsort(INT, INT);
-static INT comprec(UCHAR *, UCHAR *);
-static int numinfo(UCHAR *, int);
+static SIO siodefault;			/* used by the non-reentrant functions */
+static INT siothreads;			/* number of sort threads, 0 = one per processor */
+
+static void sortrecs(SIO *);
+static void process(SIOSORT *);
+static void dispadrsort(SIOSORT *, INT, INT);
+static void insertsort(SIOSORT *, INT, INT);
+static INT comprec(SIO *, INT, INT, UCHAR *, UCHAR *);
+static int numinfo(SIO *, UCHAR *, int);
 static int numchar(UCHAR, int);
-static INT writeout(void);
-static INT bufinit(void);
-static INT merge(void);
-static void insertmerge(INT);
-static void sioputerr(INT, INT, CHAR *);
+static INT writeout(SIO *);
+static INT bufinit(SIO *);
+static INT merge(SIO *);
+static INT mergefill(SIO *, SIOMERGE *);
+static void treeinit(SIO *, UINT *, INT, SIOLESS);
+static void treeadjust(SIO *, UINT *, INT, INT, SIOLESS);
+static INT runless(SIO *, INT, INT);
+static INT chunkless(SIO *, INT, INT);
+static INT siocpus(void);
+static void sioputerr(SIO *, INT, INT, CHAR *);
 
 extern INT fioadlerr;		/* variable to hold delete errors */
 
 
 
 INT sioinit(INT len, INT cnt, SIOKEY **keypptr, CHAR *wrkdir, CHAR *wrkname, INT size, INT flags, void (*dspcb)(CHAR *))
+{
+	siodefault.flags = 0;
+	sioxexit(&siodefault);  /* just in case it was not called previously */
+	return sioxinit(&siodefault, len, cnt, keypptr, wrkdir, wrkname, size, flags, dspcb);
+}
+
+INT sioexit()
+{
+	return sioxexit(&siodefault);
+}
+
+UCHAR *sioputstart()
+{
+	return sioxputstart(&siodefault);
+}
+
+INT sioputend()
+{
+	return sioxputend(&siodefault);
+}
+
+INT sioget(UCHAR **ptr)
+{
+	return sioxget(&siodefault, ptr);
+}
+
+CHAR *siogeterr()
+{
+	return siodefault.errorstring;
+}
+
+void siosetthreads(INT threads)
+{
+	siothreads = threads;
+}
+
+/*
+ * SIOXINIT
+ * Start a sort using the caller's SIO, which must not already be in use.
+ * sioxexit must be called when done with the sort
+ */
+INT sioxinit(SIO *sio, INT len, INT cnt, SIOKEY **keypptr, CHAR *wrkdir, CHAR *wrkname, INT size, INT flags, void (*dspcb)(CHAR *))
 {
 	CHAR work[32];
 	UCHAR **pptr;
 
-	sioflags = 0;
-	sioexit();  /* just in case it was not called previously */
+	memset(sio, 0, sizeof(SIO));
+	sio->workhandle = -1;
 
 	/* make arguments global */
-	reclen = len;
-	keycnt = cnt;
-	keyptrptr = keypptr;
-	memsize = size;
-	if (wrkdir == NULL) workdir[0] = '\0';
-	else strcpy(workdir, wrkdir);
-	if (wrkname == NULL) workname[0] = '\0';
-	else strcpy(workname, wrkname);
-	sioflags = (UCHAR) flags;
-	if (dspcb == NULL) sioflags &= ~(SIOFLAGS_DSPPHASE | SIOFLAGS_DSPEXTRA | SIOFLAGS_DSPERROR);
-	else dspcallback = dspcb;
+	sio->reclen = len;
+	sio->keycnt = cnt;
+	sio->keyptrptr = keypptr;
+	sio->memsize = size;
+	if (wrkdir != NULL) strcpy(sio->workdir, wrkdir);
+	if (wrkname != NULL) strcpy(sio->workname, wrkname);
+	sio->flags = (UCHAR) flags;
+	if (dspcb == NULL) sio->flags &= ~(SIOFLAGS_DSPPHASE | SIOFLAGS_DSPEXTRA | SIOFLAGS_DSPERROR);
+	else sio->dspcallback = dspcb;
 
 	/* initial memory */
-	if (bufinit() == RC_NO_MEM) {
-		sioputerr(DEATH_NOMEM, 0, NULL);
+	if (bufinit(sio) == RC_NO_MEM) {
+		sioputerr(sio, DEATH_NOMEM, 0, NULL);
 		return ERR_NOMEM;
 	}
 
 	/* other initialization */
-	key = 0;
-	keypos = (*keyptrptr)[0].start;
-	sortedflag = TRUE;
-	reccnt = 0;
-	nextrec = lastrec = buffer;
-	mergecnt = 0;
-	firstgetflag = TRUE;
+	sio->sortedflag = TRUE;
+	sio->nextrec = sio->lastrec = sio->buffer;
+	sio->firstgetflag = TRUE;
 	if ((pptr = fiogetopt(FIO_OPT_COLLATEMAP)) != NULL) {
-		memcpy(priority, *pptr, sizeof(priority));
-		collateflag = TRUE;
+		memcpy(sio->priority, *pptr, sizeof(sio->priority));
+		sio->collateflag = TRUE;
 	}
-	else collateflag = FALSE;
-	memset(count, 0, sizeof(count));
-
-	if (sioflags & SIOFLAGS_DSPEXTRA) {
-		mscitoa(memsize, work);
-		dspcallback(work);
-		dspcallback(" bytes of memory allocated for sort buffers\n");
-		dspcallback("Input phase 1");
-		dspcallback(NULL);
+	sio->threads = siothreads;
+	if (sio->threads <= 0) sio->threads = siocpus();
+	if (sio->threads > SIO_MAXTHREADS) sio->threads = SIO_MAXTHREADS;
+
+	if (sio->flags & SIOFLAGS_DSPEXTRA) {
+		mscitoa(sio->memsize, work);
+		sio->dspcallback(work);
+		sio->dspcallback(" bytes of memory allocated for sort buffers\n");
+		sio->dspcallback("Input phase 1");
+		sio->dspcallback(NULL);
 	}
-	else if (sioflags & SIOFLAGS_DSPPHASE) {
-		dspcallback("Input phase");
-		dspcallback(NULL);
+	else if (sio->flags & SIOFLAGS_DSPPHASE) {
+		sio->dspcallback("Input phase");
+		sio->dspcallback(NULL);
 	}
 
 	return 0;
 }
 
-INT sioexit()
+INT sioxexit(SIO *sio)
 {
 	INT i1;
 	CHAR work[48];
-	if (sioflags & (SIOFLAGS_DSPPHASE | SIOFLAGS_DSPEXTRA)) dspcallback("\r");
-	sioflags = 0;
-	if (workhandle > 0) {
-		i1 = fiokill(workhandle);
-		workhandle = -1;
-		if (i1 == ERR_DLERR && (sioflags & SIOFLAGS_DSPEXTRA)) {
+	if (sio->flags & (SIOFLAGS_DSPPHASE | SIOFLAGS_DSPEXTRA)) sio->dspcallback("\r");
+	sio->flags = 0;
+	if (sio->workhandle > 0) {
+		i1 = fiokill(sio->workhandle);
+		sio->workhandle = -1;
+		if (i1 == ERR_DLERR && (sio->flags & SIOFLAGS_DSPEXTRA)) {
 			sprintf(work, "\nError deleting work file, errno=%d\n", fioadlerr);
-			dspcallback(work);
+			sio->dspcallback(work);
 		}
 	}
-	if (order != NULL) {
-		free(order);
-		order = NULL;
+	if (sio->order != NULL) {
+		free(sio->order);
+		sio->order = NULL;
 	}
 	return 0;
 }
 
-UCHAR *sioputstart()
+UCHAR *sioxputstart(SIO *sio)
 {
-	return nextrec;
+	return sio->nextrec;
 }
 
-INT sioputend()
+INT sioxputend(SIO *sio)
 {
 	INT i1;
 	CHAR work[32];
 
-	if (sortedflag && keycnt > 0) {
-		keyptr = *keyptrptr;  /* restore key pointer */
-		if (comprec(nextrec, lastrec) < 0) sortedflag = FALSE;
+	if (sio->sortedflag && sio->keycnt > 0) {
+		sio->keyptr = *sio->keyptrptr;  /* restore key pointer */
+		if (comprec(sio, 0, sio->keyptr[0].start, sio->nextrec, sio->lastrec) < 0) sio->sortedflag = FALSE;
 	}
-	order[reccnt] = (UINT) reccnt;
-	if (++reccnt == maxrec) {
-		if (!sortedflag) {  /* sort records if not already sorted */
-			if (sioflags & SIOFLAGS_DSPEXTRA) {
-				mscitoa(reccnt, work);
-				dspcallback(eraseline);
-				dspcallback("\rSorting ");
-				dspcallback(work);
-				dspcallback(" records");
-				dspcallback(NULL);
+	sio->order[sio->reccnt] = (UINT) sio->reccnt;
+	if (++sio->reccnt == sio->maxrec) {
+		if (!sio->sortedflag) {  /* sort records if not already sorted */
+			if (sio->flags & SIOFLAGS_DSPEXTRA) {
+				mscitoa(sio->reccnt, work);
+				sio->dspcallback(eraseline);
+				sio->dspcallback("\rSorting ");
+				sio->dspcallback(work);
+				sio->dspcallback(" records");
+				sio->dspcallback(NULL);
 			}
-			keyptr = *keyptrptr;  /* restore key pointer */
-			process();
-			/* reset key values, changed by process() */
-			key = 0;
-			keypos = keyptr[0].start;
+			sortrecs(sio);
 		}
-		i1 = writeout();
+		i1 = writeout(sio);
 		if (i1) return i1;
 
 		/* reset global variables */
-		sortedflag = TRUE;
-		reccnt = 0;
-		nextrec = lastrec = buffer;
-		if (sioflags & SIOFLAGS_DSPEXTRA) {
-			mscitoa(mergecnt + 1, work);
-			dspcallback(eraseline);
-			dspcallback("\rInput phase ");
-			dspcallback(work);
-			dspcallback(NULL);
+		sio->sortedflag = TRUE;
+		sio->reccnt = 0;
+		sio->nextrec = sio->lastrec = sio->buffer;
+		if (sio->flags & SIOFLAGS_DSPEXTRA) {
+			mscitoa(sio->mergecnt + 1, work);
+			sio->dspcallback(eraseline);
+			sio->dspcallback("\rInput phase ");
+			sio->dspcallback(work);
+			sio->dspcallback(NULL);
 		}
 	}
 	else {
-		lastrec = nextrec;
-		nextrec += reclen;
+		sio->lastrec = sio->nextrec;
+		sio->nextrec += sio->reclen;
 	}
 	return 0;
 }
 
-INT sioget(UCHAR **ptr)
+INT sioxget(SIO *sio, UCHAR **ptr)
 {
-	static INT numrec;
-	INT i1, i2;
+	INT i1;
 	CHAR work[32];
-	MERGEINFO *mrgptr;
-
-	if (firstgetflag) {
-		keyptr = *keyptrptr;  /* restore key pointer */
-		if (reccnt) {
-			if (!sortedflag) {  /* sort records if not already sorted */
-				if (sioflags & SIOFLAGS_DSPEXTRA) {
-					mscitoa(reccnt, work);
-					dspcallback(eraseline);
-					dspcallback("\rSorting ");
-					dspcallback(work);
-					dspcallback(" records");
-					dspcallback(NULL);
+	SIOMERGE *mrgptr;
+
+	if (sio->firstgetflag) {
+		sio->keyptr = *sio->keyptrptr;  /* restore key pointer */
+		if (sio->reccnt) {
+			if (!sio->sortedflag) {  /* sort records if not already sorted */
+				if (sio->flags & SIOFLAGS_DSPEXTRA) {
+					mscitoa(sio->reccnt, work);
+					sio->dspcallback(eraseline);
+					sio->dspcallback("\rSorting ");
+					sio->dspcallback(work);
+					sio->dspcallback(" records");
+					sio->dspcallback(NULL);
 				}
-				process();
-				/* reset key values, changed by process() */
-				key = 0;
-				keypos = keyptr[0].start;
+				sortrecs(sio);
 			}
-			if (mergecnt) {  /* add to work file */
-				i1 = writeout();
+			if (sio->mergecnt) {  /* add to work file */
+				i1 = writeout(sio);
 				if (i1) return i1;
 			}
 		}
-		if (mergecnt) {
-			if (mergecnt > 1) {
-				i1 = merge();
+		if (sio->mergecnt) {
+			if (sio->mergecnt > 1) {
+				i1 = merge(sio);
 				if (i1) return i1;
+				sio->lastrun = -1;
 			}
 			else {  /* total records = maxrec */
 				/* records have been sorted and written out by writeout, but read from memory */
-				order[0] = maxrec;  /* first record was saved off */
-				for (reccnt = 1; reccnt < maxrec; reccnt++) order[reccnt] = reccnt;
-				mergecnt = 0;
+				sio->order[0] = sio->maxrec;  /* first record was saved off */
+				for (sio->reccnt = 1; sio->reccnt < sio->maxrec; sio->reccnt++) sio->order[sio->reccnt] = sio->reccnt;
+				sio->mergecnt = 0;
 			}
 		}
-		numrec = 0;
-		if (sioflags & (SIOFLAGS_DSPPHASE | SIOFLAGS_DSPEXTRA)) {
-			if (sioflags & SIOFLAGS_DSPEXTRA) dspcallback(eraseline);
-			dspcallback("\rOutput phase");
-			dspcallback(NULL);
+		sio->numrec = 0;
+		if (sio->flags & (SIOFLAGS_DSPPHASE | SIOFLAGS_DSPEXTRA)) {
+			if (sio->flags & SIOFLAGS_DSPEXTRA) sio->dspcallback(eraseline);
+			sio->dspcallback("\rOutput phase");
+			sio->dspcallback(NULL);
 		}
-		firstgetflag = FALSE;
+		sio->firstgetflag = FALSE;
 	}
 
-	if (!mergecnt) {
-		if (numrec >= reccnt) return 1;
-		*ptr = buffer + (order[numrec++] & ~FLAGBIT) * reclen;
+	if (!sio->mergecnt) {
+		if (sio->numrec >= sio->reccnt) return 1;
+		*ptr = sio->buffer + (sio->order[sio->numrec++] & ~FLAGBIT) * sio->reclen;
 		return 0;
 	}
-	keyptr = *keyptrptr;  /* restore key pointer */
-	for ( ; ; ) {
-		mrgptr = mrginfo + order[0];
-		if (mrgptr->bpos != mrgptr->bsize) break;
-		if (!mrgptr->fsize) {
-			if (!--mergecnt) return 1;
-			memmove(order, order + 1, mergecnt * sizeof(UINT));
-			continue;
-		}
-		i1 = mergebufsize;
-		if (mrgptr->fsize < (OFFSET) i1) i1 = (INT) mrgptr->fsize;
-		i2 = fioread(workhandle, mrgptr->fpos, mrgptr->ptr, i1);
-		if (i2 != i1) {
-			if (i2 >= 0) i2 = 0;
-			sioputerr(DEATH_READ, i2, NULL);
-			if (!i2) i2 = ERR_BADRL;
-			return i2;
+	sio->keyptr = *sio->keyptrptr;  /* restore key pointer */
+	if (sio->lastrun >= 0) {  /* advance the run that the last record came from */
+		mrgptr = sio->mrginfo + sio->lastrun;
+		if (mrgptr->bpos == mrgptr->bsize && mrgptr->fsize) {
+			i1 = mergefill(sio, mrgptr);
+			if (i1) return i1;
 		}
-		mrgptr->bpos = 0;
-		mrgptr->bsize = i1;
-		mrgptr->fpos += i1;
-		mrgptr->fsize -= i1;
-		if (mergecnt > 1) insertmerge(mergecnt);
+		treeadjust(sio, sio->order, sio->mergecnt, sio->lastrun, runless);
 	}
+	sio->lastrun = (INT) sio->order[0];
+	mrgptr = sio->mrginfo + sio->lastrun;
+	if (mrgptr->bpos == mrgptr->bsize) return 1;  /* the winner is empty, so all runs are */
 	*ptr = mrgptr->ptr + mrgptr->bpos;
-	mrgptr->bpos += reclen;
-	if (mrgptr->bpos != mrgptr->bsize && mergecnt > 1) insertmerge(mergecnt);
+	mrgptr->bpos += sio->reclen;
 	return 0;
 }
 
+CHAR *sioxgeterr(SIO *sio)
+{
+	return sio->errorstring;
+}
+
 /*** NOTE: SIOSORT IS OBSOLETE, DO NOT USE IN NEW CODE ***/
 INT siosort(INT len, INT cnt, SIOKEY **keypptr, INT (*getrtn)(UCHAR *),
 		INT (*putrtn)(UCHAR *), CHAR *wrkdir, CHAR *wrkname, INT flags, INT size, void (*dspcb)(CHAR *))
@@ -370,65 +376,168 @@ INT siosort(INT len, INT cnt, SIOKEY **keypptr, INT (*getrtn)(UCHAR *),
 	return 0;
 }
 
+#if OS_WIN32
+static DWORD WINAPI sortthread(LPVOID arg)
+{
+	process((SIOSORT *) arg);
+	return 0;
+}
+#else
+static void *sortthread(void *arg)
+{
+	process((SIOSORT *) arg);
+	return NULL;
+}
+#endif
+
+/* SORTRECS */
+/* sort the records in the buffer, splitting large buffers between threads */
+static void sortrecs(SIO *sio)
+{
+	INT i1, i2, cnt, size;
+	UINT *neworder, tree[SIO_MAXTHREADS];
+	SIOSORT sorts[SIO_MAXTHREADS];
+#if OS_WIN32
+	HANDLE threads[SIO_MAXTHREADS];
+#else
+	pthread_t threads[SIO_MAXTHREADS];
+	INT started[SIO_MAXTHREADS];
+#endif
+
+	sio->keyptr = *sio->keyptrptr;  /* restore key pointer */
+	cnt = sio->reccnt / THREADMIN;
+	if (cnt > sio->threads) cnt = sio->threads;
+	neworder = NULL;
+	if (cnt > 1) {
+		neworder = (UINT *) malloc(sio->reccnt * sizeof(UINT));
+		if (neworder == NULL) cnt = 1;
+	}
+	if (cnt <= 1) {
+		sorts[0].sio = sio;
+		sorts[0].lo = 0;
+		sorts[0].hi = sio->reccnt - 1;
+		process(&sorts[0]);
+		return;
+	}
+
+	/* each thread sorts its own part of order */
+	size = sio->reccnt / cnt;
+	for (i1 = 0; i1 < cnt; i1++) {
+		sorts[i1].sio = sio;
+		sorts[i1].lo = i1 * size;
+		sorts[i1].hi = (i1 == cnt - 1) ? sio->reccnt - 1 : (i1 + 1) * size - 1;
+	}
+	for (i1 = 1; i1 < cnt; i1++) {
+#if OS_WIN32
+		threads[i1] = CreateThread(NULL, 0, sortthread, &sorts[i1], 0, NULL);
+		if (threads[i1] == NULL) process(&sorts[i1]);
+#else
+		started[i1] = !pthread_create(&threads[i1], NULL, sortthread, &sorts[i1]);
+		if (!started[i1]) process(&sorts[i1]);
+#endif
+	}
+	process(&sorts[0]);
+	for (i1 = 1; i1 < cnt; i1++) {
+#if OS_WIN32
+		if (threads[i1] != NULL) {
+			WaitForSingleObject(threads[i1], INFINITE);
+			CloseHandle(threads[i1]);
+		}
+#else
+		if (started[i1]) pthread_join(threads[i1], NULL);
+#endif
+	}
+
+	/* merge the sorted parts */
+	for (i1 = 0; i1 < cnt; i1++) {
+		sio->chunkpos[i1] = sorts[i1].lo;
+		sio->chunkend[i1] = sorts[i1].hi;
+	}
+	treeinit(sio, tree, cnt, chunkless);
+	for (i1 = 0; i1 < sio->reccnt; i1++) {
+		i2 = (INT) tree[0];
+		neworder[i1] = sio->order[sio->chunkpos[i2]++] & ~FLAGBIT;
+		treeadjust(sio, tree, cnt, i2, chunkless);
+	}
+	memcpy(sio->order, neworder, sio->reccnt * sizeof(UINT));
+	free(neworder);
+}
+
 /* PROCESS */
 /* initialize sorting fields and choose method of sort */
-static void process()
+static void process(SIOSORT *sort)
 {
 	INT i1, i2, flag;
+	UINT *order;
+	SIOKEY *keyptr;
+
+	order = sort->sio->order;
+	keyptr = sort->sio->keyptr;
+	memset(sort->count, 0, sizeof(sort->count));
+	sort->key = 0;
+	sort->keypos = keyptr[0].start;
 
 	/* first sort the entire group */
-	i1 = reccnt - 1;
-	order[i1] = (UINT) i1 | FLAGBIT;
-	if (i1 > 48) dispadrsort(0, i1);
-	else insertsort(0, i1);
-	keypos++;
+	i1 = sort->hi;
+	order[i1] |= FLAGBIT;
+	if (i1 - sort->lo > 48) dispadrsort(sort, sort->lo, i1);
+	else insertsort(sort, sort->lo, i1);
+	sort->keypos++;
 
 	for ( ; ; ) {
-		while (keypos < keyptr[key].end) {
+		while (sort->keypos < keyptr[sort->key].end) {
 			/* assume all records are sorted until proven false */
 			flag = TRUE;
 		
 			/* read through the order array finding groups larger than 1 */
-			for (i1 = 0; i1 < reccnt; i1++) {
+			for (i1 = sort->lo; i1 <= sort->hi; i1++) {
 				if (order[i1] & FLAGBIT) continue;
 				i2 = i1;
 				while (!(order[++i1] & FLAGBIT));
-				if (i1 - i2 > 48) dispadrsort(i2, i1);
-				else insertsort(i2, i1);
+				if (i1 - i2 > 48) dispadrsort(sort, i2, i1);
+				else insertsort(sort, i2, i1);
 				flag = FALSE;
 			}
 			if (flag) return;
-			keypos++;
+			sort->keypos++;
 		}
-		if (++key == keycnt) return;
-		keypos = keyptr[key].start;
+		if (++sort->key == sort->sio->keycnt) return;
+		sort->keypos = keyptr[sort->key].start;
 	}
 }
 
 /* DISPADRSORT */
 /* displacement address sort for 50 or more records */
-static void dispadrsort(INT ilo, INT  ihi)
+static void dispadrsort(SIOSORT *sort, INT ilo, INT  ihi)
 {
-	INT i1, i2 = 0, address, location, nonzero, number, pointer, temp;
-	INT zloc[UCHAR_MAX + 1];
-	UCHAR typeflag, *ptr;
+	INT i1, i2 = 0, address, location, nonzero, number, pointer, reclen, temp;
+	INT *count, zloc[UCHAR_MAX + 1];
+	UINT *order;
+	UCHAR typeflag, *numtype, *priority, *ptr;
+	SIO *sio;
 
 	assert(ilo < ihi);
+	sio = sort->sio;
+	order = sio->order;
+	numtype = sio->numtype;
+	priority = sio->priority;
+	reclen = sio->reclen;
+	count = sort->count;
 	order[ihi] &= ~FLAGBIT;
-	typeflag = keyptr[key].typeflg;
-	ptr = buffer + keypos;
+	typeflag = sio->keyptr[sort->key].typeflg;
+	ptr = sio->buffer + sort->keypos;
 
 	if (typeflag & SIO_NUMERIC) {
-		if (keypos == keyptr[key].start)  /* get numeric information */
+		if (sort->keypos == sio->keyptr[sort->key].start)  /* get numeric information */
 			for (i1 = ilo; i1 <= ihi; i1++)
-				numtype[order[i1]] = (UCHAR) numinfo(buffer + order[i1] * reclen, key);
+				numtype[order[i1]] = (UCHAR) numinfo(sio, sio->buffer + order[i1] * reclen, sort->key);
 		for (i1 = ilo; i1 <= ihi; i1++) {
 			i2 = numchar(ptr[order[i1] * reclen], numtype[order[i1]]);
 			if (typeflag & SIO_DESCEND) i2 = UCHAR_MAX - i2;
 			count[i2]++;
 		}
 	}
-	else if (!collateflag || (typeflag & SIO_POSITION)) {
+	else if (!sio->collateflag || (typeflag & SIO_POSITION)) {
 		for (i1 = ilo; i1 <= ihi; ) {
 			i2 = ptr[order[i1++] * reclen];
 			if (typeflag & SIO_DESCEND) i2 = UCHAR_MAX - i2;
@@ -475,7 +584,7 @@ static void dispadrsort(INT ilo, INT  ihi)
 			}
 		}
 	}
-	else if (!collateflag || (typeflag & SIO_POSITION)) {
+	else if (!sio->collateflag || (typeflag & SIO_POSITION)) {
 		for (i1 = ilo; i1 <= ihi; i1++) {
 			if (!(order[i1] & FLAGBIT)) {
 				pointer = (INT) order[i1];
@@ -520,19 +629,23 @@ static void dispadrsort(INT ilo, INT  ihi)
 
 /* INSERTSORT */
 /* insertion sort for 49 or less records */
-static void insertsort(INT ilo, INT ihi)
+static void insertsort(SIOSORT *sort, INT ilo, INT ihi)
 {
 	INT i1, i2, i3;
+	UINT *order;
 	UCHAR *ptr1, *ptr2;
+	SIO *sio;
 
+	sio = sort->sio;
+	order = sio->order;
 	order[ihi] &= ~FLAGBIT;
 	for (i2 = ihi; i2-- > ilo; ) {
 		i1 = i2;
 		i3 = (INT) order[i2];
-		ptr1 = buffer + i3 * reclen;
+		ptr1 = sio->buffer + i3 * sio->reclen;
 		while (i1++ < ihi) {
-			ptr2 = buffer + order[i1] * reclen;
-			if (comprec(ptr1, ptr2) <= 0) break;
+			ptr2 = sio->buffer + order[i1] * sio->reclen;
+			if (comprec(sio, sort->key, sort->keypos, ptr1, ptr2) <= 0) break;
 			order[i1 - 1] = order[i1];
 		}
 		order[i1 - 1] = (UINT) i3;
@@ -541,18 +654,20 @@ static void insertsort(INT ilo, INT ihi)
 }
 
 /* COMPREC */
-/* compare two records */
-static INT comprec(UCHAR *rec1, UCHAR *rec2)
+/* compare two records, starting at position keypos of key */
+static INT comprec(SIO *sio, INT key, INT keypos, UCHAR *rec1, UCHAR *rec2)
 {
 	INT i1, i2, i3, i4 = 0, numflag1, numflag2;
+	SIOKEY *keyptr;
 
+	keyptr = sio->keyptr;
 	i1 = key;
 	i2 = keypos;
 	while (TRUE) {
 		i3 = keyptr[i1].end;
 		if (keyptr[i1].typeflg & SIO_NUMERIC) {
-			numflag1 = numinfo(rec1, i1);
-			numflag2 = numinfo(rec2, i1);
+			numflag1 = numinfo(sio, rec1, i1);
+			numflag2 = numinfo(sio, rec2, i1);
 			for ( ; i2 < i3; i2++) {
 				i4 = numchar(rec1[i2], numflag1) - numchar(rec2[i2], numflag2);
 				if (i4) break;
@@ -562,7 +677,7 @@ static INT comprec(UCHAR *rec1, UCHAR *rec2)
 				return i4;
 			}
 		}
-		else if (!collateflag || (keyptr[i1].typeflg & SIO_POSITION)) {
+		else if (!sio->collateflag || (keyptr[i1].typeflg & SIO_POSITION)) {
 			i4 = memcmp(rec1 + i2, rec2 + i2, i3 - i2);
 			if (i4) {
 				if (keyptr[i1].typeflg & SIO_DESCEND) return -i4;
@@ -572,7 +687,7 @@ static INT comprec(UCHAR *rec1, UCHAR *rec2)
 		else {
 			while (i2 < i3) {
 				if (rec1[i2] != rec2[i2]) {
-					i4 = (INT) priority[rec1[i2]] - (INT) priority[rec2[i2]];
+					i4 = (INT) sio->priority[rec1[i2]] - (INT) sio->priority[rec2[i2]];
 					if (i4) {
 						if (keyptr[i1].typeflg & SIO_DESCEND) return -i4;
 						return i4;
@@ -581,7 +696,7 @@ static INT comprec(UCHAR *rec1, UCHAR *rec2)
 				i2++;
 			}
 		}
-		if (++i1 == keycnt) return 0;
+		if (++i1 == sio->keycnt) return 0;
 		i2 = keyptr[i1].start;
 	}
 }
@@ -590,12 +705,12 @@ static INT comprec(UCHAR *rec1, UCHAR *rec2)
 #define NUMFLAG_INVALID	0x15
 #define NUMFLAG_NEGATIVE	0x20
 
-static int numinfo(UCHAR *rec, int keynum)
+static int numinfo(SIO *sio, UCHAR *rec, int keynum)
 {
 	int i1, i2, numflag;
 
 	numflag = NUMFLAG_NULL;
-	for (i1 = keyptr[keynum].start, i2 = keyptr[keynum].end; i1 < i2; i1++) {
+	for (i1 = sio->keyptr[keynum].start, i2 = sio->keyptr[keynum].end; i1 < i2; i1++) {
 		if (rec[i1] == ' ') {
 			if (numflag != NUMFLAG_NULL) return NUMFLAG_INVALID;
 		}
@@ -632,98 +747,101 @@ static int numchar(UCHAR chr, int numflag)
 #undef NUMFLAG_NEGATIVE
 
 
-static INT getTempWorkHandle(CHAR *work) {
+static INT getTempWorkHandle(SIO *sio, CHAR *work) {
 #if OS_UNIX && !defined(__linux)
 	UCHAR *ptr1;
 #endif
 #if OS_WIN32
-	if (!GetTempFileName(workdir, "srt", 0, work)) {
-		sioputerr(DEATH_CREATE, ERR_BADNM, workdir);
+	if (!GetTempFileName(sio->workdir, "srt", 0, work)) {
+		sioputerr(sio, DEATH_CREATE, ERR_BADNM, sio->workdir);
 		return ERR_BADNM;
 	}
 	miofixname(work, ".wrk", FIXNAME_EXT_ADD);
-	workhandle = fioopen(work, FIO_M_PRP | FIO_P_WRK);
+	sio->workhandle = fioopen(work, FIO_M_PRP | FIO_P_WRK);
 #endif
 
 #if OS_UNIX
 #ifdef __linux
-	strcpy(work, workdir);
+	strcpy(work, sio->workdir);
 	if (work[strlen(work) - 1] != '/') strcat(work, "/");
 	strcat(work, "srtXXXXXX");
-	workhandle = mkstemp(work);  // returns an fd
-	if (workhandle == -1) {
-		sioputerr(DEATH_CREATE, ERR_BADNM, workdir);
+	sio->workhandle = mkstemp(work);  // returns an fd
+	if (sio->workhandle == -1) {
+		sioputerr(sio, DEATH_CREATE, ERR_BADNM, sio->workdir);
 		return ERR_BADNM;
 	}
-	close(workhandle);
+	close(sio->workhandle);
 	unlink(work);
 #else
-	ptr1 = (UCHAR *) tempnam(workdir, "srt");
+	ptr1 = (UCHAR *) tempnam(sio->workdir, "srt");
 	if (ptr1 == NULL) {
-		sioputerr(DEATH_CREATE, ERR_BADNM, workdir);
+		sioputerr(sio, DEATH_CREATE, ERR_BADNM, sio->workdir);
 		return ERR_BADNM;
 	}
 	strcpy(work, (CHAR *) ptr1);
 	free(ptr1);
 	miofixname(work, ".wrk", FIXNAME_EXT_ADD);
 #endif
-	workhandle = fioopen(work, FIO_M_PRP | FIO_P_WRK);
+	sio->workhandle = fioopen(work, FIO_M_PRP | FIO_P_WRK);
 #endif
-	return workhandle;
+	return sio->workhandle;
 }
 
 /* WRITEOUT */
 /* write out the records */
-static INT writeout()
+static INT writeout(SIO *sio)
 {
-	INT i1, cnt, tmpcnt, wrkcnt;
+	INT i1, cnt, tmpcnt, wrkcnt, reclen;
+	UINT *order;
 	OFFSET posinfo[2];
 	CHAR work[MAX_NAMESIZE];
 	UCHAR *ptr1, *ptr2, *saveptr;
 
-	if (!mergecnt) {  /* first pass processing */
+	if (!sio->mergecnt) {  /* first pass processing */
 		/* create work file */
-		if (!workdir[0]) strcpy(workdir, ".");
-		if (!workname[0]) {
-			workhandle = getTempWorkHandle(work);
-			if (workhandle == ERR_BADNM) return ERR_BADNM;
+		if (!sio->workdir[0]) strcpy(sio->workdir, ".");
+		if (!sio->workname[0]) {
+			sio->workhandle = getTempWorkHandle(sio, work);
+			if (sio->workhandle == ERR_BADNM) return ERR_BADNM;
 		}
 		else {
-			strcpy(work, workname);
+			strcpy(work, sio->workname);
 			miofixname(work, "", FIXNAME_PAR_DBCVOL);
 			miogetname((CHAR **) &ptr1, (CHAR **) &ptr2);
-			if (!*ptr1 && fioaslash(workname) < 0) {
-				strcpy(work, workdir);
+			if (!*ptr1 && fioaslash(sio->workname) < 0) {
+				strcpy(work, sio->workdir);
 				fioaslashx(work);
 			}
 			else work[0] = 0;
-			strcat(work, workname);
+			strcat(work, sio->workname);
 			miofixname(work, ".wrk", FIXNAME_EXT_ADD);
-			workhandle = fioopen(work, FIO_M_PRP | FIO_P_WRK);
+			sio->workhandle = fioopen(work, FIO_M_PRP | FIO_P_WRK);
 		}
-		if (workhandle < 0) {
-			sioputerr(DEATH_CREATE, workhandle, work);
-			return workhandle;
+		if (sio->workhandle < 0) {
+			sioputerr(sio, DEATH_CREATE, sio->workhandle, work);
+			return sio->workhandle;
 		}
-		if (sioflags & SIOFLAGS_DSPEXTRA) {
-			dspcallback(eraseline);
-			dspcallback("\rCreated work file ");
-			dspcallback(work);
-			dspcallback("\n");
+		if (sio->flags & SIOFLAGS_DSPEXTRA) {
+			sio->dspcallback(eraseline);
+			sio->dspcallback("\rCreated work file ");
+			sio->dspcallback(work);
+			sio->dspcallback("\n");
 		}
-		writepos = 0;
-		keyptr = *keyptrptr;  /* restore key pointer */
+		sio->writepos = 0;
+		sio->keyptr = *sio->keyptrptr;  /* restore key pointer */
 	}
 
-	if (!sortedflag) {  /* rearrange buffer into sorted order */
-		saveptr = buffer + reccnt * reclen;
-		for (cnt = 0; cnt < reccnt; cnt++) {
+	order = sio->order;
+	reclen = sio->reclen;
+	if (!sio->sortedflag) {  /* rearrange buffer into sorted order */
+		saveptr = sio->buffer + sio->reccnt * reclen;
+		for (cnt = 0; cnt < sio->reccnt; cnt++) {
 			if ((INT)(order[cnt] & ~FLAGBIT) == cnt) continue;
 			wrkcnt = cnt;
 			ptr1 = saveptr;
 			do {
 				ptr2 = ptr1;
-				ptr1 = buffer + wrkcnt * reclen;
+				ptr1 = sio->buffer + wrkcnt * reclen;
 				memcpy(ptr2, ptr1, reclen);
 				tmpcnt = (INT)(order[wrkcnt] & ~FLAGBIT);
 				order[wrkcnt] = (UINT) wrkcnt;
@@ -733,347 +851,396 @@ static INT writeout()
 		}
 	}
 
-	if (sioflags & SIOFLAGS_DSPEXTRA) {
-		dspcallback(eraseline);
-		dspcallback("\rWriting to work file");
-		dspcallback("\n");
+	if (sio->flags & SIOFLAGS_DSPEXTRA) {
+		sio->dspcallback(eraseline);
+		sio->dspcallback("\rWriting to work file");
+		sio->dspcallback("\n");
 	}
-	posinfo[1] = (OFFSET) reccnt * reclen;
-	posinfo[0] = writepos + sizeof(posinfo) + posinfo[1];
+	posinfo[1] = (OFFSET) sio->reccnt * reclen;
+	posinfo[0] = sio->writepos + sizeof(posinfo) + posinfo[1];
 	if (posinfo[0] & 0x0FFF) posinfo[0] = (posinfo[0] & ~0x0FFF) + 0x1000;
-	memcpy(buffer - sizeof(posinfo), posinfo, sizeof(posinfo));
-	i1 = fiowrite(workhandle, writepos, buffer - sizeof(posinfo), (INT)(sizeof(posinfo) + posinfo[1]));
+	memcpy(sio->buffer - sizeof(posinfo), posinfo, sizeof(posinfo));
+	i1 = fiowrite(sio->workhandle, sio->writepos, sio->buffer - sizeof(posinfo), (INT)(sizeof(posinfo) + posinfo[1]));
 	if (i1) {
-		sioputerr(DEATH_WRITE, i1, NULL);
+		sioputerr(sio, DEATH_WRITE, i1, NULL);
 		return i1;
 	}
-	writepos = posinfo[0];
+	sio->writepos = posinfo[0];
 	/* if first merge, save off first record to optimize sioget if there are no more sioputend */
-	if (++mergecnt == 1) memcpy(buffer + maxrec * reclen, buffer, reclen);
+	if (++sio->mergecnt == 1) memcpy(sio->buffer + sio->maxrec * reclen, sio->buffer, reclen);
 	return 0;
 }
 
 /* MERGE */
 /* merge the sorted records */
-static INT merge()
+static INT merge(SIO *sio)
 {
-	INT i1, i2, i3, bufcnt, bufsize, mrgflag;
+	INT i1, i2, i3, bufcnt, bufsize, mrgflag, reclen;
 	INT lwork, cnt, passcnt, passnum, savecnt;
+	UINT *order;
 	OFFSET firstpos, filesize, lastpos, mergesize, nextpos, savesize, posinfo[2];
 	CHAR work[17];
 	UCHAR *ptr;
-	MERGEINFO *mrgptr;
+	SIOMERGE *mrgptr;
 
-	if ((sioflags & (SIOFLAGS_DSPPHASE | SIOFLAGS_DSPEXTRA)) == SIOFLAGS_DSPPHASE) {
-		dspcallback("\rMerge phase");
-		dspcallback(NULL);
+	if ((sio->flags & (SIOFLAGS_DSPPHASE | SIOFLAGS_DSPEXTRA)) == SIOFLAGS_DSPPHASE) {
+		sio->dspcallback("\rMerge phase");
+		sio->dspcallback(NULL);
 	}
+	order = sio->order;
+	reclen = sio->reclen;
 	firstpos = 0;
-	filesize = writepos;
+	filesize = sio->writepos;
 	for (cnt = 1; ; cnt++) {
 		/* initialize merge buffers */
-		i1 = (memsize - 0x10) / (reclen + sizeof(MERGEINFO) + sizeof(UINT));
-		if (i1 < mergecnt || mergecnt > MAXMERGE) i1 = (memsize - MERGESIZ - 0x10) / (reclen + sizeof(MERGEINFO) + sizeof(UINT));
-		if (i1 > mergecnt) i1 = mergecnt;
+		i1 = (sio->memsize - 0x10) / (reclen + sizeof(SIOMERGE) + sizeof(UINT));
+		if (i1 < sio->mergecnt || sio->mergecnt > MAXMERGE) i1 = (sio->memsize - MERGESIZ - 0x10) / (reclen + sizeof(SIOMERGE) + sizeof(UINT));
+		if (i1 > sio->mergecnt) i1 = sio->mergecnt;
 		if (i1 > MAXMERGE) passcnt = MAXMERGE;
 		else passcnt = i1;
 		mrgflag = 0;
-		if (passcnt < mergecnt) {
-			while ((passcnt - 1) * (passcnt - 1) >= mergecnt) passcnt--;
+		if (passcnt < sio->mergecnt) {
+			while ((passcnt - 1) * (passcnt - 1) >= sio->mergecnt) passcnt--;
 			mrgflag = 1;
 		}
 		i2 = passcnt * sizeof(UINT);
 		if (i2 & 0x0F) i2 = (i2 & ~0x0F) + 0x10;  /* align mrginfo on 16 byte boundary */
-		mrginfo = (MERGEINFO *)((UCHAR *) order + i2);
-		i2 += passcnt * sizeof(MERGEINFO);
+		sio->mrginfo = (SIOMERGE *)((UCHAR *) order + i2);
+		i2 += passcnt * sizeof(SIOMERGE);
 		if (mrgflag) {
-			mergebuf = (UCHAR *) order + i2;
+			sio->mergebuf = (UCHAR *) order + i2;
 			i2 += MERGESIZ;
 			bufsize = MERGESIZ;
 		}
-		mergebufsize = (memsize - i2) / passcnt;
-		mergebufsize -= mergebufsize % reclen;
-		i1 = memsize;
+		sio->mergebufsize = (sio->memsize - i2) / passcnt;
+		sio->mergebufsize -= sio->mergebufsize % reclen;
+		i1 = sio->memsize;
 		for (i3 = 0; i3 < passcnt; i3++) {
-			i1 -= mergebufsize;
-			mrginfo[i3].ptr = (UCHAR *) order + i1;
+			i1 -= sio->mergebufsize;
+			sio->mrginfo[i3].ptr = (UCHAR *) order + i1;
 		}
 		if (mrgflag) {
 			/* try to increase merge buffer with left over memory */
 			bufsize += (UINT)((i1 - i2) & ~0x0FFF);
-			if (sioflags & SIOFLAGS_DSPEXTRA) {
+			if (sio->flags & SIOFLAGS_DSPEXTRA) {
 				mscitoa(cnt, work);
-				dspcallback(eraseline);
-				dspcallback("\rMerge phase ");
-				dspcallback(work);
-				dspcallback(NULL);
+				sio->dspcallback(eraseline);
+				sio->dspcallback("\rMerge phase ");
+				sio->dspcallback(work);
+				sio->dspcallback(NULL);
 			}
 		}
 
 		/* merge pass */
 		savecnt = passcnt;
 		nextpos = firstpos;
-		writepos = filesize;
-		for (lwork = mergecnt; lwork > mrgflag; lwork -= passcnt) {
+		sio->writepos = filesize;
+		for (lwork = sio->mergecnt; lwork > mrgflag; lwork -= passcnt) {
 			if (passcnt > lwork) passcnt = lwork;
 
 			/* fill merge buffers */
 			mergesize = 0;
 			for (passnum = 0; passnum < passcnt; passnum++) {
-				i1 = fioread(workhandle, nextpos, (UCHAR *) posinfo, sizeof(posinfo));
+				i1 = fioread(sio->workhandle, nextpos, (UCHAR *) posinfo, sizeof(posinfo));
 				if (i1 != sizeof(posinfo)) {
 					if (i1 >= 0) i1 = 0;
-					sioputerr(DEATH_READ, i1, NULL);
+					sioputerr(sio, DEATH_READ, i1, NULL);
 					if (!i1) i1 = ERR_BADRL;
 					return i1;
 				}
-				mrgptr = mrginfo + passnum;
+				mrgptr = sio->mrginfo + passnum;
 				mrgptr->fpos = nextpos + sizeof(posinfo);
 				mrgptr->fsize = posinfo[1];
 				mergesize += posinfo[1];
 				nextpos = posinfo[0];
-				i1 = mergebufsize;
-				if (posinfo[1] < (OFFSET) i1) i1 = (INT) posinfo[1];
-				i2 = fioread(workhandle, mrgptr->fpos, mrgptr->ptr, i1);
-				if (i2 != i1) {
-					if (i2 >= 0) i2 = 0;
-					sioputerr(DEATH_READ, i2, NULL);
-					if (!i2) i2 = ERR_BADRL;
-					return i2;
-				}
-				mrgptr->bpos = 0;
-				mrgptr->bsize = i1;
-				mrgptr->fpos += i1;
-				mrgptr->fsize -= i1;
-				for (i2 = 0; i2 < passnum; i2++) if (comprec(mrgptr->ptr, mrginfo[order[i2]].ptr) < 0) break;
-				if (i2 < passnum) memmove(order + i2 + 1, order + i2, (passnum - i2) * sizeof(UINT));
-				order[i2] = (INT) passnum;
+				i1 = mergefill(sio, mrgptr);
+				if (i1) return i1;
 			}
+			treeinit(sio, order, passcnt, runless);
 			if (!mrgflag) return 0;
 
 			/* write header information for merge block */
 			if (passcnt + 1 < lwork) {  /* not last merge block */
-				posinfo[0] = writepos + sizeof(posinfo) + mergesize;
+				posinfo[0] = sio->writepos + sizeof(posinfo) + mergesize;
 				if (posinfo[0] & 0x0FFF) posinfo[0] = (posinfo[0] & ~0x0FFF) + 0x1000;
-				if (lwork == mergecnt) {  /* first merge block */
+				if (lwork == sio->mergecnt) {  /* first merge block */
 					firstpos = 0;
 					savesize = sizeof(posinfo) + mergesize;
 				}
 			}
-			else if (lwork == mergecnt) {  /* both first and last merge block */
+			else if (lwork == sio->mergecnt) {  /* both first and last merge block */
 				posinfo[0] = nextpos;
-				firstpos = writepos;
+				firstpos = sio->writepos;
 			}
 			else {  /* last merge block */
 				posinfo[0] = filesize;
-				lastpos = writepos;
+				lastpos = sio->writepos;
 			}
 			posinfo[1] = mergesize;
-			memcpy(mergebuf, posinfo, sizeof(posinfo));
+			memcpy(sio->mergebuf, posinfo, sizeof(posinfo));
 			bufcnt = sizeof(posinfo);
 
 			/* merge the records */
-			while (passnum) {
-				mrgptr = mrginfo + order[0];
+			for ( ; ; ) {
+				passnum = (INT) order[0];
+				mrgptr = sio->mrginfo + passnum;
+				if (mrgptr->bpos == mrgptr->bsize) break;  /* the winner is empty, so all runs are */
 				ptr = mrgptr->ptr + mrgptr->bpos;
 				i2 = reclen;
 				do {
 					i3 = bufsize - bufcnt;
 					if (i2 < i3) i3 = i2;
-					memcpy(mergebuf + bufcnt, ptr, i3);
+					memcpy(sio->mergebuf + bufcnt, ptr, i3);
 					bufcnt += i3;
 					if (bufcnt != bufsize) break;
-					i1 = fiowrite(workhandle, writepos, mergebuf, bufcnt);
+					i1 = fiowrite(sio->workhandle, sio->writepos, sio->mergebuf, bufcnt);
 					if (i1) {
-						sioputerr(DEATH_WRITE, i1, NULL);
+						sioputerr(sio, DEATH_WRITE, i1, NULL);
 						return i1;
 					}
-					writepos += bufcnt;
+					sio->writepos += bufcnt;
 					bufcnt = 0;
 					ptr += i3;
 					i2 -= i3;
 				} while (i2);
 				mrgptr->bpos += reclen;
-				if (mrgptr->bpos == mrgptr->bsize) {
-					if (!mrgptr->fsize) {
-						if (--passnum) memmove(order, order + 1, passnum * sizeof(UINT));
-						continue;
-					}
-					i1 = mergebufsize;
-					if (mrgptr->fsize < (OFFSET) i1) i1 = (INT) mrgptr->fsize;
-					i2 = fioread(workhandle, mrgptr->fpos, mrgptr->ptr, i1);
-					if (i2 != i1) {
-						if (i2 >= 0) i2 = 0;
-						sioputerr(DEATH_READ, i2, NULL);
-						if (!i2) i2 = ERR_BADRL;
-						return i2;
-					}
-					mrgptr->bpos = 0;
-					mrgptr->bsize = i1;
-					mrgptr->fpos += i1;
-					mrgptr->fsize -= i1;
+				if (mrgptr->bpos == mrgptr->bsize && mrgptr->fsize) {
+					i1 = mergefill(sio, mrgptr);
+					if (i1) return i1;
 				}
-				if (passnum > 1) insertmerge(passnum);
+				treeadjust(sio, order, passcnt, passnum, runless);
 			}
 
 			/* flush merge buffer */
 			if (bufcnt) {
-				i1 = fiowrite(workhandle, writepos, mergebuf, bufcnt);
+				i1 = fiowrite(sio->workhandle, sio->writepos, sio->mergebuf, bufcnt);
 				if (i1) {
-					sioputerr(DEATH_WRITE, i1, NULL);
+					sioputerr(sio, DEATH_WRITE, i1, NULL);
 					return i1;
 				}
-				writepos += bufcnt;
+				sio->writepos += bufcnt;
 			}
-			if (lwork == mergecnt) writepos = 0;
-			else if (writepos & 0x0FFF) writepos = (writepos & ~0x0FFF) + 0x1000;
+			if (lwork == sio->mergecnt) sio->writepos = 0;
+			else if (sio->writepos & 0x0FFF) sio->writepos = (sio->writepos & ~0x0FFF) + 0x1000;
 
-			mergecnt -= passcnt - 1;
+			sio->mergecnt -= passcnt - 1;
 		}
 
 		/* need to point to last merge block that was not merged */
 		if (lwork == 1) {
 			posinfo[0] = nextpos;
-			i1 = fiowrite(workhandle, filesize, (UCHAR *) posinfo, sizeof(posinfo[0]));
+			i1 = fiowrite(sio->workhandle, filesize, (UCHAR *) posinfo, sizeof(posinfo[0]));
 			if (i1) {
-				sioputerr(DEATH_WRITE, i1, NULL);
+				sioputerr(sio, DEATH_WRITE, i1, NULL);
 				return i1;
 			}
 		}
 
 		/* move the first merge block before the original end of file */
-		if (savecnt < mergecnt) {  /* another merge phase will follow */
+		if (savecnt < sio->mergecnt) {  /* another merge phase will follow */
 			/* modify last block written to point to new position, not old eof */
-			posinfo[0] = writepos;
-			i1 = fiowrite(workhandle, lastpos, (UCHAR *) posinfo, sizeof(posinfo[0]));
+			posinfo[0] = sio->writepos;
+			i1 = fiowrite(sio->workhandle, lastpos, (UCHAR *) posinfo, sizeof(posinfo[0]));
 			if (i1) {
-				sioputerr(DEATH_WRITE, i1, NULL);
+				sioputerr(sio, DEATH_WRITE, i1, NULL);
 				return i1;
 			}
 
 			/* move block */
 			ptr = (UCHAR *) order;
 			for (nextpos = 0; nextpos < savesize; nextpos += i2) {
-				if ((OFFSET) memsize < savesize - nextpos) i2 = memsize;
+				if ((OFFSET) sio->memsize < savesize - nextpos) i2 = sio->memsize;
 				else i2 = (INT)(savesize - nextpos);
-				i3 = fioread(workhandle, filesize + nextpos, ptr, i2);
+				i3 = fioread(sio->workhandle, filesize + nextpos, ptr, i2);
 				if (i3 != i2) {
 					if (i3 >= 0) i3 = 0;
-					sioputerr(DEATH_READ, i3, NULL);
+					sioputerr(sio, DEATH_READ, i3, NULL);
 					if (!i3) i3 = ERR_BADRL;
 					return i3;
 				}
-				i1 = fiowrite(workhandle, writepos, ptr, i2);
+				i1 = fiowrite(sio->workhandle, sio->writepos, ptr, i2);
 				if (i1) {
-					sioputerr(DEATH_WRITE, i1, NULL);
+					sioputerr(sio, DEATH_WRITE, i1, NULL);
 					return i1;
 				}
-				writepos += i2;
+				sio->writepos += i2;
 			}
 			if (!lwork) {
-				filesize = writepos;
+				filesize = sio->writepos;
 				if (filesize & 0x0FFF) filesize = (filesize & ~0x0FFF) + 0x1000;
 			}
 		}
 	}
 }
 
-/* INSERTMERGE */
-static void insertmerge(INT size)
+/* MERGEFILL */
+/* read the next part of a merge run into its buffer */
+static INT mergefill(SIO *sio, SIOMERGE *mrgptr)
 {
-	INT i1, i2, start, end;
-	UCHAR *ptr1, *ptr2;
-	MERGEINFO *mrgptr;
+	INT i1, i2;
 
-	i2 = (INT) order[0];
-	mrgptr = mrginfo + i2;
-	ptr1 = mrgptr->ptr + mrgptr->bpos;
+	i1 = sio->mergebufsize;
+	if (mrgptr->fsize < (OFFSET) i1) i1 = (INT) mrgptr->fsize;
+	i2 = fioread(sio->workhandle, mrgptr->fpos, mrgptr->ptr, i1);
+	if (i2 != i1) {
+		if (i2 >= 0) i2 = 0;
+		sioputerr(sio, DEATH_READ, i2, NULL);
+		if (!i2) i2 = ERR_BADRL;
+		return i2;
+	}
+	mrgptr->bpos = 0;
+	mrgptr->bsize = i1;
+	mrgptr->fpos += i1;
+	mrgptr->fsize -= i1;
+	return 0;
+}
 
-	i1 = start = 1;
-	end = size - 1;
-	while (TRUE) {
-		mrgptr = mrginfo + order[i1];
-		ptr2 = mrgptr->ptr + mrgptr->bpos;
-		if (comprec(ptr1, ptr2) < 0) {
-			if (i1-- == start) break;
-			end = i1;
+/* TREEINIT */
+/* build a tree of losers over cnt sources, tree[0] is the overall winner */
+/* source n is leaf cnt + n, internal node n has children 2n and 2n + 1 */
+static void treeinit(SIO *sio, UINT *tree, INT cnt, SIOLESS less)
+{
+	INT i1;
+	UINT win[MAXMERGE << 1];
+
+	for (i1 = 0; i1 < cnt; i1++) win[cnt + i1] = (UINT) i1;
+	for (i1 = cnt - 1; i1 > 0; i1--) {
+		if (less(sio, (INT) win[(i1 << 1) + 1], (INT) win[i1 << 1])) {
+			win[i1] = win[(i1 << 1) + 1];
+			tree[i1] = win[i1 << 1];
 		}
 		else {
-			if (i1 == end) break;
-			start = i1 + 1;
+			win[i1] = win[i1 << 1];
+			tree[i1] = win[(i1 << 1) + 1];
 		}
-		i1 = (start + end) >> 1;
 	}
-	if (i1) {
-		memmove(order, order + 1, i1 * sizeof(UINT));
-		order[i1] = (UINT) i2;
+	tree[0] = (cnt > 1) ? win[1] : 0;
+}
+
+/* TREEADJUST */
+/* replay the matches from the leaf of source src after its current entry changed */
+static void treeadjust(SIO *sio, UINT *tree, INT cnt, INT src, SIOLESS less)
+{
+	INT i1;
+	UINT u1;
+
+	for (i1 = (src + cnt) >> 1; i1 > 0; i1 >>= 1) {
+		if (less(sio, (INT) tree[i1], src)) {
+			u1 = tree[i1];
+			tree[i1] = (UINT) src;
+			src = (INT) u1;
+		}
 	}
+	tree[0] = (UINT) src;
+}
+
+/* RUNLESS */
+/* return TRUE if the current record of merge run r1 comes before that of r2 */
+static INT runless(SIO *sio, INT r1, INT r2)
+{
+	INT i1;
+	SIOMERGE *mrg1, *mrg2;
+
+	mrg1 = sio->mrginfo + r1;
+	mrg2 = sio->mrginfo + r2;
+	if (mrg1->bpos == mrg1->bsize) return FALSE;
+	if (mrg2->bpos == mrg2->bsize) return TRUE;
+	i1 = comprec(sio, 0, sio->keyptr[0].start, mrg1->ptr + mrg1->bpos, mrg2->ptr + mrg2->bpos);
+	if (i1) return i1 < 0;
+	return r1 < r2;
+}
+
+/* CHUNKLESS */
+/* return TRUE if the current record of sorted chunk c1 comes before that of c2 */
+static INT chunkless(SIO *sio, INT c1, INT c2)
+{
+	INT i1;
+
+	if (sio->chunkpos[c1] > sio->chunkend[c1]) return FALSE;
+	if (sio->chunkpos[c2] > sio->chunkend[c2]) return TRUE;
+	i1 = comprec(sio, 0, sio->keyptr[0].start,
+		sio->buffer + (sio->order[sio->chunkpos[c1]] & ~FLAGBIT) * sio->reclen,
+		sio->buffer + (sio->order[sio->chunkpos[c2]] & ~FLAGBIT) * sio->reclen);
+	if (i1) return i1 < 0;
+	return c1 < c2;
 }
 
 /* BUFINIT */
 /* initialize buffer and limits */
-static INT bufinit()
+static INT bufinit(SIO *sio)
 {
 	INT i1, i2, size;
 	UCHAR *ptr = NULL;
 
 	size = sizeof(UINT);
-	for (i1 = 0; i1 < keycnt && !((*keyptrptr)[i1].typeflg & SIO_NUMERIC); i1++);
-	if (i1 < keycnt) size += sizeof(UCHAR);
+	for (i1 = 0; i1 < sio->keycnt && !((*sio->keyptrptr)[i1].typeflg & SIO_NUMERIC); i1++);
+	if (i1 < sio->keycnt) size += sizeof(UCHAR);
 
-	i1 = reclen + size;
-	i2 = ((reclen + sizeof(MERGEINFO) + size) << 1) + MERGESIZ;
+	i1 = sio->reclen + size;
+	i2 = ((sio->reclen + sizeof(SIOMERGE) + size) << 1) + MERGESIZ;
 
-	if (!memsize) memsize = 2 << 20;
-	if (memsize < i2) memsize = i2;
-	while (memsize >= i2) {
-		ptr = (UCHAR *) malloc(memsize);
+	if (!sio->memsize) sio->memsize = 2 << 20;
+	if (sio->memsize < i2) sio->memsize = i2;
+	while (sio->memsize >= i2) {
+		ptr = (UCHAR *) malloc(sio->memsize);
 		if (ptr != NULL) break;
-		memsize -= 8 << 10;
+		sio->memsize -= 8 << 10;
 	}
-	if (memsize < i2) {
+	if (sio->memsize < i2) {
 		if (ptr != NULL) free(ptr);
 		return RC_NO_MEM;
 	}
-	memsize -= 4;  /* reserve 4 bytes for overflow by rioget & rioput */
-	order = (UINT *) ptr;
-	maxrec = ((memsize - (sizeof(OFFSET) << 1)) / i1) - 1;
-	numtype = ptr + maxrec * sizeof(UINT);
-	buffer = ptr + maxrec * size + (sizeof(OFFSET) << 1);
+	sio->memsize -= 4;  /* reserve 4 bytes for overflow by rioget & rioput */
+	sio->order = (UINT *) ptr;
+	sio->maxrec = ((sio->memsize - (sizeof(OFFSET) << 1)) / i1) - 1;
+	sio->numtype = ptr + sio->maxrec * sizeof(UINT);
+	sio->buffer = ptr + sio->maxrec * size + (sizeof(OFFSET) << 1);
 
 	return 0;
 }
 
-static char sioerrorstring[256];
-
-CHAR *siogeterr()
+/* SIOCPUS */
+/* return the number of processors available */
+static INT siocpus()
 {
-	return sioerrorstring;
+	INT i1;
+#if OS_WIN32
+	SYSTEM_INFO sysinfo;
+
+	GetSystemInfo(&sysinfo);
+	i1 = (INT) sysinfo.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	i1 = (INT) sysconf(_SC_NPROCESSORS_ONLN);
+#else
+	i1 = 1;
+#endif
+	if (i1 < 1) i1 = 1;
+	return i1;
 }
 
-static void sioputerr(INT n, INT e, CHAR *s)
+static void sioputerr(SIO *sio, INT n, INT e, CHAR *s)
 {
 	CHAR work[17];
 
-	if (n < (INT) (sizeof(errormsg) / sizeof(*errormsg))) strcpy(sioerrorstring, errormsg[n]);
+	if (n < (INT) (sizeof(errormsg) / sizeof(*errormsg))) strcpy(sio->errorstring, errormsg[n]);
 	else {
 		mscitoa(n, work);
-		strcpy(sioerrorstring, "*** UNKNOWN ERROR ");
-		strcat(sioerrorstring, work);
-		strcat(sioerrorstring, " ***");
+		strcpy(sio->errorstring, "*** UNKNOWN ERROR ");
+		strcat(sio->errorstring, work);
+		strcat(sio->errorstring, " ***");
 	}
 	if (e) {
-		strcat(sioerrorstring, ": ");
-		strcat(sioerrorstring, fioerrstr(e));
+		strcat(sio->errorstring, ": ");
+		strcat(sio->errorstring, fioerrstr(e));
 	}
 	if (s != NULL) {
-		strcat(sioerrorstring, ": ");
-		strcat(sioerrorstring, s);
+		strcat(sio->errorstring, ": ");
+		strcat(sio->errorstring, s);
 	}
-	if (sioflags & SIOFLAGS_DSPERROR) {
-		if (sioflags & (SIOFLAGS_DSPPHASE | SIOFLAGS_DSPEXTRA)) dspcallback("\r");
-		dspcallback(sioerrorstring);
-		dspcallback("\n");
+	if (sio->flags & SIOFLAGS_DSPERROR) {
+		if (sio->flags & (SIOFLAGS_DSPPHASE | SIOFLAGS_DSPEXTRA)) sio->dspcallback("\r");
+		sio->dspcallback(sio->errorstring);
+		sio->dspcallback("\n");
 	}
-	sioexit();
+	sioxexit(sio);
 }
@@ -31,11 +31,13 @@
 #define SCAN_UBLOCK	0x02
 #define SCAN_EXACT	0x04
 
-#define MAXBUF 100
+#define MAXBUF 100		/* default and minimum number of cached blocks */
+#define MAXHASH 0x100000	/* maximum number of hash buckets */
 #define MAXLEVEL	32
 #define MAXKEYS	64
 #define MODFLG 0x0001
 #define LCKFLG 0x0002
+#define REFFLG 0x0004			/* referenced since last pass of the clock hand */
 
 /* local declarations */
 static struct xtab *x;			/* working pointer to xtab */
@@ -73,25 +75,38 @@ static INT dupflg;				/* flag if key matches even if filepos does not */
 static INT fixcnt;				/* at least one index has had fix set */
 static UCHAR priority[256];		/* collating priority */
 static UCHAR collateflg;		/* collating flag */
+static UCHAR firstflg = TRUE;	/* set up from the fio options on the next xioopen */
 static UCHAR keytruncflg;		/* key truncation flag */
 static INT nbuf[4];				/* block buffer numbers */
 static UCHAR *blk0, *blk1, *blk2, *blk3;  /* block buffer pointers */
 static UCHAR **blkptr[] = { &blk0, &blk1, &blk2, &blk3 };
 static struct bufdef {
-	UCHAR next;
-	UCHAR prev;
+	INT next;			/* next on hash chain or free list */
+	INT prev;			/* previous on hash chain */
+	INT fnext;			/* next buffer belonging to the same file */
+	INT fprev;			/* previous buffer belonging to the same file */
 	UCHAR flgs;
 	UCHAR size;
-	UINT lrucnt;
 	INT fnum;
 	OFFSET pos;
 	UCHAR **bptr;
-} buf[MAXBUF];
-static INT maxbufs = MAXBUF;
-static INT freebuf = 0;
-static INT bufhi = 0;
-static UCHAR hashbuf[256];
-static UINT lrucnt;
+} *buf;
+static INT maxbufs;				/* number of buffer descriptors */
+static INT freebuf = -1;		/* head of free descriptor list */
+static INT *hashbuf;			/* hash bucket heads */
+static INT hashmask;			/* hash bucket count - 1 */
+static INT *filebuf;			/* head of buffer list for each file number */
+static INT filebufmax;			/* number of entries in filebuf */
+static INT clockhand;			/* next buffer to be considered for eviction */
+static INT cachesize;			/* bytes currently held by cached blocks */
+static INT cachemax;			/* maximum bytes to be held by cached blocks, 0 = MAXBUF blocks of any size */
+static INT scanflg;				/* xionext/xioprev in progress, do not promote blocks */
+static UINT64 cachehits;		/* statistics */
+static UINT64 cachemisses;
+static UINT64 cacheevicts;
+static UINT64 cachewrites;
+static CHAR cachelog[MAX_PATH];	/* file to receive statistics at exit */
+static UCHAR cachelogflg;		/* xioxlog is registered with atexit */
 
 /* local routine declarations */
 static INT xioxprv(void);
@@ -109,6 +124,10 @@ static void xioxdelb(INT, OFFSET);
 static INT xioxend(INT);
 static void xioxpurge(INT);
 static INT xioxfree(INT);
+static INT xioxinit(void);
+static INT xioxhash(INT, OFFSET);
+static INT xioxvictim(void);
+static void xioxlog(void);
 
 /*
  * XIOOPEN
@@ -119,16 +138,12 @@ static INT xioxfree(INT);
  */
 INT xioopen(CHAR *name, INT opts, INT keylen, INT reclen, OFFSET *txtpos, CHAR *txtname)
 {
-	static UCHAR firstflg = TRUE;
 	INT i1, i2, fnum;
 	CHAR filename[MAX_NAMESIZE + 1], *ptr;
 	UCHAR c1, *blk, **blkptr, **xptr;
 
 	if (firstflg) {
-/* NOTE: maxbufs is MAXBUF */
-		for (i1 = 0; i1 < maxbufs; i1++) buf[i1].next = (UCHAR)(i1 + 1);
-		buf[maxbufs - 1].next = 0xFF;
-		memset(hashbuf, 0xFF, sizeof(hashbuf));
+		if (xioxinit()) return(ERR_NOMEM);
 
 		collateflg = FALSE;
 		xptr = fiogetopt(FIO_OPT_COLLATEMAP);
@@ -318,6 +333,35 @@ INT xioopen(CHAR *name, INT opts, INT keylen, INT reclen, OFFSET *txtpos, CHAR *
 	return(fnum);
 }
 
+/*
+ * XIOEXIT
+ * release the block cache and forget the collate map and flags, the next
+ * xioopen sets them up again from the fio options.  Index files must be closed
+ */
+void xioexit()
+{
+	INT i1;
+
+	if (firstflg) return;
+	for (i1 = 0; i1 < maxbufs; i1++) if (buf[i1].fnum) memfree(buf[i1].bptr);
+	if (cachelog[0]) {
+		xioxlog();
+		cachelog[0] = '\0';
+	}
+	free(buf);
+	free(hashbuf);
+	free(filebuf);
+	buf = NULL;
+	hashbuf = NULL;
+	filebuf = NULL;
+	maxbufs = hashmask = filebufmax = clockhand = cachesize = cachemax = 0;
+	freebuf = -1;
+	cachehits = cachemisses = cacheevicts = cachewrites = 0;
+	collateflg = keytruncflg = FALSE;
+	fixcnt = 0;
+	firstflg = TRUE;
+}
+
 /* XIOCLOSE */
 /* close index file */
 INT xioclose(INT fnum)
@@ -518,6 +562,39 @@ xiofindlast1:
 	return(i1);
 }
 
+/* XIOGETKEY */
+/* copy the key last read unless key is NULL, return the key length */
+INT xiogetkey(INT fnum, UCHAR *key)
+{
+	INT i1;
+
+	i1 = xioxgo(fnum);
+	if (i1) return(i1);
+
+	if (key != NULL) memcpy(key, x->curkey, size);
+	return(size);
+}
+
+/* XIOSETKEY */
+/* position between keys at key and the record at txtpos, so the next */
+/* xionext or xioprev continues from there as if that key had been read */
+INT xiosetkey(INT fnum, UCHAR *key, INT len, OFFSET txtpos)
+{
+	INT i1;
+
+	i1 = xioxgo(fnum);
+	if (i1) return(i1);
+
+	if (len > size) len = size;
+	memcpy(x->curkey, key, len);
+	if (len < size) memset(&x->curkey[len], ' ', size - len);
+	if (version >= 9) mscoffto6x(txtpos, &x->curkey[size]);
+	else mscoffto9(txtpos, &x->curkey[size]);
+	x->keyflg = 3;
+	x->curblk = 0;
+	return(0);
+}
+
 /**
  *  XIONEXT
  *
@@ -530,6 +607,7 @@ INT xionext(INT fnum)
 
 	i1 = xioxgo(fnum);
 	if (i1) return(i1);
+	scanflg = TRUE;
 
 	if (x->keyflg == 1 || x->keyflg == 3) {  /* on or between keys */
 		memcpy(thekey, x->curkey, size1);
@@ -641,6 +719,7 @@ INT xioprev(INT fnum)
 
 	i1 = xioxgo(fnum);
 	if (i1) return(i1);
+	scanflg = TRUE;
 
 	i1 = xioxgetb(0, 0, TRUE);
 	if (i1) goto xioprev1;
@@ -1469,6 +1548,63 @@ INT xioflush(INT fnum)
 	return(i1);
 }
 
+/**
+ * XIOSTATS
+ * sample up to maxblks bottom level blocks spread evenly through the index.
+ * *keys is returned with the number of keys looked at that follow another
+ * key in the same block and *distinct with how many of them differ from
+ * the key before them (ignoring the text file position)
+ * return 0 if successful, else return negative error
+ */
+INT xiostats(INT fnum, INT maxblks, OFFSET *keys, OFFSET *distinct)
+{
+	INT i1, i2, blkcnt, numblks, step;
+	OFFSET lastpos, pos;
+	UCHAR *ptr, *prev;
+
+	*keys = *distinct = 0;
+	i1 = xioxgo(fnum);
+	if (i1) return(i1);
+	scanflg = TRUE;
+
+	i1 = xioxgetb(0, 0, TRUE);
+	if (i1) goto xiostats1;
+	if (version >= 9) msc6xtooff(&blk0[19], &lastpos);
+	else msc9tooff(&blk0[28], &lastpos);
+	numblks = (INT)(lastpos / blksize);
+	if (maxblks < 1) maxblks = 1;
+	step = numblks / maxblks;
+	if (step < 1) step = 1;
+
+	for (blkcnt = 0, pos = blksize; pos <= lastpos && blkcnt < maxblks; pos += (OFFSET) step * blksize) {
+		i1 = xioxgetb(1, pos, TRUE);
+		if (i1) goto xiostats1;
+		if (blk1[0] != 'V' || blk1[1] == eobbyte) continue;
+		blkcnt++;
+		if (version >= 9) {
+			for (i1 = size1 + 1; blk1[i1] != eobbyte && i1 < blksize; i1 += size1 - blk1[i1] + 1) {
+				(*keys)++;
+				if (blk1[i1] < size) (*distinct)++;
+			}
+		}
+		else {
+			for (prev = &blk1[1], ptr = prev + size1; *ptr != eobbyte && ptr + size1 <= blk1 + blksize; prev = ptr, ptr += size1) {
+				(*keys)++;
+				for (i2 = 0; i2 < size && ptr[i2] == prev[i2]; i2++);
+				if (i2 < size) (*distinct)++;
+			}
+		}
+	}
+
+	i1 = xioxend(x->opts & XIO_FLUSH);
+	if (i1) goto xiostats1;
+	return(0);
+
+xiostats1:
+	xioxend(-1);
+	return(i1);
+}
+
 /**
  * XIOXFIND
  * get the key block and offset that matches thekey
@@ -2015,31 +2151,20 @@ static INT xioxgo(INT fnum)
 static INT xioxgetb(INT bufnum, OFFSET pos, INT rdflg)
 {
 	INT i1, i2, bsize, hash;
-	UINT u1;
 	UCHAR allocflg, **pptr;
 
 #ifdef XIODEBUG
 	INT i3, i4;
-	for (i1 = freebuf, i3 = 0; i1 != 0xFF; ) {
+	for (i1 = freebuf, i3 = 0; i1 != -1; i1 = buf[i1].next) {
 		if (buf[i1].fnum) {
 			printf("\rfreebuf has fnum set\n");
 			exit(1);
 		}
 		i3++;
-		i4 = buf[i1].next;
-		if (i4 <= i1) {
-			printf("\rfreebuf is out of order\n");
-			exit(1);
-		}
-		i1 = i4;
 	}
 	for (i1 = 0, i2 = 0, i4 = 0; i1 < maxbufs; i1++) {
 		if (buf[i1].fnum) {
 			i2++;
-			if (i1 >= bufhi) {
-				printf("\rbuffer is higher than bufhi\n");
-				exit(1);
-			}
 			if (buf[i1].flgs & LCKFLG) i4++;
 		}
 	}
@@ -2051,9 +2176,8 @@ static INT xioxgetb(INT bufnum, OFFSET pos, INT rdflg)
 		printf("\rthere are %d freebufs and %d bufs\n", i3, i2);
 		exit(1);
 	}
-	for (i1 = 0, i4 = 0; i1 < 256; i1++) {
-		if (hashbuf[i1] == 0xFF) continue;
-		for (i3 = hashbuf[i1]; i3 != 0xFF; i3 = buf[i3].next) {
+	for (i1 = 0, i4 = 0; i1 <= hashmask; i1++) {
+		for (i3 = hashbuf[i1]; i3 != -1; i3 = buf[i3].next) {
 			if (!buf[i3].fnum) {
 				printf("\rhashtab does not have fnum set\n");
 				exit(1);
@@ -2084,27 +2208,32 @@ static INT xioxgetb(INT bufnum, OFFSET pos, INT rdflg)
 		}
 	}
 
-	hash = (UCHAR)(filenum + (pos >> 8));
-	for (i2 = hashbuf[hash]; i2 != 0xFF && (filenum != buf[i2].fnum || pos != buf[i2].pos); i2 = buf[i2].next);
-	if (i2 == 0xFF) {
+	hash = xioxhash(filenum, pos);
+	for (i2 = hashbuf[hash]; i2 != -1 && (filenum != buf[i2].fnum || pos != buf[i2].pos); i2 = buf[i2].next);
+	if (i2 == -1) {
+		cachemisses++;
+		/* evict until there is a free descriptor and the new block fits in the cache size */
 		pptr = NULL;
-		if (freebuf == 0xFF) {
-			i2 = 0xFF;
-			u1 = (UINT) 0xFFFFFFFF;
-			for (i1 = 0; i1 < maxbufs; i1++) {
-				if (buf[i1].flgs & LCKFLG) continue;
-				if (buf[i1].lrucnt < u1) {
-					u1 = buf[i1].lrucnt;
-					i2 = i1;
-				}
+		while (freebuf == -1 || (cachemax && cachesize + bsize > cachemax)) {
+			i2 = xioxvictim();
+			if (i2 == -1) {
+				if (freebuf != -1) break;  /* all cached blocks are locked, exceed cache size */
+				if (pptr != NULL) memfree(pptr);
+				return(ERR_PROGX);
 			}
-			if (i2 == 0xFF) return(ERR_PROGX);
+			cacheevicts++;
 			i1 = xioxfree(i2);
-			if (i1 || bsize != ((INT) buf[i2].size << 8)) {
+			if (!i1 && pptr == NULL && bsize == ((INT) buf[i2].size << 8)) {
+				pptr = buf[i2].bptr;
+				membufend(pptr);
+			}
+			else {
 				memfree(buf[i2].bptr);
-				if (i1) return(i1);
+				if (i1) {
+					if (pptr != NULL) memfree(pptr);
+					return(i1);
+				}
 			}
-			else pptr = buf[i2].bptr;
 		}
 
 		if (pptr == NULL) {
@@ -2122,23 +2251,42 @@ static INT xioxgetb(INT bufnum, OFFSET pos, INT rdflg)
 			}
 		}
 
+		if (filenum >= filebufmax) {
+			for (i1 = filebufmax ? filebufmax << 1 : 16; filenum >= i1; i1 <<= 1);
+			filebuf = (INT *) realloc(filebuf, i1 * sizeof(INT));
+			if (filebuf == NULL) {
+				memfree(pptr);
+				filebufmax = 0;
+				return(ERR_NOMEM);
+			}
+			while (filebufmax < i1) filebuf[filebufmax++] = -1;
+		}
+
 		i2 = freebuf;
 		freebuf = buf[i2].next;
 		buf[i2].next = hashbuf[hash];
-		if (hashbuf[hash] != 0xFF) buf[hashbuf[hash]].prev = (UCHAR) i2;
+		if (hashbuf[hash] != -1) buf[hashbuf[hash]].prev = i2;
 		hashbuf[hash] = i2;
-		buf[i2].prev = 0xFF;
-		buf[i2].flgs = 0;
+		buf[i2].prev = -1;
+		buf[i2].fnext = filebuf[filenum];
+		if (filebuf[filenum] != -1) buf[filebuf[filenum]].fprev = i2;
+		filebuf[filenum] = i2;
+		buf[i2].fprev = -1;
+		/* blocks only touched while walking keys stay eligible for early eviction */
+		buf[i2].flgs = (scanflg) ? 0 : REFFLG;
 		buf[i2].size = (UCHAR)(bsize >> 8);
 		buf[i2].fnum = filenum;
 		buf[i2].pos = pos;
 		buf[i2].bptr = pptr;
-		if (i2 >= bufhi) bufhi = i2 + 1;
+		cachesize += bsize;
+	}
+	else {
+		cachehits++;
+		if (!scanflg) buf[i2].flgs |= REFFLG;
 	}
 
 	buf[i2].flgs |= LCKFLG;
 	membufend(buf[i2].bptr);
-	buf[i2].lrucnt = lrucnt++;
 	nbuf[bufnum] = i2;
 
 	if (allocflg) {
@@ -2206,8 +2354,9 @@ static void xioxdelb(INT bufnum, OFFSET pos)
  */
 static INT xioxend(INT flushflg)
 {
-	INT i1, i2, retval;
+	INT i1, i2, i3, retval;
 
+	scanflg = FALSE;
 	if (!flushflg) {
 		for (i1 = 0; i1 < 4; i1++) {
 			i2 = nbuf[i1];
@@ -2222,10 +2371,9 @@ static INT xioxend(INT flushflg)
 	}
 
 	retval = 0;
-	if (flushflg) {
-		i2 = bufhi;
-		while (--i2 >= 0) {
-			if (filenum != buf[i2].fnum) continue;
+	if (flushflg && filenum < filebufmax) {
+		for (i2 = filebuf[filenum]; i2 != -1; i2 = i3) {
+			i3 = buf[i2].fnext;
 			if (flushflg == -1) buf[i2].flgs &= ~MODFLG;
 			i1 = xioxfree(i2);
 			if (i1) retval = i1;
@@ -2248,7 +2396,7 @@ static void xioxpurge(INT bufnum)
 	UCHAR **xptr;
 	struct xtab *x;
 
-	if (bufnum < 0 || bufnum >= bufhi) return;
+	if (bufnum < 0 || bufnum >= maxbufs) return;
 	fnum = buf[bufnum].fnum;
 	if (!fnum) return;
 	i1 = xioxfree(bufnum);
@@ -2268,7 +2416,7 @@ static void xioxpurge(INT bufnum)
  */
 static INT xioxfree(INT bufnum)
 {
-	INT i1, i2, i3, retval;
+	INT i1, i2, retval;
 	struct bufdef *bufptr;
 
 	retval = 0;
@@ -2276,32 +2424,125 @@ static INT xioxfree(INT bufnum)
 	if (bufptr->flgs & MODFLG) {
 		i1 = fiowrite(bufptr->fnum, bufptr->pos, *bufptr->bptr, (INT) bufptr->size << 8);
 		if (i1) retval = i1;
+		cachewrites++;
 	}
 	i1 = bufptr->next;
 	i2 = bufptr->prev;
-	if (i1 != 0xFF) buf[i1].prev = (UCHAR) i2;
-	if (i2 != 0xFF) buf[i2].next = (UCHAR) i1;
-	else hashbuf[(UCHAR)(bufptr->fnum + (bufptr->pos >> 8))] = (UCHAR) i1;
+	if (i1 != -1) buf[i1].prev = i2;
+	if (i2 != -1) buf[i2].next = i1;
+	else hashbuf[xioxhash(bufptr->fnum, bufptr->pos)] = i1;
+	i1 = bufptr->fnext;
+	i2 = bufptr->fprev;
+	if (i1 != -1) buf[i1].fprev = i2;
+	if (i2 != -1) buf[i2].fnext = i1;
+	else filebuf[bufptr->fnum] = i1;
+	cachesize -= (INT) bufptr->size << 8;
+
+	bufptr->next = freebuf;
+	freebuf = bufnum;
+	bufptr->flgs = 0;
+	bufptr->fnum = 0;
+	return(retval);
+}
 
-	/* put back onto freebuf list in the correct order */
-	i1 = i2 = freebuf;
-	if (bufnum > freebuf) {  /* not going to be first in list */
-		for ( ; ; ) {
-			i3 = i2;
-			i2 = buf[i2].next;
-			if (bufnum < i2) break;
-			if (i3 + 1 != i2) i1 = i2;  /* skip over gap */
-		}
-		if (i3 + 1 != bufnum) i1 = i2;  /* skip over gap */
-		buf[i3].next = bufnum;
+/*
+ * XIOXINIT
+ * size the block cache from the file.indexcache property and allocate its tables
+ * Returns zero for success, else ERR_NOMEM
+ */
+static INT xioxinit()
+{
+	INT i1, hashsize;
+	CHAR *ptr;
+
+	i1 = fiogetindexcache(&ptr);
+	if (i1 > 0 && i1 <= INT_MAX / (1024 * 1024)) {
+		cachemax = i1 * 1024 * 1024;
+		maxbufs = cachemax / 1024;
+		if (maxbufs < MAXBUF) maxbufs = MAXBUF;
+	}
+	else {  /* default is a count of blocks, whatever the block size */
+		cachemax = 0;
+		maxbufs = MAXBUF;
+	}
+	for (hashsize = 256; hashsize < maxbufs && hashsize < MAXHASH; hashsize <<= 1);
+
+	buf = (struct bufdef *) malloc(maxbufs * sizeof(struct bufdef));
+	hashbuf = (INT *) malloc(hashsize * sizeof(INT));
+	if (buf == NULL || hashbuf == NULL) {
+		free(buf);
+		free(hashbuf);
+		buf = NULL;
+		hashbuf = NULL;
+		return(ERR_NOMEM);
 	}
-	else freebuf = bufnum;
-	if (bufnum + 1 == bufhi) {
-		if (i1 < bufnum) bufhi = i1;
-		else bufhi = bufnum;
+	memset(buf, 0, maxbufs * sizeof(struct bufdef));
+	for (i1 = 0; i1 < maxbufs; i1++) buf[i1].next = i1 + 1;
+	buf[maxbufs - 1].next = -1;
+	freebuf = 0;
+	hashmask = hashsize - 1;
+	for (i1 = 0; i1 < hashsize; i1++) hashbuf[i1] = -1;
+
+	if (ptr != NULL && *ptr) {
+		strncpy(cachelog, ptr, sizeof(cachelog) - 1);
+		cachelog[sizeof(cachelog) - 1] = '\0';
+		if (!cachelogflg) atexit(xioxlog);
+		cachelogflg = TRUE;
 	}
+	return(0);
+}
 
-	bufptr->next = (UCHAR) i2;
-	bufptr->fnum = 0;
-	return(retval);
+/*
+ * XIOXHASH
+ * return the hash bucket of the block at pos in file fnum
+ */
+static INT xioxhash(INT fnum, OFFSET pos)
+{
+	UINT64 u1;
+
+	u1 = ((UINT64) pos >> 8) ^ ((UINT64) fnum << 40);
+	u1 *= 0x9E3779B97F4A7C15ULL;
+	return((INT)(u1 >> 32) & hashmask);
+}
+
+/*
+ * XIOXVICTIM
+ * pick an unlocked block to evict using the clock algorithm.
+ * Blocks are passed over once if they have been referenced since the
+ * hand last went by, so index tree upper levels stay resident while
+ * leaf blocks read by a key walk are evicted first.
+ * Returns -1 if every cached block is locked
+ */
+static INT xioxvictim()
+{
+	INT i1, i2;
+
+	for (i1 = maxbufs << 1; i1--; ) {
+		i2 = clockhand;
+		if (++clockhand == maxbufs) clockhand = 0;
+		if (!buf[i2].fnum || (buf[i2].flgs & LCKFLG)) continue;
+		if (buf[i2].flgs & REFFLG) {
+			buf[i2].flgs &= ~REFFLG;
+			continue;
+		}
+		return(i2);
+	}
+	return(-1);
+}
+
+/*
+ * XIOXLOG
+ * append the block cache statistics to the file.indexcachelog file
+ */
+static void xioxlog()
+{
+	FILE *f1;
+
+	if (!cachelog[0]) return;
+	f1 = fopen(cachelog, "a");
+	if (f1 == NULL) return;
+	fprintf(f1, "xio cache: size=%dK blocks=%d hits=%llu misses=%llu evictions=%llu writes=%llu\n",
+		(cachemax ? cachemax : cachesize) >> 10, maxbufs, (unsigned long long) cachehits, (unsigned long long) cachemisses,
+		(unsigned long long) cacheevicts, (unsigned long long) cachewrites);
+	fclose(f1);
 }
@@ -46,6 +46,7 @@ EXTERN INT counterBrkptr;
 
 EXTERN UCHAR *data;		/* pointer to data area location 0 of current module */
 EXTERN UCHAR *pgm;		/* pointer to program location 0 of current module */
+EXTERN UINT pgmdatagen;	/* memgeneration when data and pgm were last set by setpgmdata */
 EXTERN CHAR name[4096];	/* parameter for several routines */
 EXTERN CHAR DXAboutInfoString[512];
 EXTERN INT datamodule;	/* current execution data module number */
@@ -421,6 +422,7 @@ extern void dbciex(void);
 extern INT vstop(UCHAR *, INT);
 extern void getaction(INT **, INT *);
 extern void dbgaction(INT);
+extern void dbgcounteraction(INT);
 extern void dbcshutdown(void);
 extern INT popreturnstack(void);
 extern INT pushreturnstack(INT);
@@ -484,6 +486,7 @@ typedef struct codeinfostruct {
 	CHAR **nameptr;		/* program name (allocated 1st) */
 	UCHAR version;		/* version number */
 	UCHAR stdcmp;		/* standard compile */
+	UCHAR pgmmap;		/* program is mapped from the program cache */
 	INT pgmsize;		/* size of program module */
 	INT xdefsize;		/* external definition table size */
 	INT pcntsize;		/* size of pcount references (2,3 bytes) */
@@ -668,6 +671,7 @@ extern void vdebug(INT);
 extern void dbgconsole(CHAR *s, INT msglength);
 extern INT appendfplpplclause(CHAR* prefix);
 extern void dbgerror(INT, CHAR *);
+extern void dbgerrorquiet(INT);
 extern CHAR* dbggetfiletypedesc(CHAR *prefix, UCHAR *adr);
 extern CHAR* dbggetspecialtypedesc(CHAR *prefix, UCHAR *adr);
 extern INT dbgopendbg(INT);
@@ -713,6 +717,12 @@ typedef struct {
 
 extern INT getdbg(INT module, DBGINFOSTRUCT *dbgfinfo);
 
+/* dbcprf.c */
+extern INT prfinit(void);
+extern void prfverb(void);
+extern void prfunload(INT);
+extern void prfexit(void);
+
 /* dbcsrv.c */
 extern int srvinit(void);
 extern void srvexit(void);
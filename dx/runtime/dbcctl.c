@@ -1069,6 +1069,7 @@ void dbcexit(INT n)
 	}
 #endif
 
+	prfexit();
 	dbgexit();
 	dioclosemod(-1);
 	prtclosemod(-1);
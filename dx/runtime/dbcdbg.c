@@ -245,6 +245,7 @@ static UCHAR **srclineptr, **resultlineptr;
 static SRCLINE *srclines;
 static RESULTLINE *resultlines;
 static INT dbghandle;
+static INT errorquiet;			/* dbgerror only records the error, set by dbgerrorquiet */
 static INT stackptr;
 static INT savepcount;
 static INT stopline;
@@ -2804,7 +2805,13 @@ void dbgerror(INT type, CHAR *msg)
 	strcpy(dbgerrorstring, ptr);
 	strcat(dbgerrorstring, " - ");
 	strcat(dbgerrorstring, msg);
-	if (!(dbgflags & DBGFLAGS_DDT)) dbgresultline(dbgerrorstring);
+	if (!(dbgflags & DBGFLAGS_DDT) && !errorquiet) dbgresultline(dbgerrorstring);
+}
+
+/* callers outside the debugger, like the profiler, only want the error in dbgerrorstring */
+void dbgerrorquiet(INT flag)
+{
+	errorquiet = flag;
 }
 
 static void dbgresultline(CHAR *line)
@@ -155,6 +155,7 @@ static DATAMOD **datatabptr;
 static void addValueDescAttrs(INT chan);
 static INT addvartowatchtable(void);
 static INT changevarvalue(void);
+static void checkcounteraction(void);
 static int checkForClass(PVARINFO varinfo, int *dtstart, int *dtstop);
 static int compareChar(UCHAR *str1, CHAR ** str2);
 static int ddtcmpdbl(UCHAR *num1, CHAR **num2);
@@ -295,6 +296,18 @@ void convertCounterBPToRealBP(INT channel, int indexToCounterBPTable) {
 	dbgCounterbrk[indexToCounterBPTable].mod = -1;
 	dbgCounterbrk[indexToCounterBPTable].ptidx = -1;
 	dbgCounterbrk[indexToCounterBPTable].pcnt = -1;
+	checkcounteraction();
+}
+
+/**
+ * Stop counting in the verb loop when no counter breakpoints are left
+ */
+static void checkcounteraction()
+{
+	INT i1;
+
+	for (i1 = 0; i1 < counterBrkhi; i1++) if (dbgCounterbrk[i1].mod != -1) return;
+	dbgcounteraction(FALSE);
 }
 
 /*
@@ -1030,6 +1043,7 @@ static void doRemoveCounterBp(CHAR * module, CHAR *srcfilename, CHAR *line) {
 							dbgCounterbrk[i1].ptidx = -1;
 							dbgCounterbrk[i1].pcnt = -1;
 							//pgmptr[lineoffset] = dbgCounterbrk[i1].verb;
+							checkcounteraction();
 							break;
 						}
 					}
@@ -1092,6 +1106,7 @@ static void doaddCounterBrkPoint(CHAR* module, CHAR *srcfilename, CHAR *line, IN
 					dbgCounterbrk[i1].line = strtol(line, NULL, 10);
 					dbgCounterbrk[i1].count = count;
 					dbgCounterbrk[i1].verb = pgmptr[lineoffset];
+					dbgcounteraction(TRUE);
 				}
 			}
 		}
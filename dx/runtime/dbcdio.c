@@ -88,6 +88,7 @@ typedef struct fileinfostruct {
 #define DIOFLAG_DSPERR		0x10		/* display additional error message */
 #define DIOFLAG_ASCIIMP		0x20		/* use ascii code for *mp & cobol */
 #define DIOFLAG_AIMINSERT	0x40		/* aim inserts do not invalid reads */
+#define DIOFLAG_READAHEAD	0x80		/* read ahead unlocked next reads of file server files */
 
 #define MAXKEYSIZE 512
 
@@ -306,6 +307,7 @@ void vopen()
 		if (flags & FLAG_ALK) opts |= FS_LOCKAUTO;
 		if (flags & FLAG_SLK) opts |= FS_LOCKSINGLE;
 		if (flags & FLAG_TLK) opts |= FS_LOCKNOWAIT;
+		if (dioflags & DIOFLAG_READAHEAD) opts |= FS_READAHEAD;
 		if (type == DAVB_IFILE) {
 			if (flags & FLAG_DUP) opts |= FS_DUP;
 			else if (flags & FLAG_NOD) opts |= FS_NODUP;
@@ -3107,6 +3109,7 @@ static INT getfileinfo(INT reclen)
 		if (!prpget("file", "error", NULL, NULL, &ptr, PRP_LOWER) && !strcmp(ptr, "on")) dioflags |= DIOFLAG_DSPERR;
 		if (!prpget("file", "minusoverpunch", NULL, NULL, &ptr, PRP_LOWER) && !strcmp(ptr, "ascii")) dioflags |= DIOFLAG_ASCIIMP;
 		if (!prpget("file", "aiminsert", NULL, NULL, &ptr, PRP_LOWER) && !strcmp(ptr, "old")) dioflags |= DIOFLAG_AIMINSERT;
+		if (!prpget("file", "readahead", NULL, NULL, &ptr, PRP_LOWER) && !strcmp(ptr, "on")) dioflags |= DIOFLAG_READAHEAD;
 	}
 
 	if (reclen > recmax) {  /* allocate memory for record buffer */
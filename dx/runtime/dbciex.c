@@ -61,6 +61,40 @@ static INT action;				/* xprefix, filepi count, error or debug action required *
 #define ACTION_EVENT	0x10
 #define ACTION_POLL		0x20
 #define ACTION_SHUTDOWN	0x40
+#define ACTION_COUNTER	0x80	/* DDT counter breakpoints are set, checked before each verb */
+#define ACTION_PROFILE	0x100	/* dbcdx.profile is set, prfverb is called before each verb */
+
+#if OS_UNIX && defined(Linux)
+/* only reload data and pgm if the memory manager may have moved them */
+#define CHECKPGMDATA() if (pgmdatagen != memgeneration) setpgmdata()
+#else
+#define CHECKPGMDATA()
+#endif
+
+/*
+ * With gcc and clang, verbs are dispatched through a table of label addresses
+ * (labels as values) and each verb fetches and jumps to the next verb itself
+ * when no action is pending. Compile with NO_THREADED_DISPATCH to use the
+ * switch statement only.
+ */
+#if defined(__GNUC__) && !defined(NO_THREADED_DISPATCH)
+#define THREADED_DISPATCH
+#endif
+
+#ifdef THREADED_DISPATCH
+#define VERBCASE(n) VERBCASE1(n)
+#define VERBCASE1(n) case n: op_##n:
+#define DISPATCH(label) do { \
+	if (action) goto label; \
+	lsvbcode = vbcode; \
+	CHECKPGMDATA(); \
+	vbcode = getbyte(); \
+	goto *vbtable[vbcode]; \
+} while (0)
+#else
+#define VERBCASE(n) case n:
+#define DISPATCH(label) goto label
+#endif
 
 extern INT datachn;
 extern INT pgmchn;
@@ -91,6 +125,7 @@ static UCHAR x00000000[4] = { 0x00, 0x00, 0x00, 0x00 };
 static INT clearUnusedRoutineParameters;
 
 /* local function prototypes */
+static void checkcounterbrk(void);
 static void v58verbs(void);
 /*
  * The Mac has fcvt but does not supply a prototype for it!
@@ -105,6 +140,42 @@ void dbciex()  /* instruction execution module */
 	INT32 x1, x2;
 	UCHAR *ptr;
 	DAVB *davb;
+#ifdef THREADED_DISPATCH
+	static void *vbtable[256] = {
+		&&op_0x00, &&op_0x01, &&op_0x02, &&op_0x03, &&op_0x04, &&op_0x05, &&op_0x06, &&op_0x07,
+		&&op_0x08, &&op_0x09, &&op_0x0A, &&op_0x0B, &&op_0x0C, &&op_0x0D, &&op_0x0E, &&op_0x0F,
+		&&op_0x10, &&op_0x11, &&op_0x12, &&op_0x13, &&op_0x14, &&op_0x15, &&op_0x16, &&op_0x17,
+		&&op_0x18, &&op_0x19, &&op_0x1A, &&op_0x1B, &&op_0x1C, &&op_0x1D, &&op_0x1E, &&op_0x1F,
+		&&op_0x20, &&op_0x21, &&op_0x22, &&op_0x23, &&op_0x24, &&op_0x25, &&op_0x26, &&op_0x27,
+		&&op_0x28, &&op_0x29, &&op_0x2A, &&op_0x2B, &&op_0x2C, &&op_0x2D, &&op_0x2E, &&op_0x2F,
+		&&op_0x30, &&op_0x31, &&op_0x32, &&op_0x33, &&op_0x34, &&op_0x35, &&op_0x36, &&op_0x37,
+		&&op_0x38, &&op_0x39, &&op_0x3A, &&op_0x3B, &&op_0x3C, &&op_0x3D, &&op_0x3E, &&op_0x3F,
+		&&op_0x40, &&op_0x41, &&op_0x42, &&op_0x43, &&op_0x44, &&op_0x45, &&op_0x46, &&op_0x47,
+		&&op_0x48, &&op_0x49, &&op_0x4A, &&op_0x4B, &&op_0x4C, &&op_0x4D, &&op_0x4E, &&op_0x4F,
+		&&op_0x50, &&op_0x51, &&op_0x52, &&op_0x53, &&op_0x54, &&op_0x55, &&op_0x56, &&op_0x57,
+		&&op_0x58, &&op_0x59, &&op_0x5A, &&op_0x5B, &&op_0x5C, &&op_0x5D, &&op_0x5E, &&op_0x5F,
+		&&op_0x60, &&op_0x61, &&op_0x62, &&op_0x63, &&op_0x64, &&op_0x65, &&op_0x66, &&op_0x67,
+		&&op_0x68, &&op_0x69, &&op_0x6A, &&op_0x6B, &&op_0x6C, &&op_0x6D, &&op_0x6E, &&op_0x6F,
+		&&op_0x70, &&op_0x71, &&op_0x72, &&op_0x73, &&op_0x74, &&op_0x75, &&op_0x76, &&op_0x77,
+		&&op_0x78, &&op_0x79, &&op_0x7A, &&op_0x7B, &&op_0x7C, &&op_0x7D, &&op_0x7E, &&op_0x7F,
+		&&op_0x80, &&op_0x81, &&op_0x82, &&op_0x83, &&op_0x84, &&op_0x85, &&op_0x86, &&op_0x87,
+		&&op_0x88, &&op_0x89, &&op_0x8A, &&op_0x8B, &&op_0x8C, &&op_0x8D, &&op_0x8E, &&op_0x8F,
+		&&op_0x90, &&op_0x91, &&op_0x92, &&op_0x93, &&op_0x94, &&op_0x95, &&op_0x96, &&op_0x97,
+		&&op_0x98, &&op_0x99, &&op_0x9A, &&op_0x9B, &&op_0x9C, &&op_0x9D, &&op_0x9E, &&op_0x9F,
+		&&op_0xA0, &&op_0xA1, &&op_0xA2, &&op_0xA3, &&op_0xA4, &&op_0xA5, &&op_0xA6, &&op_0xA7,
+		&&op_0xA8, &&op_0xA9, &&op_0xAA, &&op_0xAB, &&op_0xAC, &&op_0xAD, &&op_0xAE, &&op_0xAF,
+		&&op_0xB0, &&op_0xB1, &&op_0xB2, &&op_0xB3, &&op_0xB4, &&op_0xB5, &&op_0xB6, &&op_0xB7,
+		&&op_0xB8, &&op_0xB9, &&op_0xBA, &&op_0xBB, &&op_0xBC, &&op_0xBD, &&op_0xBE, &&op_0xBF,
+		&&op_0xC0, &&op_0xC1, &&op_0xC2, &&op_0xC3, &&op_0xC4, &&op_0xC5, &&op_0xC6, &&op_0xC7,
+		&&op_0xC8, &&op_0xC9, &&op_0xCA, &&op_0xCB, &&op_0xCC, &&op_0xCD, &&op_0xCE, &&op_0xCF,
+		&&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop,
+		&&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop,
+		&&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop,
+		&&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop,
+		&&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop,
+		&&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&vbadop, &&op_0xFF
+	};
+#endif
 
 	if (!prpget("retstack", NULL, NULL, NULL, (CHAR **) &ptr, 0)) callmax = atoi((CHAR *) ptr);
 	if (callmax <= 0) callmax = CALLMAX;
@@ -133,6 +204,7 @@ void dbciex()  /* instruction execution module */
 	}
 	if (dbcflags & DBCFLAG_DEBUG) action = ACTION_DEBUG;
 	else action = 0;
+	if (prfinit()) action |= ACTION_PROFILE;
 	evtactionflag(&action, ACTION_POLL);
 	setjmp(errjmp);
 
@@ -189,283 +261,268 @@ next2:
 	}
 next3:
 	lsvbcode = vbcode;
-#if OS_UNIX && defined(Linux)
-	setpgmdata();
-#endif
+	CHECKPGMDATA();
 	vbcode = getbyte();
-	if (dbgflags & DBGFLAGS_DDT && counterBrkhi) {
-		for (i1 = 0; i1 < counterBrkhi; i1++) {
-			if (dbgCounterbrk[i1].mod == -1) continue;
-			if (dbgCounterbrk[i1].pcnt == pcount - 1 && getmpgm(dbgCounterbrk[i1].mod) == pgm) {
-				if (--dbgCounterbrk[i1].count == 0) {
-					CHAR line[12];
-					INT ptidx = dbgCounterbrk[i1].ptidx;
-					dbctcxputtag(1, "CounterBreakToZero");
-					sprintf(line, "%d", dbgCounterbrk[i1].line);
-					dbctcxputattr(1, "line", line);
-					dbctcxputattr(1, "module", dbgCounterbrk[i1].module);
-					convertCounterBPToRealBP(1, i1);
-					dbctcxput(1);
-					vbcode = pgm[pgmtable[ptidx].pcnt] = VERB_DEBUG;
-					break;
-				}
-			}
-		}
+	if (action & (ACTION_COUNTER | ACTION_PROFILE)) {
+		if (action & ACTION_COUNTER) checkcounterbrk();
+		if (action & ACTION_PROFILE) prfverb();
 	}
+#ifdef THREADED_DISPATCH
+	goto *vbtable[vbcode];
+#endif
 	switch(vbcode) {
-		case 0x00: goto vzeroop;
-		case 0x01: vclos(); goto next;
-		case 0x02: i1 = 0x01; goto vmath;
-		case 0x03: goto vappend;
-		case 0x04: vbeep(); goto next;
-		case 0x05: vbrpf(); goto next;
-		case 0x06:
-		case 0x07:
-		case 0x08: goto vbump;
-		case VERB_CHAIN: goto vchain;
-		case 0x0A: goto vclear;
-		case 0x0B: vclock(); goto next;
-		case 0x0C:
-		case 0x0D: goto vcmatch;
-		case 0x0E:
-		case 0x0F: goto vcmove;
-		case 0x10: goto vcompare;
-		case VERB_DEBUG: {
-			vdebug(DEBUG_DEBUG); goto next;
+		VERBCASE(0x00) goto vzeroop;
+		VERBCASE(0x01) vclos(); DISPATCH(next);
+		VERBCASE(0x02) i1 = 0x01; goto vmath;
+		VERBCASE(0x03) goto vappend;
+		VERBCASE(0x04) vbeep(); DISPATCH(next);
+		VERBCASE(0x05) vbrpf(); DISPATCH(next);
+		VERBCASE(0x06)
+		VERBCASE(0x07)
+		VERBCASE(0x08) goto vbump;
+		VERBCASE(VERB_CHAIN) goto vchain;
+		VERBCASE(0x0A) goto vclear;
+		VERBCASE(0x0B) vclock(); DISPATCH(next);
+		VERBCASE(0x0C)
+		VERBCASE(0x0D) goto vcmatch;
+		VERBCASE(0x0E)
+		VERBCASE(0x0F) goto vcmove;
+		VERBCASE(0x10) goto vcompare;
+		VERBCASE(VERB_DEBUG) {
+			vdebug(DEBUG_DEBUG); DISPATCH(next);
 		}
-		case VERB_DELETE:	/* delete */
-		case 0x13:	/* deletek */
-			vdiotwo(); goto next;
-		case 0x14:  /* display */
-			vkyds(); goto next;
-		case 0x15: i1 = 0x04; goto vmath;
-		case 0x16: vccall(); goto next;
-		case 0x17: vedit(0); goto next;
-		case 0x18: goto vendset;
-		case 0x19: vexecute(); goto next;
-		case 0x1A: goto vextend;
-		case 0x1B: vcount(); goto next;
-		case 0x1C:
+		VERBCASE(VERB_DELETE)	/* delete */
+		VERBCASE(0x13)	/* deletek */
+			vdiotwo(); DISPATCH(next);
+		VERBCASE(0x14)  /* display */
+			vkyds(); DISPATCH(next);
+		VERBCASE(0x15) i1 = 0x04; goto vmath;
+		VERBCASE(0x16) vccall(); DISPATCH(next);
+		VERBCASE(0x17) vedit(0); DISPATCH(next);
+		VERBCASE(0x18) goto vendset;
+		VERBCASE(0x19) vexecute(); DISPATCH(next);
+		VERBCASE(0x1A) goto vextend;
+		VERBCASE(0x1B) vcount(); DISPATCH(next);
+		VERBCASE(0x1C)
 			vfilepi();
 			if (fpicnt) action |= ACTION_FILEPI;
-			goto next;
-		case 0x1D:	/* fposit */
-			vdiotwo(); goto next;
-		case 0x1E: goto vgiving;
-		case VERB_INSERT:	/* insert */
-			vdiotwo(); goto next;
-		case 0x20: /* keyin */
+			DISPATCH(next);
+		VERBCASE(0x1D)	/* fposit */
+			vdiotwo(); DISPATCH(next);
+		VERBCASE(0x1E) goto vgiving;
+		VERBCASE(VERB_INSERT)	/* insert */
+			vdiotwo(); DISPATCH(next);
+		VERBCASE(0x20) /* keyin */
 			enable();
 			vkyds();
-			goto next;
-		case 0x21: goto vlenset;
-		case 0x22: goto vldst; /* load (34) */
-		case VERB_READKG:	/* readkg  (35) */
-			vread(0); goto next;
+			DISPATCH(next);
+		VERBCASE(0x21) goto vlenset;
+		VERBCASE(0x22) goto vldst; /* load (34) */
+		VERBCASE(VERB_READKG)	/* readkg  (35) */
+			vread(0); DISPATCH(next);
 
 		/* Might use 0x24 (36) for CLOCKCLIENT */
-		case VERB_CLOCKCLIENT:	/* not used as of 16.2 */
+		VERBCASE(VERB_CLOCKCLIENT)	/* not used as of 16.2 */
 			if (fpicnt) filepi0();  /* cancel any filepi */
-			vclockClient(); goto next;
-
-		case 0x25: goto vmatch;
-		case 0x26: vmove(0); goto next;
-		case 0x27: goto vmovefp;
-		case 0x28: goto vmovelp;
-		case 0x29: i1 = 0x03; goto vmath;
-		case 0x2A: goto vmoveadr;
-		case 0x2B: goto vnoret;
-		case 0x2C /* 44 */:
-		case 0x2D /* 45 */:
-			vopen(); goto next;
-		case 0x2E: /* ROLLOUT */
-			vrollout(); goto next;
-		case VERB_PACK: vpack(FALSE); goto next;
-		case 0x30: vpause(); goto next;
-		case 0x31: goto vtest;
-		case 0x32: vprep(); goto next;
-		case 0x33: vprint(); goto next;
-		case 0x34:	/* read readtab */
-			vread(0); goto next;
-		case 0x35: goto vbadop; /* (53) not used */
-		case 0x36:	/* readkp readkptb */
-			vread(0); goto next;
-		case 0x37: goto vbadop;	/* not used */
-		case 0x38:	/* readks readkstb */
-			vread(0); goto next;
-		case 0x39: goto vbadop;	/* not used */
-		case 0x3A: vrelease(); goto next;
-		case 0x3B: vrep(); goto next;
-		case 0x3C:	/* reposit */
-			vdiotwo(); goto next;
-		case 0x3D:
-			vsplclose(); goto next;
-		case 0x3E:
-		case 0x3F:
-		case 0x40:
+			vclockClient(); DISPATCH(next);
+
+		VERBCASE(0x25) goto vmatch;
+		VERBCASE(0x26) vmove(0); DISPATCH(next);
+		VERBCASE(0x27) goto vmovefp;
+		VERBCASE(0x28) goto vmovelp;
+		VERBCASE(0x29) i1 = 0x03; goto vmath;
+		VERBCASE(0x2A) goto vmoveadr;
+		VERBCASE(0x2B) goto vnoret;
+		VERBCASE(0x2C) /* 44 */
+		VERBCASE(0x2D) /* 45 */
+			vopen(); DISPATCH(next);
+		VERBCASE(0x2E) /* ROLLOUT */
+			vrollout(); DISPATCH(next);
+		VERBCASE(VERB_PACK) vpack(FALSE); DISPATCH(next);
+		VERBCASE(0x30) vpause(); DISPATCH(next);
+		VERBCASE(0x31) goto vtest;
+		VERBCASE(0x32) vprep(); DISPATCH(next);
+		VERBCASE(0x33) vprint(); DISPATCH(next);
+		VERBCASE(0x34)	/* read readtab */
+			vread(0); DISPATCH(next);
+		VERBCASE(0x35) goto vbadop; /* (53) not used */
+		VERBCASE(0x36)	/* readkp readkptb */
+			vread(0); DISPATCH(next);
+		VERBCASE(0x37) goto vbadop;	/* not used */
+		VERBCASE(0x38)	/* readks readkstb */
+			vread(0); DISPATCH(next);
+		VERBCASE(0x39) goto vbadop;	/* not used */
+		VERBCASE(0x3A) vrelease(); DISPATCH(next);
+		VERBCASE(0x3B) vrep(); DISPATCH(next);
+		VERBCASE(0x3C)	/* reposit */
+			vdiotwo(); DISPATCH(next);
+		VERBCASE(0x3D)
+			vsplclose(); DISPATCH(next);
+		VERBCASE(0x3E)
+		VERBCASE(0x3F)
+		VERBCASE(0x40)
 			goto vreset;
-		case 0x41: vscan(); goto next;
-		case 0x42: vsearch(); goto next;
-		case 0x43:
-		case 0x44:
-		case 0x45: goto vsetlptr;
-		case 0x46:							/* splopen (70) */
-		case 0x47: vsplopen(); goto next;	/* splopen with pfile (71) */
-		case 0x48: goto vldst;				/* store (72) */
-		case 0x49: vtrap(); goto next;
-		case 0x4A: i1 = 0x02; goto vmath;
-		case 0x4B: vtrap(); goto next;
-		case 0x4C: vtrapclr(); goto next;
-		case 0x4D: goto vtype;
-		case 0x4E: {
+		VERBCASE(0x41) vscan(); DISPATCH(next);
+		VERBCASE(0x42) vsearch(); DISPATCH(next);
+		VERBCASE(0x43)
+		VERBCASE(0x44)
+		VERBCASE(0x45) goto vsetlptr;
+		VERBCASE(0x46)							/* splopen (70) */
+		VERBCASE(0x47) vsplopen(); DISPATCH(next);	/* splopen with pfile (71) */
+		VERBCASE(0x48) goto vldst;				/* store (72) */
+		VERBCASE(0x49) vtrap(); DISPATCH(next);
+		VERBCASE(0x4A) i1 = 0x02; goto vmath;
+		VERBCASE(0x4B) vtrap(); DISPATCH(next);
+		VERBCASE(0x4C) vtrapclr(); DISPATCH(next);
+		VERBCASE(0x4D) goto vtype;
+		VERBCASE(0x4E) {
 			dbcexit(0);
 		} // @suppress("No break at end of case")
-		case 0x4F: vunpack(); goto next;
-		case 0x50:
-		case 0x51: vwrite(); goto next;
-		case 0x52: vdiotwo(); goto next;
-		case 0x53:
-		case 0x54: vwrite(); goto next;
-		case 0x55: vcom(); goto next;
-		case 0x56: vnformat(); goto next;
-		case 0x57: vsformat(); goto next;
-		case 0x58: v58verbs(); goto next;
-		case 0x59: goto vset;
-		case 0x5A: vreturn(); goto next;
-		case 0x5B:
-		case 0x5C:
-		case 0x5D:
-		case 0x5E:
-		case 0x5F:
-		case 0x60:
-		case 0x61:
-		case 0x62: goto vreturnc;
-		case 0x63: goto vreturnx;
-		case 0x64: vstop(NULL, 0); goto next;
-		case 0x65:
-		case 0x66:
-		case 0x67:
-		case 0x68:
-		case 0x69:
-		case 0x6A:
-		case 0x6B:
-		case 0x6C: goto vstopc;
-		case 0x6D: goto vstopx;
-		case 0x6E: goto vroutine;
-		case 0x6F: goto vcallp;  /* CALL with parameters */
-		case 0x70:
-		case 0x71:
-		case 0x72:
-		case 0x73: goto vcall;
-		case 0x74: // goto (116)
-		case 0x75: // (117)
-		case 0x76: // (118)
-		case 0x77: // (119)
+		VERBCASE(0x4F) vunpack(); DISPATCH(next);
+		VERBCASE(0x50)
+		VERBCASE(0x51) vwrite(); DISPATCH(next);
+		VERBCASE(0x52) vdiotwo(); DISPATCH(next);
+		VERBCASE(0x53)
+		VERBCASE(0x54) vwrite(); DISPATCH(next);
+		VERBCASE(0x55) vcom(); DISPATCH(next);
+		VERBCASE(0x56) vnformat(); DISPATCH(next);
+		VERBCASE(0x57) vsformat(); DISPATCH(next);
+		VERBCASE(0x58) v58verbs(); DISPATCH(next);
+		VERBCASE(0x59) goto vset;
+		VERBCASE(0x5A) vreturn(); DISPATCH(next);
+		VERBCASE(0x5B)
+		VERBCASE(0x5C)
+		VERBCASE(0x5D)
+		VERBCASE(0x5E)
+		VERBCASE(0x5F)
+		VERBCASE(0x60)
+		VERBCASE(0x61)
+		VERBCASE(0x62) goto vreturnc;
+		VERBCASE(0x63) goto vreturnx;
+		VERBCASE(0x64) vstop(NULL, 0); DISPATCH(next);
+		VERBCASE(0x65)
+		VERBCASE(0x66)
+		VERBCASE(0x67)
+		VERBCASE(0x68)
+		VERBCASE(0x69)
+		VERBCASE(0x6A)
+		VERBCASE(0x6B)
+		VERBCASE(0x6C) goto vstopc;
+		VERBCASE(0x6D) goto vstopx;
+		VERBCASE(0x6E) goto vroutine;
+		VERBCASE(0x6F) goto vcallp;  /* CALL with parameters */
+		VERBCASE(0x70)
+		VERBCASE(0x71)
+		VERBCASE(0x72)
+		VERBCASE(0x73) goto vcall;
+		VERBCASE(0x74) // goto (116)
+		VERBCASE(0x75) // (117)
+		VERBCASE(0x76) // (118)
+		VERBCASE(0x77) // (119)
 			goto vgoto;
-		case 0x78:
-		case 0x79:
-		case 0x7A:
-		case 0x7B: goto vcallx;
-		case 0x7C:
-		case 0x7D:
-		case 0x7E:
-		case 0x7F: goto vgotox;
-		case 0x80:
-		case 0x81:
-		case 0x82:
-		case 0x83:
-		case 0x84:
-		case 0x85:
-		case 0x86:
-		case 0x87:
-		case 0x88:
-		case 0x89:
-		case 0x8A:
-		case 0x8B: /* switch? */
-		case 0x8C: /* case? */
-		case 0x8D: /* default */
-		case 0x8E: /* endswitch? */
-		case 0x8F:
-		case 0x90:
-		case 0x91:
-		case 0x92:
-		case 0x93:
-		case 0x94:
-		case 0x95:
-		case 0x96:
-		case 0x97:
-		case 0x98:
-		case 0x99:
-		case 0x9A:
-		case 0x9B:
-		case 0x9C:
-		case 0x9D:
-		case 0x9E:
-		case 0x9F: goto vcallc;
-		case 0xA0: /* (160) */
-		case 0xA1:
-		case 0xA2:
-		case 0xA3:
-		case 0xA4:
-		case 0xA5:
-		case 0xA6:
-		case 0xA7:
-		case 0xA8:
-		case 0xA9:
-		case 0xAA:
-		case 0xAB:
-		case 0xAC:
-		case 0xAD:
-		case 0xAE:
-		case 0xAF:
-		case 0xB0:
-		case 0xB1:
-		case 0xB2:
-		case 0xB3:
-		case 0xB4:
-		case 0xB5:
-		case 0xB6:
-		case 0xB7:
-		case 0xB8:
-		case 0xB9:
-		case 0xBA:
-		case 0xBB:
-		case 0xBC:
-		case 0xBD:
-		case 0xBE:
-		case 0xBF: goto vgotoc;
-		case 0xC0: // _XPREFIX (192)
+		VERBCASE(0x78)
+		VERBCASE(0x79)
+		VERBCASE(0x7A)
+		VERBCASE(0x7B) goto vcallx;
+		VERBCASE(0x7C)
+		VERBCASE(0x7D)
+		VERBCASE(0x7E)
+		VERBCASE(0x7F) goto vgotox;
+		VERBCASE(0x80)
+		VERBCASE(0x81)
+		VERBCASE(0x82)
+		VERBCASE(0x83)
+		VERBCASE(0x84)
+		VERBCASE(0x85)
+		VERBCASE(0x86)
+		VERBCASE(0x87)
+		VERBCASE(0x88)
+		VERBCASE(0x89)
+		VERBCASE(0x8A)
+		VERBCASE(0x8B) /* switch? */
+		VERBCASE(0x8C) /* case? */
+		VERBCASE(0x8D) /* default */
+		VERBCASE(0x8E) /* endswitch? */
+		VERBCASE(0x8F)
+		VERBCASE(0x90)
+		VERBCASE(0x91)
+		VERBCASE(0x92)
+		VERBCASE(0x93)
+		VERBCASE(0x94)
+		VERBCASE(0x95)
+		VERBCASE(0x96)
+		VERBCASE(0x97)
+		VERBCASE(0x98)
+		VERBCASE(0x99)
+		VERBCASE(0x9A)
+		VERBCASE(0x9B)
+		VERBCASE(0x9C)
+		VERBCASE(0x9D)
+		VERBCASE(0x9E)
+		VERBCASE(0x9F) goto vcallc;
+		VERBCASE(0xA0) /* (160) */
+		VERBCASE(0xA1)
+		VERBCASE(0xA2)
+		VERBCASE(0xA3)
+		VERBCASE(0xA4)
+		VERBCASE(0xA5)
+		VERBCASE(0xA6)
+		VERBCASE(0xA7)
+		VERBCASE(0xA8)
+		VERBCASE(0xA9)
+		VERBCASE(0xAA)
+		VERBCASE(0xAB)
+		VERBCASE(0xAC)
+		VERBCASE(0xAD)
+		VERBCASE(0xAE)
+		VERBCASE(0xAF)
+		VERBCASE(0xB0)
+		VERBCASE(0xB1)
+		VERBCASE(0xB2)
+		VERBCASE(0xB3)
+		VERBCASE(0xB4)
+		VERBCASE(0xB5)
+		VERBCASE(0xB6)
+		VERBCASE(0xB7)
+		VERBCASE(0xB8)
+		VERBCASE(0xB9)
+		VERBCASE(0xBA)
+		VERBCASE(0xBB)
+		VERBCASE(0xBC)
+		VERBCASE(0xBD)
+		VERBCASE(0xBE)
+		VERBCASE(0xBF) goto vgotoc;
+		VERBCASE(0xC0) // _XPREFIX (192)
 			action |= ACTION_XPREFIX;
 			xprfxflags = dbcflags & DBCFLAG_FLAGS;
 			xprfxcode = lsvbcode;
 			goto next3;
-		case 0xC1:
-		case 0xC2: goto _gotosetclr;
-		case 0xC3:
-		case 0xC4:
-		case 0xC5:
-		case 0xC6:
-		case 0xC7:
-		case 0xC8: goto _gotoifx;
-		case 0xC9: goto _goto;
-		case 0xCA: goto _gotox;
-		case 0xCB: goto _call;
-		case 0xCC: goto _callx;
-		case 0xCD: goto vcallp;
-		case 0xCE: goto _gotofor;
-		case 0xCF: goto vcallp;
-	}
-	if (vbcode == 0xFF) {
-		if (action & ACTION_FILEPI) fpicnt++;
-		goto next;
+		VERBCASE(0xC1)
+		VERBCASE(0xC2) goto _gotosetclr;
+		VERBCASE(0xC3)
+		VERBCASE(0xC4)
+		VERBCASE(0xC5)
+		VERBCASE(0xC6)
+		VERBCASE(0xC7)
+		VERBCASE(0xC8) goto _gotoifx;
+		VERBCASE(0xC9) goto _goto;
+		VERBCASE(0xCA) goto _gotox;
+		VERBCASE(0xCB) goto _call;
+		VERBCASE(0xCC) goto _callx;
+		VERBCASE(0xCD) goto vcallp;
+		VERBCASE(0xCE) goto _gotofor;
+		VERBCASE(0xCF) goto vcallp;
+		VERBCASE(0xFF)
+			if (action & ACTION_FILEPI) fpicnt++;
+			DISPATCH(next);
 	}
 vbadop:
 	dbcerrinfo(505, (UCHAR*)"Bad opcode encountered", -1);
-	goto next;
+	DISPATCH(next);
 
 vzeroop:
 	dbcerrinfo(505, (UCHAR*)"Zero opcode encountered", -1);
-	goto next;
+	DISPATCH(next);
 
 vldst:
 	adr1 = getvar(VAR_READ);
@@ -482,7 +539,7 @@ vldst:
 			break;
 		}
 	}
-	goto next;
+	DISPATCH(next);
 
 vmoveadr:
 	i1 = datamodule;
@@ -494,7 +551,7 @@ vmoveadr:
 	adr1[4] = (UCHAR)((UINT) i4 >> 8);
 	adr1[5] = (UCHAR)(i4 >> 16);
 	chkavar(adr1, TRUE);
-	goto next;
+	DISPATCH(next);
 
 vmath:
 	adr1 = getint(work6a);
@@ -502,7 +559,7 @@ vmath:
 	adr2 = getvar(VAR_WRITE);
 	if ((i2 | vartype) & TYPE_ARRAY) arraymath(i1, adr1, adr2, adr2);
 	else mathop(i1, adr1, adr2, adr2);
-	goto next;
+	DISPATCH(next);
 
 vcompare:
 	adr1 = getint(work6a);
@@ -510,7 +567,7 @@ vcompare:
 	adr2 = getint(work6b);
 	if ((i1 | vartype) & TYPE_ARRAY) arraymath(0x00, adr1, adr2, NULL);
 	else mathop(0x00, adr1, adr2, NULL);
-	goto next;
+	DISPATCH(next);
 
 vgiving:
 	i1 = getbyte();
@@ -524,7 +581,7 @@ vgiving:
 		if ((i2 | i3) & TYPE_ARRAY) arraymath(i1, adr1, adr2, adr3);
 		else mathop(i1, adr1, adr2, adr3);
 	}
-	goto next;
+	DISPATCH(next);
 
 vtest:
 	adr1 = getint(work6a);
@@ -545,7 +602,7 @@ vtest:
 		if ((aligndavb(adr1, NULL))->refnum) dbcflags &= ~DBCFLAG_OVER;
 		else dbcflags |= DBCFLAG_OVER;
 	}
-	goto next;
+	DISPATCH(next);
 
 vappend:
 	adr1 = getvar(VAR_READ);
@@ -560,7 +617,7 @@ vappend:
 	hl1 = hl;
 	adr2 = getvar(VAR_WRITE);
 	dbcflags &= ~DBCFLAG_EOS;
-	if (!fp1) goto next;
+	if (!fp1) DISPATCH(next);
 	i1 = fp1 + hl1 - 1;
 	i3 = lp1 - fp1 + 1;
 	i2 = pl - fp;
@@ -573,17 +630,17 @@ vappend:
 	setfplp(adr2);
 	if (adr1 == adr2) while(i3--) adr2[i2++] = adr1[i1++];
 	else memcpy(&adr2[i2], &adr1[i1], i3);
-	goto next;
+	DISPATCH(next);
 
 vclear:
 	adr1 = getvar(VAR_WRITE);
 	if (adr1[0] < 128) {
 		adr1[0] = adr1[1] = 0;  /* do non-list small dim fast */
-		goto next;
+		DISPATCH(next);
 	}
 	if (vartype & (TYPE_LIST | TYPE_ARRAY)) {
 		adr1 = getlist(LIST_WRITE | LIST_LIST | LIST_ARRAY | LIST_NUM1);
-		if (adr1 == NULL) goto next;
+		if (adr1 == NULL) DISPATCH(next);
 		i1 = TRUE;
 	}
 	else i1 = FALSE;
@@ -598,13 +655,13 @@ vclear:
 			setfplp(adr1);
 		}
 	} while (i1 && ((adr1 = getlist(LIST_WRITE | LIST_LIST | LIST_ARRAY | LIST_NUM1)) != NULL));
-	goto next;
+	DISPATCH(next);
 
 vset:
 	adr1 = getvar(VAR_WRITE);
 	if (vartype & (TYPE_LIST | TYPE_ARRAY)) {
 		adr1 = getlist(LIST_WRITE | LIST_LIST | LIST_ARRAY | LIST_NUM1);
-		if (adr1 == NULL) goto next;
+		if (adr1 == NULL) DISPATCH(next);
 		i1 = TRUE;
 	}
 	else i1 = FALSE;
@@ -612,7 +669,7 @@ vset:
 	do movevar(x8131, adr1);
 	while (i1 && ((adr1 = getlist(LIST_WRITE | LIST_LIST | LIST_ARRAY | LIST_NUM1)) != NULL));
 	dbcflags = (dbcflags & ~DBCFLAG_FLAGS) | i2;
-	goto next;
+	DISPATCH(next);
 
 vmatch:
 	dbcflags &= ~(DBCFLAG_EOS | DBCFLAG_EQUAL);
@@ -626,7 +683,7 @@ vmatch:
 	hl2 = hl;
 	if (!fp1 || !fp2) {
 		dbcflags |= DBCFLAG_EOS;
-		goto next;
+		DISPATCH(next);
 	}
 	i1 = lp1 - fp1 + 1;
 	i2 = lp2 - fp2 + 1;
@@ -637,13 +694,11 @@ vmatch:
 	else dbcflags &= ~DBCFLAG_LESS;
 	adr1 += fp1 + hl1 - 1;
 	adr2 += fp2 + hl2 - 1;
-	while (i1 && *adr1++ == *adr2++) i1--;
+	i1 = memcmp(adr1, adr2, i1);
 	if (!i1) dbcflags |= DBCFLAG_EQUAL;
-	else {
-		if (*(adr1 - 1) > *(adr2 - 1)) dbcflags |= DBCFLAG_LESS;
-		else dbcflags &= ~DBCFLAG_LESS;
-	}
-	goto next;
+	else if (i1 > 0) dbcflags |= DBCFLAG_LESS;
+	else dbcflags &= ~DBCFLAG_LESS;
+	DISPATCH(next);
 
 vlenset:
 	adr1 = getvar(VAR_WRITE);
@@ -652,7 +707,7 @@ vlenset:
 		adr1[3] = adr1[1];
 		adr1[4] = adr1[2];
 	}
-	goto next;
+	DISPATCH(next);
 
 vendset:
 	adr1 = getvar(VAR_WRITE);
@@ -661,7 +716,7 @@ vendset:
 		adr1[1] = adr1[3];
 		adr1[2] = adr1[4];
 	}
-	goto next;
+	DISPATCH(next);
 
 vextend:
 	adr1 = getvar(VAR_WRITE);
@@ -672,7 +727,7 @@ vextend:
 		setfplp(adr1);
 		dbcflags &= ~DBCFLAG_EOS;
 	}
-	goto next;
+	DISPATCH(next);
 
 vtype:
 	adr1 = getvar(VAR_READ);
@@ -684,7 +739,7 @@ vtype:
 		dbcflags &= ~(DBCFLAG_EQUAL | DBCFLAG_EOS);
 		if (typ(adr1)) dbcflags |= DBCFLAG_EQUAL;
 	}
-	goto next;
+	DISPATCH(next);
 
 vmovefp:
 	adr1 = getvar(VAR_READ);
@@ -699,7 +754,7 @@ vmovefp:
 		movevar(work45, adr1);
 		dbcflags = (dbcflags & ~DBCFLAG_LESS) | i1;
 	}
-	goto next;
+	DISPATCH(next);
 
 vmovelp:
 	adr1 = getvar(VAR_READ);
@@ -714,7 +769,7 @@ vmovelp:
 		movevar(work45, adr1);
 		dbcflags = (dbcflags & ~DBCFLAG_LESS) | i1;
 	}
-	goto next;
+	DISPATCH(next);
 
 vcmatch:
 	dbcflags |= DBCFLAG_EOS;
@@ -724,12 +779,12 @@ vcmatch:
 		adr1 = getvar(VAR_READ);
 		if (!fp) {
 			getvar(VAR_READ);
-			goto next;
+			DISPATCH(next);
 		}
 		c1 = adr1[fp + hl - 1];
 	}
 	adr2 = getvar(VAR_READ);
-	if (!fp) goto next;
+	if (!fp) DISPATCH(next);
 	c2 = adr2[fp + hl - 1];
 	dbcflags &= ~DBCFLAG_EOS;
 	if (c1 == c2) dbcflags |= DBCFLAG_EQUAL;
@@ -737,7 +792,7 @@ vcmatch:
 		i1 = c2;
 		if ((UCHAR) i1 < c1) dbcflags |= DBCFLAG_LESS;
 	}
-	goto next;
+	DISPATCH(next);
 
 vcmove:
 	dbcflags |= DBCFLAG_EOS;
@@ -746,15 +801,15 @@ vcmove:
 		adr1 = getvar(VAR_READ);
 		if (!fp) {
 			getvar(VAR_READ);
-			goto next;
+			DISPATCH(next);
 		}
 		c1 = adr1[fp + hl - 1];
 	}
 	adr2 = getvar(VAR_WRITE);
-	if (!fp) goto next;
+	if (!fp) DISPATCH(next);
 	adr2[fp + hl - 1] = c1;
 	dbcflags &= ~DBCFLAG_EOS;
-	goto next;
+	DISPATCH(next);
 
 vbump:
 	adr1 = getvar(VAR_WRITE);
@@ -772,7 +827,7 @@ vbump:
 		setfp(adr1);
 		dbcflags &= ~DBCFLAG_EOS;
 	}
-	goto next;
+	DISPATCH(next);
 
 vreset:
 	adr1 = getvar(VAR_WRITE);
@@ -803,7 +858,7 @@ vreset:
 		fp = lp = i2;
 		setfplp(adr1);
 	}
-	goto next;
+	DISPATCH(next);
 
 vsetlptr:
 	adr1 = getvar(VAR_WRITE);
@@ -833,7 +888,7 @@ vsetlptr:
 		}
 		setfplp(adr1);
 	}
-	goto next;
+	DISPATCH(next);
 
 /**
  * The <label> construct is a two byte field that represents the execution
@@ -850,28 +905,28 @@ vgoto: // 0x74 -> -0x77
 	i1 = getbyte() + ((vbcode & 0x03) << 8);
 	if (i1 == 0x03FF) i1 = gethhll();
 	chgpcnt(i1);
-	goto next1;
+	DISPATCH(next1);
 
 vgotoc: // 0xA0 -> 0xBF
 	if (chkcond(vbcode >> 2 & 0x07)) goto vgoto;
 	if (getbyte() == 0xFF && (vbcode & 0x03) == 0x03) pcount += 2;
-	goto next1;
+	DISPATCH(next1);
 
 vgotox:
 	i1 = getbyte() + ((vbcode & 0x03) << 8);
 	if (i1 == 0x03FF) i1 = gethhll();
 	if (chkcond(getbyte())) chgpcnt(i1);
-	goto next1;
+	DISPATCH(next1);
 
 vcall:
 	i1 = getbyte() + ((vbcode & 0x03) << 8);
 	if (i1 == 0x03FF /* 1,023 */) i1 = gethhll();
 	if (pushreturnstack(-1)) {
 		dbcerror(501);
-		goto next;
+		DISPATCH(next);
 	}
 	chgpcnt(i1);
-	goto next1;
+	DISPATCH(next1);
 
 vcallc:
 	if (chkcond(vbcode >> 2 & 0x07)) {
@@ -879,12 +934,12 @@ vcallc:
 		if (i1 == 0x03FF) i1 = gethhll();
 		if (pushreturnstack(-1)) {
 			dbcerror(501);
-			goto next;
+			DISPATCH(next);
 		}
 		chgpcnt(i1);
 	}
 	else if (getbyte() == 0xFF && (vbcode & 0x03) == 0x03) pcount += 2;
-	goto next1;
+	DISPATCH(next1);
 
 vcallx:
 	i1 = getbyte() + ((vbcode & 0x03) << 8);
@@ -892,11 +947,11 @@ vcallx:
 	if (chkcond(getbyte())) {
 		if (pushreturnstack(-1)) {
 			dbcerror(501);
-			goto next;
+			DISPATCH(next);
 		}
 		chgpcnt(i1);
 	}
-	goto next1;
+	DISPATCH(next1);
 
 vcallp:
 	if (vbcode == 0xCD /* 205 */) {
@@ -911,7 +966,7 @@ vcallp:
 			davb = getdavb();
 			if (!davb->refnum) {
 				dbcerror(563);
-				goto next;
+				DISPATCH(next);
 			}
 			getlastvar(&lastmod, &lastoff);
 		}
@@ -954,7 +1009,7 @@ vcallp:
 	pcount++;
 	if (pushreturnstack(i5)) {
 		dbcerror(501);
-		goto next;
+		DISPATCH(next);
 	}
 	if (vbcode == 0x6F /* 111  call parms... */) chgpcnt(i4);
 	else if (vbcode == 0xCF /* 207  call method...*/) {
@@ -963,11 +1018,11 @@ vcallp:
 		chgmethod(i4, davb->refnum - 1);
 	}
 	else pcount = i4;
-	goto next2;
+	DISPATCH(next2);
 
 _goto:
 	pcount = llmmhh(&pgm[pcount]);
-	goto next1;
+	DISPATCH(next1);
 
 _gotox:
 	i1 = getbyte();
@@ -987,7 +1042,7 @@ _gotox:
 	}
 	else if (chkcond(i1)) goto _goto;
 	pcount += 3;
-	goto next2;
+	DISPATCH(next2);
 
 _gotosetclr:
 	adr1 = getint(work6a);
@@ -1009,7 +1064,7 @@ _gotosetclr:
 	}
 	else if (!fp) goto _goto;
 	pcount += 3;
-	goto next2;
+	DISPATCH(next2);
 
 _gotoifx:
 	adr1 = getint(work6a);
@@ -1058,7 +1113,7 @@ _gotoifx:
 		case 200: if (i1 >= 0) goto _goto; break;
 	}
 	pcount += 3;
-	goto next2;
+	DISPATCH(next2);
 
 _gotofor:
 	adr1 = getint(work6a);
@@ -1080,10 +1135,10 @@ _call:
 	pcount += 3;
 	if (pushreturnstack(-1)) {
 		dbcerror(501);
-		goto next;
+		DISPATCH(next);
 	}
 	pcount = i4;
-	goto next2;
+	DISPATCH(next2);
 
 _callx:
 	i1 = getbyte();
@@ -1103,15 +1158,15 @@ _callx:
 	}
 	else if (chkcond(i1)) goto _call;
 	pcount += 3;
-	goto next2;
+	DISPATCH(next2);
 
 vreturnc:
 	if (chkcond(vbcode - 0x5B)) vreturn();
-	goto next1;
+	DISPATCH(next1);
 
 vreturnx:
 	if (chkcond(getbyte())) vreturn();
-	goto next1;
+	DISPATCH(next1);
 
 vnoret:
 	/* pop stack if not part of make or destroy call path */
@@ -1124,7 +1179,7 @@ vnoret:
 		pcount = i2;
 	}
 	else dbcflags |= DBCFLAG_OVER;
-	goto next1;
+	DISPATCH(next1);
 
 	/*
 	 * 0x6F = 111 = CALL parms
@@ -1135,7 +1190,7 @@ vroutine:
 	if (lsvbcode == 0x6F || lsvbcode == 0xCD || lsvbcode == 0xCF) {
 		if ((ptr = getmpgm(callpmod)) == NULL) {
 			dbcerrinfo(505, (UCHAR*)"Failure calling a routine", -1);
-			goto next1;
+			DISPATCH(next1);
 		}
 		i1 = TRUE;  // Are there parameters because we got here from a CALL?
 	}
@@ -1162,7 +1217,7 @@ vroutine:
 		/* check for invalid code, this should not happen */
 		if (i6 == 0xFFFF && (adr1[0] < 0xB0 || adr1[0] > 0xC7)) {
 			dbcerrinfo(505, (UCHAR*)"Failure parsing param list on a call", -1);
-			goto next;
+			DISPATCH(next);
 		}
 		if (i1) {
 			if ((c1 = ptr[callpcnt]) < 0xF8) {
@@ -1213,7 +1268,7 @@ vroutine:
 		}
 	}
 	pcount++;
-	goto next1;
+	DISPATCH(next1);
 
 vchain:
 	if (fpicnt) filepi0();  /* cancel any filepi */
@@ -1233,17 +1288,45 @@ vchain:
 		enable();
 		/*vsql(0);*/
 	}
-	goto next;
+	DISPATCH(next);
 
 vstopc:
-	if (!chkcond(vbcode - 0x65)) goto next1;
+	if (!chkcond(vbcode - 0x65)) DISPATCH(next1);
 	vstop(NULL, 0);
-	goto next;
+	DISPATCH(next);
 
 vstopx:
-	if (!chkcond(getbyte())) goto next1;
+	if (!chkcond(getbyte())) DISPATCH(next1);
 	vstop(NULL, 0);
-	goto next;
+	DISPATCH(next);
+}
+
+/**
+ * Count down the DDT counter breakpoints set on the verb just fetched,
+ * a counter that reaches zero is converted to a real breakpoint
+ */
+static void checkcounterbrk()
+{
+	INT i1;
+
+	if (!(dbgflags & DBGFLAGS_DDT)) return;
+	for (i1 = 0; i1 < counterBrkhi; i1++) {
+		if (dbgCounterbrk[i1].mod == -1) continue;
+		if (dbgCounterbrk[i1].pcnt == pcount - 1 && getmpgm(dbgCounterbrk[i1].mod) == pgm) {
+			if (--dbgCounterbrk[i1].count == 0) {
+				CHAR line[12];
+				INT ptidx = dbgCounterbrk[i1].ptidx;
+				dbctcxputtag(1, "CounterBreakToZero");
+				sprintf(line, "%d", dbgCounterbrk[i1].line);
+				dbctcxputattr(1, "line", line);
+				dbctcxputattr(1, "module", dbgCounterbrk[i1].module);
+				convertCounterBPToRealBP(1, i1);
+				dbctcxput(1);
+				vbcode = pgm[pgmtable[ptidx].pcnt] = VERB_DEBUG;
+				break;
+			}
+		}
+	}
 }
 
 /**
@@ -3181,6 +3264,12 @@ void dbgaction(INT flag)
 	else action &= ~ACTION_DEBUG;
 }
 
+void dbgcounteraction(INT flag)
+{
+	if (flag) action |= ACTION_COUNTER;
+	else action &= ~ACTION_COUNTER;
+}
+
 void dbcshutdown()
 {
 	action |= ACTION_SHUTDOWN;
@@ -65,6 +65,8 @@
 #define DATA_ARRAYADR	0x10000000
 #define DATA_GTYPESHIFT	0
 
+#define OPCACHE_SIZE	512			/* entries in the getvar operand cache, a power of 2 */
+
 /**
  * A singly linked list of structures defining global variables.
  */
@@ -74,6 +76,21 @@ typedef struct globalinfostruct {
 	CHAR name[32]; // Must be last, its allocated size varies to accomodate the actual name length plus term-null
 } GLOBALINFO;
 
+/**
+ * Operand decoded by getvar at one instruction site, the 2 and 3 byte
+ * address forms with any common redirection already followed.
+ * An entry is only used while memgeneration is unchanged, so moved
+ * or freed modules never match.
+ */
+typedef struct opcachestruct {
+	UCHAR *site;		/* pgm + pcount of the operand */
+	UCHAR *data;		/* data module the operand was decoded against */
+	UINT gen;			/* memgeneration when the entry was made */
+	INT size;			/* bytes of the operand in the instruction */
+	INT off;			/* offset of the variable */
+	INT common;			/* TRUE if the variable is in the chain (common) data module */
+} OPCACHE;
+
 /* global variables */
 INT datachn, pgmchn;				/* chain data and program */
 
@@ -151,15 +168,23 @@ static INT rbyte;
  */
 static OFFSET fpos;
 
+/*
+ * Directory of shared program images, dbcdx.file.modcache
+ */
+static CHAR **modcache;
+
 static INT adrmod;					/* hold module of variable */
 static INT adroff;					/* hold offset of variable */
 static INT pcntsave = -1;			/* hold pcount used by getadrx */
+static OPCACHE opcache[OPCACHE_SIZE];	/* getvar operands, hashed by pcount */
 
 /* local routines */
 static INT loadclass(INT);
 static INT loadlabel(INT, INT, INT, INT, UCHAR ***, UCHAR ***, UCHAR ***);
 static INT loaddata(UCHAR ***, INT, INT, INT, INT *, INT *);
 static INT modread(UCHAR *, INT);
+static INT mappgm(CODEINFO *, CHAR *, INT);
+static void freepgm(CODEINFO *);
 static void unloadmod(INT, INT);
 static INT destroy(INT, INT *);
 static INT getdatax(INT);
@@ -262,6 +287,15 @@ INT newmod(INT chnflg, CHAR *pname, CHAR *dname, INT *mod, INT pcnt)
 		}
 		libptr[i1] = NULL;
 
+		/* get shared program image directory */
+		if (!prpget("file", "modcache", NULL, NULL, &ptr1, 0) && *ptr1) {
+			modcache = (CHAR **) memalloc((INT) strlen(ptr1) + 1, 0);
+			if (modcache == NULL) {
+				return(107);
+			}
+			strcpy(*modcache, ptr1);
+		}
+
 		/* allocate dummy code, program and name area, used when chain fails */
 		dummycode = (CODEINFO **) memalloc(sizeof(CODEINFO), MEMFLAGS_ZEROFILL);
 		pptr = memalloc(1, 0);
@@ -909,10 +943,16 @@ newmod0:
 		}
 		else if (c1 == 0x04) {  /* program area */
 			if (codewrk.pgmptr == NULL) {
-				codewrk.pgmptr = memalloc(nwork, 0);
-				if (codewrk.pgmptr == NULL) goto newmod2;
-				i1 = modread(*codewrk.pgmptr, nwork);
-				if (i1) goto newmod3;
+				if (modcache != NULL && !srvhandle) {
+					i1 = mappgm(&codewrk, pgmname, nwork);
+					if (i1) goto newmod3;
+				}
+				else {
+					codewrk.pgmptr = memalloc(nwork, 0);
+					if (codewrk.pgmptr == NULL) goto newmod2;
+					i1 = modread(*codewrk.pgmptr, nwork);
+					if (i1) goto newmod3;
+				}
 				codewrk.pgmsize = nwork;
 			}
 			else modread(NULL, nwork);
@@ -1111,7 +1151,7 @@ newmod3:
 	memfree(pgmwrk.xrefptr);
 	memfree(pgmwrk.xdefptr);
 	if (codewrk.codecnt == 1) {
-		memfree(codewrk.pgmptr);
+		freepgm(&codewrk);
 		memfree(codewrk.xrefptr);
 		memfree(codewrk.xdefptr);
 		memfree((UCHAR **) codewrk.fileptr);
@@ -2578,6 +2618,84 @@ static INT modread(UCHAR *buf, INT len)
 	return(0);
 }
 
+/*
+ * Load the program area from the shared program image of this .dbc,
+ * writing the image first if it does not exist yet.  The image is mapped
+ * copy on write, so processes running the same module share its pages
+ * and the debugger can still set breakpoints.  The image name includes
+ * the path, size and modification time of the .dbc, so a recompiled
+ * module never maps an old image.  Falls back to a memalloc copy.
+ */
+static INT mappgm(CODEINFO *code, CHAR *pgmname, INT size)
+{
+	INT i1;
+	UINT32 hash;
+	OFFSET filesize, mtime;
+	CHAR cachename[MAX_NAMESIZE + 1], work[32], *ptr;
+	UCHAR *map, **pptr;
+
+	cachename[0] = '\0';
+	ptr = fioname(handle);
+	if (ptr != NULL && !fioastat(fiogetOSHandle(handle), &filesize, &mtime)) {
+		/* different directories can hold modules of the same name */
+		for (hash = 5381; *ptr; ptr++) hash = hash * 33 + (UCHAR) *ptr;
+		i1 = (INT) strlen(*modcache);
+		if (i1 + strlen(pgmname) + 60 < sizeof(cachename)) {
+			strcpy(cachename, *modcache);
+			if (i1 && cachename[i1 - 1] != '/' && cachename[i1 - 1] != '\\') cachename[i1++] = '/';
+			i1 += sprintf(cachename + i1, "%s.%08X.", pgmname, (unsigned int) hash);
+			work[mscofftoa(filesize, work)] = '\0';
+			i1 += sprintf(cachename + i1, "%s.", work);
+			work[mscofftoa(mtime, work)] = '\0';
+			sprintf(cachename + i1, "%s.dbx", work);
+		}
+	}
+
+	if (cachename[0] && !fioamapfile(cachename, size, &map)) {
+		i1 = modread(NULL, size);  /* skip the program in the .dbc */
+		if (i1) {
+			fioaunmap(map, size);
+			return(i1);
+		}
+	}
+	else {
+		pptr = memalloc(size, 0);
+		if (pptr == NULL) return(ERR_NOMEM);
+		i1 = modread(*pptr, size);
+		if (i1) {
+			memfree(pptr);
+			return(i1);
+		}
+		if (!cachename[0] || fioasavefile(cachename, *pptr, size) || fioamapfile(cachename, size, &map)) {
+			code->pgmptr = pptr;
+			return(0);
+		}
+		memfree(pptr);
+	}
+
+	/* the pointer to the mapping must not move like memalloc memory */
+	code->pgmptr = (UCHAR **) malloc(sizeof(UCHAR *));
+	if (code->pgmptr == NULL) {
+		fioaunmap(map, size);
+		return(ERR_NOMEM);
+	}
+	*code->pgmptr = map;
+	code->pgmmap = TRUE;
+	return(0);
+}
+
+/* free the program area of a module */
+static void freepgm(CODEINFO *code)
+{
+	if (code->pgmmap) {
+		fioaunmap(*code->pgmptr, code->pgmsize);
+		free(code->pgmptr);
+		code->pgmptr = NULL;
+		code->pgmmap = FALSE;
+	}
+	else memfree(code->pgmptr);
+}
+
 /* unload one or all modules, singleflg = single module flag */
 INT vunload(INT singleflg, INT pcnt)
 {
@@ -2728,11 +2846,12 @@ static void unloadmod(INT mod, INT pgmflg)
 /*** CODE: NOW THAT THIS HAS BEEN ADDED FOR CHAIN, MAYBE SUPPORT TRAPS ***/
 /***       IN PRELOADS - NO IMPLICIT TRAPCLR ALL (CHANGE DOCUMENTATION) ***/
 			if (pgmtab[mod].typeflg != 4) pgmflg = FALSE;
+			prfunload(pgmtab[mod].pgmmod);
 			trapclearmod(pgmtab[mod].pgmmod);
 			code = *pgmtab[mod].codeptr;
 
 			if (!--code->codecnt) {
-				memfree(code->pgmptr);
+				freepgm(code);
 				memfree(code->xrefptr);
 				memfree(code->xdefptr);
 				memfree((UCHAR **) code->fileptr);
@@ -2845,6 +2964,7 @@ destroy1:
 
 void setpgmdata()
 {
+	pgmdatagen = memgeneration;
 	datatab = *datatabptr;
 	pgmtab = *pgmtabptr;
 	if (datatab[dataxmodule].dataptr != NULL) data = *datatab[dataxmodule].dataptr;
@@ -3496,22 +3616,37 @@ INT gethhll()
 	return(i1);
 }
 
-/* return redirected address and set fp, lp, pl, hl */
+/*
+ * return redirected address and set fp, lp, pl, hl
+ *
+ * The location of a 2 or 3 byte address operand is kept in opcache, keyed by the
+ * program address and data module of the operand. The header (fp, lp, null)
+ * changes at run time and is always decoded again. Qualified arrays, address
+ * variables and operands read through getvarx are not cached.
+ */
 UCHAR *getvar(INT flag)
 {
-	INT adrflg;
+	INT adrflg, opsize;
 	UCHAR *adr;
+	OPCACHE *op;
 	CHAR work[128]; // Only used for error messages
 
 	adrflg = FALSE;
 	adrmod = dataxmodule;
+	op = &opcache[pcount & (OPCACHE_SIZE - 1)];
+	if (op->site == pgm + pcount && op->data == data && op->gen == memgeneration && pcntsave == -1) {
+		pcount += op->size;
+		adroff = op->off;
+		if (op->common) adr = *datatab[adrmod = dataxchn].dataptr + adroff;
+		else adr = data + adroff;
+		goto getvar2;
+	}
 	adroff = hhll(&pgm[pcount]);
 
 	/* typical variable with 2 byte address */
 	if (adroff < 0xC000) {
-		adr = data + adroff;
-		pcount += 2;
-		goto getvar1;
+		opsize = 2;
+		goto getvar3;
 	}
 
 	/* qualified array */
@@ -3520,15 +3655,15 @@ UCHAR *getvar(INT flag)
 		goto getvar1;
 	}
 
-	pcount += 2;
 	/* variable with 3 byte address */
 	if (adroff < 0xC180) {
-		adroff = ((adroff & 0xFF) << 16) | hhll(&pgm[pcount]);
-		adr = data + adroff;
-		pcount += 2;
-		goto getvar1;
+		adroff = ((adroff & 0xFF) << 16) | hhll(&pgm[pcount + 2]);
+		opsize = 4;
+		goto getvar3;
 	}
 
+	pcount += 2;
+
 	if ((flag & (VAR_READ | VAR_WRITE)) && adroff == 0xFFFF) return(NULL);
 	sprintf(work, "Fail in getvar, adroff=%#x", (UINT)adroff);
 
@@ -3539,11 +3674,28 @@ getvar0:
 	}
 	dbcerrinfo(505, (UCHAR*)work, -1);
 
+getvar3:
+	adr = data + adroff;
+	if (adroff < datatab[adrmod].size && pcntsave == -1) {
+		if (adr[0] == 0xFD) adr = *datatab[adrmod = dataxchn].dataptr + adroff;  /* common redirection */
+		if (adroff < datatab[adrmod].size) {
+			op->site = pgm + pcount;
+			op->data = data;
+			op->gen = memgeneration;
+			op->size = opsize;
+			op->off = adroff;
+			op->common = (adrmod != dataxmodule);
+		}
+	}
+	pcount += opsize;
+
 getvar1:
 	if (adroff >= datatab[adrmod].size) {
 		sprintf(work, "Fail in getvar, adroff=%#x, datatab[adrmod].size=%d", (UINT)adroff, datatab[adrmod].size);
 		goto getvar0;
 	}
+
+getvar2:
 	if (adr[0] < 0x80) {  /* small char */
 		fp = adr[0];
 		lp = adr[1];
@@ -193,9 +193,9 @@ void vsformat()
 void vsearch()
 {
 	static UCHAR searchflg = 0;
-	INT i1, i2, i3, i4, flags, fp1, lp1, hl1, off1, len1, listflag, off2, vartype1;
+	INT i1, i2, i3, i4, i5, flags, fp1, lp1, hl1, off1, len1, listflag, off2, vartype1;
 	INT32 x1;
-	UCHAR work45[45], formvar1[32], formvar2[32], *adr1, *adr2, *adr3, *ptr2;
+	UCHAR c1, c2, work45[45], formvar1[32], formvar2[32], *adr1, *adr2, *adr3, *ptr2;
 
 	if (!searchflg) {
 		searchflg = 1;
@@ -236,9 +236,56 @@ void vsearch()
 	}
 
 	x1 = 0;
-	for (i4 = 1; i4 <= i3; i4++) {
+	i4 = 1;
+	i5 = FALSE;
+	if (!listflag && i3) {
+		/*
+		 * step through consecutive character variables without scanvar/skipvar
+		 * and only compare all bytes when the first and last bytes match,
+		 * keys are often padded with blanks on one side
+		 */
+		c1 = adr1[off1];
+		c2 = adr1[off1 + len1 - 1];
+		for ( ; i4 <= i3; i4++) {
+			if (i5) {  /* skip to next variable, including the fill bytes and name as skipvar does */
+				i1 = hl + pl;
+				while (adr2[i1] == 0xF3) i1++;
+				if (adr2[i1] == 0xFE) {
+					while (adr2[++i1] != 0xFE);
+					i1++;
+				}
+				adr2 += i1;
+			}
+			i5 = TRUE;
+			if (*adr2 < 0x80) {  /* small dim */
+				fp = adr2[0];
+				lp = adr2[1];
+				pl = adr2[2];
+				hl = 3;
+			}
+			else if (*adr2 == 0xF0) {  /* large dim */
+				fp = llhh(&adr2[1]);
+				lp = llhh(&adr2[3]);
+				pl = llhh(&adr2[5]);
+				hl = 7;
+			}
+			else {  /* let the loop below handle it from this variable */
+				i5 = FALSE;
+				break;
+			}
+			if (!fp || len1 > (lp - fp + 1)) continue;
+			ptr2 = adr2 + fp + hl - 1;
+			if (ptr2[0] == c1 && ptr2[len1 - 1] == c2 && (len1 <= 2 || !memcmp(ptr2 + 1, adr1 + off1 + 1, len1 - 2))) {
+				x1 = i4;
+				break;
+			}
+		}
+		if (x1) i3 = 0;
+	}
+	for ( ; i4 <= i3; i4++) {
 		if (!listflag) {
-			if (i4 > 1) adr2 += skipvar(adr2, TRUE);  /* skip to next variable */
+			if (i5) adr2 += skipvar(adr2, TRUE);  /* skip to next variable */
+			i5 = TRUE;
 			scanvar(adr2);
 		}
 		else {
@@ -446,8 +493,8 @@ void chk1011(INT chk, UCHAR *s1, UCHAR *s2, UCHAR *s3)  /* check10, check11 */
 
 void vscan()
 {
-	INT i1, i2, i3, i4, fp1, lp1, hl1, fp2, lp2, hl2;
-	UCHAR *adr1, *adr2;
+	INT i4, fp1, lp1, hl1, fp2, lp2, hl2;
+	UCHAR *adr1, *adr2, *ptr1, *ptr2;
 
 	dbcflags &= ~(DBCFLAG_EOS | DBCFLAG_EQUAL);
 	adr1 = getvar(VAR_READ);
@@ -464,14 +511,18 @@ void vscan()
 	}
 	hl1 = lp1 - fp1 + 1;
 	i4 = lp2 - fp2 + 2 - hl1;
-	for (i3 = 0; i3 < i4; i3++) {
-		for (i1 = 0, i2 = fp2 + hl2 + i3 - 1; i1 < hl1; i1++, i2++) if (adr1[i1] != adr2[i2]) break;
-		if (i1 == hl1) {
-			fp = fp2 + i3;
+	if (i4 <= 0) return;
+	/* find the first byte with memchr, then compare the rest */
+	ptr1 = adr2 + fp2 + hl2 - 1;
+	ptr2 = ptr1;
+	while ((ptr2 = (UCHAR *) memchr(ptr2, adr1[0], i4 - (INT)(ptr2 - ptr1))) != NULL) {
+		if (!memcmp(ptr2 + 1, adr1 + 1, hl1 - 1)) {
+			fp = fp2 + (INT)(ptr2 - ptr1);
 			setfp(adr2);
 			dbcflags |= DBCFLAG_EQUAL;
 			break;
 		}
+		if (++ptr2 - ptr1 >= i4) break;
 	}
 }
 
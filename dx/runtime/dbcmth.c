@@ -31,6 +31,14 @@ static UCHAR x8130[2] = { 0x81, 0x30 };
 static UCHAR x00000000[4] = { 0x00, 0x00, 0x00, 0x00 };
 static UCHAR precisionflg = 0;
 
+/* maximum number of digits handled by the binary fast path, must fit in an OFFSET */
+#define MATHFAST_DIGITS 18
+
+/* local routine declarations */
+static INT mathfast(INT, UCHAR *, UCHAR *, UCHAR *);
+static INT formtobin(UCHAR *, OFFSET *, INT *, INT *);
+static INT bintoform(OFFSET, INT, UCHAR *);
+
 
 void vmathexp(INT vx)  /* _math operations */
 {
@@ -222,6 +230,7 @@ void mathop(INT op, UCHAR *src1, UCHAR *src2, UCHAR *dest)
 	}
 
 	if (typeflag == 2) {  /* form : form  OR INT : form */
+		if (op <= 0x03 && !mathfast(op, src1, src2, dest)) return;
 		if (src1[0] < 0xA0) {  /* not a literal */
 			if (src1[0] == 0x80) {  /* null */
 				memcpy(formvar1, src1, 32);
@@ -765,6 +774,150 @@ zerodiv:
 	itonv(0, dest);
 }
 
+/**
+ * Binary fast path for compare, add, subtract and multiply of form variables
+ * and numeric literals whose digits fit in a 64 bit integer.  The result and
+ * flags are the same as the decimal code in mathop, which handles whatever
+ * this declines (null or non-canonical forms, too many digits).
+ * Return 0 if done, RC_ERROR if the decimal code must be used.
+ */
+static INT mathfast(INT op, UCHAR *src1, UCHAR *src2, UCHAR *dest)
+{
+	INT i1, lft1, lft2, rgt, rgt1, rgt2;
+	OFFSET x1, x2, x3;
+	UCHAR work[32];
+
+	if (formtobin(src1, &x1, &lft1, &rgt1) || formtobin(src2, &x2, &lft2, &rgt2)) return RC_ERROR;
+	if (op <= 0x02) {  /* compare, add and subtract */
+		rgt = (rgt1 > rgt2) ? rgt1 : rgt2;
+		if (((lft1 > lft2) ? lft1 : lft2) + rgt > MATHFAST_DIGITS) return RC_ERROR;
+		for (i1 = rgt1; i1 < rgt; i1++) x1 *= 10;
+		for (i1 = rgt2; i1 < rgt; i1++) x2 *= 10;
+		if (!op) {
+			dbcflags &= ~(DBCFLAG_EQUAL | DBCFLAG_LESS);
+			if (x2 == x1) dbcflags |= DBCFLAG_EQUAL;
+			else if (x2 < x1) dbcflags |= DBCFLAG_LESS;
+			return 0;
+		}
+		if (op == 0x01) x3 = x2 + x1;
+		else x3 = x2 - x1;
+	}
+	else {  /* multiply */
+		if (lft1 + rgt1 + lft2 + rgt2 > MATHFAST_DIGITS) return RC_ERROR;
+		x3 = x2 * x1;
+		rgt = rgt1 + rgt2;
+	}
+
+	if (dest[0] > 0x80 && dest[0] < 0xA0 && !bintoform(x3, rgt, dest)) return 0;
+
+	/* let movevar round, truncate and set the flags */
+	x1 = (x3 < 0) ? -x3 : x3;
+	for (i1 = 31; i1 > 31 - rgt; i1--) {
+		work[i1] = (UCHAR)('0' + x1 % 10);
+		x1 /= 10;
+	}
+	if (rgt) work[i1--] = '.';
+	do {
+		work[i1--] = (UCHAR)('0' + x1 % 10);
+		x1 /= 10;
+	} while (x1);
+	if (x3 < 0) work[i1--] = '-';
+	work[i1] = (UCHAR)(0x80 | (31 - i1));
+	movevar(&work[i1], dest);
+	return 0;
+}
+
+/**
+ * Convert a non-null form variable or numeric literal to a binary value scaled
+ * by 10 to the power of the number of right digits.
+ * Return 0 if successful, RC_ERROR if not in canonical form or too many digits
+ */
+static INT formtobin(UCHAR *src, OFFSET *value, INT *lft, INT *rgt)
+{
+	INT i1, len, digits, negflg, right;
+	OFFSET x1;
+
+	if (src[0] < 0xA0) {
+		if (src[0] == 0x80) return RC_ERROR;  /* null */
+		len = src[0] & 0x1F;
+		src++;
+	}
+	else {  /* literal */
+		len = src[1];
+		src += 2;
+	}
+	for (i1 = 0; i1 < len && src[i1] == ' '; i1++);
+	negflg = FALSE;
+	if (i1 < len && src[i1] == '-') {
+		negflg = TRUE;
+		i1++;
+	}
+	for (x1 = 0, digits = 0, right = -1; i1 < len; i1++) {
+		if (src[i1] >= '0' && src[i1] <= '9') {
+			if (++digits > MATHFAST_DIGITS) return RC_ERROR;
+			x1 = x1 * 10 + src[i1] - '0';
+			if (right >= 0) right++;
+		}
+		else if (src[i1] == '.' && right < 0) right = 0;
+		else return RC_ERROR;
+	}
+	if (!digits) return RC_ERROR;
+	if (right < 0) right = 0;
+	*value = (negflg) ? -x1 : x1;
+	*lft = digits - right;
+	*rgt = right;
+	return 0;
+}
+
+/**
+ * Store a binary value with rgt right digits into a non-null form variable,
+ * formatted and flagged the way movevar does.
+ * Return 0 if successful, RC_ERROR if rounding is required or it does not fit
+ */
+static INT bintoform(OFFSET value, INT rgt, UCHAR *dest)
+{
+	INT i1, i2, len, rd, need;
+	OFFSET x1, x2;
+
+	len = dest[0] & 0x1F;
+	for (i1 = 0; i1 < len && dest[++i1] != '.'; );
+	rd = len - i1;  /* number of right digits in dest */
+	if (rd < rgt) return RC_ERROR;
+
+	x1 = (value < 0) ? -value : value;
+	for (i1 = rgt, i2 = 0, x2 = x1; x2; x2 /= 10) i2++;
+	if (i2 + rd - rgt > MATHFAST_DIGITS) return RC_ERROR;
+	while (i1++ < rd) x1 *= 10;
+
+	/* count the integer digits, a zero integer part only shows without decimals */
+	for (i2 = 0, x2 = x1; i2 < rd; i2++) x2 /= 10;
+	for (need = 0; x2; x2 /= 10) need++;
+	if (!need && !rd) need = 1;
+	if (rd) need += rd + 1;
+	if (value < 0) need++;
+	if (need > len) return RC_ERROR;
+
+	i1 = len;
+	for (i2 = 0; i2 < rd; i2++) {
+		dest[i1--] = (UCHAR)('0' + x1 % 10);
+		x1 /= 10;
+	}
+	if (rd) i1--;  /* skip over the decimal point */
+	if (x1 || !rd) {
+		do {
+			dest[i1--] = (UCHAR)('0' + x1 % 10);
+			x1 /= 10;
+		} while (x1);
+	}
+	if (value < 0) dest[i1--] = '-';
+	while (i1 > 0) dest[i1--] = ' ';
+
+	dbcflags &= ~(DBCFLAG_EQUAL | DBCFLAG_LESS | DBCFLAG_OVER);
+	if (!value) dbcflags |= DBCFLAG_EQUAL;
+	else if (value < 0) dbcflags |= DBCFLAG_LESS;
+	return 0;
+}
+
 void vgetsize(UCHAR *adr, INT *lft, INT *rgt)
 {
 	INT i1, i2;
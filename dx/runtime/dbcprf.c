@@ -0,0 +1,530 @@
+/*******************************************************************************
+ *
+ * Copyright 2023 Portable Software Company
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************/
+
+/*
+ * Verb profiler
+ *
+ * Enabled by dbcdx.profile.file=<file> (flat profile) and/or
+ * dbcdx.profile.stacks=<file> (collapsed stacks for flame graph tools).
+ * dbciex calls prfverb() before each verb while profiling. Every verb is
+ * counted and timed against the verb code and the module/pcount it started at;
+ * the call stack is sampled every dbcdx.profile.interval microseconds
+ * (default 1000). Source lines and routine names are taken from the .dbg
+ * files when a module is unloaded or at exit.
+ * The tables are allocated with malloc so that profiling never moves memory.
+ */
+
+#define INC_STDIO
+#define INC_STRING
+#define INC_STDLIB
+#define INC_TIME
+#include "includes.h"
+#include "base.h"
+#include "dbc.h"
+
+#define PRF_VERBS 512			/* verb codes, 0x100 + vx for 0x58 verbs */
+#define PRF_MAXDEPTH 64			/* deepest sampled stack */
+#define PRF_STACKHASH 4096		/* stack hash buckets */
+
+#define PRFHASH(mod, pcnt, max) (((UINT) (mod) * 31 + (UINT) (pcnt)) & ((max) - 1))
+
+typedef struct {
+	INT mod;		/* program module number */
+	INT pcnt;		/* pcount of the verb */
+	INT modname;	/* index into names of the module name */
+	INT srcname;	/* index into names of the source file name, -1 if unknown */
+	INT rtnname;	/* index into names of the routine name, -1 if none */
+	INT line;		/* one based source line, 0 if unknown */
+	INT resolved;	/* module name, source and routine have been looked up */
+	UINT64 count;	/* times executed */
+	UINT64 time;	/* nanoseconds spent */
+} PRFPOINT;
+
+typedef struct PRFSTACK_struct {
+	struct PRFSTACK_struct *next;
+	INT depth;		/* number of points in stack */
+	INT *points;	/* point indexes, outermost first */
+	UINT64 samples;	/* samples with this stack */
+} PRFSTACK;
+
+typedef struct {
+	INT index;		/* verb code or point index */
+	UINT64 count;
+	UINT64 time;
+} PRFLINE;
+
+static INT prfflag;				/* profiling is active */
+static CHAR *prffile;			/* flat profile file name */
+static CHAR *prfstacksfile;		/* collapsed stacks file name */
+static UINT64 interval;			/* stack sample interval in nanoseconds */
+static UINT64 starttime, lasttime, nextsample;
+static UINT64 verbcount[PRF_VERBS], verbtime[PRF_VERBS];
+static INT lastpoint, lastverb;
+
+static PRFPOINT *points;		/* points in order of creation */
+static INT pointmax, pointhi;
+static INT *pointhash;			/* open addressed hash of point indexes, -1 is empty */
+static INT hashmax;
+static PRFSTACK *stacks[PRF_STACKHASH];
+static INT stackframes[PRF_MAXDEPTH];
+static CHAR **names;			/* module, source and routine names */
+static INT namemax, namehi;
+
+static UCHAR fileverbs[PRF_VERBS];
+
+/* verbs that call the file i/o routines through dbcdio */
+static INT fileverblist[] = {
+	0x01, 0x12, 0x13, 0x1D, 0x1F, 0x23, 0x2C, 0x2D, 0x32, 0x34, 0x36, 0x38, 0x3C,
+	0x50, 0x51, 0x52, 0x53, 0x54,
+	0x10A, 0x112, 0x11E, 0x11F, 0x121, 0x16B, 0x16C,
+	0x1C2, 0x1C3, 0x1C4, 0x1C5, 0x1C6, 0x1C7, 0x1C8, 0x1E8, -1
+};
+
+static UINT64 prfclock(void);
+static INT prfpoint(INT, INT);
+static void prfsample(UINT64);
+static void prfresolve(INT);
+static INT prfname(CHAR *);
+static CHAR *prfstrdup(CHAR *);
+static CHAR *prfstr(INT);
+static void prfflat(void);
+static void prfstacks(void);
+static INT prfcompare(const void *, const void *);
+static INT prflinecompare(const void *, const void *);
+static CHAR *prfframe(PRFPOINT *, CHAR *);
+
+/*
+ * Read the profile properties, return TRUE if profiling is enabled
+ */
+INT prfinit()
+{
+	INT i1;
+	CHAR *ptr;
+
+	if (!prpget("profile", "file", NULL, NULL, &ptr, 0) && *ptr) prffile = prfstrdup(ptr);
+	if (!prpget("profile", "stacks", NULL, NULL, &ptr, 0) && *ptr) prfstacksfile = prfstrdup(ptr);
+	if (prffile == NULL && prfstacksfile == NULL) return FALSE;
+	interval = 1000;
+	if (!prpget("profile", "interval", NULL, NULL, &ptr, 0) && atoi(ptr) > 0) interval = atoi(ptr);
+	interval *= 1000;
+
+	pointmax = 2048;
+	points = (PRFPOINT *) malloc(pointmax * sizeof(PRFPOINT));
+	hashmax = 4096;
+	pointhash = (INT *) malloc(hashmax * sizeof(INT));
+	namemax = 64;
+	names = (CHAR **) malloc(namemax * sizeof(CHAR *));
+	if (points == NULL || pointhash == NULL || names == NULL) return FALSE;
+	for (i1 = 0; i1 < hashmax; i1++) pointhash[i1] = -1;
+	for (i1 = 0; fileverblist[i1] != -1; i1++) fileverbs[fileverblist[i1]] = TRUE;
+
+	lastpoint = -1;
+	starttime = lasttime = prfclock();
+	nextsample = starttime + interval;
+	prfflag = TRUE;
+	return TRUE;
+}
+
+/*
+ * Count the verb at pcount - 1 and charge the time since the last call to the previous verb
+ */
+void prfverb()
+{
+	INT verb;
+	UINT64 now;
+
+	now = prfclock();
+	if (lastpoint != -1) {
+		points[lastpoint].time += now - lasttime;
+		verbtime[lastverb] += now - lasttime;
+		/* the sample belongs to the verb that used the time */
+		if (now >= nextsample && prfstacksfile != NULL) prfsample(now);
+	}
+	verb = vbcode;
+	if (verb == 0x58) verb = 0x100 + pgm[pcount];
+	verbcount[verb]++;
+	lastverb = verb;
+	lastpoint = prfpoint(pgmmodule, pcount - 1);
+	if (lastpoint != -1) points[lastpoint].count++;
+	lasttime = now;
+}
+
+/*
+ * Look up source lines for a module that is being unloaded
+ */
+void prfunload(INT mod)
+{
+	if (prfflag) prfresolve(mod);
+}
+
+/*
+ * Write the profile files
+ */
+void prfexit()
+{
+	INT i1;
+	UINT64 now;
+
+	if (!prfflag) return;
+	prfflag = FALSE;
+	now = prfclock();
+	if (lastpoint != -1) {
+		points[lastpoint].time += now - lasttime;
+		verbtime[lastverb] += now - lasttime;
+	}
+	lasttime = now;
+	for (i1 = 0; i1 < pointhi; i1++) {
+		if (!points[i1].resolved) prfresolve(points[i1].mod);
+	}
+	if (prffile != NULL) prfflat();
+	if (prfstacksfile != NULL) prfstacks();
+}
+
+/* return a time in nanoseconds */
+static UINT64 prfclock()
+{
+#if OS_WIN32
+	LARGE_INTEGER count;
+	static LARGE_INTEGER freq;
+
+	if (!freq.QuadPart && !QueryPerformanceFrequency(&freq)) return(0);
+	QueryPerformanceCounter(&count);
+	return((UINT64)(count.QuadPart / freq.QuadPart) * 1000000000
+		+ (UINT64)(count.QuadPart % freq.QuadPart) * 1000000000 / freq.QuadPart);
+#else
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return((UINT64) ts.tv_sec * 1000000000 + ts.tv_nsec);
+#endif
+}
+
+/*
+ * Return the index of the point for mod and pcnt, adding it if new.
+ * Return -1 if the tables can not grow.
+ */
+static INT prfpoint(INT mod, INT pcnt)
+{
+	INT i1, i2, newmax, *newhash;
+	PRFPOINT *point;
+
+	for (i1 = PRFHASH(mod, pcnt, hashmax); (i2 = pointhash[i1]) != -1; i1 = (i1 + 1) & (hashmax - 1)) {
+		if (points[i2].pcnt == pcnt && points[i2].mod == mod) return i2;
+	}
+	if (pointhi == pointmax) {
+		point = (PRFPOINT *) realloc(points, (pointmax << 1) * sizeof(PRFPOINT));
+		if (point == NULL) return -1;
+		points = point;
+		pointmax <<= 1;
+	}
+	if ((pointhi + 1) << 1 > hashmax) {  /* keep the hash at most half full */
+		newmax = hashmax << 1;
+		newhash = (INT *) malloc(newmax * sizeof(INT));
+		if (newhash == NULL) return -1;
+		for (i1 = 0; i1 < newmax; i1++) newhash[i1] = -1;
+		for (i2 = 0; i2 < pointhi; i2++) {
+			for (i1 = PRFHASH(points[i2].mod, points[i2].pcnt, newmax); newhash[i1] != -1; i1 = (i1 + 1) & (newmax - 1));
+			newhash[i1] = i2;
+		}
+		free(pointhash);
+		pointhash = newhash;
+		hashmax = newmax;
+		for (i1 = PRFHASH(mod, pcnt, hashmax); pointhash[i1] != -1; i1 = (i1 + 1) & (hashmax - 1));
+	}
+	pointhash[i1] = pointhi;
+	point = &points[pointhi];
+	memset(point, 0, sizeof(PRFPOINT));
+	point->mod = mod;
+	point->pcnt = pcnt;
+	point->modname = point->srcname = point->rtnname = -1;
+	return pointhi++;
+}
+
+/*
+ * Add a sample of the return stack and the last verb
+ */
+static void prfsample(UINT64 now)
+{
+	INT i1, i2, depth, start;
+	UINT hash;
+	UINT64 samples;
+	PRFSTACK *stack;
+
+	samples = 1 + (now - nextsample) / interval;
+	nextsample += samples * interval;
+
+	depth = returnstackcount();
+	start = (depth >= PRF_MAXDEPTH) ? depth - PRF_MAXDEPTH + 1 : 0;
+	for (i1 = start, i2 = 0; i1 < depth; i1++) {
+		/* return pcount is after the call, use its last byte */
+		stackframes[i2] = prfpoint(returnstackpgm(i1), returnstackpcount(i1) - 1);
+		if (stackframes[i2] == -1) return;
+		i2++;
+	}
+	if (lastpoint == -1) return;
+	stackframes[i2++] = lastpoint;
+	depth = i2;
+
+	for (i1 = 0, hash = 0; i1 < depth; i1++) hash = hash * 31 + (UINT) stackframes[i1];
+	hash &= PRF_STACKHASH - 1;
+	for (stack = stacks[hash]; stack != NULL; stack = stack->next) {
+		if (stack->depth == depth && !memcmp(stack->points, stackframes, depth * sizeof(INT))) break;
+	}
+	if (stack == NULL) {
+		stack = (PRFSTACK *) malloc(sizeof(PRFSTACK));
+		if (stack == NULL) return;
+		stack->points = (INT *) malloc(depth * sizeof(INT));
+		if (stack->points == NULL) {
+			free(stack);
+			return;
+		}
+		memcpy(stack->points, stackframes, depth * sizeof(INT));
+		stack->depth = depth;
+		stack->samples = 0;
+		stack->next = stacks[hash];
+		stacks[hash] = stack;
+	}
+	stack->samples += samples;
+}
+
+/*
+ * Set the module name, source line and routine of the points in module mod
+ */
+static void prfresolve(INT mod)
+{
+	INT i1, i2, lo, hi, rc, modname, best;
+	CHAR *ntable, savename[sizeof(name)];
+	PGMDEF *ptable;
+	SRCDEF *stable;
+	RTNDEF *rtable;
+	PRFPOINT *point;
+	DBGINFOSTRUCT dbginfo;
+
+	/* getdbg uses name, errors are only recorded, the debugger screen may not exist */
+	strcpy(savename, name);
+	dbgerrorquiet(TRUE);
+	rc = getdbg(mod, &dbginfo);
+	dbgerrorquiet(FALSE);
+	strcpy(name, savename);
+	setpgmdata();
+
+	modname = prfname(getpname(mod));
+	for (i1 = 0; i1 < pointhi; i1++) {
+		point = &points[i1];
+		if (point->mod != mod || point->resolved) continue;
+		point->resolved = TRUE;
+		point->modname = modname;
+		if (rc) continue;
+		ptable = (PGMDEF *) *dbginfo.ptabptr;
+		stable = (SRCDEF *) *dbginfo.stabptr;
+		rtable = (RTNDEF *) *dbginfo.rtabptr;
+		ntable = (CHAR *) *dbginfo.ntabptr;
+		/* last program line starting at or before pcnt */
+		for (lo = 0, hi = dbginfo.ptabsize; lo < hi; ) {
+			i2 = (lo + hi) >> 1;
+			if (ptable[i2].pcnt <= point->pcnt) lo = i2 + 1;
+			else hi = i2;
+		}
+		if (lo) {
+			point->line = ptable[lo - 1].linenum + 1;
+			point->srcname = prfname(&ntable[stable[ptable[lo - 1].stidx].nametableptr]);
+		}
+		/* innermost routine */
+		for (i2 = 0, best = -1; i2 < dbginfo.rtabsize; i2++) {
+			if (point->pcnt < rtable[i2].spcnt || point->pcnt >= rtable[i2].epcnt) continue;
+			if (best == -1 || rtable[i2].epcnt - rtable[i2].spcnt < rtable[best].epcnt - rtable[best].spcnt) best = i2;
+		}
+		if (best != -1) point->rtnname = prfname(&ntable[rtable[best].nptr]);
+	}
+}
+
+/*
+ * Return the index of name str in the names table, adding it if new
+ */
+static INT prfname(CHAR *str)
+{
+	INT i1;
+	CHAR **newnames;
+
+	for (i1 = 0; i1 < namehi; i1++) if (!strcmp(names[i1], str)) return i1;
+	if (namehi == namemax) {
+		newnames = (CHAR **) realloc(names, (namemax << 1) * sizeof(CHAR *));
+		if (newnames == NULL) return -1;
+		names = newnames;
+		namemax <<= 1;
+	}
+	if ((names[namehi] = prfstrdup(str)) == NULL) return -1;
+	return namehi++;
+}
+
+static CHAR *prfstrdup(CHAR *str)
+{
+	CHAR *ptr;
+
+	ptr = (CHAR *) malloc(strlen(str) + 1);
+	if (ptr != NULL) strcpy(ptr, str);
+	return ptr;
+}
+
+static CHAR *prfstr(INT index)
+{
+	if (index == -1) return "?";
+	return names[index];
+}
+
+/*
+ * Write the flat profile, by verb then by source line
+ */
+static void prfflat()
+{
+	INT i1, i2, linehi;
+	UINT64 total, count, filetime;
+	CHAR work[300];
+	FILE *file;
+	PRFPOINT *point, *point2;
+	PRFLINE *lines;
+
+	file = fopen(prffile, "w");
+	if (file == NULL) return;
+	total = lasttime - starttime;
+	if (!total) total = 1;
+	for (i1 = 0, count = 0, filetime = 0; i1 < PRF_VERBS; i1++) {
+		count += verbcount[i1];
+		if (fileverbs[i1]) filetime += verbtime[i1];
+	}
+	fprintf(file, "DB/C profile: %llu verbs in %.3f ms, %.3f ms (%.1f%%) in file i/o verbs\n\n",
+		(unsigned long long) count, (double) total / 1e6, (double) filetime / 1e6, (double) filetime * 100 / total);
+
+	/* verbs */
+	lines = (PRFLINE *) malloc((pointhi > PRF_VERBS ? pointhi : PRF_VERBS) * sizeof(PRFLINE));
+	if (lines == NULL) {
+		fclose(file);
+		return;
+	}
+	for (i1 = 0, linehi = 0; i1 < PRF_VERBS; i1++) {
+		if (!verbcount[i1]) continue;
+		lines[linehi].index = i1;
+		lines[linehi].count = verbcount[i1];
+		lines[linehi++].time = verbtime[i1];
+	}
+	qsort(lines, linehi, sizeof(PRFLINE), prfcompare);
+	fprintf(file, "%14s %12s %6s  verb\n", "count", "time ms", "time%");
+	for (i1 = 0; i1 < linehi; i1++) {
+		i2 = lines[i1].index;
+		if (i2 >= 0x100) sprintf(work, "58 %02X", i2 - 0x100);
+		else sprintf(work, "%02X", i2);
+		fprintf(file, "%14llu %12.3f %6.2f  %s%s\n", (unsigned long long) lines[i1].count,
+			(double) lines[i1].time / 1e6, (double) lines[i1].time * 100 / total, work, fileverbs[i2] ? " (file i/o)" : "");
+	}
+
+	/* source lines, verbs on the same line are added together */
+	for (i1 = 0, linehi = 0; i1 < pointhi; i1++) {
+		if (!points[i1].count) continue;
+		lines[linehi].index = i1;
+		lines[linehi].count = points[i1].count;
+		lines[linehi++].time = points[i1].time;
+	}
+	qsort(lines, linehi, sizeof(PRFLINE), prflinecompare);
+	for (i1 = 0, i2 = -1; i1 < linehi; i1++) {
+		point = &points[lines[i1].index];
+		if (i2 != -1) {
+			point2 = &points[lines[i2].index];
+			if (point->line && point2->mod == point->mod && point2->line == point->line && point2->srcname == point->srcname) {
+				if (lines[i2].count < lines[i1].count) lines[i2].count = lines[i1].count;  /* line executions */
+				lines[i2].time += lines[i1].time;
+				continue;
+			}
+		}
+		lines[++i2] = lines[i1];
+	}
+	linehi = i2 + 1;
+	qsort(lines, linehi, sizeof(PRFLINE), prfcompare);
+	fprintf(file, "\n%14s %12s %6s  module  source:line  routine\n", "count", "time ms", "time%");
+	for (i1 = 0; i1 < linehi; i1++) {
+		point = &points[lines[i1].index];
+		if (point->line) snprintf(work, sizeof(work), "%s:%d", prfstr(point->srcname), point->line);
+		else sprintf(work, "pcount %d", point->pcnt);
+		fprintf(file, "%14llu %12.3f %6.2f  %s  %s  %s\n", (unsigned long long) lines[i1].count,
+			(double) lines[i1].time / 1e6, (double) lines[i1].time * 100 / total,
+			prfstr(point->modname), work, point->rtnname == -1 ? "" : names[point->rtnname]);
+	}
+	free(lines);
+	fclose(file);
+}
+
+/*
+ * Write the sampled stacks, one line per stack: frame;frame;frame samples
+ */
+static void prfstacks()
+{
+	INT i1, i2;
+	CHAR work[300];
+	FILE *file;
+	PRFSTACK *stack;
+
+	file = fopen(prfstacksfile, "w");
+	if (file == NULL) return;
+	for (i1 = 0; i1 < PRF_STACKHASH; i1++) {
+		for (stack = stacks[i1]; stack != NULL; stack = stack->next) {
+			for (i2 = 0; i2 < stack->depth; i2++) {
+				fputs(prfframe(&points[stack->points[i2]], work), file);
+				fputc((i2 + 1 < stack->depth) ? ';' : ' ', file);
+			}
+			fprintf(file, "%llu\n", (unsigned long long) stack->samples);
+		}
+	}
+	fclose(file);
+}
+
+/* frame name is module[:routine][:line], the line of the call for outer frames */
+static CHAR *prfframe(PRFPOINT *point, CHAR *work)
+{
+	INT i1, i2;
+
+	/* snprintf returns the length it wanted, keep i1 at the bytes actually written */
+	i1 = snprintf(work, 200, "%s", prfstr(point->modname));
+	if (i1 > 199) i1 = 199;
+	if (point->rtnname != -1) {
+		i2 = snprintf(work + i1, 60, ":%s", names[point->rtnname]);
+		i1 += (i2 > 59) ? 59 : i2;
+	}
+	if (point->line) snprintf(work + i1, 30, ":%d", point->line);
+	return work;
+}
+
+/* sort by time, then count, descending */
+static INT prfcompare(const void *p1, const void *p2)
+{
+	const PRFLINE *line1 = (const PRFLINE *) p1, *line2 = (const PRFLINE *) p2;
+
+	if (line1->time != line2->time) return (line1->time < line2->time) ? 1 : -1;
+	if (line1->count != line2->count) return (line1->count < line2->count) ? 1 : -1;
+	return 0;
+}
+
+/* sort by module, source and line */
+static INT prflinecompare(const void *p1, const void *p2)
+{
+	const PRFPOINT *point1 = &points[((const PRFLINE *) p1)->index];
+	const PRFPOINT *point2 = &points[((const PRFLINE *) p2)->index];
+
+	if (point1->mod != point2->mod) return (point1->mod < point2->mod) ? -1 : 1;
+	if (point1->srcname != point2->srcname) return (point1->srcname < point2->srcname) ? -1 : 1;
+	if (point1->line != point2->line) return (point1->line < point2->line) ? -1 : 1;
+	return (point1->pcnt < point2->pcnt) ? -1 : (point1->pcnt > point2->pcnt);
+}
@@ -46,6 +46,7 @@
 #define TYPE_CREATE     3
 #define TYPE_ALTER      4
 #define TYPE_DROP       5
+#define TYPE_INSERT		6
 
 /* note: access to workbuffer must be protected with entersync/exitsync */
 extern CHAR workbuffer[65536];
@@ -153,6 +154,11 @@ static COLUMNS tables[] = {
 };
 
 static SQLRETURN fixupexec(STATEMENT *, ERRORS *, UCHAR **, INT *, INT);
+static INT execprepared(STATEMENT *, UCHAR *, INT, INT, INT *);
+static INT execload(STATEMENT *, INT *);
+static INT paramrow(STATEMENT *, SQLULEN, INT *);
+static SQLLEN paramsize(APP_DESC_RECORD *, IMP_PARAM_DESC_RECORD *);
+static SQLRETURN paramvalue(ERRORS *, APP_DESC_RECORD *, IMP_PARAM_DESC_RECORD *, CHAR *, CHAR **, SQLLEN *, INT *);
 static int nextword(char *, int, int *, int *);
 static int findword(char *, int, char *, int, int *);
 static void asctocnum(char *, int, int, SQL_NUMERIC_STRUCT *);
@@ -169,6 +175,7 @@ SQLRETURN exec_prepare(STATEMENT *stmt, SQLCHAR *text, SQLINTEGER length)
 	INT i1, size;
 	CHAR *ptr;
 
+	exec_unprepare(stmt);
 	/*** CODE: MAYBE VERIFY THERE ARE MATCHING '\'' AND GIVE 42000 IF NOT (THIS IS BEING DONE IN EXECUTE()) ***/
 	while (length > 0 && isspace(text[length - 1])) length--;
 	if (length >= stmt->textsize) {
@@ -223,7 +230,7 @@ SQLRETURN exec_prepare(STATEMENT *stmt, SQLCHAR *text, SQLINTEGER length)
  */
 SQLRETURN exec_execute(STATEMENT *stmt)
 {
-	INT i1, i2, i3, i4, len, reslen, savepos, type;
+	INT i1, i2, i3, i4, len, prepflag, reslen, savepos, type;
 	SQLRETURN rc, rc2;
 	CHAR errmsg[512], *cmdptr, *rsidptr;
 	UCHAR *text;
@@ -311,7 +318,10 @@ SQLRETURN exec_execute(STATEMENT *stmt)
 #endif
 	text = stmt->text;
 	len = stmt->textlength;
-	if (fixupexec(stmt, &stmt->errors, &text, &len, TRUE) == SQL_ERROR) {
+	/* a prepared statement with parameters is prepared on the server and the values are sent apart from the text */
+	prepflag = (stmt->executeflags & EXECUTE_PREPARED) && stmt->serverstmt >= 0 && stmt->sql_attr_app_param_desc->sql_desc_count &&
+		SERVER_PREPARE(stmt->cnct) && !findword("CURRENT", 7, (char*)text, len, &i1);
+	if (fixupexec(stmt, &stmt->errors, &text, &len, !prepflag) == SQL_ERROR) {
 		exitsync();
 		return SQL_ERROR;
 	}
@@ -334,6 +344,7 @@ SQLRETURN exec_execute(STATEMENT *stmt)
 		}
 		else if (!_memicmp((const void *)&text[i1], "DELETE", 6)) type = TYPE_DELETE;
 		else if (!_memicmp((const void *)&text[i1], "CREATE", 6)) type = TYPE_CREATE;
+		else if (!_memicmp((const void *)&text[i1], "INSERT", 6)) type = TYPE_INSERT;
 		else type = TYPE_OTHER;
 		if (type == TYPE_UPDATE || type == TYPE_DELETE) {  /* check for "where current of" */
 			i3 = i1 + 6;
@@ -410,8 +421,20 @@ SQLRETURN exec_execute(STATEMENT *stmt)
 
 	rc2 = SQL_SUCCESS;
 	reslen = sizeof(workbuffer);
-	rc = server_communicate(stmt2->cnct, (UCHAR*)rsidptr, (UCHAR*)cmdptr,
-		text, len, &stmt->errors, (UCHAR*)workbuffer, &reslen);
+	rc = (prepflag) ? execprepared(stmt, text, len, type == TYPE_INSERT, &reslen) : 0;
+	if (!rc) {
+		if (prepflag) {  /* server can not prepare it, put the values in the text */
+			text = stmt->text;
+			len = stmt->textlength;
+			if (fixupexec(stmt, &stmt->errors, &text, &len, TRUE) == SQL_ERROR) {
+				exitsync();
+				return SQL_ERROR;
+			}
+			reslen = sizeof(workbuffer);
+		}
+		rc = server_communicate(stmt2->cnct, (UCHAR*)rsidptr, (UCHAR*)cmdptr,
+			text, len, &stmt->errors, (UCHAR*)workbuffer, &reslen);
+	}
 	switch(rc) {
 	case SERVER_OKTRUNC:
 		error_record(&stmt->errors, "01004", TEXT_01004, "Numeric or character truncation", 0);
@@ -452,6 +475,21 @@ SQLRETURN exec_execute(STATEMENT *stmt)
 	return rc2;
 }
 
+/**
+ * Free the statement prepared on the server for the text
+ * Called with entersync active
+ */
+void exec_unprepare(STATEMENT *stmt)
+{
+	CHAR stmtid[32];
+
+	if (stmt->serverstmt > 0) {
+		snprintf(stmtid, sizeof(stmtid), "%*d", FIELD_LENGTH, stmt->serverstmt);
+		server_communicate(stmt->cnct, (UCHAR*)stmtid, (UCHAR*)FREESTMT, NULL, 0, NULL, NULL, NULL);
+	}
+	stmt->serverstmt = 0;
+}
+
 /**
  * Protects itself with enter/exit sync
  */
@@ -550,6 +588,7 @@ SQLRETURN exec_resultset(STATEMENT *stmt, ERRORS *errors, CHAR *buffer, INT len,
 	stmt->row_count = nrows;
 	stmt->lastcolumn = -1;
 	stmt->sql_attr_row_number = stmt->row_number = 0;
+	stmt->rowset_rows = 0;
 
 	/* parse numcols */
 	while (i1 < len && buffer[i1] == ' ') i1++;
@@ -1318,11 +1357,11 @@ SQLRETURN exec_sqltoc(
 /***       bind_type if driver only supports one row at a time.  Any changes need ***/\
 /***       to be carried down below ***/
 		if (crownum) {
-			if (!crowsize) crowsize = sizeof(SQLINTEGER);
+			if (!crowsize) crowsize = sizeof(SQLLEN);
 			coffset += crownum * crowsize;
 		}
 		if (coffset) {
-			cnullind = cnullind + coffset;
+			cnullind = (SQLLEN *) ((CHAR *) cnullind + coffset);
 #if OS_WIN32
 			if (IsBadWritePtr(cnullind, sizeof(SQLINTEGER))) {
 				error_record(&stmt->errors, "HY000", TEXT_HY000, "invalid indicator offset", 0);
@@ -1519,10 +1558,10 @@ SQLRETURN exec_sqltoc(
 		if (crownum || coffset) {
 			if (crownum) {
 				if (!crowsize) {
-					if (type == SQL_C_CHAR) cbuffer = (CHAR *) cbuffer + cbuflen;
-					else cbuffer = (CHAR*) cbuffer + sqllen;
+					if (type == SQL_C_CHAR) cbuffer = (CHAR *) cbuffer + crownum * cbuflen;
+					else cbuffer = (CHAR*) cbuffer + crownum * sqllen;
 				}
-				else cbuffer = (CHAR *) cbuffer + crowsize;
+				else cbuffer = (CHAR *) cbuffer + crownum * crowsize;
 			}
 			cbuffer = (CHAR *) cbuffer + coffset;
 #if OS_WIN32
@@ -1546,12 +1585,12 @@ SQLRETURN exec_sqltoc(
 		else memcpy(cbuffer, &ctype, sqllen);
 	}
 	if (crownum) {
-		if (!crowsize) crowsize = sizeof(SQLINTEGER);
+		if (!crowsize) crowsize = sizeof(SQLLEN);
 		coffset += crownum * crowsize;
 	}
 	if (cnullind != NULL && cnullind != cdatalen) {
 		if (coffset) {
-			cnullind = (SQLLEN *) (CHAR *) cnullind + coffset;
+			cnullind = (SQLLEN *) ((CHAR *) cnullind + coffset);
 #if OS_WIN32
 			if (IsBadWritePtr(cnullind, sizeof(SQLINTEGER))) {
 				error_record(&stmt->errors, "HY000", TEXT_HY000, "invalid indicator offset", 0);
@@ -1565,7 +1604,7 @@ SQLRETURN exec_sqltoc(
 	}
 	if (cdatalen != NULL) {
 		if (coffset) {
-			cdatalen = (SQLLEN *) (CHAR *) cdatalen + coffset;
+			cdatalen = (SQLLEN *) ((CHAR *) cdatalen + coffset);
 #if OS_WIN32
 			if (IsBadWritePtr(cdatalen, sizeof(SQLINTEGER))) {
 				error_record(&stmt->errors, "HY000", TEXT_HY000, "invalid length offset", 0);
@@ -1580,6 +1619,250 @@ SQLRETURN exec_sqltoc(
 	return rc;
 }
 
+/**
+ * Execute the statement as a statement prepared on the server, sending the
+ * parameter values apart from the text. The text with the parameter markers
+ * is prepared the first time.
+ * An INSERT with an array of parameters (SQL_ATTR_PARAMSET_SIZE > 1) is sent with LOAD,
+ * other statements use the first row of parameter values.
+ * Return 0 if the server can not prepare the statement, else same as server_communicate
+ * This uses the global field workbuffer and must be called inside a thread-safe region.
+ */
+static INT execprepared(STATEMENT *stmt, UCHAR *text, INT len, INT insertflag, INT *reslen)
+{
+	INT i1, i2, rc, worklen;
+	CHAR work[64], stmtid[32];
+	UCHAR errmsg[MAX_ERROR_MSG];
+
+	if (!stmt->serverstmt) {
+		/* reply is "<statement id> <number of parameter markers>" */
+		i1 = sizeof(work);
+		rc = server_communicate(stmt->cnct, (UCHAR*)EMPTY, (UCHAR*)PREPARE, text, len, NULL, (UCHAR*)work, &i1);
+		stmt->serverstmt = -1;
+		if (rc != SERVER_OK) return 0;
+		for (i2 = 0; i2 < i1 && work[i2] == ' '; i2++);
+		for (stmt->serverstmt = 0; i2 < i1 && isdigit(work[i2]); i2++) stmt->serverstmt = stmt->serverstmt * 10 + work[i2] - '0';
+		while (i2 < i1 && work[i2] == ' ') i2++;
+		for (stmt->serverparams = 0; i2 < i1 && isdigit(work[i2]); i2++) stmt->serverparams = stmt->serverparams * 10 + work[i2] - '0';
+		if (stmt->serverstmt <= 0 || !stmt->serverparams) {  /* nothing to bind, execute the text */
+			exec_unprepare(stmt);
+			stmt->serverstmt = -1;
+			return 0;
+		}
+	}
+	if (stmt->serverparams > stmt->sql_attr_app_param_desc->sql_desc_count) {  /* too few dynamic parameters have been bound */
+		sprintf((char*)errmsg, "%s, too few bound parameters", TEXT_07002);
+		error_record(&stmt->errors, "07002", (char*)errmsg, NULL, 0);
+		return SERVER_FAIL;
+	}
+	if (insertflag && stmt->sql_attr_app_param_desc->sql_desc_array_size > 1) return execload(stmt, reslen);
+
+	worklen = 0;
+	rc = paramrow(stmt, 0, &worklen);
+	if (rc < 0) return SERVER_FAIL;
+	if (rc > 0) {
+		error_record(&stmt->errors, "HY000", TEXT_HY000, "parameter values are too long", 0);
+		return SERVER_FAIL;
+	}
+	snprintf(stmtid, sizeof(stmtid), "%*d", FIELD_LENGTH, stmt->serverstmt);
+	return server_communicate(stmt->cnct, (UCHAR*)stmtid, (UCHAR*)EXECPREP,
+		(UCHAR*)workbuffer, worklen, &stmt->errors, (UCHAR*)workbuffer, reslen);
+}
+
+/**
+ * Insert the rows of an array of parameters with LOAD, one row of values on each line.
+ * Each LOAD has as many rows as fit in workbuffer. Rows with SQL_PARAM_IGNORE in the
+ * operation array are not sent. The parameter status array and the number of rows
+ * processed are set if the application has bound them.
+ * If the server fails, its message starts with the number of rows it inserted before
+ * the error; the rows sent with earlier messages are added to it.
+ * Return same as server_communicate, with the total number of rows inserted in workbuffer
+ * This uses the global field workbuffer and must be called inside a thread-safe region.
+ */
+static INT execload(STATEMENT *stmt, INT *reslen)
+{
+	INT i1, count, linelen, rc, rc2, total, worklen;
+	SQLULEN first, processed, row, rows;
+	CHAR work[64], stmtid[32], *ptr;
+	SQLUSMALLINT *operation, *status;
+	ERRORINFO *errinfo;
+
+	rows = stmt->sql_attr_app_param_desc->sql_desc_array_size;
+	operation = stmt->sql_attr_app_param_desc->sql_desc_array_status_ptr;
+	status = stmt->sql_attr_imp_param_desc->sql_desc_array_status_ptr;
+	if (status != NULL) for (row = 0; row < rows; row++) status[row] = SQL_PARAM_UNUSED;
+	snprintf(stmtid, sizeof(stmtid), "%*d", FIELD_LENGTH, stmt->serverstmt);
+	rc2 = SERVER_OK;
+	total = 0;
+	processed = 0;
+	for (row = 0; row < rows; ) {
+		for (first = row, worklen = 0; row < rows; row++) {
+			if (operation != NULL && operation[row] == SQL_PARAM_IGNORE) continue;
+			linelen = worklen;
+			rc = paramrow(stmt, row, &linelen);
+			if (rc == 0 && linelen >= (INT) sizeof(workbuffer)) rc = 1;
+			if (rc > 0 && worklen) break;  /* send the rows before this one */
+			if (rc) {
+				if (rc > 0) error_record(&stmt->errors, "HY000", TEXT_HY000, "parameter values are too long", 0);
+				if (status != NULL) status[row] = SQL_PARAM_ERROR;
+				processed = row + 1;
+				rc2 = SERVER_FAIL;
+				break;
+			}
+			workbuffer[linelen++] = '\n';
+			worklen = linelen;
+		}
+		if (!worklen) break;
+		i1 = sizeof(work);
+		rc = server_communicate(stmt->cnct, (UCHAR*)stmtid, (UCHAR*)LOAD,
+			(UCHAR*)workbuffer, worklen, &stmt->errors, (UCHAR*)work, &i1);
+		if (processed < row) processed = row;
+		if (rc == SERVER_OK || rc == SERVER_OKTRUNC) {
+			total += char_to_int32(work, i1);
+			if (rc == SERVER_OKTRUNC && rc2 == SERVER_OK) rc2 = SERVER_OKTRUNC;
+			count = -1;
+		}
+		else if (rc == SERVER_FAIL && stmt->errors.numerrors) {
+			/* message is "<n> rows inserted: <error>" */
+			errinfo = &stmt->errors.errorinfo[stmt->errors.numerrors - 1];
+			for (count = 0, ptr = (CHAR *) errinfo->text; isdigit(*ptr); ptr++) count = count * 10 + *ptr - '0';
+			if (total && ptr != (CHAR *) errinfo->text) {
+				snprintf(work, sizeof(work), "%d", total + count);
+				i1 = (INT) strlen(work);
+				if (strlen((CHAR *) errinfo->text) + i1 - (ptr - (CHAR *) errinfo->text) < sizeof(errinfo->text)) {
+					memmove(errinfo->text + i1, ptr, strlen(ptr) + 1);
+					memcpy(errinfo->text, work, i1);
+				}
+			}
+			total += count;
+		}
+		else count = 0;
+		if (status != NULL) {
+			for (i1 = 0; first < row; first++) {
+				if (operation != NULL && operation[first] == SQL_PARAM_IGNORE) continue;
+				if (count < 0) status[first] = (rc == SERVER_OKTRUNC) ? SQL_PARAM_SUCCESS_WITH_INFO : SQL_PARAM_SUCCESS;
+				else if (i1++ < count) status[first] = SQL_PARAM_SUCCESS;
+				else status[first] = SQL_PARAM_DIAG_UNAVAILABLE;
+			}
+		}
+		if (count >= 0) {
+			rc2 = rc;
+			break;
+		}
+		if (rc2 == SERVER_FAIL) break;
+	}
+	if (stmt->sql_attr_imp_param_desc->sql_desc_rows_processed_ptr != NULL)
+		*stmt->sql_attr_imp_param_desc->sql_desc_rows_processed_ptr = (SQLUINTEGER) processed;
+	stmt->errors.rowcount = stmt->row_count = total;
+	*reslen = sprintf(workbuffer, "%d", total);
+	return rc2;
+}
+
+/**
+ * Put the parameter values of a row of the parameter array (0 for the first) at workbuffer + *worklenp.
+ * The values are separated by blanks and quoted, a quote or backslash in a value is escaped with a backslash.
+ * The value of a row is located as for a bound column in exec_sqltoc.
+ * Return 0 with *worklenp updated, 1 if the values do not fit in workbuffer, -1 if error
+ * This uses the global field workbuffer and must be called inside a thread-safe region.
+ */
+static INT paramrow(STATEMENT *stmt, SQLULEN row, INT *worklenp)
+{
+	INT i1, param, scanflag, sqltype, worklen;
+	SQLLEN parmlen, size;
+	SQLULEN offset;
+	CHAR work[64], *ptr;
+	APP_DESC_RECORD *apd_rec, rowrec;
+	IMP_PARAM_DESC_RECORD *ipd_rec;
+	DESCRIPTOR *apd;
+
+	apd = stmt->sql_attr_app_param_desc;
+	scanflag = (stmt->sql_attr_noscan == SQL_NOSCAN_OFF);
+	apd_rec = apd->firstrecord.appdrec;
+	ipd_rec = stmt->sql_attr_imp_param_desc->firstrecord.ipdrec;
+	worklen = *worklenp;
+	for (param = 1; param <= stmt->serverparams; param++) {
+		if (param > 1) {
+			apd_rec = apd_rec->nextrecord;
+			ipd_rec = ipd_rec->nextrecord;
+			if (worklen >= (INT) sizeof(workbuffer)) return 1;
+			workbuffer[worklen++] = ' ';
+		}
+		if (row || apd->sql_desc_bind_offset_ptr != NULL) {
+			rowrec = *apd_rec;
+			offset = (apd->sql_desc_bind_offset_ptr != NULL) ? *apd->sql_desc_bind_offset_ptr : 0;
+			if (apd->sql_desc_bind_type != SQL_PARAM_BIND_BY_COLUMN) {
+				offset += row * apd->sql_desc_bind_type;
+				if (rowrec.sql_desc_data_ptr != NULL) rowrec.sql_desc_data_ptr = (CHAR *) rowrec.sql_desc_data_ptr + offset;
+				if (rowrec.sql_desc_octet_length_ptr != NULL) rowrec.sql_desc_octet_length_ptr = (SQLLEN *) ((CHAR *) rowrec.sql_desc_octet_length_ptr + offset);
+			}
+			else {
+				size = paramsize(apd_rec, ipd_rec);
+				if (rowrec.sql_desc_data_ptr != NULL) rowrec.sql_desc_data_ptr = (CHAR *) rowrec.sql_desc_data_ptr + offset + row * size;
+				if (rowrec.sql_desc_octet_length_ptr != NULL) rowrec.sql_desc_octet_length_ptr = (SQLLEN *) ((CHAR *) (rowrec.sql_desc_octet_length_ptr + row) + offset);
+			}
+			if (row && rowrec.sql_desc_octet_length_ptr != NULL && (*rowrec.sql_desc_octet_length_ptr == SQL_DATA_AT_EXEC ||
+				*rowrec.sql_desc_octet_length_ptr <= SQL_LEN_DATA_AT_EXEC_OFFSET)) {
+				error_record(&stmt->errors, "HYC00", TEXT_HYC00, "data at execution is not supported with an array of parameters", 0);
+				return -1;
+			}
+			apd_rec = &rowrec;
+		}
+		if (paramvalue(&stmt->errors, apd_rec, ipd_rec, work, &ptr, &parmlen, &sqltype) == SQL_ERROR) return -1;
+		if (sqltype == SQL_TYPE_TIMESTAMP || sqltype == SQL_TYPE_TIME || sqltype == SQL_TYPE_DATE) {
+			/* check for escape clause in parameter, send only the literal */
+			if (scanflag && parmlen > 4 && *ptr == '{' && *(ptr + (parmlen - 1)) == '}' && (*(ptr + 1) == 'd' || *(ptr + 1) == 't')) {
+				i1 = (*(ptr + 1) == 't' && *(ptr + 2) == 's') ? 4 : 3;
+				ptr += i1;
+				parmlen -= i1 + 1;
+				while (parmlen && *ptr == ' ') {
+					ptr++;
+					parmlen--;
+				}
+				if (parmlen >= 2 && *ptr == '\'' && *(ptr + (parmlen - 1)) == '\'') {
+					ptr++;
+					parmlen -= 2;
+				}
+			}
+		}
+		/* room for the quotes and an escape for every character */
+		if (worklen + 2 * parmlen + 2 > (SQLLEN) sizeof(workbuffer)) return 1;
+		workbuffer[worklen++] = '"';
+		while (parmlen-- > 0) {
+			if (*ptr == '"' || *ptr == '\\') workbuffer[worklen++] = '\\';
+			workbuffer[worklen++] = *ptr++;
+		}
+		workbuffer[worklen++] = '"';
+	}
+	*worklenp = worklen;
+	return 0;
+}
+
+/**
+ * Return the size of one element of a parameter bound by column for an array of parameters
+ */
+static SQLLEN paramsize(APP_DESC_RECORD *apd_rec, IMP_PARAM_DESC_RECORD *ipd_rec)
+{
+	INT type;
+
+	type = apd_rec->sql_desc_concise_type;
+	if (type == SQL_C_DEFAULT) {
+		if (ipd_rec->sql_desc_concise_type == SQL_TYPE_DATE) type = SQL_C_TYPE_DATE;
+		else if (ipd_rec->sql_desc_concise_type == SQL_TYPE_TIME) type = SQL_C_TYPE_TIME;
+		else if (ipd_rec->sql_desc_concise_type == SQL_TYPE_TIMESTAMP) type = SQL_C_TYPE_TIMESTAMP;
+		else type = SQL_C_CHAR;
+	}
+	if (type == SQL_C_LONG || type == SQL_C_SLONG || type == SQL_C_ULONG) return sizeof(SQLINTEGER);
+	if (type == SQL_C_SHORT || type == SQL_C_SSHORT || type == SQL_C_USHORT) return sizeof(SQLSMALLINT);
+	if (type == SQL_C_TINYINT || type == SQL_C_STINYINT || type == SQL_C_UTINYINT) return sizeof(SQLSCHAR);
+	if (type == SQL_C_DOUBLE) return sizeof(SQLDOUBLE);
+	if (type == SQL_C_FLOAT) return sizeof(SQLREAL);
+	if (type == SQL_C_NUMERIC) return sizeof(SQL_NUMERIC_STRUCT);
+	if (type == SQL_C_TYPE_DATE) return sizeof(SQL_DATE_STRUCT);
+	if (type == SQL_C_TYPE_TIME) return sizeof(SQL_TIME_STRUCT);
+	if (type == SQL_C_TYPE_TIMESTAMP) return sizeof(SQL_TIMESTAMP_STRUCT);
+	return apd_rec->sql_desc_octet_length;
+}
+
 /**
  * This uses the global field workbuffer and must be called inside a thread-safe region.
  */
@@ -1591,14 +1874,11 @@ static SQLRETURN fixupexec(STATEMENT *stmt, ERRORS *errors, UCHAR **textp, INT *
 #define ESCAPE_ESCAPE		4
 #define ESCAPE_TIME			5
 #define ESCAPE_TIMESTAMP	6
-	INT i1, i2, esccnt, len, param, scanflag, sqltype, type;
+	INT i1, i2, esccnt, len, param, scanflag, sqltype;
 	SQLLEN parmlen, worklen, pos, mark;
 	CHAR work[64], *ptr;
 	UCHAR *text;
 	UCHAR errmsg[MAX_ERROR_MSG];
-	SQL_DATE_STRUCT *sqldate;
-	SQL_TIME_STRUCT *sqltime;
-	SQL_TIMESTAMP_STRUCT *sqltimestamp;
 	APP_DESC_RECORD *apd_rec;
 	IMP_PARAM_DESC_RECORD *ipd_rec;
 	struct {
@@ -1649,120 +1929,8 @@ static SQLRETURN fixupexec(STATEMENT *stmt, ERRORS *errors, UCHAR **textp, INT *
 				apd_rec = apd_rec->nextrecord;
 				ipd_rec = ipd_rec->nextrecord;
 			}
-			type = apd_rec->sql_desc_concise_type;
-			if (type == SQL_C_DEFAULT) {
-				if (ipd_rec->sql_desc_concise_type == SQL_TYPE_DATE) type = SQL_C_TYPE_DATE;
-				else if (ipd_rec->sql_desc_concise_type == SQL_TYPE_TIME) type = SQL_C_TYPE_TIME;
-				else if (ipd_rec->sql_desc_concise_type == SQL_TYPE_TIMESTAMP) type = SQL_C_TYPE_TIMESTAMP;
-				else type = SQL_C_CHAR;
-			}
-			if (type == SQL_C_CHAR) {
-				sqltype = SQL_CHAR;
-				ptr = (CHAR *) apd_rec->sql_desc_data_ptr;
-				if (apd_rec->sql_desc_octet_length_ptr == NULL || *apd_rec->sql_desc_octet_length_ptr == SQL_NTS)
-					parmlen = (INT)strlen((CHAR *) apd_rec->sql_desc_data_ptr);
-				else if (*apd_rec->sql_desc_octet_length_ptr == SQL_NULL_DATA) parmlen = 0;
-				else if (*apd_rec->sql_desc_octet_length_ptr >= 0) parmlen = *apd_rec->sql_desc_octet_length_ptr;
-				else {
-					ptr = (CHAR*)apd_rec->dataatexecptr;
-					parmlen = apd_rec->dataatexeclength;
-				}
-			}
-			else {
-				if (apd_rec->sql_desc_octet_length_ptr != NULL && (*apd_rec->sql_desc_octet_length_ptr == SQL_NULL_DATA ||
-					*apd_rec->sql_desc_octet_length_ptr == SQL_DATA_AT_EXEC || *apd_rec->sql_desc_octet_length_ptr <= SQL_LEN_DATA_AT_EXEC_OFFSET)) {
-					if (*apd_rec->sql_desc_octet_length_ptr != SQL_NULL_DATA) {
-						ptr = (CHAR*)apd_rec->dataatexecptr;
-						parmlen = apd_rec->dataatexeclength;
-					}
-					else parmlen = 0;
-				}
-				else {
-					ptr = (CHAR *) apd_rec->sql_desc_data_ptr;
-					parmlen = 1;  /* set to any non-zero value */
-				}
-				sqltype = SQL_NUMERIC;
-				if (parmlen) {
-					if (type == SQL_C_LONG || type == SQL_C_SLONG)
-						_ltoa(*(SQLINTEGER *) ptr, work, 10);
-					else if (type == SQL_C_ULONG)
-						_ltoa(*(SQLUINTEGER *) ptr, work, 10);
-					else if (type == SQL_C_SHORT || type == SQL_C_SSHORT)
-						_itoa(*(SQLSMALLINT *) ptr, work, 10);
-					else if (type == SQL_C_USHORT)
-						_itoa(*(SQLUSMALLINT *) ptr, work, 10);
-					else if (type == SQL_C_TINYINT || type == SQL_C_STINYINT)
-						_itoa(*(SQLSCHAR *) ptr, work, 10);
-					else if (type == SQL_C_UTINYINT)
-						_itoa(*(SQLCHAR *) ptr, work, 10);
-					else if (type == SQL_C_DOUBLE)
-						sprintf(work, "%.*f", ipd_rec->sql_desc_scale, *(SQLDOUBLE *) ptr);
-					else if (type == SQL_C_FLOAT)
-						sprintf(work, "%.*f", ipd_rec->sql_desc_scale, (double)(*((SQLREAL *) ptr)));
-					else if (type == SQL_C_NUMERIC)
-						cnumtoasc((SQL_NUMERIC_STRUCT *) ptr, apd_rec->sql_desc_precision, apd_rec->sql_desc_scale, work);
-					else if (type == SQL_C_TYPE_DATE) {
-						sqltype = SQL_TYPE_DATE;
-						sqldate = (SQL_DATE_STRUCT *) ptr;
-						i1 = sqldate->year;
-						for (i1 = 4, i2 = sqldate->year; i1 > 0; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
-						for (i1 = 7, i2 = sqldate->month; i1 > 5; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
-						for (i1 = 10, i2 = sqldate->day; i1 > 8; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
-						work[4] = work[7] = '-';
-						work[10] = '\0';
-					}
-					else if (type == SQL_C_TYPE_TIME) {
-						sqltype = SQL_TYPE_TIME;
-						sqltime = (SQL_TIME_STRUCT *) ptr;
-						for (i1 = 2, i2 = sqltime->hour; i1 > 0; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
-						for (i1 = 5, i2 = sqltime->minute; i1 > 3; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
-						for (i1 = 8, i2 = sqltime->second; i1 > 6; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
-						work[2] = work[5] = ':';
-						work[8] = '\0';
-					}
-					else if (type == SQL_C_TYPE_TIMESTAMP) {
-						sqltype = SQL_TYPE_TIMESTAMP;
-						sqltimestamp = (SQL_TIMESTAMP_STRUCT *) ptr;
-						for (i1 = 4, i2 = sqltimestamp->year; i1 > 0; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
-						for (i1 = 7, i2 = sqltimestamp->month; i1 > 5; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
-						for (i1 = 10, i2 = sqltimestamp->day; i1 > 8; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
-						for (i1 = 13, i2 = sqltimestamp->hour; i1 > 11; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
-						for (i1 = 16, i2 = sqltimestamp->minute; i1 > 14; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
-						for (i1 = 19, i2 = sqltimestamp->second; i1 > 17; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
-						/*** MS docs say that FRACTION is REPRESENTED by Billionths ***/
-						for (i1 = TIMESTAMP_LENGTH, i2 = sqltimestamp->fraction/1000000; i1 > 20; i2 /= 10)
-							work[--i1] = (char)(i2 % 10 + '0');
-						work[4] = work[7] = '-';
-						work[10] = ' ';
-						work[13] = work[16] = ':';
-						work[19] = '.';
-						work[TIMESTAMP_LENGTH] = '\0';
-					}
-					else {
-						sprintf((char*)errmsg, "%s: Binding parameters: Unexpected C data type: %d", TEXT_HY003, (int) apd_rec->sql_desc_concise_type);
-						error_record(errors, "HY003", (char*)errmsg, NULL, 0);
-						return SQL_ERROR;
-					}
-					ptr = work;
-					parmlen = (INT)strlen(work);
-				}
-				else if (type == SQL_C_TYPE_DATE) sqltype = SQL_TYPE_DATE;
-				else if (type == SQL_C_TYPE_TIME) sqltype = SQL_TYPE_TIME;
-				else if (type == SQL_C_TYPE_TIMESTAMP) sqltype = SQL_TYPE_TIMESTAMP;
-			}
-
+			if (paramvalue(errors, apd_rec, ipd_rec, work, &ptr, &parmlen, &sqltype) == SQL_ERROR) return SQL_ERROR;
 			if (ipd_rec->sql_desc_concise_type == SQL_NUMERIC || ipd_rec->sql_desc_concise_type == SQL_DECIMAL) {
-				if (sqltype != SQL_NUMERIC) {
-					if (sqltype == SQL_CHAR) {
-/*** CODE: VERIFY STRING TO BE VALID NUMERIC ***/
-						sqltype = SQL_NUMERIC;
-					}
-					if (sqltype != SQL_NUMERIC) {
-						sprintf((char*)errmsg, "%s: Binding parameters: Unable to convert C type %d to SQL type %d", TEXT_HYC00, type, (int) ipd_rec->sql_desc_concise_type);
-						error_record(errors, "HYC00", (char*)errmsg, NULL, 0);
-						return SQL_ERROR;
-					}
-				}
 				if (parmlen) {
 					memcpy(&workbuffer[worklen], ptr, parmlen);
 					worklen += parmlen;
@@ -1773,76 +1941,6 @@ static SQLRETURN fixupexec(STATEMENT *stmt, ERRORS *errors, UCHAR **textp, INT *
 				}
 			}
 			else {
-				if (ipd_rec->sql_desc_concise_type == SQL_TYPE_DATE) {
-					if (sqltype != SQL_TYPE_DATE) {
-						if (sqltype == SQL_CHAR) {
-/*** CODE: VERIFY STRING TO BE A VALID DATE / TIMESTAMP ***/
-							sqltype = SQL_TYPE_DATE;
-						}
-						if (sqltype == SQL_TYPE_TIMESTAMP) {
-							if (parmlen) parmlen = 10;  /* truncate timestamp */
-							sqltype = SQL_TYPE_DATE;
-						}
-						if (sqltype != SQL_TYPE_DATE) {
-							sprintf((char*)errmsg, "%s: Binding parameters: Unable to convert C type %d to SQL type %d", TEXT_HYC00, type, (int) ipd_rec->sql_desc_concise_type);
-							error_record(errors, "HYC00", (char*)errmsg, NULL, 0);
-							return SQL_ERROR;
-						}
-					}
-				}
-				else if (ipd_rec->sql_desc_concise_type == SQL_TYPE_TIME) {
-					if (sqltype != SQL_TYPE_TIME) {
-						if (sqltype == SQL_CHAR) {
-/*** CODE: VERIFY STRING TO BE A VALID TIME / TIMESTAMP ***/
-							sqltype = SQL_TYPE_TIME;
-						}
-						if (sqltype == SQL_TYPE_TIMESTAMP) {
-							if (parmlen) {  /* move time portion */
-								memmove(work, work + 11, TIMESTAMP_LENGTH - 11);
-								parmlen = TIMESTAMP_LENGTH - 11;
-							}
-							sqltype = SQL_TYPE_TIME;
-						}
-						if (sqltype != SQL_TYPE_TIME) {
-							sprintf((char*)errmsg, "%s: Binding parameters: Unable to convert C type %d to SQL type %d", TEXT_HYC00, type, (int) ipd_rec->sql_desc_concise_type);
-							error_record(errors, "HYC00", (char*)errmsg, NULL, 0);
-							return SQL_ERROR;
-						}
-					}
-				}
-				else if (ipd_rec->sql_desc_concise_type == SQL_TYPE_TIMESTAMP) {
-					if (sqltype != SQL_TYPE_TIMESTAMP) {
-						if (sqltype == SQL_CHAR) {
-/*** CODE: VERIFY STRING TO BE A VALID DATE / TIME / TIMESTAMP ***/
-							sqltype = SQL_TYPE_TIMESTAMP;
-						}
-						if (sqltype == SQL_TYPE_DATE) {
-							if (parmlen) {  /* append zero time */
-								memcpy(work + 10, " 00:00:00", 9);
-								parmlen = 19;
-							}
-							sqltype = SQL_TYPE_TIMESTAMP;
-						}
-						else if (sqltype == SQL_TYPE_TIME) {
-							if (parmlen) {  /* prefix zero date */
-								memmove(work + 11, work, 8);
-								memcpy(work, "0000-00-00 ", 11);
-								parmlen = 19;
-							}
-							sqltype = SQL_TYPE_TIMESTAMP;
-						}
-						if (sqltype != SQL_TYPE_TIMESTAMP) {
-							sprintf((char*)errmsg, "%s: Binding parameters: Unable to convert C type %d to SQL type %d", TEXT_HYC00, type, (int) ipd_rec->sql_desc_concise_type);
-							error_record(errors, "HYC00", (char*)errmsg, NULL, 0);
-							return SQL_ERROR;
-						}
-					}
-				}
-				else if (ipd_rec->sql_desc_concise_type != SQL_CHAR && ipd_rec->sql_desc_concise_type != SQL_VARCHAR && ipd_rec->sql_desc_concise_type != SQL_LONGVARCHAR) {
-					sprintf((char*)errmsg, "%s: Binding parameters: Unsupported SQL data type: %d", TEXT_HY003, (int) ipd_rec->sql_desc_concise_type);
-					error_record(errors, "HY003", (char*)errmsg, NULL, 0);
-					return SQL_ERROR;
-				}
 				if (sqltype == SQL_TYPE_TIMESTAMP || sqltype == SQL_TYPE_TIME || sqltype == SQL_TYPE_DATE) {
 					/* check for escape clause in parameter */
 					if (scanflag && parmlen) {
@@ -1950,6 +2048,213 @@ static SQLRETURN fixupexec(STATEMENT *stmt, ERRORS *errors, UCHAR **textp, INT *
 #undef ESCAPE_TIMESTAMP
 }
 
+/**
+ * Get the value of a bound parameter as text, converted to suit the SQL type of the parameter
+ * work needs room for 64 characters and may be used for the value
+ * Return with *sqltypep = type of the value and *parmlenp = 0 if the value is null
+ */
+static SQLRETURN paramvalue(ERRORS *errors, APP_DESC_RECORD *apd_rec, IMP_PARAM_DESC_RECORD *ipd_rec,
+	CHAR *work, CHAR **ptrp, SQLLEN *parmlenp, INT *sqltypep)
+{
+	INT i1, i2, sqltype, type;
+	SQLLEN parmlen;
+	CHAR *ptr;
+	UCHAR errmsg[MAX_ERROR_MSG];
+	SQL_DATE_STRUCT *sqldate;
+	SQL_TIME_STRUCT *sqltime;
+	SQL_TIMESTAMP_STRUCT *sqltimestamp;
+
+	type = apd_rec->sql_desc_concise_type;
+	if (type == SQL_C_DEFAULT) {
+		if (ipd_rec->sql_desc_concise_type == SQL_TYPE_DATE) type = SQL_C_TYPE_DATE;
+		else if (ipd_rec->sql_desc_concise_type == SQL_TYPE_TIME) type = SQL_C_TYPE_TIME;
+		else if (ipd_rec->sql_desc_concise_type == SQL_TYPE_TIMESTAMP) type = SQL_C_TYPE_TIMESTAMP;
+		else type = SQL_C_CHAR;
+	}
+	if (type == SQL_C_CHAR) {
+		sqltype = SQL_CHAR;
+		ptr = (CHAR *) apd_rec->sql_desc_data_ptr;
+		if (apd_rec->sql_desc_octet_length_ptr == NULL || *apd_rec->sql_desc_octet_length_ptr == SQL_NTS)
+			parmlen = (INT)strlen((CHAR *) apd_rec->sql_desc_data_ptr);
+		else if (*apd_rec->sql_desc_octet_length_ptr == SQL_NULL_DATA) parmlen = 0;
+		else if (*apd_rec->sql_desc_octet_length_ptr >= 0) parmlen = *apd_rec->sql_desc_octet_length_ptr;
+		else {
+			ptr = (CHAR*)apd_rec->dataatexecptr;
+			parmlen = apd_rec->dataatexeclength;
+		}
+	}
+	else {
+		if (apd_rec->sql_desc_octet_length_ptr != NULL && (*apd_rec->sql_desc_octet_length_ptr == SQL_NULL_DATA ||
+			*apd_rec->sql_desc_octet_length_ptr == SQL_DATA_AT_EXEC || *apd_rec->sql_desc_octet_length_ptr <= SQL_LEN_DATA_AT_EXEC_OFFSET)) {
+			if (*apd_rec->sql_desc_octet_length_ptr != SQL_NULL_DATA) {
+				ptr = (CHAR*)apd_rec->dataatexecptr;
+				parmlen = apd_rec->dataatexeclength;
+			}
+			else parmlen = 0;
+		}
+		else {
+			ptr = (CHAR *) apd_rec->sql_desc_data_ptr;
+			parmlen = 1;  /* set to any non-zero value */
+		}
+		sqltype = SQL_NUMERIC;
+		if (parmlen) {
+			if (type == SQL_C_LONG || type == SQL_C_SLONG)
+				_ltoa(*(SQLINTEGER *) ptr, work, 10);
+			else if (type == SQL_C_ULONG)
+				_ltoa(*(SQLUINTEGER *) ptr, work, 10);
+			else if (type == SQL_C_SHORT || type == SQL_C_SSHORT)
+				_itoa(*(SQLSMALLINT *) ptr, work, 10);
+			else if (type == SQL_C_USHORT)
+				_itoa(*(SQLUSMALLINT *) ptr, work, 10);
+			else if (type == SQL_C_TINYINT || type == SQL_C_STINYINT)
+				_itoa(*(SQLSCHAR *) ptr, work, 10);
+			else if (type == SQL_C_UTINYINT)
+				_itoa(*(SQLCHAR *) ptr, work, 10);
+			else if (type == SQL_C_DOUBLE)
+				sprintf(work, "%.*f", ipd_rec->sql_desc_scale, *(SQLDOUBLE *) ptr);
+			else if (type == SQL_C_FLOAT)
+				sprintf(work, "%.*f", ipd_rec->sql_desc_scale, (double)(*((SQLREAL *) ptr)));
+			else if (type == SQL_C_NUMERIC)
+				cnumtoasc((SQL_NUMERIC_STRUCT *) ptr, apd_rec->sql_desc_precision, apd_rec->sql_desc_scale, work);
+			else if (type == SQL_C_TYPE_DATE) {
+				sqltype = SQL_TYPE_DATE;
+				sqldate = (SQL_DATE_STRUCT *) ptr;
+				i1 = sqldate->year;
+				for (i1 = 4, i2 = sqldate->year; i1 > 0; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
+				for (i1 = 7, i2 = sqldate->month; i1 > 5; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
+				for (i1 = 10, i2 = sqldate->day; i1 > 8; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
+				work[4] = work[7] = '-';
+				work[10] = '\0';
+			}
+			else if (type == SQL_C_TYPE_TIME) {
+				sqltype = SQL_TYPE_TIME;
+				sqltime = (SQL_TIME_STRUCT *) ptr;
+				for (i1 = 2, i2 = sqltime->hour; i1 > 0; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
+				for (i1 = 5, i2 = sqltime->minute; i1 > 3; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
+				for (i1 = 8, i2 = sqltime->second; i1 > 6; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
+				work[2] = work[5] = ':';
+				work[8] = '\0';
+			}
+			else if (type == SQL_C_TYPE_TIMESTAMP) {
+				sqltype = SQL_TYPE_TIMESTAMP;
+				sqltimestamp = (SQL_TIMESTAMP_STRUCT *) ptr;
+				for (i1 = 4, i2 = sqltimestamp->year; i1 > 0; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
+				for (i1 = 7, i2 = sqltimestamp->month; i1 > 5; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
+				for (i1 = 10, i2 = sqltimestamp->day; i1 > 8; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
+				for (i1 = 13, i2 = sqltimestamp->hour; i1 > 11; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
+				for (i1 = 16, i2 = sqltimestamp->minute; i1 > 14; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
+				for (i1 = 19, i2 = sqltimestamp->second; i1 > 17; i2 /= 10) work[--i1] = (char)(i2 % 10 + '0');
+				/*** MS docs say that FRACTION is REPRESENTED by Billionths ***/
+				for (i1 = TIMESTAMP_LENGTH, i2 = sqltimestamp->fraction/1000000; i1 > 20; i2 /= 10)
+					work[--i1] = (char)(i2 % 10 + '0');
+				work[4] = work[7] = '-';
+				work[10] = ' ';
+				work[13] = work[16] = ':';
+				work[19] = '.';
+				work[TIMESTAMP_LENGTH] = '\0';
+			}
+			else {
+				sprintf((char*)errmsg, "%s: Binding parameters: Unexpected C data type: %d", TEXT_HY003, (int) apd_rec->sql_desc_concise_type);
+				error_record(errors, "HY003", (char*)errmsg, NULL, 0);
+				return SQL_ERROR;
+			}
+			ptr = work;
+			parmlen = (INT)strlen(work);
+		}
+		else if (type == SQL_C_TYPE_DATE) sqltype = SQL_TYPE_DATE;
+		else if (type == SQL_C_TYPE_TIME) sqltype = SQL_TYPE_TIME;
+		else if (type == SQL_C_TYPE_TIMESTAMP) sqltype = SQL_TYPE_TIMESTAMP;
+	}
+
+	if (ipd_rec->sql_desc_concise_type == SQL_NUMERIC || ipd_rec->sql_desc_concise_type == SQL_DECIMAL) {
+		if (sqltype != SQL_NUMERIC) {
+			if (sqltype == SQL_CHAR) {
+/*** CODE: VERIFY STRING TO BE VALID NUMERIC ***/
+				sqltype = SQL_NUMERIC;
+			}
+			if (sqltype != SQL_NUMERIC) {
+				sprintf((char*)errmsg, "%s: Binding parameters: Unable to convert C type %d to SQL type %d", TEXT_HYC00, type, (int) ipd_rec->sql_desc_concise_type);
+				error_record(errors, "HYC00", (char*)errmsg, NULL, 0);
+				return SQL_ERROR;
+			}
+		}
+	}
+	else if (ipd_rec->sql_desc_concise_type == SQL_TYPE_DATE) {
+		if (sqltype != SQL_TYPE_DATE) {
+			if (sqltype == SQL_CHAR) {
+/*** CODE: VERIFY STRING TO BE A VALID DATE / TIMESTAMP ***/
+				sqltype = SQL_TYPE_DATE;
+			}
+			if (sqltype == SQL_TYPE_TIMESTAMP) {
+				if (parmlen) parmlen = 10;  /* truncate timestamp */
+				sqltype = SQL_TYPE_DATE;
+			}
+			if (sqltype != SQL_TYPE_DATE) {
+				sprintf((char*)errmsg, "%s: Binding parameters: Unable to convert C type %d to SQL type %d", TEXT_HYC00, type, (int) ipd_rec->sql_desc_concise_type);
+				error_record(errors, "HYC00", (char*)errmsg, NULL, 0);
+				return SQL_ERROR;
+			}
+		}
+	}
+	else if (ipd_rec->sql_desc_concise_type == SQL_TYPE_TIME) {
+		if (sqltype != SQL_TYPE_TIME) {
+			if (sqltype == SQL_CHAR) {
+/*** CODE: VERIFY STRING TO BE A VALID TIME / TIMESTAMP ***/
+				sqltype = SQL_TYPE_TIME;
+			}
+			if (sqltype == SQL_TYPE_TIMESTAMP) {
+				if (parmlen) {  /* move time portion */
+					memmove(work, work + 11, TIMESTAMP_LENGTH - 11);
+					parmlen = TIMESTAMP_LENGTH - 11;
+				}
+				sqltype = SQL_TYPE_TIME;
+			}
+			if (sqltype != SQL_TYPE_TIME) {
+				sprintf((char*)errmsg, "%s: Binding parameters: Unable to convert C type %d to SQL type %d", TEXT_HYC00, type, (int) ipd_rec->sql_desc_concise_type);
+				error_record(errors, "HYC00", (char*)errmsg, NULL, 0);
+				return SQL_ERROR;
+			}
+		}
+	}
+	else if (ipd_rec->sql_desc_concise_type == SQL_TYPE_TIMESTAMP) {
+		if (sqltype != SQL_TYPE_TIMESTAMP) {
+			if (sqltype == SQL_CHAR) {
+/*** CODE: VERIFY STRING TO BE A VALID DATE / TIME / TIMESTAMP ***/
+				sqltype = SQL_TYPE_TIMESTAMP;
+			}
+			if (sqltype == SQL_TYPE_DATE) {
+				if (parmlen) {  /* append zero time */
+					memcpy(work + 10, " 00:00:00", 9);
+					parmlen = 19;
+				}
+				sqltype = SQL_TYPE_TIMESTAMP;
+			}
+			else if (sqltype == SQL_TYPE_TIME) {
+				if (parmlen) {  /* prefix zero date */
+					memmove(work + 11, work, 8);
+					memcpy(work, "0000-00-00 ", 11);
+					parmlen = 19;
+				}
+				sqltype = SQL_TYPE_TIMESTAMP;
+			}
+			if (sqltype != SQL_TYPE_TIMESTAMP) {
+				sprintf((char*)errmsg, "%s: Binding parameters: Unable to convert C type %d to SQL type %d", TEXT_HYC00, type, (int) ipd_rec->sql_desc_concise_type);
+				error_record(errors, "HYC00", (char*)errmsg, NULL, 0);
+				return SQL_ERROR;
+			}
+		}
+	}
+	else if (ipd_rec->sql_desc_concise_type != SQL_CHAR && ipd_rec->sql_desc_concise_type != SQL_VARCHAR && ipd_rec->sql_desc_concise_type != SQL_LONGVARCHAR) {
+		sprintf((char*)errmsg, "%s: Binding parameters: Unsupported SQL data type: %d", TEXT_HY003, (int) ipd_rec->sql_desc_concise_type);
+		error_record(errors, "HY003", (char*)errmsg, NULL, 0);
+		return SQL_ERROR;
+	}
+	*ptrp = ptr;
+	*parmlenp = parmlen;
+	*sqltypep = sqltype;
+	return SQL_SUCCESS;
+}
+
 static int nextword(char *string, int length, int *offset, int *wordlen)
 {
 	int i1, i2, quoteflag;
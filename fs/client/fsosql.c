@@ -56,6 +56,8 @@ static SQLRETURN setDescType(SQLSMALLINT Value, INT descType, LPVOID drec, ERROR
 static SQLRETURN SQL_API fsFetchScroll(SQLHSTMT StatementHandle, SQLSMALLINT FetchOrientation,
 		SQLLEN FetchOffset);
 static SQLRETURN SQL_API fsAllocStmt(SQLHANDLE, SQLHANDLE *);
+static INT fetchrowset(STATEMENT *stmt, INT first, INT count);
+static INT storerows(STATEMENT *stmt, INT first, INT count, INT rowlength, UCHAR *rows);
 static BOOL consistency_check(DESCRIPTOR *, LPVOID);
 static INT hide_escapes(CHAR *output,  CHAR *input, INT Length);
 
@@ -1890,12 +1892,13 @@ static SQLRETURN SQL_API fsFetchScroll(
 	SQLSMALLINT FetchOrientation,
 	SQLLEN FetchOffset)
 {
-	INT i1, columnlen, precision, rowlength, scale;
+	INT i1, absflag, columnlen, precision, row, rowlength, rows, rowsetsize, scale;
 	SQLLEN rownumber;
 	SQLSMALLINT ard_count, count, ird_count;
-	SQLRETURN rc, rc2;
+	SQLRETURN rc, rc2, rowrc;
+	SQLUSMALLINT *statusptr;
 	CHAR work[65], *getrow;
-	UCHAR *bufptr;
+	UCHAR *bufptr, *rowset;
 	STATEMENT *stmt;
 	struct client_connection_struct *cnct;
 	APP_DESC_RECORD *ard_rec;
@@ -1911,13 +1914,16 @@ static SQLRETURN SQL_API fsFetchScroll(
 	}
 	if (stmt->row_count == 0) return SQL_NO_DATA;
 	stmt->executeflags &= ~EXECUTE_FETCH;
+	rowsetsize = (INT) stmt->sql_attr_app_row_desc->sql_desc_array_size;
+	if (rowsetsize < 1 || (stmt->executeflags & EXECUTE_SQLGETTYPEINFO)) rowsetsize = 1;
 
 	work[0] = 0;
+	absflag = FALSE;
 	rownumber = stmt->row_number;
 	switch (FetchOrientation) {
 	case SQL_FETCH_NEXT:
 		getrow = GETROWN;
-		rownumber++;
+		rownumber += (stmt->rowset_rows > 1) ? stmt->rowset_rows : 1;
 		break;
 	case SQL_FETCH_PRIOR:
 		getrow = GETROWP;
@@ -1934,6 +1940,7 @@ static SQLRETURN SQL_API fsFetchScroll(
 		break;
 	case SQL_FETCH_ABSOLUTE:
 		getrow = GETROWA;
+		absflag = TRUE;
 #ifdef _WIN64
 		_i64toa(FetchOffset, work, 10);
 #else
@@ -1956,10 +1963,50 @@ static SQLRETURN SQL_API fsFetchScroll(
 		return SQL_ERROR;
 	}
 
-	if (stmt->sql_attr_imp_row_desc->sql_desc_array_status_ptr != NULL) {
+	/* after a block fetch the server is positioned on the last row of the rowset, */
+	/* so any movement other than next is converted to an absolute fetch of the first row */
+	if (rowsetsize > 1 || stmt->rowset_rows > 1) {
+		switch (FetchOrientation) {
+		case SQL_FETCH_PRIOR:
+			rownumber = stmt->row_number - rowsetsize;
+			if (rownumber < 1 && stmt->row_number > 1) rownumber = 1;
+			absflag = TRUE;
+			break;
+		case SQL_FETCH_LAST:
+			if (stmt->row_count > 0) {
+				rownumber = stmt->row_count - rowsetsize + 1;
+				if (rownumber < 1) rownumber = 1;
+				absflag = TRUE;
+			}
+			break;
+		case SQL_FETCH_ABSOLUTE:
+			if (FetchOffset < 0 && stmt->row_count > 0) {
+				rownumber = stmt->row_count + 1 + FetchOffset;
+				if (rownumber < 1 && -FetchOffset <= rowsetsize) rownumber = 1;
+			}
+			break;
+		case SQL_FETCH_RELATIVE:
+			if (rownumber < 1 && stmt->row_number > 1 && -FetchOffset <= rowsetsize) rownumber = 1;
+			absflag = TRUE;
+			break;
+		}
+		if (absflag) {
+			if (rownumber < 0) rownumber = 0;
+			getrow = GETROWA;
+#ifdef _WIN64
+			_i64toa(rownumber, work, 10);
+#else
+			_itoa((INT) rownumber, work, 10);
+#endif
+		}
+	}
+
+	statusptr = stmt->sql_attr_imp_row_desc->sql_desc_array_status_ptr;
+	if (statusptr != NULL) {
 		for (i1 = 0; i1 < (int) stmt->sql_attr_app_row_desc->sql_desc_array_size; i1++)
-			stmt->sql_attr_imp_row_desc->sql_desc_array_status_ptr[i1] = SQL_ROW_NOROW;
+			statusptr[i1] = SQL_ROW_NOROW;
 	}
+	stmt->rowset_rows = 0;
 	if (stmt->executeflags & EXECUTE_SQLGETTYPEINFO) {
 		if (rownumber < 1 || rownumber > stmt->row_count) {
 			if (rownumber < 1) stmt->row_number = 0;
@@ -1971,6 +2018,7 @@ static SQLRETURN SQL_API fsFetchScroll(
 		}
 		memcpy(stmt->row_buffer, stmt->row_buffer + rownumber * MAX_DATA_LENGTH, MAX_DATA_LENGTH);
 		stmt->row_length = rowlength = MAX_DATA_LENGTH;
+		rows = 1;
 	}
 	else {
 		entersync();  /* protect workbuffer */
@@ -1978,12 +2026,34 @@ static SQLRETURN SQL_API fsFetchScroll(
 		__try {
 #endif
  		cnct = stmt->cnct;
-		rowlength = sizeof(workbuffer);
-		rc = server_communicate(cnct, (UCHAR*)stmt->rsid, (UCHAR*)getrow,
-				(UCHAR*)work, (INT)strlen(work), &stmt->errors, (UCHAR*)workbuffer, &rowlength);
-		if (rc != SERVER_OK) {
+		if (FetchOrientation == SQL_FETCH_NEXT && rowsetsize > 1 && SERVER_GETROWS(cnct)) {
+			/* whole rowset in one round trip */
+			rows = fetchrowset(stmt, 0, rowsetsize);
+		}
+		else {
+			rowlength = sizeof(workbuffer);
+			rc = server_communicate(cnct, (UCHAR*)stmt->rsid, (UCHAR*)getrow,
+					(UCHAR*)work, (INT)strlen(work), &stmt->errors, (UCHAR*)workbuffer, &rowlength);
+			if (rc == SERVER_OK) {
+				/* fixup column packet returned from the FS 2 server */
+				if (cnct->server_majorver == 2 && (stmt->executeflags & EXECUTE_SQLCOLUMNS) && rowlength == 253) {
+					memcpy(workbuffer + 250, workbuffer + 244, 3);
+					memset(workbuffer + 244, ' ', 3);
+				}
+				if (rowlength > (INT) sizeof(workbuffer)) rowlength = sizeof(workbuffer);
+				rows = storerows(stmt, 0, 1, rowlength, (UCHAR *) workbuffer);
+				if (!rows && rowsetsize > 1) {
+					rows = fetchrowset(stmt, 1, rowsetsize - 1);
+					if (rows >= 0) rows++;
+				}
+				else if (!rows) rows = 1;
+			}
+			else if (rc == SERVER_NODATA) rows = 0;
+			else rows = -1;
+		}
+		if (rows <= 0) {
 			exitsync();
-			if (rc == SERVER_NODATA) {
+			if (!rows) {
 				if (rownumber < 1) stmt->row_number = 0;
 				else stmt->row_number = stmt->row_count + 1;
 				stmt->sql_attr_row_number = 0;
@@ -1993,36 +2063,7 @@ static SQLRETURN SQL_API fsFetchScroll(
 			}
 			return SQL_ERROR;
 		}
-		/* fixup column packet returned from the FS 2 server */
-		if (cnct->server_majorver == 2 && (stmt->executeflags & EXECUTE_SQLCOLUMNS) && rowlength == 253) {
-			memcpy(workbuffer + 250, workbuffer + 244, 3);
-			memset(workbuffer + 244, ' ', 3);
-		}
-
-/*** CODE: FREEING THIS BUFFER DURING CLOSE CURSOR AND FREESTATEMENT(SQL_CLOSE), MAY WANT TO ***/
-/***       WAIT TILL STATMENT HANDLE IS FREED ***/
-		if (stmt->row_buffer == NULL) {
-			bufptr = allocmem(rowlength, 0);
-			if (bufptr == NULL) {
-				exitsync();
-				error_record(&stmt->errors, "HY001", TEXT_HY001, NULL, 0);
-				return SQL_ERROR;
-			}
-			stmt->row_buffer = bufptr;
-			stmt->row_buffer_size = rowlength;
-		}
-		else if (rowlength > stmt->row_buffer_size) {
-			bufptr = reallocmem(stmt->row_buffer, rowlength, 0);
-			if (bufptr == NULL) {
-				exitsync();
-				error_record(&stmt->errors, "HY001", TEXT_HY001, NULL, 0);
-				return SQL_ERROR;
-			}
-			stmt->row_buffer = bufptr;
-			stmt->row_buffer_size = rowlength;
-		}
-		memcpy(stmt->row_buffer, workbuffer, rowlength);
-		stmt->row_length = rowlength;
+		rowlength = stmt->row_length;
 #if OS_WIN32
 		}
 		__except( EXCEPTION_EXECUTE_HANDLER )
@@ -2038,11 +2079,15 @@ static SQLRETURN SQL_API fsFetchScroll(
 
 	rc = SQL_SUCCESS;
 	ard_count = stmt->sql_attr_app_row_desc->sql_desc_count;
-	if (ard_count) {  /* fill the bound columns */
-		ird_count = stmt->sql_attr_imp_row_desc->sql_desc_count;
+	ird_count = stmt->sql_attr_imp_row_desc->sql_desc_count;
+	rowset = stmt->row_buffer;
+	for (row = 0; row < rows; row++) {
+		/* exec_sqltoc and SQLGetData see the row being converted as the row buffer */
+		stmt->row_buffer = rowset + row * rowlength;
+		rowrc = SQL_SUCCESS;
 		ard_rec = stmt->sql_attr_app_row_desc->firstrecord.appdrec;
 		ird_rec = stmt->sql_attr_imp_row_desc->firstrecord.irdrec;
-		for (count = 0; ++count <= ard_count; ) {
+		for (count = 0; ++count <= ard_count; ) {  /* fill the bound columns */
 			if (count <= ird_count) {
 				if (ard_rec->sql_desc_data_ptr != NULL) {  /* bound */
 					if (stmt->cnct->env->sql_attr_odbc_version == SQL_OV_ODBC2) precision = scale = -1;
@@ -2059,22 +2104,35 @@ static SQLRETURN SQL_API fsFetchScroll(
 						ard_rec->sql_desc_data_ptr, ard_rec->sql_desc_octet_length,
 						ard_rec->sql_desc_octet_length_ptr, ard_rec->sql_desc_indicator_ptr,
 						(stmt->sql_attr_app_row_desc->sql_desc_bind_offset_ptr != NULL) ? *stmt->sql_attr_app_row_desc->sql_desc_bind_offset_ptr : 0,
-						0, stmt->sql_attr_app_row_desc->sql_desc_bind_type);
-					if (rc2 == SQL_ERROR) return SQL_ERROR;
-					if (rc2 != SQL_SUCCESS) rc = rc2;
+						row, stmt->sql_attr_app_row_desc->sql_desc_bind_type);
+					if (rc2 == SQL_ERROR) {
+						rowrc = SQL_ERROR;
+						break;
+					}
+					if (rc2 != SQL_SUCCESS) rowrc = rc2;
 				}
 				ird_rec = ird_rec->nextrecord;
 			}
 			else if (ard_rec->sql_desc_data_ptr != NULL) {
+				stmt->row_buffer = rowset;
 				error_record(&stmt->errors, "07009", TEXT_07009, "Bound column exceeds number of columns in result set", 0);
 				return SQL_ERROR;
 			}
 			ard_rec = ard_rec->nextrecord;
 		}
+		if (statusptr != NULL) {
+			if (rowrc == SQL_ERROR) statusptr[row] = SQL_ROW_ERROR;
+			else if (rowrc == SQL_SUCCESS_WITH_INFO) statusptr[row] = SQL_ROW_SUCCESS_WITH_INFO;
+			else statusptr[row] = SQL_ROW_SUCCESS;
+		}
+		/* an error in one row of a rowset is reported through the row status array */
+		if (rowrc == SQL_ERROR) rc = (rows == 1) ? SQL_ERROR : SQL_SUCCESS_WITH_INFO;
+		else if (rowrc != SQL_SUCCESS && rc == SQL_SUCCESS) rc = rowrc;
 	}
+	stmt->row_buffer = rowset;
 	if (rc != SQL_ERROR) {
 		entersync(); // added 22MAY2020
-		if (FetchOrientation != SQL_FETCH_LAST) {
+		if (FetchOrientation != SQL_FETCH_LAST || absflag) {
 			if (rownumber < 1) rownumber = 1;
 			if (rownumber > stmt->row_count) {
 				if (!(stmt->executeflags & EXECUTE_DYNAMIC)) rownumber = stmt->row_count;
@@ -2103,19 +2161,13 @@ static SQLRETURN SQL_API fsFetchScroll(
 			 *
 			 * jpr 30 NOV 2015
 			 * Change, the ODBC spec says that this should be the size of the 'row set'
-			 * We always fetch ONE row, so this should always return 1
 			 *
-			 * Note that stmt->sql_attr_app_row_desc->sql_desc_array_size, used below and in other places
-			 * is always ONE.
+			 * This is the number of rows actually fetched into the rowset, which is
+			 * less than sql_desc_array_size when the end of the result set is reached.
 			 */
-			*stmt->sql_attr_imp_row_desc->sql_desc_rows_processed_ptr = 1; //stmt->row_count;
-		}
-		if (stmt->sql_attr_imp_row_desc->sql_desc_array_status_ptr != NULL) {
-			/** After success fetch update row status - SSN **/
-			for (i1 = 0; i1 < (int) stmt->sql_attr_app_row_desc->sql_desc_array_size; i1++) {
-				stmt->sql_attr_imp_row_desc->sql_desc_array_status_ptr[i1] = SQL_SUCCESS;
-			}
+			*stmt->sql_attr_imp_row_desc->sql_desc_rows_processed_ptr = rows;
 		}
+		stmt->rowset_rows = rows;
 		stmt->executeflags |= EXECUTE_FETCH;
 		stmt->lastcolumn = 0;
 		exitsync(); // added 22MAY2020
@@ -2123,6 +2175,103 @@ static SQLRETURN SQL_API fsFetchScroll(
 	return rc;
 }
 
+/*
+ * Fetch up to count rows following the current server position into the rowset
+ * buffer starting at entry first. Uses GETROWS to return as many rows per reply
+ * as fit in the work buffer, or GETROWN per row with servers older than 101.01.
+ * Caller must hold workbuffer.
+ * Return number of rows fetched, -1 if error
+ */
+static INT fetchrowset(STATEMENT *stmt, INT first, INT count)
+{
+	INT endflag, len, rowcount, rowlength, rows;
+	SQLRETURN rc;
+	CHAR work[32];
+	UCHAR *bufptr;
+
+	for (rows = 0; rows < count; rows += rowcount) {
+		len = sizeof(workbuffer);
+		if (SERVER_GETROWS(stmt->cnct)) {
+			sprintf(work, "%d %d", count - rows, (INT) sizeof(workbuffer) - 24);
+			rc = server_communicate(stmt->cnct, (UCHAR *) stmt->rsid, (UCHAR *) GETROWS,
+					(UCHAR *) work, (INT) strlen(work), &stmt->errors, (UCHAR *) workbuffer, &len);
+			if (rc == SERVER_NODATA) break;
+			if (rc != SERVER_OK) return -1;
+			rowcount = rowlength = 0;
+			if (len >= 24 && len <= (INT) sizeof(workbuffer)) {
+				tcpntoi((UCHAR *) workbuffer, 8, &rowcount);
+				tcpntoi((UCHAR *) workbuffer + 8, 8, &rowlength);
+			}
+			if (rowcount < 1 || rowcount > count - rows || rowlength < 0 || 24 + rowcount * rowlength > len) {
+				error_record(&stmt->errors, "08S01", TEXT_08S01_INVALIDLEN, "Invalid GETROWS reply", 0);
+				return -1;
+			}
+			endflag = (workbuffer[16] == 'E');
+			bufptr = (UCHAR *) workbuffer + 24;
+		}
+		else {
+			rc = server_communicate(stmt->cnct, (UCHAR *) stmt->rsid, (UCHAR *) GETROWN,
+					NULL, 0, &stmt->errors, (UCHAR *) workbuffer, &len);
+			if (rc == SERVER_NODATA) break;
+			if (rc != SERVER_OK) return -1;
+			if (len > (INT) sizeof(workbuffer)) len = sizeof(workbuffer);
+			rowcount = 1;
+			rowlength = len;
+			endflag = FALSE;
+			bufptr = (UCHAR *) workbuffer;
+		}
+		if (storerows(stmt, first + rows, rowcount, rowlength, bufptr)) return -1;
+		if (endflag) {
+			rows += rowcount;
+			break;
+		}
+	}
+	return rows;
+}
+
+/*
+ * Copy count rows of rowlength bytes into the rowset buffer starting at entry first.
+ * The first entry sets the row length, later rows are truncated or blank padded to it.
+ * Return 0 if success, -1 if out of memory
+ */
+static INT storerows(STATEMENT *stmt, INT first, INT count, INT rowlength, UCHAR *rows)
+{
+	INT i1, size;
+	UCHAR *bufptr;
+
+/*** CODE: FREEING THIS BUFFER DURING CLOSE CURSOR AND FREESTATEMENT(SQL_CLOSE), MAY WANT TO ***/
+/***       WAIT TILL STATMENT HANDLE IS FREED ***/
+	if (!first) stmt->row_length = rowlength;
+	size = (first + count) * stmt->row_length;
+	if (stmt->row_buffer == NULL) {
+		bufptr = allocmem(size, 0);
+		if (bufptr == NULL) {
+			error_record(&stmt->errors, "HY001", TEXT_HY001, NULL, 0);
+			return -1;
+		}
+		stmt->row_buffer = bufptr;
+		stmt->row_buffer_size = size;
+	}
+	else if (size > stmt->row_buffer_size) {
+		bufptr = reallocmem(stmt->row_buffer, size, 0);
+		if (bufptr == NULL) {
+			error_record(&stmt->errors, "HY001", TEXT_HY001, NULL, 0);
+			return -1;
+		}
+		stmt->row_buffer = bufptr;
+		stmt->row_buffer_size = size;
+	}
+	for (i1 = 0; i1 < count; i1++, rows += rowlength) {
+		bufptr = stmt->row_buffer + (first + i1) * stmt->row_length;
+		if (rowlength >= stmt->row_length) memcpy(bufptr, rows, stmt->row_length);
+		else {
+			memcpy(bufptr, rows, rowlength);
+			memset(bufptr + rowlength, ' ', stmt->row_length - rowlength);
+		}
+	}
+	return 0;
+}
+
 #if 0
 /*** CODE: DO NOT SUPPORT INITIALLY ***/
 SQLRETURN SQL_API SQLForeignKeys(
@@ -2198,6 +2347,7 @@ SQLRETURN SQL_API SQLFreeHandle(
 				return SQL_ERROR;
 			}
 		}
+		exec_unprepare(stmt);
 		/* remove from connections linked list */
 #if OS_WIN32
 		/**
@@ -3909,7 +4059,7 @@ SQLRETURN SQL_API SQLGetInfo(
 		chardata = TRUE;
 		break;
 	case SQL_PARAM_ARRAY_ROW_COUNTS:	/* 153 */
-		ptr.uinteger = 0;
+		ptr.uinteger = SQL_PARC_NO_BATCH;  /* the row count of an array of parameters is the total */
 		length = sizeof(ptr.uinteger);
 		break;
 	case SQL_PARAM_ARRAY_SELECTS:		/* 154 */
@@ -4983,10 +5133,13 @@ SQLRETURN SQL_API SQLSetDescField(
 	entersync();
 	switch (FieldIdentifier) {
 	case SQL_DESC_ARRAY_SIZE:
-		if (desc->type == TYPE_APP_DESC && SQLPTR_TO_SQLUINT ValuePtr != 1) {
-			error_record(&desc->errors, "01S02", C01S02TEXT, NULL, 0);
-			exitsync();
-			return SQL_SUCCESS_WITH_INFO;
+		if (desc->type == TYPE_APP_DESC) {
+			if (SQLPTR_TO_SQLUINT ValuePtr < 1) {
+				error_record(&desc->errors, "HY024", TEXT_HY024, NULL, 0);
+				exitsync();
+				return SQL_ERROR;
+			}
+			desc->sql_desc_array_size = SQLPTR_TO_SQLUINT ValuePtr;
 		}
 		break;
 	case SQL_DESC_ARRAY_STATUS_PTR:
@@ -5525,10 +5678,11 @@ SQLRETURN SQL_API SQLSetStmtAttr(
 		break;
 	case SQL_ATTR_ROW_ARRAY_SIZE:
 	case SQL_ROWSET_SIZE:  /* ODBC 2.0 compatability */
-		if (SQLPTR_TO_SQLUINT ValuePtr != 1) {
-			error_record(&stmt->errors, "01S02", C01S02TEXT, NULL, 0);
-			return SQL_SUCCESS_WITH_INFO;
+		if (SQLPTR_TO_SQLUINT ValuePtr < 1) {
+			error_record(&stmt->errors, "HY024", TEXT_HY024, NULL, 0);
+			return SQL_ERROR;
 		}
+		stmt->sql_attr_app_row_desc->sql_desc_array_size = SQLPTR_TO_SQLUINT ValuePtr;
 		break;
 	case SQL_ATTR_ROW_BIND_OFFSET_PTR:
 		stmt->sql_attr_app_row_desc->sql_desc_bind_offset_ptr = (SQLUINTEGER *) ValuePtr;
@@ -38,6 +38,19 @@ extern void memcompact(void);
 extern void membase(UCHAR **, UINT *, INT *);
 extern INT isValidHandle(UCHAR **pptr);
 extern UINT walkmemory(void);
+extern UINT memgeneration;  /* changes each time memory blocks may have moved */
+
+/* memory manager statistics, see memstats() */
+typedef struct memstats_struct {
+	UINT compacts;		/* full compactions */
+	UINT partials;		/* compactions of only the end of memory */
+	UINT holefills;		/* allocations placed in a hole */
+	UINT holebytes;		/* current total of unused bytes between blocks */
+	ULONG bytesmoved;	/* bytes moved by compaction */
+	ULONG stalltime;	/* total time spent compacting, in microseconds */
+	UINT maxstall;		/* longest single compaction, in microseconds */
+} MEMSTATS;
+extern void memstats(MEMSTATS *);
 
 /* property handling functions */
 
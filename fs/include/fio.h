@@ -64,6 +64,8 @@ struct fioparmsstruct {
 	CHAR tdbpath[512];		/* termdef binary file directories */
 	CHAR imgpath[1024];		/* image file directories */
 	CHAR cftpath[MAX_PATH]; /* Smart Client file transfer directory */
+	INT indexcache;			/* xio block cache size in megabytes, 0 = default */
+	CHAR indexcachelog[MAX_PATH];	/* file to receive xio block cache statistics */
 	UCHAR casemap[256];		/* case map */
 	UCHAR collatemap[256];	/* collating order */
 	INT (*cvtvolfnc)(CHAR *, CHAR ***);	/* function to translate :VOLUME to directory */
@@ -86,6 +88,8 @@ struct htab {			/* operating system handle number table */
 	OFFSET lpos;		/* last position on read or write */
 	UINT luse;		/* least recently used algorithm marker */
 	UCHAR **pptr;		/* pointer to locked positions list */
+	UCHAR *mptr;		/* read only memory mapping of the file, NULL if not mapped */
+	OFFSET msiz;		/* size of the memory mapping */
 	CHAR fnam[MAX_NAMESIZE + 1];	/* file name */
 };
 
@@ -214,6 +218,7 @@ typedef struct {
 #define FIO_FLAG_PATHCASELOWER	  0x00008000  /* miofixname pathcase=lower */
 #define FIO_FLAG_UTILPREPDOS	  0x00010000  /* aim insert does not invalidate lookup table */
 #define FIO_FLAG_RANDWRTLCK       0x00020000  /* random writes lock the file for duration of process */
+#define FIO_FLAG_MMAP             0x00040000  /* read exclusive files, and SRO files while file locked, through a memory mapping */
 
 #define FIO_PARM_FILETIMEOUT	0x00000001  /* filetimeout parm specified */
 #define FIO_PARM_RECTIMEOUT		0x00000002  /* rectimeout parm specified */
@@ -476,6 +481,7 @@ extern CHAR *fioinit(FIOPARMS *, INT);
 extern void fioexit(void);
 extern void fiosetflags(INT);
 extern INT fiogetflags(void);
+extern INT fiogetindexcache(CHAR **);
 extern FHANDLE fiogetOSHandle(INT fnum);
 extern INT fiosetopt(INT, UCHAR *);
 extern UCHAR **fiogetopt(INT);
@@ -484,6 +490,7 @@ extern INT fioopen(CHAR *, INT);
 extern INT fioclose(INT);
 extern INT fiokill(INT);
 extern INT fioread(INT, OFFSET, UCHAR *, INT);
+extern UCHAR *fiomap(INT, OFFSET, INT *);
 extern INT fiowrite(INT, OFFSET, UCHAR *, size_t);
 extern INT fiogetsize(INT, OFFSET *);
 extern INT fioclru(INT);
@@ -521,6 +528,7 @@ extern void miogetname(CHAR **, CHAR **);
 /* rio.c */
 extern INT riologstart(CHAR *, CHAR *, CHAR *, INT);
 extern INT riologend(void);
+extern void rioexit(void);
 extern INT rioopen(CHAR *name, INT opts, INT bufs, INT maxlen);
 extern INT rioclose(INT);
 extern INT riokill(INT);
@@ -543,10 +551,13 @@ extern void riounlock(INT, OFFSET);
 
 /* xio.c */
 extern INT xioopen(CHAR *, INT, INT, INT, OFFSET *, CHAR *);
+extern void xioexit(void);
 extern INT xioclose(INT);
 extern INT xiokill(INT);
 extern INT xiofind(INT, UCHAR *, INT);
 extern INT xiofindlast(INT, UCHAR *, INT);
+extern INT xiogetkey(INT, UCHAR *);
+extern INT xiosetkey(INT, UCHAR *, INT, OFFSET);
 extern INT xionext(INT);
 extern INT xioprev(INT);
 extern INT xioinsert(INT, UCHAR *, INT);
@@ -554,9 +565,11 @@ extern INT xiodelete(INT, UCHAR *, INT, INT);
 extern INT xiogetrec(INT);
 extern INT xiodelrec(INT);
 extern INT xioflush(INT);
+extern INT xiostats(INT, INT, OFFSET *, OFFSET *);
 
 /* aio.c */
 extern INT aioopen(CHAR *, INT, INT, OFFSET *, CHAR *, INT *, CHAR *, INT, INT);
+extern void aioexit(void);
 extern INT aioclose(INT);
 extern INT aiokill(INT);
 extern INT aionew(INT);
@@ -566,6 +579,7 @@ extern INT aiochkrec(INT, UCHAR *, INT);
 extern INT aioinsert(INT, UCHAR *);
 extern INT aiogetrec(INT);
 extern INT aiodelrec(INT);
+extern INT aiostats(INT, INT, OFFSET, OFFSET *, OFFSET *);
 extern void aiomatch(INT, INT);
 
 /* fioa???.c */
@@ -578,6 +592,11 @@ extern INT fioalseek(FHANDLE, OFFSET, INT, OFFSET *);
 extern INT fioalock(FHANDLE, INT, OFFSET, INT);
 extern INT fioaflush(FHANDLE);
 extern INT fioatrunc(FHANDLE, OFFSET);
+extern INT fioamap(FHANDLE, UCHAR **, OFFSET *);
+extern void fioaunmap(UCHAR *, OFFSET);
+extern INT fioamapfile(CHAR *, OFFSET, UCHAR **);
+extern INT fioasavefile(CHAR *, UCHAR *, INT);
+extern INT fioastat(FHANDLE, OFFSET *, OFFSET *);
 extern INT fioadelete(CHAR *);
 extern INT fioarename(CHAR *oldname, CHAR *newname);
 extern INT fioafindfirst(CHAR *path, CHAR *file, CHAR **found);
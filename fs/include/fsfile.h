@@ -44,6 +44,7 @@
 INT fileconnect(CHAR *, CHAR *, CHAR *, CHAR *, CHAR *logfile);
 INT filegetinfo(CHAR *, INT, CHAR *, INT *);
 INT filedisconnect(INT);
+void filereset(void);
 INT fileopen(INT, CHAR *, INT, INT, CHAR *, INT, CHAR *, INT, INT *);
 INT fileclose(INT, INT, INT);
 INT filefposit(INT, INT, OFFSET *);
@@ -52,6 +53,8 @@ INT filereadrec(INT, INT, INT, OFFSET, UCHAR *, INT *);
 INT filereadkey(INT, INT, INT, UCHAR *, INT, UCHAR *, INT *);
 INT filereadaim(INT, INT, INT, INT, UCHAR **, INT *, UCHAR *, INT *);
 INT filereadnext(INT, INT, INT, INT, UCHAR *, INT *);
+INT filereadahead(INT, INT, INT, INT, UCHAR *, INT *, INT *, INT *);
+INT filereadback(INT, INT, INT, OFFSET, UCHAR *, INT, UCHAR *, INT);
 INT filereadraw(INT, INT, OFFSET, UCHAR *, INT *);
 INT filewriterec(INT, INT, OFFSET, UCHAR *, INT);
 INT filewritekey(INT, INT, UCHAR *, INT, UCHAR *, INT);
@@ -127,7 +127,8 @@ struct statement_struct {
 /*** CODE, SET ROW_LENGTH TO -1 IN APPROPRIATE PLACES ***/
 	INT row_length;										/* length of row from last fetch, -1 means no previous fetch */
 	INT row_buffer_size;
-	UCHAR *row_buffer;
+	UCHAR *row_buffer;									/* rows of the rowset from last fetch, each row_length bytes */
+	INT rowset_rows;									/* number of rows in the rowset from last fetch */
 	SQLUSMALLINT lastcolumn;							/* last column retrieved by sqlgetdata, -1 = none */
 	INT coloffset;										/* offset in column to support multiple sqlgetdata's */
 	CHAR rsid[FIELD_LENGTH];
@@ -139,6 +140,8 @@ struct statement_struct {
 	 * Used only in SQLPrepare and SQLNumParams
 	 */
 	SQLUSMALLINT parameter_marker_count;
+	INT serverstmt;										/* id of text prepared on the server, 0 = none, -1 = server can not prepare it */
+	INT serverparams;									/* number of parameter markers of the statement prepared on the server */
 	/* statement attributes */
 	DESCRIPTOR *sql_attr_app_param_desc;
 	DESCRIPTOR *sql_attr_app_row_desc;
@@ -365,6 +368,7 @@ typedef struct connectinfo_struct {
 #define TEXT_HY019 "Non-character and non-binary data sent in pieces"
 #define TEXT_HY020 "Attempt to concatenate a null value"
 #define TEXT_HY021 "Inconsistent descriptor information"
+#define TEXT_HY024 "Invalid attribute value"
 #define TEXT_HY090 "Invalid string or buffer length"
 #define TEXT_HY092 "Invalid attribute/option"
 #define TEXT_HY105 "Invalid parameter type"
@@ -396,6 +400,15 @@ typedef struct connectinfo_struct {
 #define GETROWA		"GETROWA "
 #define GETROWR		"GETROWR "
 #define GETROWCT	"GETROWCT"
+#define GETROWS		"GETROWS "
+/* GETROWS is supported by servers starting with 101.01 */
+#define SERVER_GETROWS(cnct) ((cnct)->server_majorver > 101 || ((cnct)->server_majorver == 101 && (cnct)->server_minorver >= 1))
+#define PREPARE		"PREPARE "
+#define EXECPREP	"EXECPREP"
+#define FREESTMT	"FREESTMT"
+#define LOAD		"LOAD    "
+/* PREPARE, EXECPREP, FREESTMT and LOAD are supported by servers starting with 101.02 */
+#define SERVER_PREPARE(cnct) ((cnct)->server_majorver > 101 || ((cnct)->server_majorver == 101 && (cnct)->server_minorver >= 2))
 #define PSUPDATE	"PSUPDATE"
 #define PSDELETE	"PSDELETE"
 #define DISCARD		"DISCARD "
@@ -447,6 +460,7 @@ extern SQLRETURN desc_unbind(DESCRIPTOR *desc, INT number);
 /* fsoexec.c */
 extern SQLRETURN exec_prepare(STATEMENT *stmt, SQLCHAR *text, SQLINTEGER length);
 extern SQLRETURN exec_execute(STATEMENT *stmt);
+extern void exec_unprepare(STATEMENT *stmt);
 extern SQLRETURN exec_columninfo(STATEMENT *stmt, ERRORS *errors);
 extern SQLRETURN exec_resultset(STATEMENT *stmt, ERRORS *errors, CHAR *buffer, INT len, INT executetype);
 extern SQLRETURN exec_sqltoc(STATEMENT *stmt, IMP_ROW_DESC_RECORD *drec, SQLSMALLINT column,
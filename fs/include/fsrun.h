@@ -35,6 +35,7 @@
 
 #define FSFLAGS_SHUTDOWN	0x0001
 #define FSFLAGS_LOGFILE		0x0002
+#define FSFLAGS_POOL		0x0004
 #define FSFLAGS_DEBUG1		0x0100
 #define FSFLAGS_DEBUG2		0x0200
 #define FSFLAGS_DEBUG3		0x0400
@@ -68,6 +69,7 @@ extern INT cfglogname(CHAR *);
 extern INT cfggetentry(CHAR *, CHAR *, CHAR *, INT);
 extern INT cfgaddname(CHAR *, CHAR ***nametable, INT *nametablesize, INT *nametablealloc);
 extern INT writedbdfile(CONNECTION *);
+extern INT writestatsfile(CONNECTION *);
 extern INT coltype(CHAR *, INT, COLUMN *, CHAR *);
 extern CHAR *cfggeterror(void);
 
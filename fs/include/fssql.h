@@ -21,6 +21,10 @@ extern INT sqldisconnect(INT connectid);
 extern INT sqlcatalog(INT connectid, UCHAR *buffer, INT buflen, UCHAR *result, INT *resultsize);
 extern INT sqlexecute(INT connectid, UCHAR *stmt, INT stmtlen, UCHAR *result, INT *resultsize);
 extern INT sqlexecnone(INT connectid, UCHAR *stmt, INT stmtlen, UCHAR *result, INT *resultsize);
+extern INT sqlprepare(INT connectid, UCHAR *stmt, INT stmtlen, UCHAR *result, INT *resultsize);
+extern INT sqlexecprepared(INT connectid, INT stmtid, UCHAR *params, INT paramlen, UCHAR *result, INT *resultsize);
+extern INT sqlload(INT connectid, INT stmtid, UCHAR *data, INT datalen, UCHAR *result, INT *resultsize);
+extern INT sqlfreestmt(INT connectid, INT stmtid);
 extern INT sqlrowcount(INT connectid, INT rsid, UCHAR *result, INT *resultsize);
 extern INT sqlgetrow(INT connectid, INT rsid, INT type, LONG row, UCHAR *result, INT *resultsize);
 extern INT sqlposupdate(INT connectid, INT rsid, UCHAR *stmt, INT stmtlen);
@@ -30,3 +34,4 @@ extern INT sqldiscard(INT connectid, INT rsid);
 extern char *sqlcode(void);
 extern char *sqlmsg(void);
 extern void sqlmsgclear(void);
+extern void sqlreset(void);
@@ -25,8 +25,12 @@
 #define MAX_SELECT_TABLES	16		/* maximum number of tables in a select statement or query */
 #define MAX_IDXKEYS			100		/* maximum number of index or aimdex keys */
 #define MAX_COLKEYS			200		/* maximum number of columns associated with the index keys */
+#define MAX_PARAM_SIZE		256		/* maximum length of a parameter value not bound to a column */
+#define MAX_PLANCACHE		16		/* number of plans kept in the plan cache of a connection */
+#define MAX_LOADBATCH		65536	/* LOAD writes the records it has collected when they reach this many bytes */
 
 #define SQLERR_BADCONNECTID				-401
+#define SQLERR_BADSTMTID				-402
 #define SQLERR_DBDOPENERROR				-501
 #define SQLERR_DBDSYNTAX				-502
 #define SQLERR_DBDAMBIGUOUS				-503
@@ -147,6 +151,8 @@ typedef struct INDEX_STRUCT {
 	INT numcolkeys;					/* number of columns in the keys */
 	HIDXKEY hkeys;					/* handle to array of keys this index */
 	HCOLKEY hcolkeys;				/* handle to table of columns that make up the index key(s) */
+	OFFSET statdistinct;			/* ISAM index: estimated number of distinct keys, set by ANALYZE */
+	INT statdensity;				/* AIM index: average rows per slot in 1/10000ths of the table, set by ANALYZE */
 } INDEX, **HINDEX;
 
 /* column */
@@ -186,6 +192,8 @@ typedef struct TABLE_STRUCT {
 #define TABLE_FLAGS_EORSIZE		0x08
 #define TABLE_FLAGS_TEMPLATE	0x10
 #define TABLE_FLAGS_TEMPLATEDIR	0x20
+#define TABLE_FLAGS_STATS		0x40
+#define TABLE_FLAGS_ANALYZED	0x80	/* statistics collected by this connection, not yet saved */
 	UCHAR flags;					/* is index info complete (TRUE/FALSE) */
 	UCHAR eorsize;					/* number of characters in end-of-record mark */
 	INT filtercolumnnum;			/* column number of filter */
@@ -202,11 +210,14 @@ typedef struct TABLE_STRUCT {
 	HINDEX hindexarray;				/* handle of array of INDEX structures */
 	INT numdbdprops;				/* number of external properties */
 	HDBDPROP hdbdproparray;			/* handle of array of external properties */
+	OFFSET statrows;				/* estimated number of rows, valid if TABLE_FLAGS_STATS is set */
 } TABLE, **HTABLE;
 
 typedef struct OPENFILE_STRUCT OPENFILE;
 typedef struct OPENFILE_STRUCT **HOPENFILE;
 
+typedef struct SCANSTATE_STRUCT SCANSTATE;
+
 typedef struct OPENINDEX_STRUCT OPENINDEX;
 typedef struct OPENINDEX_STRUCT **HOPENINDEX;
 
@@ -230,6 +241,14 @@ typedef struct PCODE_STRUCT **HPCODE;
 
 typedef UCHAR **HBUF;
 
+/* a plan kept by the plan cache, cloned for each execution */
+typedef struct PLANCACHE_STRUCT {
+	USHORT lrucount;				/* least recently used count */
+	INT keylength;					/* length of key */
+	UCHAR **key;					/* normalized statement text */
+	HPLAN hplan;					/* plan that has never been executed (NULL = unused entry) */
+} PLANCACHE, **HPLANCACHE;
+
 /*
  * Represents a connection from the server's point of view
  */
@@ -249,6 +268,7 @@ typedef struct server_connection_struct {
 	INT numlockfiles;				/* number of lock files */
 	HLOCKFILE hlockfilearray;		/* handle of array of locked files */
 	INT memresultsize;				/* size of in memory result buffer */
+	INT scanthreads;				/* threads used to check batched full scans (0 = one per processor) */
 	INT updatelock;					/* update lock type */
 	INT deletelock;					/* delete lock type */
 	INT maxtablename;				/* longest table name length */
@@ -256,6 +276,10 @@ typedef struct server_connection_struct {
 	INT maxtableremarks;			/* longest table remarks length */
 	INT maxcolumnname;				/* longest column name length */
 	INT maxcolumnremarks;			/* longest column remarks length */
+	INT numplans;					/* number of entries in the plan cache */
+	HPLANCACHE hplancache;			/* handle of array of cached plans */
+	INT numprepared;				/* number of prepared statement entries */
+	HBUF **hpreparedarray;			/* handle of array of prepared statement texts (NULL = unused) */
 } CONNECTION;
 
 /* description of an open file */
@@ -270,6 +294,7 @@ struct OPENFILE_STRUCT {
 	OFFSET aimnextpos;					/* next record position */
 	UCHAR **hrecbuf;					/* record buffer */
 	INT **hopenindexarray;				/* handle of an array of filenums correspding with INDEX structures */
+	SCANSTATE *scan;					/* batched full scan in progress (NULL if none) */
 };
 
 /* description of a lock file */
@@ -296,6 +321,12 @@ struct WORKSET_STRUCT {
 	INT fileposoffset;					/* first long in fileposarray correspond with rowid */
 	OFFSET **fileposarray;				/* for update specified, row text file positions */
 	INT fiofilenum;						/* work filenum for rows or fileposarray */
+	INT hashbuckets;					/* hash join/group, number of buckets in hashtable (0 = not built) */
+	INT hashfirst;						/* hash join, first hashtable entry of the probe bucket */
+	INT hashcount;						/* hash join, number of entries in the probe bucket */
+	INT hashpos;						/* hash join, position in probe bucket (-1 = not positioned) */
+	UINT hashvalue;						/* hash join, hash value of the probe key */
+	INT **hashtable;					/* hash join, bucket starts then rowids by bucket; hash group, rowids then hashes by slot */
 };
 
 /* a working set of rows */
@@ -313,6 +344,7 @@ struct PLAN_STRUCT {
 #define PLAN_FLAG_VALIDREC		0x04	/* current record is valid for modification */
 #define PLAN_FLAG_SORT			0x08
 #define PLAN_FLAG_ERROR			0x10
+#define PLAN_FLAG_INSERT		0x20	/* single row INSERT, can be run for each row of a LOAD */
 	UCHAR flags;						/* miscellaneous flags */
 	CHAR updatable;						/* (R)ead, (W)rite, (U)known */
 	UCHAR multirowcnt;					/* count of number of multi-row result sets */
@@ -338,8 +370,33 @@ struct PLAN_STRUCT {
 	INT **filerefmap;					/* array of file numbers mapping */
 	long **savevars;					/* array of variables (NULL on first execution, saved between executions) */
 	struct corrtable_struct **corrtable;  /* table of column and table correlations (alias) (transferred from stmt) */
+	INT litsize;						/* bytes used in literals */
+	INT numparams;						/* number of parameter markers in the statement */
+	INT numparamslots;					/* number of entries in paramslots */
+	struct paramslot_struct **paramslots;  /* literals that parameter values are bound into */
+	struct opprofile_struct **profile;  /* one entry per operation when run by EXPLAIN ANALYZE (NULL otherwise) */
+	UCHAR **batch;						/* records saved by OP_WRITE to be written together by OP_WRITEBATCH */
+	INT batchcount;						/* number of records in batch */
+	INT batchalloc;						/* number of records batch has room for */
 };
 
+/* a literal in the plan that receives the value of a parameter marker */
+typedef struct paramslot_struct {
+	INT paramnum;						/* parameter marker number (1 is first) */
+	INT offset;							/* offset of the literal in literals */
+	INT size;							/* space reserved for the value */
+	INT type;							/* 0: value may not exceed size, TYPE_CHAR: value is truncated to size */
+										/* TYPE_NUM or TYPE_POSNUM: value is formatted as column of size and scale */
+	INT scale;							/* if numeric, scale of the column */
+} PARAMSLOT;
+
+/* counts and time of one program operation, kept for EXPLAIN ANALYZE */
+typedef struct opprofile_struct {
+	LONG count;							/* times the operation was executed */
+	LONG rows;							/* records read or rows produced by the operation */
+	UINT64 time;						/* microseconds spent in the operation */
+} OPPROFILE;
+
 /* definition of a buffer column */
 struct COLREF_STRUCT {
 	UCHAR type;							/* type of column */
@@ -385,7 +442,7 @@ struct PCODE_STRUCT {
 #define OP_READBYKEYREV		9		/*	tableref		indexnum		var:dest (0 1) */
 #define OP_READPOS			10		/*	tableref		colref (pos)	var:dest (0=deleted 1=success) */
 #define OP_UNLOCK			11		/*	tableref */
-#define OP_WRITE			12		/*	tableref */
+#define OP_WRITE			12		/*	tableref		1 = add record to the batch instead of writing it */
 #define OP_UPDATE			13		/*	tableref */
 #define OP_DELETE			14		/*	tableref */
 #define OP_TABLELOCK		15		/*	tableref */
@@ -443,6 +500,15 @@ struct PCODE_STRUCT {
 #define OP_COLTRIM_L		68		/*	colref:src1		colref:src2		colref:dest */
 #define OP_COLTRIM_T		69		/*	colref:src1		colref:src2		colref:dest */
 #define OP_COLTRIM_B		70		/*	colref:src1		colref:src2		colref:dest */
+#define OP_HASHBUILD		71		/*	worksetref		tableref		colref (build key) */
+#define OP_HASHKEY			72		/*	worksetref		colref (probe key) */
+#define OP_HASHNEXT			73		/*	worksetref		tableref		var:dest (0 1) */
+#define OP_HASHPREV			74		/*	worksetref		tableref		var:dest (0 1) */
+#define OP_HASHGROUP		75		/*	worksetref		number of keys	var:dest (-1=too many 0=found 1=new), counts record */
+#define OP_RECCOMPARE		76		/*	colref:column	colref:literal	var:dest (-1 0 1 = src1-src2), read in place from the record */
+#define OP_SCANINIT			77		/*	tableref, read the following full scan in batches */
+#define OP_SCANFILTER		78		/*	colref:column	colref:literal	opcode (OP_GOTOIF... test that rejects the record) */
+#define OP_WRITEBATCH		79		/*	tableref, write the records saved by OP_WRITE */
 #define OP_GOTOIFTRUE		OP_GOTOIFNOTZERO
 #define OP_GOTOIFFALSE		OP_GOTOIFZERO
 
@@ -507,6 +573,7 @@ struct PCODE_STRUCT {
 #define STYPE_CREATE      7			/* SQL CREATE statement */
 #define STYPE_DROP        8			/* SQL DROP statement */
 #define STYPE_ALTER       9			/* SQL ALTER statement */
+#define STYPE_ANALYZE    10			/* SQL ANALYZE statement */
 /* #define STYPE_GRANT	  */		/* SQL GRANT statement */
 /* #define STYPE_REVOKE   */		/* SQL REVOKE statement */
 
@@ -526,6 +593,10 @@ typedef struct S_VALUE {
 	INT stype;					/* structure type STYPE_VALUE */
 	INT length;					/* length of value */
 	INT litoffset;				/* offset + 1 in literal buffer assigned by makelitfromsvalue or 0 if not referenced */
+	INT paramnum;				/* parameter marker number (1 is first) or 0 if a literal */
+	INT paramsize;				/* if parameter marker, space reserved for its value */
+	INT paramtype;				/* if parameter marker, PARAMSLOT type */
+	INT paramscale;				/* if parameter marker, PARAMSLOT scale */
 	UCHAR escape[1];			/* escape character for LIKE */
 	UCHAR data[1];				/* value, N.B. THIS FIELD MUST REMAIN LAST IN THE STRUCT!!!*/
 } S_VALUE;
@@ -643,7 +714,8 @@ typedef struct S_INSERT {
 	INT numcolumns;				/* number of columns/values specified */
 	UINT **tabcolnumarray;		/* array of tablenum/columnnums or NULL if only values */
 	INT numvalues;				/* number of columns/values specified */
-	S_VALUE ****valuesarray;	/* ptr to array of ptrs to values for each column in table */
+	INT numrows;				/* number of rows of values */
+	S_VALUE ****valuesarray;	/* ptr to array of ptrs to values, numvalues for each row */
 } S_INSERT;
 
 /* This structure describes an SQL UPDATE statement.
@@ -683,7 +755,9 @@ INT sqlsuccess(void);
 INT sqlerrnum(INT);
 INT sqlerrmsg(CHAR *);
 INT sqlerrnummsg(INT, CHAR *, CHAR *);
+INT sqlerrset(CHAR *, CHAR *);
 void sqlswi(void);
+INT sqlisswi(void);
 
 /* fssql2.c */
 extern INT getcolumninfo(CHAR *table, CHAR *column, INT *rsid);
@@ -692,6 +766,12 @@ extern INT getbestrowid(CHAR *table, INT *rsid);
 extern INT getindexinfo(CHAR *table, INT allindexes, INT *rsid);
 extern INT gettableinfo(CHAR *table, INT *rsid);
 extern INT execstmt(UCHAR *stmtstring, INT stmtsize, INT *rsid);
+extern INT preparestmt(UCHAR *stmtstring, INT stmtsize, INT *stmtid, INT *numparams);
+extern INT execpreparedstmt(INT stmtid, UCHAR *params, INT paramsize, INT *rsid);
+extern INT loadstmt(INT stmtid, UCHAR *data, INT datasize, LONG *count);
+extern INT freepreparedstmt(INT stmtid);
+extern void freeplancache(void);
+extern void resetstmtstate(void);
 extern INT execnonestmt(UCHAR *stmtstring, INT stmtsize, UCHAR *result, INT *length);
 extern INT getrow(INT rsid, INT type, LONG recnum, UCHAR *row, INT *rowsize);
 extern INT posupdate(INT rsid, UCHAR *stmtstring, INT stmtsize);
@@ -705,6 +785,7 @@ extern INT allocworkset(INT count);
 extern void freeworkset(INT worksetnum);
 extern INT maketemplate(CHAR *tablename, INT *tablenum);
 extern INT maketablecomplete(INT tablenum);
+extern INT analyzetable(INT tablenum);
 extern INT opentabletextfile(INT tablenum);
 extern INT opentableindexfile(INT openfilenum, INT indexnum);
 extern void closetablefiles(INT openfilenum);
@@ -715,9 +796,10 @@ extern INT unlocktextfile(INT lockfilenum);
 extern void closetablelocks(void);
 
 /* fssql3.c */
-extern INT parsesqlstmt(UCHAR *stmtstring, INT stmtlen, S_GENERIC ***stmt);
+extern INT parsesqlstmt(UCHAR *stmtstring, INT stmtlen, S_GENERIC ***stmt, INT *numparams);
 extern INT scanselectstmt(UCHAR *stmtstring, INT stmtlen, S_GENERIC ***stmt);
 extern void freestmt(S_GENERIC **stmt);
+extern INT formatnumeric(UCHAR *number, INT numberlen, INT minus, INT length, INT scale, UCHAR *dest);
 
 /* fssql4.c */
 extern INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag);
@@ -728,9 +810,15 @@ extern INT buildlockplan(S_LOCK **stmt, HPLAN *phplan);
 extern INT buildunlockplan(S_LOCK **stmt, HPLAN *phplan);
 extern INT appendupdateplan(S_UPDATE **stmt, HPLAN hplan);
 extern void freeplan(HPLAN hplan);
+extern INT copyplan(HPLAN hplan, HPLAN *phplan);
+extern CHAR *getopname(INT code, CHAR **operands);
 
 /* fssql5.c */
 extern INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3);
 extern INT readwks(INT worksetnum, INT count);
+extern void freescan(OPENFILE *opf1);
+extern void freeupdaterecbuf(void);
+extern UINT64 execclock(void);
+extern INT writebatch(HPLAN hplan);
 
 #endif  /* _FSSQLX_INCLUDED */
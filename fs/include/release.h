@@ -24,13 +24,13 @@
 #define COPYRIGHT "  (c) Copyright 2023 Portable Software Company"
 #define CFG_PREFIX "dbcfs"
 #define FS_MAJOR_VERSION 101
-#define FS_MINOR_VERSION 0
+#define FS_MINOR_VERSION 2
 #define FS_SUB_VERSION 0
 #define FS_MAJOR_MINOR_STRING "101"
 #define FS_MAJOR_STRING "101"
-#define FS_MINOR_STRING "0"
+#define FS_MINOR_STRING "2"
 #define FS_SETUP_CAPTION "Portable Software File Server 101 Setup"
-#define FS_RC_VERSION "101.00.0000\0"
-#define FS_ODBC_VERSION "101.00.00.00"
+#define FS_RC_VERSION "101.02.0000\0"
+#define FS_ODBC_VERSION "101.02.00.00"
 
 #endif
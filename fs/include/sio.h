@@ -31,6 +31,51 @@ typedef struct {
 #define SIOFLAGS_DSPEXTRA	0x02
 #define SIOFLAGS_DSPERROR	0x04
 
+#define SIO_MAXTHREADS	16
+
+typedef struct siomerge_struct {
+	UCHAR *ptr;
+	INT bpos;
+	INT bsize;
+	OFFSET fpos;
+	OFFSET fsize;
+} SIOMERGE;
+
+/* sort context, one per sort in progress, initialized by sioxinit */
+typedef struct sio_struct {
+	UCHAR flags;
+	UCHAR collateflag;
+	UCHAR priority[256];		/* holds priority of characters */
+	UCHAR *buffer;				/* sort buffer */
+	UINT *order;				/* order of records, also the merge tree */
+	UCHAR *numtype;				/* results of numinfo */
+	INT keycnt;					/* number of keys */
+	SIOKEY *keyptr;				/* key structure */
+	SIOKEY **keyptrptr;
+	INT mergecnt;
+	INT sortedflag;
+	INT firstgetflag;
+	INT numrec;					/* next record returned by sioxget from memory */
+	INT lastrun;				/* merge run of the record last returned by sioxget */
+	INT maxrec;					/* maximum number of records in buffer */
+	INT reclen;					/* length of record */
+	INT reccnt;					/* number of records in buffer */
+	UCHAR *nextrec, *lastrec;	/* pointers into buffer used by sioxputend */
+	INT memsize;				/* memory allocated */
+	OFFSET writepos;			/* current position to write to work file */
+	UCHAR *mergebuf;
+	SIOMERGE *mrginfo;
+	INT mergebufsize;
+	INT threads;				/* number of threads used to sort the buffer */
+	INT chunkpos[SIO_MAXTHREADS];	/* merge positions of the sorted thread chunks */
+	INT chunkend[SIO_MAXTHREADS];
+	INT workhandle;				/* work file handle */
+	CHAR workdir[MAX_NAMESIZE];
+	CHAR workname[MAX_NAMESIZE];
+	void (*dspcallback)(CHAR *);
+	CHAR errorstring[256];
+} SIO;
+
 /* function prototypes */
 
 /* sio.c */
@@ -43,3 +88,13 @@ extern INT sioget(UCHAR **ptr);
 /*** NOTE: SIOSORT IS OBSOLETE, DO NOT USE IN NEW CODE ***/
 extern INT siosort(INT, INT, SIOKEY **, INT (*)(UCHAR *), INT (*)(UCHAR *), CHAR *, CHAR *, INT, INT, void (*)(CHAR *));
 extern CHAR *siogeterr(void);
+
+/* reentrant versions of the above, each sort has its own SIO */
+extern INT sioxinit(SIO *sio, INT len, INT cnt, SIOKEY **keypptr, CHAR *wrkdir, CHAR *wrkname, INT size, INT flags, void (*dspcb)(CHAR *));
+extern INT sioxexit(SIO *sio);
+extern UCHAR *sioxputstart(SIO *sio);
+extern INT sioxputend(SIO *sio);
+extern INT sioxget(SIO *sio, UCHAR **ptr);
+extern CHAR *sioxgeterr(SIO *sio);
+/* set the number of sort threads, 0 for one per processor */
+extern void siosetthreads(INT);
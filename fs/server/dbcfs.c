@@ -132,6 +132,14 @@ typedef struct {
 	CHAR user[21];
 } USERINFO;
 
+typedef struct {
+	INT pid;
+	SOCKET sockethandle;		/* dbcfs end of the socket pair to the worker */
+	INT usernum;				/* index into userinfo, -1 if idle */
+	INT count;					/* number of clients assigned */
+	time_t started;
+} POOLINFO;
+
 #define MAX_VOLUMESIZE	8
 typedef struct {
 	CHAR volume[MAX_VOLUMESIZE + 1];
@@ -182,6 +190,14 @@ static INT usercount;
  * The maximum number of connections allowed. Default to 10. Can be set by config
  */
 static INT usermax = 10;
+/*
+ * Pre-started dbcfsrun workers, see the poolsize and poolrecycle config keywords.
+ * Zero poolsize means every client gets a fork/exec of dbcfsrun
+ */
+static POOLINFO *poolinfo;
+static INT poolsize = 0;
+static INT poolrecycle = 100;
+static INT poolstarts, poolhits, poolmisses, poolrecycles;
 static INT debuglevel;
 static CHAR adminpassword[32];
 static CHAR showpassword[32];
@@ -253,6 +269,10 @@ static void tryGetPidNameViaPopen(pid_t pid, CHAR *name, INT cbname);
 static void sigevent(INT);
 #endif
 static void checkchildren(void);
+static void poolstart(INT);
+static INT poolassign(INT, CHAR *);
+static void poolcheck(fd_set *);
+static void poolstop(void);
 #endif
 
 #if OS_UNIX
@@ -602,6 +622,19 @@ static INT dbcfsstart(INT argc, CHAR **argv)
 	userinfo = (USERINFO *) malloc(usermax * sizeof(USERINFO));
 	if (userinfo == NULL) death1("Insufficient memory");
 	usercount = 0;
+#if OS_UNIX
+	if (fsflags & FLAG_MANUAL) poolsize = 0;
+	if (poolsize) {
+		poolinfo = (POOLINFO *) calloc(poolsize, sizeof(POOLINFO));
+		if (poolinfo == NULL) death1("Insufficient memory");
+		for (i1 = 0; i1 < poolsize; i1++) {
+			poolinfo[i1].sockethandle = INVALID_SOCKET;
+			poolinfo[i1].usernum = -1;
+		}
+	}
+#else
+	poolsize = 0;
+#endif
 
 	/* set the signal handlers */
 #if OS_WIN32
@@ -946,6 +979,16 @@ static INT dbcfsstart(INT argc, CHAR **argv)
 			FD_SET(sockethandle2, &fdset);
 			if (sockethandle2 > (SOCKET)tempsockethandle) tempsockethandle = (INT) sockethandle2;
 		}
+#if OS_UNIX
+		/* replace pool workers that have exited, but not more than once a second per slot */
+		for (i1 = 0; i1 < poolsize; i1++) {
+			if (!poolinfo[i1].pid && poolinfo[i1].sockethandle == INVALID_SOCKET
+				&& difftime(time(NULL), poolinfo[i1].started) >= 1) poolstart(i1);
+			if (poolinfo[i1].sockethandle == INVALID_SOCKET) continue;
+			FD_SET(poolinfo[i1].sockethandle, &fdset);
+			if (poolinfo[i1].sockethandle > tempsockethandle) tempsockethandle = poolinfo[i1].sockethandle;
+		}
+#endif
 		timeval.tv_sec = 5;
 		timeval.tv_usec = 0;
 		tempsockethandle = select(tempsockethandle + 1, &fdset, NULL, NULL, &timeval);
@@ -955,6 +998,9 @@ static INT dbcfsstart(INT argc, CHAR **argv)
 		 * return >0 if any of the FDs are ready.
 		 */
 		if (tempsockethandle <= 0) continue;
+#if OS_UNIX
+		if (poolsize) poolcheck(&fdset);
+#endif
 		if (FD_ISSET(sockethandle1, &fdset)) {
 			processaccept(sockethandle1, TCP_UTF8);
 			if (tempsockethandle == 1) continue;
@@ -997,6 +1043,9 @@ static INT dbcfsstart(INT argc, CHAR **argv)
 
 	closesocket(sockethandle1);
 	if (sockethandle2 != INVALID_SOCKET) closesocket(sockethandle2);
+#if OS_UNIX
+	if (poolsize) poolstop();
+#endif
 
 	/* stop any running dbcfsruns */
 #if OS_WIN32
@@ -1129,6 +1178,12 @@ static void closeAndCleanUpLogFile() {
 				}
 			}
 #endif
+			if (poolsize) {
+				sprintf(work, "<pool size=\"%d\" started=\"%d\" fallback=\"%d\" recycled=\"%d\">%d</pool>",
+						poolsize, poolstarts, poolmisses, poolrecycles, poolhits);
+				i1 = fioawrite(loghandle, (UCHAR *) work, strlen(work), -1, NULL);
+				if (i1) death1("unable to write to log file");
+			}
 			memcpy(work, "<stop>", 6);
 			msctimestamp((UCHAR *)(work + 6));
 			memcpy(work + 22, "</stop>", 7);
@@ -1590,6 +1645,13 @@ static void processaccept(SOCKET sockethandle, INT tcpflags)
 			}
 		}
 
+#if OS_UNIX
+		if (poolsize && (pid = (pid_t) poolassign(usernum, cmdline)) > 0) {
+			userinfo[usernum].pid = (INT) pid;
+			if (usernum == usercount) usercount++;
+		}
+		else
+#endif
 		if (!(fsflags & FLAG_MANUAL)) {
 #if OS_WIN32
 			GetStartupInfo(&sinfo);
@@ -2394,6 +2456,17 @@ static void parsecfgfile(CHAR *cfgfile, CHAR *adminpwd, CHAR *license, CHAR *log
 				continue;
 			}
 		}
+		if (*kw == 'i') {
+			if (!strcmp(kw, "indexcache")) {
+				i1 = atoi(val);
+				if (i1 > 0) fioparms->indexcache = i1;
+				continue;
+			}
+			if (!strcmp(kw, "indexcachelog")) {
+				strncpy(fioparms->indexcachelog, val, sizeof(fioparms->indexcachelog) - 1);
+				continue;
+			}
+		}
 		if (*kw == 'l') {
 			if (!strcmp(kw, "licensekey")) {
 				strcpy(license, val);
@@ -2455,6 +2528,7 @@ static void parsecfgfile(CHAR *cfgfile, CHAR *adminpwd, CHAR *license, CHAR *log
 		if (*kw == 'm') {
 			if (!strcmp(kw, "memalloc")) continue;
 			if (!strcmp(kw, "memresult")) continue;
+			if (!strcmp(kw, "mmap")) continue;
 		}
 		if (*kw == 'n') {
 			if (!strcmp(kw, "namecase")) {
@@ -2503,6 +2577,16 @@ static void parsecfgfile(CHAR *cfgfile, CHAR *adminpwd, CHAR *license, CHAR *log
 				}
 				continue;
 			}
+			if (!strcmp(kw, "poolrecycle")) {
+				poolrecycle = atoi(val);
+				if (poolrecycle < 0) poolrecycle = 0;
+				continue;
+			}
+			if (!strcmp(kw, "poolsize")) {
+				poolsize = atoi(val);
+				if (poolsize < 0) poolsize = 0;
+				continue;
+			}
 			if (!strcmp(kw, "preppath")) {
 				if (xmlflag) {
 					for (element2 = element->firstsubelement; element2 != NULL; element2 = element2->nextelement) {
@@ -2529,6 +2613,7 @@ static void parsecfgfile(CHAR *cfgfile, CHAR *adminpwd, CHAR *license, CHAR *log
 			}
 		}
 		if (*kw == 's') {
+			if (!strcmp(kw, "scanthreads")) continue;
 			if (!strcmp(kw, "showpassword")) {
 				if (strlen(val) >= 32) death1("CFG error: show password too long");
 				strcpy(showpwd, val);
@@ -3047,6 +3132,160 @@ static void checkchildren()
 	}
 	while (usercount && !userinfo[usercount - 1].pid) usercount--;
 }
+
+/*
+ * Start a dbcfsrun pool worker in the given slot. The worker waits on its end
+ * of a socket pair for the command line that would otherwise be used to exec it.
+ */
+static void poolstart(INT slot)
+{
+	INT i1, handles[2];
+	CHAR work[64], *argv[3];
+	pid_t pid;
+
+	poolinfo[slot].started = time(NULL);
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, handles) == -1) {
+		if (fsflags & FLAG_DEBUG) {
+			writestart();
+			sprintf(work, "POOL: socketpair() failed, error = %d", errno);
+			writeout(work, -1);
+			writefinish();
+		}
+		return;
+	}
+	/* set close on exec */
+	i1 = fcntl(handles[0], F_GETFD, 0);
+	if (i1 != -1) {
+#ifdef FD_CLOEXEC
+		fcntl(handles[0], F_SETFD, i1 | FD_CLOEXEC);
+#else
+		fcntl(handles[0], F_SETFD, i1 | 0x01);
+#endif
+	}
+	sprintf(work, "-pool=%d:%d", handles[1], poolrecycle);
+	argv[0] = fsbinary;
+	argv[1] = work;
+	argv[2] = NULL;
+	if ((pid = fork()) == (pid_t) -1) {  /* fork failed */
+		close(handles[0]);
+		close(handles[1]);
+		if (fsflags & FLAG_DEBUG) {
+			writestart();
+			sprintf(work, "POOL: fork() failed, error = %d", errno);
+			writeout(work, -1);
+			writefinish();
+		}
+		return;
+	}
+	if (pid == (pid_t) 0) {  /* child */
+		close(handles[0]);
+		if (sockethandle1 != INVALID_SOCKET) closesocket(sockethandle1);
+		if (sockethandle2 != INVALID_SOCKET) closesocket(sockethandle2);
+		if (temphandle != -1) fioaclose(temphandle);
+		if (loghandle != -1) fioaclose(loghandle);
+		execvp(argv[0], argv);
+		_exit(1);
+	}
+	close(handles[1]);
+	poolinfo[slot].pid = (INT) pid;
+	poolinfo[slot].sockethandle = handles[0];
+	poolinfo[slot].usernum = -1;
+	poolinfo[slot].count = 0;
+	poolstarts++;
+	if ((fsflags & FLAG_DEBUG) && debuglevel >= 2) {
+		writestart();
+		sprintf(work, "POOL: started worker %d in slot %d", (INT) pid, slot);
+		writeout(work, -1);
+		writefinish();
+	}
+}
+
+/*
+ * Hand the client to an idle pool worker.
+ * Return the pid of the worker, or 0 if none is idle.
+ */
+static INT poolassign(INT usernum, CHAR *cmdline)
+{
+	INT i1, len;
+	CHAR work[1024];
+
+	len = (INT)strlen(cmdline);
+	if (len >= (INT) sizeof(work) - 8) return 0;
+	tcpiton(len, (UCHAR *) work, 8);
+	memcpy(work + 8, cmdline, len);
+	for (i1 = 0; i1 < poolsize; i1++) {
+		if (!poolinfo[i1].pid || poolinfo[i1].sockethandle == INVALID_SOCKET || poolinfo[i1].usernum != -1) continue;
+		if (write(poolinfo[i1].sockethandle, work, 8 + len) != 8 + len) {
+			/* worker has gone away, SIGCHLD will reap it */
+			closesocket(poolinfo[i1].sockethandle);
+			poolinfo[i1].sockethandle = INVALID_SOCKET;
+			poolinfo[i1].pid = 0;
+			continue;
+		}
+		poolinfo[i1].usernum = usernum;
+		poolinfo[i1].count++;
+		poolhits++;
+		if ((fsflags & FLAG_DEBUG) && debuglevel >= 2) {
+			writestart();
+			sprintf(work, "POOL: assigned user %d to worker %d, hits=%d, misses=%d", usernum + 1, poolinfo[i1].pid, poolhits, poolmisses);
+			writeout(work, -1);
+			writefinish();
+		}
+		return poolinfo[i1].pid;
+	}
+	poolmisses++;
+	return 0;
+}
+
+/*
+ * Process idle notifications and terminations from pool workers
+ */
+static void poolcheck(fd_set *fdset)
+{
+	INT i1, pid, usernum;
+	CHAR c1, work[128];
+
+	for (i1 = 0; i1 < poolsize; i1++) {
+		if (poolinfo[i1].sockethandle == INVALID_SOCKET || !FD_ISSET(poolinfo[i1].sockethandle, fdset)) continue;
+		pid = poolinfo[i1].pid;
+		usernum = poolinfo[i1].usernum;
+		if (read(poolinfo[i1].sockethandle, &c1, 1) == 1) {  /* worker is idle again */
+			poolinfo[i1].usernum = -1;
+		}
+		else {  /* worker exited, it is replaced in the main loop */
+			closesocket(poolinfo[i1].sockethandle);
+			poolinfo[i1].sockethandle = INVALID_SOCKET;
+			if (poolrecycle && poolinfo[i1].count >= poolrecycle) poolrecycles++;
+			poolinfo[i1].pid = 0;
+		}
+		if (usernum >= 0 && usernum < usercount && userinfo[usernum].pid == pid) {
+			userinfo[usernum].pid = 0;
+			userinfo[usernum].flags = 0;
+		}
+		if ((fsflags & FLAG_DEBUG) && debuglevel >= 2) {
+			writestart();
+			sprintf(work, "POOL: slot %d %s, started=%d, hits=%d, misses=%d, recycled=%d", i1,
+					(poolinfo[i1].pid) ? "idle" : "exited", poolstarts, poolhits, poolmisses, poolrecycles);
+			writeout(work, -1);
+			writefinish();
+		}
+	}
+	while (usercount && !userinfo[usercount - 1].pid) usercount--;
+}
+
+/*
+ * Stop the idle pool workers, busy workers are stopped with the other dbcfsruns
+ */
+static void poolstop()
+{
+	INT i1;
+
+	for (i1 = 0; i1 < poolsize; i1++) {
+		if (poolinfo[i1].sockethandle != INVALID_SOCKET) closesocket(poolinfo[i1].sockethandle);
+		poolinfo[i1].sockethandle = INVALID_SOCKET;
+		if (poolinfo[i1].pid && poolinfo[i1].usernum == -1) kill(poolinfo[i1].pid, SIGTERM);
+	}
+}
 #endif
 
 /**
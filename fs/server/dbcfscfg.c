@@ -71,6 +71,7 @@ static INT volalloc = 0;					/* dbd volume memory allocation flag */
 static VOLUME **volumes;					/* dbd array structure of volumes */
 
 static CFGVOLUME *cfgvolumes = NULL;		/* buffer of linked list of volumes as defined in the cfg file */
+static INT cfgvolumesize = 0;				/* bytes of cfgvolumes in use */
 static INT lastcfgvolume = -1;		/* linked list of volumes as defined in the cfg file */
 static CHAR *lognames = NULL;
 static INT logallfiles = FALSE;
@@ -80,8 +81,59 @@ static INT logtimestamp = FALSE;
 static INT logusername = FALSE;
 static CHAR cfgerrorstring[256];
 
-static INT parsecfgfile(CHAR *cfgfilename, CHAR *useraccess, CHAR *password, INT *memallocsize, FIOPARMS *fioparms, CONNECTION *cnct);
+/* a pool worker keeps what was parsed from the cfg file between clients, see cfgcacheload() */
+typedef struct cfgcache_struct {
+	FIOPARMS fioparms;						/* cvtvolfnc is not kept */
+	INT memallocsize;
+	INT updatelock;
+	INT deletelock;
+	INT memresultsize;
+	INT scanthreads;
+	INT sqlstatisticsflag;
+	INT logallfiles;
+	INT logfilenames;
+	INT logopenclose;
+	INT logtimestamp;
+	INT logusername;
+	INT lastcfgvolume;
+	INT volumesize;							/* bytes of cfgvolumes that follow this structure */
+	INT lognamessize;						/* bytes of lognames that follow the volumes, 0 if none */
+	CHAR workdir[256];
+	CHAR pwdfile[256];
+} CFGCACHE;
+static CHAR cfgcachekey[MAX_NAMESIZE + 64];	/* cfg name, change time and size, connection type */
+static INT cfgcachekeylen = 0;				/* length of key, zero if nothing is cached */
+static CFGCACHE *cfgcache = NULL;
+static CHAR cfgentrykey[sizeof(cfgcachekey)];	/* key of the cfg file the entries below came from */
+static INT cfgentrykeylen = 0;
+static CHAR cfgentries[1024];				/* entry and value pairs returned by cfggetentry */
+static INT cfgentriessize = 0;
+
+/* a pool worker keeps the parsed dbd between clients, see dbdcacheload() */
+static CHAR dbdcachekey[MAX_NAMESIZE * 2 + 600];	/* dbd and cfg names and times, user access */
+static INT dbdcachekeylen = 0;				/* length of key, zero if nothing is cached */
+static UCHAR *dbdcache = NULL;				/* parsed dbd */
+static INT dbdcachesize, dbdcachealloc, dbdcachepos;
+
+static void cfgrelease(void);
+static INT parsecfgfile(CHAR *cfgfilename, CHAR *pwdfile, INT *memallocsize, FIOPARMS *fioparms, CONNECTION *cnct);
+static INT readpwdfile(CHAR *pwdfile, CHAR *useraccess, CHAR *password);
+static INT getcfgcachekey(CHAR *cfgfile, CONNECTION *cnct, CHAR *key);
+static INT cfgcacheload(CHAR *key, INT keylen, CHAR *pwdfile, INT *memallocsize, FIOPARMS *fioparms, CONNECTION *cnct);
+static void cfgcachesave(CHAR *key, INT keylen, CHAR *pwdfile, INT memallocsize, FIOPARMS *fioparms, CONNECTION *cnct);
 static INT readdbdfile(CHAR *dbdfile, CHAR *useraccess, CONNECTION *cnct);
+static void readstatsfile(CONNECTION *cnct);
+static INT statsappend(CHAR **buffer, INT *bufsize, INT *bufalloc, CHAR *record);
+static INT getstatsfilename(CONNECTION *cnct, CHAR *filename);
+static INT getdbdcachekey(CHAR *cfgfile, CHAR *dbdfile, CHAR *useraccess, CHAR *key);
+static INT dbdcacheload(CHAR *key, INT keylen, CONNECTION *cnct);
+static void dbdcachesave(CHAR *key, INT keylen, CONNECTION *cnct);
+static INT dbdcacheput(void *data, INT size);
+static INT dbdcacheputmem(UCHAR **hmem, INT size);
+static INT dbdcacheputarray(UCHAR **hmem, INT count);
+static UCHAR *dbdcacheget(INT size);
+static INT dbdcachegetmem(UCHAR ***hmem);
+static INT dbdcachegetarray(UCHAR ***hmem, INT size, INT *count);
 static void writebuiltin(FILE *dbd, CHAR *data);
 static ELEMENT *getxmldata(CHAR *filebuffer, LONG filesize);
 static INT getnextkwval(CHAR *record, CHAR **kw, CHAR **val, CHAR **error);
@@ -97,8 +149,8 @@ static void syntaxerror(INT type, INT line, CHAR *msg1, CHAR *msg2);
  */
 INT cfginit(CHAR *cfgfile, CHAR *dbdfile, CHAR *user, CHAR *password, CHAR *logfile, CONNECTION *cnct)
 {
-	INT i1, cid, memallocsize, flags;
-	CHAR *ptr, useraccess[512];
+	INT i1, cid, keylen, memallocsize, flags;
+	CHAR *ptr, pwdfile[256], useraccess[512], key[sizeof(dbdcachekey)];
 	FIOPARMS fioparms;
 	clock_t t1;
 
@@ -119,7 +171,18 @@ INT cfginit(CHAR *cfgfile, CHAR *dbdfile, CHAR *user, CHAR *password, CHAR *logf
 		cnct->maxcolumnname = 1;
 		cnct->maxcolumnremarks = 1;
 	}
-	if (parsecfgfile(cfgfile, useraccess, password, &memallocsize, &fioparms, cnct) < 0) return RC_ERROR;
+
+	/* a pool worker reuses the cfg parsed for its previous client while the file is unchanged */
+	keylen = (fsflags & FSFLAGS_POOL) ? getcfgcachekey(cfgfile, cnct, key) : 0;
+	i1 = (keylen) ? cfgcacheload(key, keylen, pwdfile, &memallocsize, &fioparms, cnct) : 0;
+	if (!i1) {
+		i1 = parsecfgfile(cfgfile, pwdfile, &memallocsize, &fioparms, cnct);
+		if (!i1 && keylen) cfgcachesave(key, keylen, pwdfile, memallocsize, &fioparms, cnct);
+	}
+	if (i1 < 0 || readpwdfile(pwdfile, useraccess, password) < 0) {
+		cfgrelease();
+		return RC_ERROR;
+	}
 	if (memallocsize < 256) memallocsize = 256;
 	if (meminit(memallocsize << 10, 0, 1024) == -1) {
 		strcpy(cfgerrorstring, "meminit failed");
@@ -134,12 +197,21 @@ INT cfginit(CHAR *cfgfile, CHAR *dbdfile, CHAR *user, CHAR *password, CHAR *logf
 		return RC_ERROR;
 	}
 
-	if (readdbdfile(dbdfile, useraccess, cnct) < 0) {
+	/* a pool worker reuses the dbd parsed for its previous client while the files are unchanged */
+	keylen = 0;
+	if (cnct != NULL && (fsflags & FSFLAGS_POOL)) keylen = getdbdcachekey(cfgfile, dbdfile, useraccess, key);
+	i1 = (keylen) ? dbdcacheload(key, keylen, cnct) : 0;
+	if (!i1) {
+		i1 = readdbdfile(dbdfile, useraccess, cnct);
+		if (!i1 && keylen) dbdcachesave(key, keylen, cnct);
+	}
+	if (i1 < 0) {
 		if (cnct != NULL) memset(cnct, 0, sizeof(*cnct));
 		cfgexit();
 		return RC_ERROR;
 	}
 	dbdvolcount = volcount;
+	if (cnct != NULL) readstatsfile(cnct);
 	if (cnct != NULL && !cnct->memresultsize) cnct->memresultsize = 128;
 	if (fixupvolmap() < 0) {
 		if (cnct != NULL) memset(cnct, 0, sizeof(*cnct));
@@ -169,6 +241,26 @@ INT cfginit(CHAR *cfgfile, CHAR *dbdfile, CHAR *user, CHAR *password, CHAR *logf
 }
 
 void cfgexit()
+{
+	cfgrelease();
+	/* the memory of the volumes is released below */
+	volumes = NULL;
+	volcount = volalloc = dbdvolcount = 0;
+	riologend();
+	rioexit();
+	aioexit();
+	xioexit();
+	fioexit();
+#ifdef _DEBUG
+	memcompact();
+#endif
+	meminit(0, 0, 0);
+}
+
+/*
+ * Release and reset what was parsed from the cfg file, a pool worker runs the next client
+ */
+static void cfgrelease()
 {
 	if (cfgvolumes != NULL) {
 		free(cfgvolumes);
@@ -178,12 +270,10 @@ void cfgexit()
 		free(lognames);
 		lognames = NULL;
 	}
-	riologend();
-	fioexit();
-#ifdef _DEBUG
-	memcompact();
-#endif
-	meminit(0, 0, 0);
+	cfgvolumesize = 0;
+	lastcfgvolume = -1;
+	logallfiles = logfilenames = logtimestamp = logusername = FALSE;
+	logopenclose = TRUE;
 }
 
 /**
@@ -226,16 +316,34 @@ INT cfglogname(CHAR *filename)
  */
 INT cfggetentry(CHAR *cfgfilename, CHAR *entry, CHAR *value, INT size)
 {
-	INT i1, length;
+	INT i1, i2, keylen, length;
 	LONG filesize;
 	INT nextoffset, rc, xmlflag;
-	CHAR *filebuffer, *error, *kw, *val;
+	CHAR *filebuffer, *error, *kw, *val, key[sizeof(cfgentrykey)];
 	FILE *cfgfile; // @suppress("Statement has no effect")
 	ELEMENT *element, *nextelement, *xmlbuffer;
 
 	if (size <= 0) return RC_ERROR;
 	value[0] = '\0';
 
+	/* a pool worker answers from the entries it already looked up while the cfg file is unchanged */
+	keylen = (fsflags & FSFLAGS_POOL) ? getcfgcachekey(cfgfilename, NULL, key) : 0;
+	if (keylen) {
+		if (keylen != cfgentrykeylen || memcmp(key, cfgentrykey, keylen)) {
+			memcpy(cfgentrykey, key, keylen);
+			cfgentrykeylen = keylen;
+			cfgentriessize = 0;
+		}
+		for (i1 = 0; i1 < cfgentriessize; i1 = i2 + (INT) strlen(cfgentries + i2) + 1) {
+			i2 = i1 + (INT) strlen(cfgentries + i1) + 1;
+			if (!strcmp(cfgentries + i1, entry)) {
+				strncpy(value, cfgentries + i2, size);
+				value[size - 1] = '\0';
+				return (INT)strlen(value);
+			}
+		}
+	}
+
 	cfgfile = fopen(cfgfilename, "rb");
 	if (cfgfile == NULL) {
 		strcpy(cfgerrorstring, "CFG file open failed");
@@ -306,6 +414,13 @@ INT cfggetentry(CHAR *cfgfilename, CHAR *entry, CHAR *value, INT size)
 	}
 	if (xmlflag) free(xmlbuffer);
 	else free(filebuffer);
+	i1 = (INT) strlen(entry) + 1;
+	i2 = (INT) strlen(value) + 1;
+	if (keylen && cfgentriessize + i1 + i2 <= (INT) sizeof(cfgentries)) {
+		memcpy(cfgentries + cfgentriessize, entry, i1);
+		memcpy(cfgentries + cfgentriessize + i1, value, i2);
+		cfgentriessize += i1 + i2;
+	}
 	return (INT)strlen(value);
 }
 
@@ -343,13 +458,13 @@ CHAR *cfggeterror()
 	return cfgerrorstring;
 }
 
-static INT parsecfgfile(CHAR *cfgfilename, CHAR *useraccess, CHAR *password, INT *memallocsize, FIOPARMS *fioparms, CONNECTION *cnct)
+static INT parsecfgfile(CHAR *cfgfilename, CHAR *pwdfile, INT *memallocsize, FIOPARMS *fioparms, CONNECTION *cnct)
 {
 	INT i1, i2, exclusiveflag, length, linecnt, logpos, logsize;
 	LONG filesize;
-	INT nextlevel, nextoffset, prepflag, pwdstate, rc, volpos, volsize, xmlflag;
+	INT nextlevel, nextoffset, prepflag, rc, volpos, volsize, xmlflag;
 	OFFSET off;
-	CHAR pwdfile[256], *filebuffer, *error, *kw, *ptr, *val;
+	CHAR *filebuffer, *error, *kw, *ptr, *val;
 	FILE *cfgfile, *f1;
 	ELEMENT *element, *element2, *nextelement[2], *xmlbuffer;
 	CFGVOLUME *cfgvol;
@@ -582,6 +697,17 @@ static INT parsecfgfile(CHAR *cfgfilename, CHAR *useraccess, CHAR *password, INT
 				continue;
 			}
 		}
+		if (*kw == 'i') {
+			if (!strcmp(kw, "indexcache")) {
+				i1 = atoi(val);
+				if (i1 > 0) fioparms->indexcache = i1;
+				continue;
+			}
+			if (!strcmp(kw, "indexcachelog")) {
+				strncpy(fioparms->indexcachelog, val, sizeof(fioparms->indexcachelog) - 1);
+				continue;
+			}
+		}
 		if (*kw == 'l') {
 			if (!strcmp(kw, "licensekey")) continue;
 			if (xmlflag) {
@@ -700,6 +826,15 @@ static INT parsecfgfile(CHAR *cfgfilename, CHAR *useraccess, CHAR *password, INT
 				*memallocsize = atoi(val);
 				continue;
 			}
+			if (!strcmp(kw, "mmap")) {
+				for (i1 = 0; val[i1]; i1++) val[i1] = (CHAR) tolower(val[i1]);
+				if (!strcmp(val, "on")) fioparms->flags |= FIO_FLAG_MMAP;
+				else if (strcmp(val, "off")) {
+					syntaxerror(SYNTAX_CFG, linecnt, "invalid mmap specification", NULL);
+					break;
+				}
+				continue;
+			}
 			if (!strcmp(kw, "memresult")) {
 				if (cnct != NULL) cnct->memresultsize = atoi(val);
 				continue;
@@ -749,6 +884,8 @@ static INT parsecfgfile(CHAR *cfgfilename, CHAR *useraccess, CHAR *password, INT
 				}
 				continue;
 			}
+			if (!strcmp(kw, "poolrecycle")) continue;
+			if (!strcmp(kw, "poolsize")) continue;
 			if (!strcmp(kw, "preppath")) {
 				if (xmlflag) {
 					for (element2 = element->firstsubelement; element2 != NULL; element2 = element2->nextelement) {
@@ -775,6 +912,10 @@ static INT parsecfgfile(CHAR *cfgfilename, CHAR *useraccess, CHAR *password, INT
 			}
 		}
 		if (*kw == 's') {
+			if (!strcmp(kw, "scanthreads")) {
+				if (cnct != NULL) cnct->scanthreads = atoi(val);
+				continue;
+			}
 			if (!strcmp(kw, "showpassword")) continue;
 			if (!strcmp(kw, "sport")) continue;
 			if (!strcmp(kw, "sqlstatistics")) {
@@ -891,142 +1032,156 @@ static INT parsecfgfile(CHAR *cfgfilename, CHAR *useraccess, CHAR *password, INT
 #if OS_UNIX
 		if (exclusiveflag || (fioparms->flags & FIO_FLAG_SINGLEUSER)) fioparms->flags |= FIO_FLAG_EXCLOPENLOCK;
 #endif
-		/* get access code from password file and store back into useraccess */
 		if (!pwdfile[0]) strcpy(pwdfile, "dbcfspwd.cfg");
-		cfgfile = fopen(pwdfile, "rb");
-		if (cfgfile == NULL) {
-			strcpy(cfgerrorstring, "open failure on password file");
-			return RC_ERROR;
-		}
-		fseek(cfgfile, 0, 2);
-		filesize = (INT) ftell(cfgfile);
-		fseek(cfgfile, 0, 0);
-		filebuffer = (CHAR *) malloc(filesize + sizeof(CHAR));
-		if (filebuffer == NULL) {
-			fclose(cfgfile);
-			strcpy(cfgerrorstring, "insufficient memory (malloc)");
-			return RC_ERROR;
-		}
-		i1 = (INT)fread(filebuffer, 1, filesize, cfgfile);
+		cfgvolumesize = volpos * (INT) sizeof(CFGVOLUME);
+	}
+	return rc;
+}
+
+/*
+ * Get the access codes of the user from the password file and store them back into useraccess
+ */
+static INT readpwdfile(CHAR *pwdfile, CHAR *useraccess, CHAR *password)
+{
+	INT i1, i2, length, linecnt, nextlevel, nextoffset, pwdstate, rc, xmlflag;
+	LONG filesize;
+	CHAR *filebuffer, *error, *kw, *val;
+	FILE *cfgfile;
+	ELEMENT *element, *nextelement[2], *xmlbuffer;
+
+	cfgfile = fopen(pwdfile, "rb");
+	if (cfgfile == NULL) {
+		strcpy(cfgerrorstring, "open failure on password file");
+		return RC_ERROR;
+	}
+	fseek(cfgfile, 0, 2);
+	filesize = (INT) ftell(cfgfile);
+	fseek(cfgfile, 0, 0);
+	filebuffer = (CHAR *) malloc(filesize + sizeof(CHAR));
+	if (filebuffer == NULL) {
 		fclose(cfgfile);
-		if (i1 != filesize) {
-			free(filebuffer);
-			strcpy(cfgerrorstring, "error reading password file");
+		strcpy(cfgerrorstring, "insufficient memory (malloc)");
+		return RC_ERROR;
+	}
+	i1 = (INT)fread(filebuffer, 1, filesize, cfgfile);
+	fclose(cfgfile);
+	if (i1 != filesize) {
+		free(filebuffer);
+		strcpy(cfgerrorstring, "error reading password file");
+		return RC_ERROR;
+	}
+	for (i1 = 0; i1 < filesize && (isspace(filebuffer[i1]) || filebuffer[i1] == '\n' || filebuffer[i1] == '\r'); i1++);
+	if (i1 < filesize && filebuffer[i1] == '<') {
+		xmlbuffer = getxmldata(filebuffer + i1, filesize - i1);
+		free(filebuffer);
+		if (xmlbuffer == NULL) return RC_ERROR;
+		for (element = xmlbuffer; element != NULL && (element->cdataflag || strcmp(element->tag, "dbcfspwd")); element = element->nextelement);
+		if (element == NULL) {
+			free(xmlbuffer);
+			strcpy(cfgerrorstring, "CFG file does not contain 'dbcfspwd' element");
 			return RC_ERROR;
 		}
-		for (i1 = 0; i1 < filesize && (isspace(filebuffer[i1]) || filebuffer[i1] == '\n' || filebuffer[i1] == '\r'); i1++);
-		if (i1 < filesize && filebuffer[i1] == '<') {
-			xmlbuffer = getxmldata(filebuffer + i1, filesize - i1);
-			free(filebuffer);
-			if (xmlbuffer == NULL) return RC_ERROR;
-			for (element = xmlbuffer; element != NULL && (element->cdataflag || strcmp(element->tag, "dbcfspwd")); element = element->nextelement);
-			if (element == NULL) {
-				free(xmlbuffer);
-				strcpy(cfgerrorstring, "CFG file does not contain 'dbcfspwd' element");
-				return RC_ERROR;
+		nextelement[0] = element->firstsubelement;
+		nextlevel = 0;
+		xmlflag = TRUE;
+	}
+	else {
+		nextoffset = length = 0;
+		xmlflag = FALSE;
+	}
+
+	rc = RC_ERROR;  /* assume error */
+	pwdstate = 0;
+	for (linecnt = 0; ; ) {
+		if (xmlflag) {
+			if (nextelement[nextlevel] == NULL) {
+				if (--nextlevel < 0) break;
+				if (pwdstate == 0x07) {
+					useraccess[i2] = '\0';
+					rc = 0;  /* set success */
+					break;
+				}
+				continue;
 			}
-			nextelement[0] = element->firstsubelement;
-			nextlevel = 0;
-			xmlflag = TRUE;
+			element = nextelement[nextlevel];
+			nextelement[nextlevel] = element->nextelement;
+			if (element->cdataflag) continue;
+			kw = element->tag;
+			if (element->firstsubelement != NULL && element->firstsubelement->cdataflag) val = element->firstsubelement->tag;
+			else val = "";
 		}
 		else {
-			nextoffset = length = 0;
-			xmlflag = FALSE;
-		}
-
-		rc = RC_ERROR;  /* assume error */
-		pwdstate = 0;
-		for (linecnt = 0; ; ) {
-			if (xmlflag) {
-				if (nextelement[nextlevel] == NULL) {
-					if (--nextlevel < 0) break;
-					if (pwdstate == 0x07) {
-						useraccess[i2] = '\0';
-						rc = 0;  /* set success */
-						break;
-					}
-					continue;
-				}
-				element = nextelement[nextlevel];
-				nextelement[nextlevel] = element->nextelement;
-				if (element->cdataflag) continue;
-				kw = element->tag;
-				if (element->firstsubelement != NULL && element->firstsubelement->cdataflag) val = element->firstsubelement->tag;
-				else val = "";
+			if (nextoffset >= length) {
+				if (nextoffset >= filesize) break;
+				for (length = nextoffset; length < filesize && filebuffer[length] != '\n' && filebuffer[length] != '\r'; length++);
+				if (filebuffer[length] == '\r' && filebuffer[length + 1] == '\n') filebuffer[length + 1] = ' ';
+				filebuffer[length] = '\0';
+				linecnt++;
 			}
-			else {
-				if (nextoffset >= length) {
-					if (nextoffset >= filesize) break;
-					for (length = nextoffset; length < filesize && filebuffer[length] != '\n' && filebuffer[length] != '\r'; length++);
-					if (filebuffer[length] == '\r' && filebuffer[length + 1] == '\n') filebuffer[length + 1] = ' ';
-					filebuffer[length] = '\0';
-					linecnt++;
-				}
-				i1 = getnextkwval(filebuffer + nextoffset, &kw, &val, &error);
-				if (i1 < 0) {
-					nextoffset = length;
-					continue;
-				}
-				nextoffset += i1;
-				i2 = 0;
+			i1 = getnextkwval(filebuffer + nextoffset, &kw, &val, &error);
+			if (i1 < 0) {
+				nextoffset = length;
+				continue;
 			}
-			if (!*kw) continue;
-			if (xmlflag) {
-				if (!strcmp(kw, "user")) {
-					if (nextlevel) {  /* invalid format */
-						nextlevel = 0;
-						continue;
-					}
-					nextelement[++nextlevel] = element->firstsubelement;
-					i2 = 0;
+			nextoffset += i1;
+			i2 = 0;
+		}
+		if (!*kw) continue;
+		if (xmlflag) {
+			if (!strcmp(kw, "user")) {
+				if (nextlevel) {  /* invalid format */
+					nextlevel = 0;
 					continue;
 				}
-				if (!nextlevel) continue;  /* invalid format */
-			}
-			if (!*val) continue;
-			if (!strcmp(kw, "name")) {
-				for (i1 = 0; val[i1]; i1++) val[i1] = (CHAR) toupper(val[i1]);
-				if (!strcmp(val, useraccess)) pwdstate |= 0x01;
-				else {
-					pwdstate = 0;
-					if (xmlflag) nextlevel--;
-				}
-			}
-			else if (!strcmp(kw, "password")) {
-				for (i1 = 0; val[i1]; i1++) val[i1] = (CHAR) toupper(val[i1]);
-				if (!strcmp(val, password)) pwdstate |= 0x02;
-				else {
-					pwdstate = 0;
-					if (xmlflag) nextlevel--;
-				}
+				nextelement[++nextlevel] = element->firstsubelement;
+				i2 = 0;
+				continue;
 			}
-			else if (!strcmp(kw, "access")) {
-				if (xmlflag || pwdstate == 0x03) {
-					/* fixup to be used by readdbdfile */
-					for (i1 = 0; val[i1]; i1++) {
-						if (isspace(val[i1])) continue;
-						if (val[i1] == ';') useraccess[i2++] = '\0';
-						else useraccess[i2++] = (CHAR) toupper(val[i1]);
-					}
-					useraccess[i2++] = '\0';
-					if (!xmlflag) {
-						useraccess[i2] = '\0';
-						rc = 0;  /* set success */
-						break;
-					}
-					pwdstate |= 0x04;
-				}
-				else pwdstate = 0;
+			if (!nextlevel) continue;  /* invalid format */
+		}
+		if (!*val) continue;
+		if (!strcmp(kw, "name")) {
+			for (i1 = 0; val[i1]; i1++) val[i1] = (CHAR) toupper(val[i1]);
+			if (!strcmp(val, useraccess)) pwdstate |= 0x01;
+			else {
+				pwdstate = 0;
+				if (xmlflag) nextlevel--;
 			}
+		}
+		else if (!strcmp(kw, "password")) {
+			for (i1 = 0; val[i1]; i1++) val[i1] = (CHAR) toupper(val[i1]);
+			if (!strcmp(val, password)) pwdstate |= 0x02;
 			else {
 				pwdstate = 0;
 				if (xmlflag) nextlevel--;
 			}
 		}
-		if (xmlflag) free(xmlbuffer);
-		else free(filebuffer);
-		if (rc == -1) strcpy(cfgerrorstring, "user access denied");
+		else if (!strcmp(kw, "access")) {
+			if (xmlflag || pwdstate == 0x03) {
+				/* fixup to be used by readdbdfile */
+				for (i1 = 0; val[i1]; i1++) {
+					if (isspace(val[i1])) continue;
+					if (val[i1] == ';') useraccess[i2++] = '\0';
+					else useraccess[i2++] = (CHAR) toupper(val[i1]);
+				}
+				useraccess[i2++] = '\0';
+				if (!xmlflag) {
+					useraccess[i2] = '\0';
+					rc = 0;  /* set success */
+					break;
+				}
+				pwdstate |= 0x04;
+			}
+			else pwdstate = 0;
+		}
+		else {
+			pwdstate = 0;
+			if (xmlflag) nextlevel--;
+		}
 	}
+	if (xmlflag) free(xmlbuffer);
+	else free(filebuffer);
+	if (rc == -1) strcpy(cfgerrorstring, "user access denied");
 	return rc;
 }
 
@@ -1256,6 +1411,7 @@ INT writedbdfile(CONNECTION *cnct) {
 	fprintf(dbd, "</dbcfsdbd>\n");
 	fflush(dbd);
 	fclose(dbd);
+	dbdcachekeylen = 0;  /* the parsed copy is out of date */
 #if OS_WIN32
 	/* copy temporary dbd over original, then delete the temporary dbd file */
 	if (CopyFile(work, found, FALSE) == 0) {
@@ -1280,6 +1436,585 @@ INT writedbdfile(CONNECTION *cnct) {
 	return 0;
 }
 
+/*
+ * The statistics file has the same name as the dbd file with a .sta
+ * extension. For each table analyzed there is a line
+ *   T <rows> <number of indexes> <table name>
+ * followed by a line for each of its indexes
+ *   I <distinct keys> <aim density>
+ * Other connections may have analyzed other tables since this one read the
+ * file, so the current file is merged while holding a lock on the file with
+ * the .lck extension: the tables analyzed by this connection replace their
+ * old lines, the lines of the other tables are kept. The result is written
+ * under a temporary name and renamed into place.
+ */
+INT writestatsfile(CONNECTION *cnct)
+{
+	INT i1, i2, i3, bufsize, bufalloc, keepflag;
+	CHAR work[MAX_NAMESIZE], lockname[MAX_NAMESIZE], record[512], num1[32], num2[32];
+	CHAR *buffer, *ptr;
+	FHANDLE lockhandle;
+	TABLE *tab1;
+	INDEX *idx1;
+	FILE *sta;
+
+	if (getstatsfilename(cnct, work) != 0) return RC_ERROR;
+	strcpy(lockname, work);
+	miofixname(lockname, ".lck", FIXNAME_EXT_REPLACE);
+	i1 = fioaopen(lockname, FIO_M_SHR, 0, &lockhandle);
+	if (i1 == ERR_FNOTF) {
+		if (!fioaopen(lockname, FIO_M_EOC, 1, &lockhandle)) fioaclose(lockhandle);
+		i1 = fioaopen(lockname, FIO_M_SHR, 0, &lockhandle);
+	}
+	if (!i1) {
+		i1 = fioalock(lockhandle, FIOA_FLLCK | FIOA_WRLCK, 0, 120);
+		if (i1) fioaclose(lockhandle);
+	}
+	if (i1) {
+		strcpy(cfgerrorstring, "lock of statistics file failed: ");
+		strcat(cfgerrorstring, fioerrstr(i1));
+		return RC_ERROR;
+	}
+
+	buffer = NULL;
+	bufsize = bufalloc = 0;
+	i1 = 0;
+	sta = fopen(work, "r");
+	if (sta != NULL) {
+		keepflag = FALSE;
+		while (!i1 && fgets(record, sizeof(record), sta) != NULL) {
+			if (record[0] == 'T' && record[1] == ' ') {
+				ptr = strchr(record + 2, ' ');
+				if (ptr != NULL) ptr = strchr(ptr + 1, ' ');
+				keepflag = (ptr != NULL);
+				if (keepflag) {
+					for (i2 = (INT) strlen(++ptr); i2 && (ptr[i2 - 1] == '\n' || ptr[i2 - 1] == '\r'); i2--);
+					for (i3 = 0; i3 < cnct->numtables; i3++) {
+						tab1 = *cnct->htablearray + i3;
+						if ((tab1->flags & TABLE_FLAGS_ANALYZED) && !strncmp(*cnct->nametable + tab1->name, ptr, i2)
+							&& !(*cnct->nametable)[tab1->name + i2]) break;
+					}
+					if (i3 < cnct->numtables) keepflag = FALSE;
+				}
+			}
+			else if (record[0] != 'I' || record[1] != ' ') continue;
+			if (keepflag) i1 = statsappend(&buffer, &bufsize, &bufalloc, record);
+		}
+		fclose(sta);
+	}
+	for (i2 = 0; !i1 && i2 < cnct->numtables; i2++) {
+		tab1 = *cnct->htablearray + i2;
+		if (!(tab1->flags & TABLE_FLAGS_ANALYZED) || (tab1->flags & TABLE_FLAGS_TEMPLATE)) continue;
+		mscofftoa(tab1->statrows, num1);
+		sprintf(record, "T %s %d %s\n", num1, tab1->numindexes, *cnct->nametable + tab1->name);
+		i1 = statsappend(&buffer, &bufsize, &bufalloc, record);
+		for (i3 = 0; !i1 && i3 < tab1->numindexes; i3++) {
+			idx1 = *tab1->hindexarray + i3;
+			mscofftoa(idx1->statdistinct, num2);
+			sprintf(record, "I %s %d\n", num2, idx1->statdensity);
+			i1 = statsappend(&buffer, &bufsize, &bufalloc, record);
+		}
+	}
+	if (!i1) i1 = fioasavefile(work, (UCHAR *) buffer, bufsize);
+	free(buffer);
+	fioalock(lockhandle, FIOA_FLLCK | FIOA_UNLCK, 0, 0);
+	fioaclose(lockhandle);
+	if (i1) {
+		strcpy(cfgerrorstring, "failure writing statistics file: ");
+		strcat(cfgerrorstring, fioerrstr(i1));
+		return RC_ERROR;
+	}
+	for (i2 = 0; i2 < cnct->numtables; i2++) (*cnct->htablearray + i2)->flags &= ~TABLE_FLAGS_ANALYZED;
+	return 0;
+}
+
+/*
+ * Append a line to the statistics being written, return ERR_NOMEM if out of memory
+ */
+static INT statsappend(CHAR **buffer, INT *bufsize, INT *bufalloc, CHAR *record)
+{
+	INT i1, i2;
+	CHAR *ptr;
+
+	i1 = (INT) strlen(record);
+	if (*bufsize + i1 + 1 > *bufalloc) {
+		for (i2 = (*bufalloc) ? *bufalloc << 1 : 4096; *bufsize + i1 + 1 > i2; i2 <<= 1);
+		ptr = (CHAR *) realloc(*buffer, i2);
+		if (ptr == NULL) return ERR_NOMEM;
+		*buffer = ptr;
+		*bufalloc = i2;
+	}
+	memcpy(*buffer + *bufsize, record, i1);
+	*bufsize += i1;
+	if (!i1 || record[i1 - 1] != '\n') (*buffer)[(*bufsize)++] = '\n';
+	return 0;
+}
+
+/*
+ * Load the statistics saved by the last ANALYZE, if any. Tables whose
+ * number of indexes has changed since then are left without statistics.
+ */
+static void readstatsfile(CONNECTION *cnct)
+{
+	INT i1, indexnum, numindexes;
+	CHAR work[MAX_NAMESIZE], record[512], *ptr;
+	OFFSET off;
+	TABLE *tab1;
+	INDEX *idx1;
+	FILE *sta;
+
+	if (getstatsfilename(cnct, work) != 0) {
+		cfgerrorstring[0] = '\0';
+		return;
+	}
+	sta = fopen(work, "r");
+	if (sta == NULL) return;
+	tab1 = NULL;
+	indexnum = 0;
+	while (fgets(record, sizeof(record), sta) != NULL) {
+		for (i1 = (INT) strlen(record); i1 && (record[i1 - 1] == '\n' || record[i1 - 1] == '\r'); ) record[--i1] = '\0';
+		if (record[0] == 'T' && record[1] == ' ') {
+			tab1 = NULL;
+			ptr = strchr(record + 2, ' ');
+			if (ptr == NULL) continue;
+			*ptr = '\0';
+			mscatooff(record + 2, &off);
+			numindexes = (INT) strtol(ptr + 1, &ptr, 10);
+			if (*ptr++ != ' ') continue;
+			for (i1 = 0; i1 < cnct->numtables; i1++) {
+				if (!strcmp(*cnct->nametable + (*cnct->htablearray)[i1].name, ptr)) break;
+			}
+			if (i1 == cnct->numtables) continue;
+			tab1 = *cnct->htablearray + i1;
+			if (tab1->numindexes != numindexes || (tab1->flags & TABLE_FLAGS_TEMPLATE)) {
+				tab1 = NULL;
+				continue;
+			}
+			tab1->statrows = off;
+			tab1->flags |= TABLE_FLAGS_STATS;
+			indexnum = 0;
+		}
+		else if (record[0] == 'I' && record[1] == ' ' && tab1 != NULL && indexnum < tab1->numindexes) {
+			ptr = strchr(record + 2, ' ');
+			if (ptr == NULL) continue;
+			*ptr = '\0';
+			idx1 = *tab1->hindexarray + indexnum++;
+			mscatooff(record + 2, &idx1->statdistinct);
+			idx1->statdensity = (INT) strtol(ptr + 1, NULL, 10);
+		}
+	}
+	fclose(sta);
+}
+
+static INT getstatsfilename(CONNECTION *cnct, CHAR *filename)
+{
+	CHAR *found;
+
+	strcpy(filename, *cnct->dbdfilename);
+	miofixname(filename, ".dbd", FIXNAME_EXT_ADD);
+	found = NULL;
+	fiofindfirst(filename, FIO_P_DBD, &found);
+	if (found == NULL) {
+		strcpy(cfgerrorstring, "DBD file not found");
+		return RC_ERROR;
+	}
+	strcpy(filename, found);
+	miofixname(filename, ".sta", FIXNAME_EXT_REPLACE);
+	return 0;
+}
+
+/*
+ * Build the key that the parsed cfg is cached under. It is the name, change time
+ * and size of the cfg file and whether it is parsed for a database connection.
+ * Return the length of the key, zero if the cfg can not be cached
+ */
+static INT getcfgcachekey(CHAR *cfgfile, CONNECTION *cnct, CHAR *key)
+{
+	INT i1;
+	LONG filesize;
+	FILE *f1;
+
+	i1 = (INT) strlen(cfgfile) + 1;
+	if (i1 > MAX_NAMESIZE) return 0;
+	memcpy(key, cfgfile, i1);
+	if (miogetfilechgtime(cfgfile, (UCHAR *) key + i1) < 0) return 0;
+	i1 += 16;
+	f1 = fopen(cfgfile, "rb");
+	if (f1 == NULL) return 0;
+	fseek(f1, 0, 2);
+	filesize = (LONG) ftell(f1);
+	fclose(f1);
+	memcpy(key + i1, (CHAR *) &filesize, sizeof(LONG));
+	i1 += sizeof(LONG);
+	key[i1++] = (cnct != NULL) ? 'D' : 'F';
+	return i1;
+}
+
+/*
+ * Restore what was parsed from the cfg file by an earlier client of this pool
+ * worker, if it was parsed under the same key.
+ * Return 1 if restored, 0 if the cfg must be parsed, RC_ERROR if out of memory
+ */
+static INT cfgcacheload(CHAR *key, INT keylen, CHAR *pwdfile, INT *memallocsize, FIOPARMS *fioparms, CONNECTION *cnct)
+{
+	CHAR *ptr;
+
+	if (keylen != cfgcachekeylen || memcmp(key, cfgcachekey, keylen)) return 0;
+	ptr = (CHAR *)(cfgcache + 1);
+	if (cfgcache->volumesize) {
+		cfgvolumes = (CFGVOLUME *) malloc(cfgcache->volumesize);
+		if (cfgvolumes == NULL) goto nomem;
+		memcpy((CHAR *) cfgvolumes, ptr, cfgcache->volumesize);
+		ptr += cfgcache->volumesize;
+	}
+	if (cfgcache->lognamessize) {
+		lognames = (CHAR *) malloc(cfgcache->lognamessize);
+		if (lognames == NULL) goto nomem;
+		memcpy(lognames, ptr, cfgcache->lognamessize);
+	}
+	cfgvolumesize = cfgcache->volumesize;
+	lastcfgvolume = cfgcache->lastcfgvolume;
+	*fioparms = cfgcache->fioparms;
+	*memallocsize = cfgcache->memallocsize;
+	if (cnct != NULL) {
+		cnct->updatelock = cfgcache->updatelock;
+		cnct->deletelock = cfgcache->deletelock;
+		cnct->memresultsize = cfgcache->memresultsize;
+		cnct->scanthreads = cfgcache->scanthreads;
+	}
+	sqlstatisticsflag = cfgcache->sqlstatisticsflag;
+	logallfiles = cfgcache->logallfiles;
+	logfilenames = cfgcache->logfilenames;
+	logopenclose = cfgcache->logopenclose;
+	logtimestamp = cfgcache->logtimestamp;
+	logusername = cfgcache->logusername;
+	strcpy(workdir, cfgcache->workdir);
+	strcpy(pwdfile, cfgcache->pwdfile);
+	return 1;
+
+nomem:
+	strcpy(cfgerrorstring, "insufficient memory (malloc)");
+	return RC_ERROR;
+}
+
+/*
+ * Keep a copy of what was just parsed from the cfg file for the next client of this pool worker
+ */
+static void cfgcachesave(CHAR *key, INT keylen, CHAR *pwdfile, INT memallocsize, FIOPARMS *fioparms, CONNECTION *cnct)
+{
+	INT i1;
+	CHAR *ptr;
+
+	i1 = 0;
+	if (lognames != NULL) {
+		while (lognames[i1]) i1 += (INT) strlen(lognames + i1) + 1;
+		i1++;
+	}
+	cfgcachekeylen = 0;
+	free(cfgcache);
+	cfgcache = (CFGCACHE *) malloc(sizeof(CFGCACHE) + cfgvolumesize + i1);
+	if (cfgcache == NULL) return;  /* out of memory, nothing cached */
+	memset(cfgcache, 0, sizeof(CFGCACHE));
+	cfgcache->fioparms = *fioparms;
+	cfgcache->fioparms.cvtvolfnc = NULL;
+	cfgcache->memallocsize = memallocsize;
+	if (cnct != NULL) {
+		cfgcache->updatelock = cnct->updatelock;
+		cfgcache->deletelock = cnct->deletelock;
+		cfgcache->memresultsize = cnct->memresultsize;
+		cfgcache->scanthreads = cnct->scanthreads;
+	}
+	cfgcache->sqlstatisticsflag = sqlstatisticsflag;
+	cfgcache->logallfiles = logallfiles;
+	cfgcache->logfilenames = logfilenames;
+	cfgcache->logopenclose = logopenclose;
+	cfgcache->logtimestamp = logtimestamp;
+	cfgcache->logusername = logusername;
+	cfgcache->lastcfgvolume = lastcfgvolume;
+	cfgcache->volumesize = cfgvolumesize;
+	cfgcache->lognamessize = i1;
+	strcpy(cfgcache->workdir, workdir);
+	strcpy(cfgcache->pwdfile, pwdfile);
+	ptr = (CHAR *)(cfgcache + 1);
+	if (cfgvolumesize) memcpy(ptr, (CHAR *) cfgvolumes, cfgvolumesize);
+	if (i1) memcpy(ptr + cfgvolumesize, lognames, i1);
+	memcpy(cfgcachekey, key, keylen);
+	cfgcachekeylen = keylen;
+}
+
+/*
+ * Build the key that the parsed dbd is cached under. It is the full name, size and
+ * change time of the dbd file, the name and change time of the cfg file (the cfg
+ * volumes are used while parsing the dbd) and the user access codes.
+ * Return the length of the key, zero if the dbd can not be cached
+ */
+static INT getdbdcachekey(CHAR *cfgfile, CHAR *dbdfile, CHAR *useraccess, CHAR *key)
+{
+	INT i1, i2, filenum;
+	OFFSET filesize;
+	CHAR work[MAX_NAMESIZE], *ptr;
+
+	strcpy(work, dbdfile);
+	miofixname(work, ".dbd", FIXNAME_EXT_ADD);
+	filenum = fioopen(work, FIO_M_SRO | FIO_P_DBD);
+	if (filenum < 0) return 0;
+	ptr = fioname(filenum);
+	if (ptr == NULL || fiogetsize(filenum, &filesize)) {
+		fioclose(filenum);
+		return 0;
+	}
+	i1 = (INT) strlen(ptr) + 1;
+	memcpy(key, ptr, i1);
+	fioclose(filenum);
+	if (miogetfilechgtime(key, (UCHAR *) key + i1) < 0) return 0;
+	i1 += 16;
+	memcpy(key + i1, (CHAR *) &filesize, sizeof(OFFSET));
+	i1 += sizeof(OFFSET);
+
+	i2 = (INT) strlen(cfgfile) + 1;
+	if (i2 > MAX_NAMESIZE) return 0;
+	memcpy(key + i1, cfgfile, i2);
+	if (miogetfilechgtime(cfgfile, (UCHAR *) key + i1 + i2) < 0) return 0;
+	i1 += i2 + 16;
+
+	for (i2 = 0; useraccess[i2]; i2 += (INT) strlen(useraccess + i2) + 1);
+	if (i1 + i2 + 1 > (INT) sizeof(dbdcachekey)) return 0;
+	memcpy(key + i1, useraccess, i2 + 1);
+	return i1 + i2 + 1;
+}
+
+/*
+ * Restore the dbd parsed by an earlier client of this pool worker, if it was
+ * parsed under the same key. The memory of that client is gone, so everything
+ * is copied back into newly allocated memory and the handles are set to it.
+ * Return 1 if restored, 0 if the dbd must be read, RC_ERROR if out of memory
+ */
+static INT dbdcacheload(CHAR *key, INT keylen, CONNECTION *cnct)
+{
+	INT i1, i2, i3, tablenum;
+	CHAR *ptr, **hmem;
+	TABLE tab1;
+	COLUMN col1;
+	INDEX idx1;
+
+	if (keylen != dbdcachekeylen || memcmp(key, dbdcachekey, keylen)) return 0;
+	dbdcachepos = 0;
+	strcpy(dbdaccess, (CHAR *) dbdcacheget((INT) strlen((CHAR *) dbdcache + dbdcachepos) + 1));
+	strcpy(workdir, (CHAR *) dbdcacheget((INT) strlen((CHAR *) dbdcache + dbdcachepos) + 1));
+	strcpy(filepath, (CHAR *) dbdcacheget((INT) strlen((CHAR *) dbdcache + dbdcachepos) + 1));
+	for (i1 = 0; i1 < 2; i1++) {
+		ptr = (CHAR *) dbdcacheget((INT) strlen((CHAR *) dbdcache + dbdcachepos) + 1);
+		if (*ptr) fiosetopt((i1) ? FIO_OPT_PREPPATH : FIO_OPT_OPENPATH, (UCHAR *) ptr);
+	}
+
+	memcpy((CHAR *) &i2, dbdcacheget(sizeof(INT)), sizeof(INT));
+	if (i2) {
+		volumes = (VOLUME **) memalloc(i2 * sizeof(VOLUME), 0);
+		if (volumes == NULL) goto nomem;
+		volalloc = i2;
+		for (volcount = 0; volcount < i2; volcount++) {
+			if (dbdcachegetmem((UCHAR ***) &hmem) < 0) goto nomem;
+			memcpy((*volumes)[volcount].volume, dbdcacheget(MAX_VOLUMESIZE + 1), MAX_VOLUMESIZE + 1);
+			(*volumes)[volcount].path = hmem;
+		}
+	}
+
+	memcpy((CHAR *) &cnct->numtables, dbdcacheget(sizeof(INT)), sizeof(INT));
+	cnct->numalltables = cnct->numtables;
+	memcpy((CHAR *) &cnct->maxtablename, dbdcacheget(sizeof(INT)), sizeof(INT));
+	memcpy((CHAR *) &cnct->maxtableindex, dbdcacheget(sizeof(INT)), sizeof(INT));
+	memcpy((CHAR *) &cnct->maxtableremarks, dbdcacheget(sizeof(INT)), sizeof(INT));
+	memcpy((CHAR *) &cnct->maxcolumnname, dbdcacheget(sizeof(INT)), sizeof(INT));
+	memcpy((CHAR *) &cnct->maxcolumnremarks, dbdcacheget(sizeof(INT)), sizeof(INT));
+	memcpy((CHAR *) &cnct->nametablesize, dbdcacheget(sizeof(INT)), sizeof(INT));
+	memcpy((CHAR *) &cnct->nametablealloc, dbdcacheget(sizeof(INT)), sizeof(INT));
+	if (dbdcachegetmem((UCHAR ***) &cnct->nametable) < 0) goto nomem;
+	if (dbdcachegetmem((UCHAR ***) &cnct->dbdfilename) < 0) goto nomem;
+	if (dbdcachegetarray((UCHAR ***) &cnct->htablearray, sizeof(TABLE), &i2) < 0) goto nomem;
+
+	for (tablenum = 0; tablenum < i2; tablenum++) {
+		memcpy((CHAR *) &tab1, dbdcacheget(sizeof(TABLE)), sizeof(TABLE));
+		if (dbdcachegetarray((UCHAR ***) &tab1.hcolumnarray, sizeof(COLUMN), &i1) < 0) goto nomem;
+		for (i3 = 0; i3 < i1; i3++) {
+			memcpy((CHAR *) &col1, dbdcacheget(sizeof(COLUMN)), sizeof(COLUMN));
+			if (dbdcachegetmem((UCHAR ***) &col1.hdbdproparray) < 0) goto nomem;
+			*(*tab1.hcolumnarray + i3) = col1;
+		}
+		if (dbdcachegetarray((UCHAR ***) &tab1.hindexarray, sizeof(INDEX), &i1) < 0) goto nomem;
+		for (i3 = 0; i3 < i1; i3++) {
+			memcpy((CHAR *) &idx1, dbdcacheget(sizeof(INDEX)), sizeof(INDEX));
+			if (dbdcachegetmem((UCHAR ***) &idx1.hkeys) < 0) goto nomem;
+			if (dbdcachegetmem((UCHAR ***) &idx1.hcolkeys) < 0) goto nomem;
+			*(*tab1.hindexarray + i3) = idx1;
+		}
+		if (dbdcachegetmem((UCHAR ***) &tab1.hdbdproparray) < 0) goto nomem;
+		*(*cnct->htablearray + tablenum) = tab1;
+	}
+	return 1;
+
+nomem:
+	strcpy(cfgerrorstring, "insufficient memory");
+	return RC_ERROR;
+}
+
+/*
+ * Keep a copy of the dbd that was just parsed for the next client of this pool worker.
+ * The memory of this client does not outlive it, so the TABLE, COLUMN and INDEX entries
+ * are kept with their handles cleared and the contents of each handle follow the entry
+ */
+static void dbdcachesave(CHAR *key, INT keylen, CONNECTION *cnct)
+{
+	INT i1, i2, tablenum;
+	UCHAR **pptr;
+	TABLE tab1, *tab2;
+	COLUMN col1;
+	INDEX idx1;
+
+	dbdcachekeylen = dbdcachesize = 0;
+	dbdcacheput(dbdaccess, (INT) strlen(dbdaccess) + 1);
+	dbdcacheput(workdir, (INT) strlen(workdir) + 1);
+	dbdcacheput(filepath, (INT) strlen(filepath) + 1);
+	for (i1 = 0; i1 < 2; i1++) {
+		pptr = fiogetopt((i1) ? FIO_OPT_PREPPATH : FIO_OPT_OPENPATH);
+		if (pptr != NULL) dbdcacheput(*pptr, (INT) strlen((CHAR *) *pptr) + 1);
+		else dbdcacheput("", 1);
+	}
+
+	dbdcacheput(&volcount, sizeof(INT));
+	for (i1 = 0; i1 < volcount; i1++) {
+		dbdcacheputmem((UCHAR **)(*volumes)[i1].path, (INT) strlen(*(*volumes)[i1].path) + 1);
+		dbdcacheput((*volumes)[i1].volume, MAX_VOLUMESIZE + 1);
+	}
+
+	dbdcacheput(&cnct->numtables, sizeof(INT));
+	dbdcacheput(&cnct->maxtablename, sizeof(INT));
+	dbdcacheput(&cnct->maxtableindex, sizeof(INT));
+	dbdcacheput(&cnct->maxtableremarks, sizeof(INT));
+	dbdcacheput(&cnct->maxcolumnname, sizeof(INT));
+	dbdcacheput(&cnct->maxcolumnremarks, sizeof(INT));
+	dbdcacheput(&cnct->nametablesize, sizeof(INT));
+	dbdcacheput(&cnct->nametablealloc, sizeof(INT));
+	dbdcacheputmem((UCHAR **) cnct->nametable, cnct->nametablealloc);
+	dbdcacheputmem((UCHAR **) cnct->dbdfilename, (INT) strlen(*cnct->dbdfilename) + 1);
+	dbdcacheputarray((UCHAR **) cnct->htablearray, cnct->numtables);
+	i2 = (cnct->htablearray != NULL) ? cnct->numtables : 0;
+	for (tablenum = 0; tablenum < i2; tablenum++) {
+		tab2 = *cnct->htablearray + tablenum;
+		tab1 = *tab2;
+		tab1.hcolumnarray = NULL;
+		tab1.hindexarray = NULL;
+		tab1.hdbdproparray = NULL;
+		tab1.lastopenfilenum = tab1.lockcount = tab1.lockhandle = 0;
+		dbdcacheput(&tab1, sizeof(TABLE));
+		dbdcacheputarray((UCHAR **) tab2->hcolumnarray, tab2->numcolumns);
+		for (i1 = 0; tab2->hcolumnarray != NULL && i1 < tab2->numcolumns; i1++) {
+			col1 = *(*tab2->hcolumnarray + i1);
+			col1.hdbdproparray = NULL;
+			dbdcacheput(&col1, sizeof(COLUMN));
+			dbdcacheputmem((UCHAR **)(*tab2->hcolumnarray + i1)->hdbdproparray, col1.numdbdprops * sizeof(DBDPROP));
+		}
+		dbdcacheputarray((UCHAR **) tab2->hindexarray, tab2->numindexes);
+		for (i1 = 0; tab2->hindexarray != NULL && i1 < tab2->numindexes; i1++) {
+			idx1 = *(*tab2->hindexarray + i1);
+			idx1.hkeys = NULL;
+			idx1.hcolkeys = NULL;
+			dbdcacheput(&idx1, sizeof(INDEX));
+			dbdcacheputmem((UCHAR **)(*tab2->hindexarray + i1)->hkeys, idx1.numkeys * sizeof(IDXKEY));
+			dbdcacheputmem((UCHAR **)(*tab2->hindexarray + i1)->hcolkeys, idx1.numcolkeys * sizeof(COLKEY));
+		}
+		dbdcacheputmem((UCHAR **) tab2->hdbdproparray, tab2->numdbdprops * sizeof(DBDPROP));
+	}
+	if (dbdcachesize < 0) return;  /* out of memory, nothing cached */
+	memcpy(dbdcachekey, key, keylen);
+	dbdcachekeylen = keylen;
+}
+
+/*
+ * Append to the dbd cache, return RC_ERROR if out of memory
+ */
+static INT dbdcacheput(void *data, INT size)
+{
+	INT i1;
+	UCHAR *ptr;
+
+	if (dbdcachesize < 0) return RC_ERROR;
+	if (dbdcachesize + size > dbdcachealloc) {
+		for (i1 = (dbdcachealloc) ? dbdcachealloc << 1 : 65536; dbdcachesize + size > i1; i1 <<= 1);
+		ptr = (UCHAR *) realloc(dbdcache, i1);
+		if (ptr == NULL) {
+			dbdcachesize = -1;
+			return RC_ERROR;
+		}
+		dbdcache = ptr;
+		dbdcachealloc = i1;
+	}
+	memcpy(dbdcache + dbdcachesize, data, size);
+	dbdcachesize += size;
+	return 0;
+}
+
+/*
+ * Append the contents of a memalloc buffer to the dbd cache, hmem may be NULL
+ */
+static INT dbdcacheputmem(UCHAR **hmem, INT size)
+{
+	if (hmem == NULL) size = -1;
+	if (dbdcacheput(&size, sizeof(INT)) < 0) return RC_ERROR;
+	if (size <= 0) return 0;
+	return dbdcacheput(*hmem, size);
+}
+
+/*
+ * Start an array of count entries in the dbd cache, the entries are put by the caller.
+ * The handle of the array may be NULL
+ */
+static INT dbdcacheputarray(UCHAR **hmem, INT count)
+{
+	if (hmem == NULL) count = -1;
+	return dbdcacheput(&count, sizeof(INT));
+}
+
+static UCHAR *dbdcacheget(INT size)
+{
+	dbdcachepos += size;
+	return dbdcache + dbdcachepos - size;
+}
+
+/*
+ * Allocate a memalloc buffer and copy the next entry of the dbd cache into it
+ */
+static INT dbdcachegetmem(UCHAR ***hmem)
+{
+	INT size;
+
+	memcpy((CHAR *) &size, dbdcacheget(sizeof(INT)), sizeof(INT));
+	if (size < 0) {
+		*hmem = NULL;
+		return 0;
+	}
+	*hmem = memalloc(size, 0);
+	if (*hmem == NULL) return RC_ERROR;
+	memcpy(**hmem, dbdcacheget(size), size);
+	return 0;
+}
+
+/*
+ * Allocate a memalloc buffer for the next array of the dbd cache, the entries are
+ * copied into it by the caller. Set count to the number of entries
+ */
+static INT dbdcachegetarray(UCHAR ***hmem, INT size, INT *count)
+{
+	memcpy((CHAR *) count, dbdcacheget(sizeof(INT)), sizeof(INT));
+	if (*count < 0) {
+		*hmem = NULL;
+		*count = 0;
+		return 0;
+	}
+	*hmem = memalloc(*count * size, 0);
+	if (*hmem == NULL) return RC_ERROR;
+	return 0;
+}
+
 static int readdbdfile(CHAR *dbdfilename, CHAR *useraccess, CONNECTION *cnct)
 {
 	INT i1, i2, i3, accessflag, coloffset, tablealloc, columnalloc;
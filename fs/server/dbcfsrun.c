@@ -108,6 +108,10 @@ typedef struct timeval TIMEVAL;
 #define MSGFUNC_SIZE		128
 #define MSGFUNC_RENAME		129
 #define MSGFUNC_COMMAND		130
+#define MSGFUNC_PREPARE		131
+#define MSGFUNC_EXECPREP	132
+#define MSGFUNC_FREESTMT	133
+#define MSGFUNC_LOAD		134
 
 #define MSGDATASIZE ((4 * 65536) + 1024)
 
@@ -139,6 +143,9 @@ static UCHAR *msgindata = tcpbuffer + 40;
 static UCHAR *msgoutdata = tcpbuffer + 24;
 static int rc;
 static FILE *outputfile;
+static INT getrowserrfsid;			/* result set whose last GETROWS stopped on an error, 0 if none */
+static CHAR getrowserrcode[5];		/* sql code and message of that error */
+static CHAR getrowserrtext[512];
 
 #if OS_WIN32
 static HANDLE shutdownevent = NULL;
@@ -167,8 +174,13 @@ static int dodisconnect(int);
 static int docatalog(void);
 static int doexecnone(void);
 static int doexecute(void);
+static int doprepare(void);
+static int doexecprep(void);
+static int dofreestmt(void);
+static int doload(void);
 static INT dorowcount(void);
 static int dogetrow(void);
+static int dogetrows(void);
 static int dopsupdate(void);
 static int dopsdelete(void);
 static int dodiscard(void);
@@ -178,6 +190,7 @@ static int doclose(void);
 static int dofposit(void);
 static int doreposit(void);
 static int doread(void);
+static int doreadahead(void);
 static int dowrite(void);
 static int doinsert(void);
 static int doupdate(void);
@@ -198,6 +211,7 @@ static void debug2(char *, int);
 static void debug2s(char *, char *);
 static void death1(char *);
 static void death2(char *, int);
+static INT runclient(INT, CHAR **);
 
 #if OS_WIN32
 static BOOL sigevent(DWORD);
@@ -205,21 +219,17 @@ static BOOL sigevent(DWORD);
 
 #if OS_UNIX
 static void sigevent(int);
+static INT poolmain(INT, INT);
+static INT poolread(INT, UCHAR *, INT);
+static void poolreset(void);
 #endif
 
 
 /* start of program */
 INT main(INT argc, CHAR **argv)
 {
-	INT i1, i2, i3, portnum, ppid, recvbufpos, sportflag, timeoutcnt;
-	time_t timer1;
-	CHAR work[256], *ptr;
-	SOCKET workhandle;
-#if OS_WIN32
-	WSADATA versioninfo;
-#endif
 #if OS_UNIX
-	struct sigaction act;
+	INT i1, poolhandle, poolrecycle;
 #endif
 
 	if (argc < 5) {
@@ -228,12 +238,44 @@ INT main(INT argc, CHAR **argv)
 			fputs("\n", stdout);
 			exit(0);
 		}
+#if OS_UNIX
+		/* argv[1] = -pool=<socket handle>:<recycle count> when started as a pool worker */
+		if (argc >= 2 && !strncmp(argv[1], "-pool=", 6)) {
+			for (i1 = 6, poolhandle = 0; isdigit(argv[1][i1]); i1++) poolhandle = poolhandle * 10 + argv[1][i1] - '0';
+			poolrecycle = 0;
+			if (argv[1][i1] == ':')
+				for (i1++; isdigit(argv[1][i1]); i1++) poolrecycle = poolrecycle * 10 + argv[1][i1] - '0';
+			fsflags |= FSFLAGS_POOL;
+			return poolmain(poolhandle, poolrecycle);
+		}
+#endif
 		fputs("Too few command line parameters", stdout);
 		exit(1);
 	}
+	return runclient(argc, argv);
+}
+
+/*
+ * Service one client, the arguments are those passed by dbcfs on the command line
+ */
+static INT runclient(INT argc, CHAR **argv)
+{
+	INT i1, i2, i3, portnum, ppid, recvbufpos, sportflag, timeoutcnt;
+	time_t timer1;
+	CHAR work[256], *ptr;
+	SOCKET workhandle;
+	MEMSTATS memstat;
+#if OS_WIN32
+	WSADATA versioninfo;
+#endif
+#if OS_UNIX
+	struct sigaction act;
+#endif
 
+	fsflags &= FSFLAGS_POOL;
 	sportflag = FALSE;
 	tcpflags = TCP_UTF8;
+	logfilename = "";
 	outputfile = NULL;
 	/* argv[1] = client address */
 	/* argv[2] = client port number or dbcfsrun port number if sport */
@@ -608,6 +650,12 @@ INT main(INT argc, CHAR **argv)
 		recvbufpos = 0;
 	}
 	if (sqlconnection || fileconnection) dodisconnect(FALSE);
+	if (fsflags & FSFLAGS_DEBUG2) {
+		memstats(&memstat);
+		sprintf(work, "memory: compactions=%u partial=%u moved=%lu stall=%luus maxstall=%uus holefills=%u",
+			memstat.compacts, memstat.partials, memstat.bytesmoved, memstat.stalltime, memstat.maxstall, memstat.holefills);
+		debug1(work);
+	}
 	if (tcpflags & TCP_SSL) tcpsslcomplete(sockethandle);
 	closesocket(sockethandle);
 #if OS_WIN32
@@ -621,9 +669,96 @@ INT main(INT argc, CHAR **argv)
 	if (oldsighup.sa_handler != SIG_IGN) sigaction(SIGHUP, &oldsighup, NULL);
 	sigaction(SIGPIPE, &oldsigpipe, NULL);
 #endif
+	if (outputfile != stdout) fclose(outputfile);
+	sockethandle = INVALID_SOCKET;
+	return 0;
+}
+
+#if OS_UNIX
+/*
+ * Run as a pre-started dbcfs pool worker. Each assignment from dbcfs is an
+ * 8 byte length followed by the command line that would otherwise have been
+ * used to exec dbcfsrun. After each client, write one byte back so that dbcfs
+ * returns this worker to the idle list. Exit after poolrecycle clients or
+ * when dbcfs closes the socket.
+ */
+static INT poolmain(INT poolhandle, INT poolrecycle)
+{
+	INT i1, i2, i3, argc, len, poolcnt;
+	CHAR cmdline[1024], *argv[32];
+
+	for (poolcnt = 0; ; ) {
+		if (poolread(poolhandle, (UCHAR *) cmdline, 8)) break;
+		if (tcpntoi((UCHAR *) cmdline, 8, &len) || len <= 0 || len >= (INT) sizeof(cmdline)) break;
+		if (poolread(poolhandle, (UCHAR *) cmdline, len)) break;
+		cmdline[len] = '\0';
+		for (i1 = argc = 0; i1 < len; i1++) {
+			if (isspace(cmdline[i1])) continue;
+			if (argc == 31) break;
+			argv[argc++] = cmdline + i1;
+			for (i2 = i1, i3 = FALSE; cmdline[i1] && (!isspace(cmdline[i1]) || i3); i1++) {
+				if (cmdline[i1] == '"') {
+					i3 = !i3;
+					continue;
+				}
+				if (cmdline[i1] == '\\' && (cmdline[i1 + 1] == '"' || cmdline[i1 + 1] == '\\')) i1++;
+				cmdline[i2++] = cmdline[i1];
+			}
+			cmdline[i2] = '\0';
+		}
+		argv[argc] = NULL;
+		if (argc < 5) break;
+		runclient(argc, argv);
+		poolreset();
+		if (poolrecycle && ++poolcnt >= poolrecycle) break;
+		if (write(poolhandle, "I", 1) != 1) break;
+	}
+	close(poolhandle);
 	return 0;
 }
 
+/*
+ * Reset everything kept for the client just serviced, so that none of it is seen
+ * by the next client of this pool worker. Only the cfg and dbd caches of dbcfscfg.c
+ * are kept, they are checked against the files at the next connect
+ */
+static void poolreset()
+{
+	if (sqlconnection || fileconnection) dodisconnect(FALSE);
+	sqlreset();
+	filereset();
+	connectid = 0;
+	sqlconnection = fileconnection = FALSE;
+	keepaliveflag = keepalivecnt = keepaliveretry = 0;
+	usernum = 0;
+	certificatefilename[0] = '\0';
+	memset(msgid, 0, sizeof(msgid));
+	msgfunc = msgfunc1 = msgfunc2 = 0;
+	msgcnid = msgfsid = msgdatasize = rc = 0;
+	getrowserrfsid = 0;
+	fsflags &= FSFLAGS_POOL;
+}
+
+/*
+ * Read exactly len bytes from the dbcfs pool socket, return -1 on end of file or error
+ */
+static INT poolread(INT handle, UCHAR *buffer, INT len)
+{
+	INT i1;
+
+	while (len > 0) {
+		i1 = (INT) read(handle, buffer, len);
+		if (i1 <= 0) {
+			if (i1 == -1 && errno == EINTR) continue;
+			return -1;
+		}
+		buffer += i1;
+		len -= i1;
+	}
+	return 0;
+}
+#endif
+
 static void clearbuffer()
 {
 	int i1;
@@ -723,11 +858,13 @@ static void processmsg(void)
 	case 'E':
 		if (!memcmp(tcpbuffer + 24, "EXECUTE ", 8)) msgfunc = MSGFUNC_EXECUTE;
 		else if (!memcmp(tcpbuffer + 24, "EXECNONE", 8)) msgfunc = MSGFUNC_EXECNONE;
+		else if (!memcmp(tcpbuffer + 24, "EXECPREP", 8)) msgfunc = MSGFUNC_EXECPREP;
 		break;
 	case 'F':
 		if (!memcmp(tcpbuffer + 24, "FLOCK   ", 8)) msgfunc = MSGFUNC_FLOCK;
 		else if (!memcmp(tcpbuffer + 24, "FUNLOCK ", 8)) msgfunc = MSGFUNC_FUNLOCK;
 		else if (!memcmp(tcpbuffer + 24, "FPOSIT  ", 8)) msgfunc = MSGFUNC_FPOSIT;
+		else if (!memcmp(tcpbuffer + 24, "FREESTMT", 8)) msgfunc = MSGFUNC_FREESTMT;
 		break;
 	case 'G':
 		if (!memcmp(tcpbuffer + 24, "GETROWCT", 8)) msgfunc = MSGFUNC_GETROWCOUNT;
@@ -741,6 +878,9 @@ static void processmsg(void)
 	case 'I':
 		if (!memcmp(tcpbuffer + 24, "INSERT  ", 8)) msgfunc = MSGFUNC_INSERT;
 		break;
+	case 'L':
+		if (!memcmp(tcpbuffer + 24, "LOAD    ", 8)) msgfunc = MSGFUNC_LOAD;
+		break;
 	case 'O':
 		if (!memcmp(tcpbuffer + 24, "OPEN", 4)) {
 			msgfunc = MSGFUNC_OPEN;
@@ -751,6 +891,7 @@ static void processmsg(void)
 	case 'P':
 		if (!memcmp(tcpbuffer + 24, "PSUPDATE", 8)) msgfunc = MSGFUNC_PSUPDATE;
 		else if (!memcmp(tcpbuffer + 24, "PSDELETE", 8)) msgfunc = MSGFUNC_PSDELETE;
+		else if (!memcmp(tcpbuffer + 24, "PREPARE ", 8)) msgfunc = MSGFUNC_PREPARE;
 		break;
 	case 'R':
 		if (!memcmp(tcpbuffer + 24, "READ", 4)) {
@@ -809,6 +950,18 @@ static void processmsg(void)
 		case MSGFUNC_EXECUTE:
 			rc = doexecute();
 			break;
+		case MSGFUNC_PREPARE:
+			rc = doprepare();
+			break;
+		case MSGFUNC_EXECPREP:
+			rc = doexecprep();
+			break;
+		case MSGFUNC_FREESTMT:
+			rc = dofreestmt();
+			break;
+		case MSGFUNC_LOAD:
+			rc = doload();
+			break;
 		case MSGFUNC_GETROWCOUNT:
 			rc = dorowcount();
 			break;
@@ -1320,6 +1473,69 @@ static int doexecute(void)
 	return 0;
 }
 
+/**
+ * PREPARE: compile a statement for repeated execution with EXECPREP.
+ * Reply data is "<statement id> <number of parameter markers>"
+ */
+static int doprepare(void)
+{
+	int size;
+
+	if (!msgdatasize) return sqlerrnummsg(ERR_INVALIDVALUE, "zero length data", NULL);
+	size = msgdatasize;
+	msgdatasize = MSGDATASIZE;
+	rc = sqlprepare(connectid, msgindata, size, msgoutdata, &msgdatasize);
+	if (rc < 0) return rc;
+	putmsgok(30);
+	return 0;
+}
+
+/**
+ * EXECPREP: execute the prepared statement whose id is in the fsid field.
+ * Request data is the parameter values separated by blanks, a value is
+ * quoted if it contains blanks. Reply is the same as EXECUTE
+ */
+static int doexecprep(void)
+{
+	int size;
+
+	size = msgdatasize;
+	msgdatasize = MSGDATASIZE;
+	rc = sqlexecprepared(connectid, msgfsid, msgindata, size, msgoutdata, &msgdatasize);
+	if (rc < 0) return rc;
+	if (rc == 0) putmsgok(30);
+	else if (rc == 1) putmsgtext("OKTRUNC ");
+	else putmsgtext("SET     ");
+	return 0;
+}
+
+/**
+ * LOAD: insert rows with the prepared INSERT statement whose id is in the fsid field.
+ * Request data is one row per line, the parameter values of a row are separated
+ * as for EXECPREP. Reply data is the number of rows inserted
+ */
+static int doload(void)
+{
+	int size;
+
+	size = msgdatasize;
+	msgdatasize = MSGDATASIZE;
+	rc = sqlload(connectid, msgfsid, msgindata, size, msgoutdata, &msgdatasize);
+	if (rc < 0) return rc;
+	if (rc == 0) putmsgok(30);
+	else putmsgtext("OKTRUNC ");
+	return 0;
+}
+
+static int dofreestmt(void)
+{
+	rc = sqlfreestmt(connectid, msgfsid);
+	if (rc < 0) return rc;
+	msgdatasize = 0;
+	putmsgok(30);
+	return 0;
+}
+
 static INT dorowcount(void)
 {
 	msgdatasize = MSGDATASIZE;
@@ -1334,6 +1550,7 @@ static int dogetrow(void)
 	INT type;
 	long i1, count, row;
 
+	if (msgfunc1 == 'S') return dogetrows();
 	if (msgfunc1 == 'N' || msgfunc1 == 'C') type = 1;
 	else if (msgfunc1 == 'P') type = 2;
 	else if (msgfunc1 == 'F') type = 3;
@@ -1367,6 +1584,73 @@ static int dogetrow(void)
 	return 0;
 }
 
+/*
+ * GETROWS: return up to <count> following rows in a single reply, stopping before the
+ * row data would exceed <budget> bytes.  Request data is "<count> [<budget>]".
+ * Reply data is the row count (8), the row length (8), "END     " if the end of the
+ * result set was reached or blanks (8), followed by the rows.
+ * If a row fails after some rows were fetched, those rows are returned and the error
+ * is returned by the next GETROWS of the result set
+ */
+static int dogetrows(void)
+{
+	INT endflag, rowsize, size, totalsize;
+	long i1, budget, count, rows;
+
+	/* msgoutdata overlaps msgindata, so parse the request first */
+	for (i1 = 0; i1 < msgdatasize && msgindata[i1] != ' '; i1++);
+	if ((rc = fromcntolong(msgindata, (int) i1, &count)) < 0) {
+		return sqlerrnummsg(rc, "bad numeric in data string", NULL);
+	}
+	if (count < 1) return sqlerrnummsg(ERR_INVALIDVALUE, "invalid row count", NULL);
+	if (getrowserrfsid && getrowserrfsid == msgfsid) {
+		getrowserrfsid = 0;
+		return sqlerrset(getrowserrcode, getrowserrtext);
+	}
+	budget = MSGDATASIZE - 24;
+	if (i1 < msgdatasize) {
+		if ((rc = fromcntolong(msgindata + i1, msgdatasize - (int) i1, &budget)) < 0) {
+			return sqlerrnummsg(rc, "bad numeric in data string", NULL);
+		}
+		if (budget > MSGDATASIZE - 24) budget = MSGDATASIZE - 24;
+	}
+
+	endflag = FALSE;
+	rowsize = totalsize = 0;
+	for (rows = 0; rows < count; rows++) {
+		/* rows are fixed length, so the first row tells whether another will fit */
+		if (rows && totalsize + rowsize > budget) break;
+		size = MSGDATASIZE - 24 - totalsize;
+		rc = sqlgetrow(connectid, msgfsid, 1, 0, msgoutdata + 24 + totalsize, &size);
+		if (rc < 0) {
+			if (!rows) return rc;
+			getrowserrfsid = msgfsid;
+			memcpy(getrowserrcode, sqlcode(), 5);
+			strncpy(getrowserrtext, sqlmsg(), sizeof(getrowserrtext) - 1);
+			getrowserrtext[sizeof(getrowserrtext) - 1] = '\0';
+			break;
+		}
+		if (rc > 0) {
+			endflag = TRUE;
+			break;
+		}
+		if (!rows) rowsize = size;
+		else if (size < rowsize) memset(msgoutdata + 24 + totalsize + size, ' ', rowsize - size);
+		totalsize += rowsize;
+	}
+	if (!rows) {
+		msgdatasize = 0;
+		putmsgtext("SQL20000"); /* no data found */
+		return 0;
+	}
+	msciton((INT) rows, msgoutdata, 8);
+	msciton(rowsize, msgoutdata + 8, 8);
+	memcpy(msgoutdata + 16, (endflag) ? "END     " : "        ", 8);
+	msgdatasize = 24 + totalsize;
+	putmsgok(30);
+	return 0;
+}
+
 static int dopsupdate(void)
 {
 	if (!msgdatasize) return sqlerrnummsg(ERR_INVALIDVALUE, "zero length data", NULL);
@@ -1390,6 +1674,7 @@ static int dopsdelete(void)
 
 static int dodiscard(void)
 {
+	if (getrowserrfsid == msgfsid) getrowserrfsid = 0;
 	rc = sqldiscard(connectid, msgfsid);
 	if (rc < 0) return rc;
 	msgdatasize = 0;
@@ -1543,6 +1828,7 @@ static int doread(void)
 
 	if (msgfunc2 == ' ') lockflag = FALSE;
 	else if (msgfunc2 == 'L') lockflag = TRUE;
+	else if (msgfunc2 == 'M' || msgfunc2 == 'U') return doreadahead();
 	else return ERR_BADFUNC;
 	keysize = msgdatasize;
 	msgdatasize = MSGDATASIZE;
@@ -1603,6 +1889,56 @@ static int doread(void)
 	return 0;
 }
 
+/* M reads ahead for unlocked next reads, the data is the record count and buffer size */
+/* U returns to the last record used, the data is its position followed by its key */
+static int doreadahead(void)
+{
+	int i1, count, endflag, keylen, seqflag, size;
+	OFFSET pos;
+
+	if (msgfunc1 == 'S') seqflag = TRUE;
+	else if (msgfunc1 == 'N' || msgfunc1 == 'O') seqflag = FALSE;
+	else return ERR_BADFUNC;
+
+	if (msgfunc2 == 'U') {
+		if (msgdatasize < 12) return ERR_INVALIDSIZESPEC;
+		rc = fromcntooff(msgindata, 12, &pos);
+		if (rc < 0) return rc;
+		/* msgoutdata overlaps msgindata, so read the record past the key */
+		rc = filereadback(connectid, msgfsid, seqflag, pos, msgindata + 12, msgdatasize - 12,
+			msgindata + msgdatasize, MSGDATASIZE - msgdatasize);
+		if (rc < 0) return rc;
+		msgdatasize = 0;
+		putmsgok(30);
+		return 0;
+	}
+	/* msgoutdata overlaps msgindata, so parse the request first */
+	for (i1 = 0; i1 < msgdatasize && msgindata[i1] != ' '; i1++);
+	if (!i1) return ERR_INVALIDSIZESPEC;
+	rc = fromcntoint(msgindata, i1, &count);
+	if (rc < 0) return rc;
+	size = MSGDATASIZE - 24;
+	if (i1 < msgdatasize) {
+		rc = fromcntoint(msgindata + i1 + 1, msgdatasize - i1 - 1, &size);
+		if (rc < 0) return rc;
+		if (size > MSGDATASIZE) size = MSGDATASIZE;
+		size -= 24;
+	}
+	rc = filereadahead(connectid, msgfsid, seqflag, count, msgoutdata + 24, &size, &keylen, &endflag);
+	if (rc == -1) {
+		msgdatasize = 0;
+		putmsgtext("NOREC   ");
+		return 0;
+	}
+	if (rc < 0) return rc;
+	msciton(rc, msgoutdata, 8);
+	memcpy(msgoutdata + 8, (endflag) ? "END     " : "        ", 8);
+	msciton(keylen, msgoutdata + 16, 8);
+	msgdatasize = 24 + size;
+	putmsgok(30);
+	return 0;
+}
+
 #if OS_UNIX
 static CHAR dbgbasename[] = "debug_fs_nulls.txt";
 static FILE *debugfile;
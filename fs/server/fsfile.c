@@ -85,6 +85,19 @@ INT fileconnect(CHAR *cfgfile, CHAR *dbdfile, CHAR *user, CHAR *password, CHAR *
 	return cid;
 }
 
+/*
+ * forget the files of the last client, called by a pool worker before it runs the next client
+ */
+void filereset()
+{
+	free(fileinfo);
+	fileinfo = NULL;
+	openhi = openmax = 0;
+	filepos = 0;
+	errormsg[0] = '\0';
+	cid = 0;
+}
+
 /*** CODE: THIS LOOKS PRETTY USELESS, VERIFY ***/
 /* get file information */
 INT filegetinfo(CHAR *input, INT inputsize, CHAR *output, INT *outputsize)
@@ -635,6 +648,104 @@ INT filereadnext(INT connectid, INT fileid, INT lockflag, INT nextflag, UCHAR *r
 	return retcode;
 }
 
+/* read up to count records forward into buf, each preceded by its 8 character */
+/* length, its 12 character position and for an index file its keylen key */
+/* seqflag:  TRUE = sequential text, FALSE = index or aim key next */
+/* returns the number of records read */
+INT filereadahead(INT connectid, INT fileid, INT seqflag, INT count, UCHAR *buf, INT *bufsize, INT *keylen, INT *endflag)
+{
+	INT i1, hdrsize, reclen, retcode, size;
+	OFFSET pos;
+	FILEINFO *f1;
+
+	errormsg[0] = '\0';
+	if (connectid != cid) return ERR_BADCONNECTID;
+	i1 = fileid - FILEBASE;
+	if (i1 < 0 || i1 >= openhi || !fileinfo[i1].type) return ERR_BADFILEID;
+	f1 = &fileinfo[i1];
+	if (f1->options & FILEOPTIONS_LOCKAUTO) return ERR_BADFUNC;  /* every read would lock */
+	if (count < 1) return ERR_INVALIDVALUE;
+	*keylen = 0;
+	if (!seqflag && f1->type == FILEOPTIONS_IFILEOPEN) {
+		*keylen = xiogetkey(f1->xhandle, NULL);
+		if (*keylen < 0) {
+			putfilename(f1->xhandle);
+			return *keylen - 1730;
+		}
+	}
+	hdrsize = 20 + *keylen;
+	if (f1->reclen + hdrsize > *bufsize) return ERR_INVALIDSIZESPEC;
+	*endflag = FALSE;
+	for (i1 = size = 0; i1 < count && size + hdrsize + f1->reclen <= *bufsize; i1++) {
+		reclen = *bufsize - size - hdrsize;
+		if (seqflag) retcode = filereadrec(connectid, fileid, FALSE, -1, buf + size + hdrsize, &reclen);
+		else retcode = filereadnext(connectid, fileid, FALSE, TRUE, buf + size + hdrsize, &reclen);
+		if (retcode) {
+			if (!i1) return retcode;
+			/* return what was read, a hard error will repeat on the next read */
+			if (retcode == -1) *endflag = TRUE;
+			break;
+		}
+		msciton(reclen, buf + size, 8);
+		riolastpos(f1->handle, &pos);
+		mscoffton(pos, buf + size + 8, 12);
+		if (*keylen) xiogetkey(f1->xhandle, buf + size + 20);
+		size += hdrsize + reclen;
+	}
+	*bufsize = size;
+	return i1;
+}
+
+/* return to the record at pos, the last of those read ahead that was used, */
+/* as if it had just been read.  key is its index key for an index file */
+INT filereadback(INT connectid, INT fileid, INT seqflag, OFFSET pos, UCHAR *key, INT keylen, UCHAR *rec, INT reclen)
+{
+	INT retcode, size;
+	OFFSET lastpos;
+	FILEINFO *f1;
+
+	errormsg[0] = '\0';
+	if (connectid != cid) return ERR_BADCONNECTID;
+	fileid -= FILEBASE;
+	if (fileid < 0 || fileid >= openhi || !fileinfo[fileid].type) return ERR_BADFILEID;
+	f1 = &fileinfo[fileid];
+	if (pos < 0) return ERR_INVALIDVALUE;
+	f1->flags &= ~FLAGS_UPDATE;
+	if (!seqflag && f1->type == FILEOPTIONS_AFILEOPEN) {
+		/* aim reads are in file order, so back up until at or before pos */
+		fileid += FILEBASE;
+		for ( ; ; ) {
+			size = reclen;
+			retcode = filereadnext(connectid, fileid, FALSE, FALSE, rec, &size);
+			if (retcode) {
+				if (retcode == -1) retcode = 0;
+				return retcode;
+			}
+			riolastpos(f1->handle, &lastpos);
+			if (lastpos <= pos) break;
+		}
+		/* a record that was deleted or no longer matches can not be updated */
+		if (lastpos != pos) f1->flags &= ~FLAGS_UPDATE;
+		return 0;
+	}
+	if (!seqflag) {
+		if (f1->type != FILEOPTIONS_IFILEOPEN) return ERR_BADFUNC;
+		retcode = xiosetkey(f1->xhandle, key, keylen, pos);
+		if (retcode) {
+			putfilename(f1->xhandle);
+			return retcode - 1730;
+		}
+	}
+	/* a deleted record leaves the position after it for the next read */
+	retcode = readrec(f1, FALSE, pos, rec);
+	if (retcode >= 0) f1->flags |= FLAGS_UPDATE;
+	else if (retcode != -720) {
+		putfilename(f1->handle);
+		return retcode;
+	}
+	return 0;
+}
+
 /* read directly from the file */
 INT filereadraw(INT connectid, INT fileid, OFFSET pos, UCHAR *rec, INT *reclen)
 {
@@ -158,6 +158,90 @@ INT sqlexecute(INT connectid, UCHAR *stmt, INT stmtlen, UCHAR *result, INT *resu
 	return rc >> 1;
 }
 
+/**
+ * prepare an sql statement for repeated execution
+ * return 0 if statement succeeded, w/ data = statement id and number of parameter markers
+ * return negative if error
+ *
+ * Called only from doprepare in dbcfsrun
+ */
+INT sqlprepare(INT connectid, UCHAR *stmt, INT stmtlen, UCHAR *result, INT *resultsize)
+{
+	INT i1, numparams, rc, stmtid;
+
+	if (connectid != cid) return sqlerrnum(SQLERR_BADCONNECTID);
+	rc = preparestmt(stmt, stmtlen, &stmtid, &numparams);
+	if (rc < 0) return rc;
+	i1 = mscitoa(stmtid, (CHAR *) result);
+	result[i1++] = ' ';
+	*resultsize = i1 + mscitoa(numparams, (CHAR *) result + i1);
+	return 0;
+}
+
+/**
+ * execute a prepared sql statement with parameter values
+ * return values are the same as sqlexecute
+ *
+ * Called only from doexecprep in dbcfsrun
+ */
+INT sqlexecprepared(INT connectid, INT stmtid, UCHAR *params, INT paramlen, UCHAR *result, INT *resultsize)
+{
+	INT rc, rsid;
+
+	if (connectid != cid) return sqlerrnum(SQLERR_BADCONNECTID);
+	rc = execpreparedstmt(stmtid, params, paramlen, &rsid);
+	if (rc < 0) return rc;
+	if (sqlinfoflag && (rc == 0 || rc == 1)) {
+		rc += 2;
+		sqlmsgclear();
+	}
+	if (rc == 1 || rc == 3) *resultsize = mscitoa(rsid, (CHAR *) result);
+	else if (rc >= 5) {
+		buildresultsetstring(rc, rsid, result, resultsize);
+		if (rc == 5) discard(rsid);
+	}
+	else *resultsize = 0;
+	return rc >> 1;
+}
+
+/**
+ * insert the rows of parameter values in data with a prepared INSERT statement
+ * return 0 if statement succeeded, 1 if data was truncated, w/ data = number of rows inserted
+ * return negative if error, the message text starts with "<n> rows inserted: "
+ * where n is the number of rows written before the error
+ *
+ * Called only from doload in dbcfsrun
+ */
+INT sqlload(INT connectid, INT stmtid, UCHAR *data, INT datalen, UCHAR *result, INT *resultsize)
+{
+	INT rc;
+	LONG count;
+	CHAR code[5], work[32];
+
+	if (connectid != cid) return sqlerrnum(SQLERR_BADCONNECTID);
+	rc = loadstmt(stmtid, data, datalen, &count);
+	if (rc < 0) {
+		memcpy(code, sqlerrcode, 5);
+		sprintf(work, "%d rows inserted", (INT) count);
+		sqlerrmsg(work);
+		memcpy(sqlerrcode, code, 5);
+		return rc;
+	}
+	if (sqlinfoflag) {
+		rc = 1;
+		sqlmsgclear();
+	}
+	*resultsize = mscitoa((INT) count, (CHAR *) result);
+	return rc;
+}
+
+/* free a prepared statement */
+INT sqlfreestmt(INT connectid, INT stmtid)
+{
+	if (connectid != cid) return sqlerrnum(SQLERR_BADCONNECTID);
+	return freepreparedstmt(stmtid);
+}
+
 /**
  * get result set format of an sql statement
  * return 0 if statement succeeded, w/ data = result format
@@ -225,6 +309,10 @@ static void freeconnection()
 
 	for (i1 = 1; i1 <= connection.numworksets; i1++) freeworkset(i1);
 	memfree((UCHAR **) connection.hworksetarray);
+	freeplancache();
+	freeupdaterecbuf();
+	for (i1 = 0; i1 < connection.numprepared; i1++) memfree((*connection.hpreparedarray)[i1]);
+	memfree((UCHAR **) connection.hpreparedarray);
 	closetablelocks();
 	memfree((UCHAR **) connection.hlockfilearray);
 	closefilesinalltables();
@@ -435,6 +523,9 @@ INT sqlerrnum(INT num)
 		case SQLERR_BADCONNECTID:
 			msg = "Bad connect ID";
 			break;
+		case SQLERR_BADSTMTID:
+			msg = "Bad statement ID";
+			break;
 		case SQLERR_BADINDEX:
 			msg = "Bad index";
 			break;
@@ -496,6 +587,17 @@ INT sqlerrmsg(char *msg)
 	return -1;
 }
 
+/*
+ * set the sql code and message text saved from an earlier error, return SQL_ERROR
+ */
+INT sqlerrset(CHAR *code, CHAR *msg)
+{
+	strncpy(sqlerrtext, msg, sizeof(sqlerrtext) - 1);
+	sqlerrtext[sizeof(sqlerrtext) - 1] = '\0';
+	memcpy(sqlerrcode, code, 5);
+	return SQL_ERROR;
+}
+
 /*
  * set error number and two message texts, return SQL_ERROR
  */
@@ -534,7 +636,25 @@ void sqlmsgclear()
 	sqlinfoflag = FALSE;
 }
 
+/*
+ * forget the connection and messages of the last client, called by a pool worker
+ * before it runs the next client
+ */
+void sqlreset()
+{
+	cid = 0;
+	filepos = 0;
+	sqlmsgclear();
+	resetstmtstate();
+}
+
 void sqlswi()
 {
 	sqlinfoflag = TRUE;
 }
+
+/* return TRUE if the result will be SQL_SUCCESS_WITH_INFO */
+INT sqlisswi()
+{
+	return sqlinfoflag;
+}
@@ -27,6 +27,7 @@
 #include "fssql.h"
 #include "fssqlx.h"
 #include "fio.h"
+#include "tcp.h"
 
 #define READ_INDEX_NONE		0
 #define READ_INDEX_AIMDEX	1
@@ -43,16 +44,40 @@
 #define TEMPLATE_EXACT		1
 #define TEMPLATE_PATTERN	2
 
+/* file layers that EXPLAIN ANALYZE charges the time of operations to */
+#define EXPLAIN_RIO			0
+#define EXPLAIN_XIO			1
+#define EXPLAIN_AIO			2
+#define EXPLAIN_WORKSET		3
+#define EXPLAIN_OTHER		4
+#define EXPLAIN_LAYERS		5
+
 extern INT fsflags;
 extern CONNECTION connection;
 extern OFFSET filepos;
 extern int sqlstatisticsflag;
 
 static USHORT lrucount = 1;
+static USHORT planlrucount = 1;
 static CHAR lasttable[MAX_NAME_LENGTH + 1];
 static CHAR lastalias[MAX_NAME_LENGTH + 1];
 
 static CHAR *getcrfinfo(COLREF *crf1, HCORRTABLE corrtable);
+static INT normalizestmt(UCHAR *stmtstring, INT stmtsize);
+static INT ddlstmt(UCHAR *stmtstring, INT stmtsize);
+static INT getplan(UCHAR *stmtstring, INT stmtsize, HPLAN *phplan);
+static INT getpreparedplan(INT stmtid, HPLAN *phplan);
+static INT bindparams(HPLAN hplan, UCHAR *params, INT paramsize);
+static INT runplan(HPLAN hplan, INT *rsid);
+static INT explainprefix(UCHAR *stmtstring, INT stmtsize, INT *analyzeflag);
+static INT explainplan(HPLAN hplan, INT analyzeflag, INT *rsid);
+static INT explainread(HPLAN hplan, INT pcount, INT *tableref, INT *indexnum);
+static INT explainisread(PCODE *pcode);
+static INT explainaccess(HPLAN hplan, PCODE *pcode, INT *tableref, INT *indexnum);
+static void explaindetail(HPLAN hplan, PCODE *pcode, CHAR *operands, CHAR *detail);
+static void explaincolref(HPLAN hplan, UINT colref, CHAR *dest);
+static void explaintext(UCHAR *row, COLREF *crf1, CHAR *value);
+static void explainnum(UCHAR *row, COLREF *crf1, OFFSET value);
 static INT matchname(CHAR *name, CHAR *pattern, INT templateflag);
 static void replacename(CHAR *srcpattern, CHAR *srcname, CHAR *destpattern, CHAR *destname);
 
@@ -866,54 +891,180 @@ INT gettableinfo(CHAR *table, INT *rsid)
  */
 INT execstmt(UCHAR *stmtstring, INT stmtsize, INT *rsid)
 {
-	INT rc;
-	LONG sqlexeccode, sqlinfo;
-	S_GENERIC **stmt;
-	WORKSETINFO *wsinfo;
+	INT analyzeflag, explainsize, rc;
 	HPLAN hplan;
 
-	if (parsesqlstmt(stmtstring, stmtsize, &stmt)) {
-		return RC_ERROR;
+	explainsize = explainprefix(stmtstring, stmtsize, &analyzeflag);
+	if (explainsize) {
+		stmtstring += explainsize;
+		stmtsize -= explainsize;
+		if (ddlstmt(stmtstring, stmtsize)) return sqlerrnummsg(SQLERR_PARSE_ERROR, "EXPLAIN of CREATE, DROP, ALTER or ANALYZE not supported", NULL);
 	}
-	if ((*stmt)->stype == STYPE_SELECT) rc = buildselectplan((S_SELECT **) stmt, &hplan, FALSE);
-	else if ((*stmt)->stype == STYPE_INSERT) rc = buildinsertplan((S_INSERT **) stmt, &hplan);
-	else if ((*stmt)->stype == STYPE_UPDATE) rc = buildupdateplan((S_UPDATE **) stmt, &hplan);
-	else if ((*stmt)->stype == STYPE_DELETE) rc = builddeleteplan((S_DELETE **) stmt, &hplan);
-	else if ((*stmt)->stype == STYPE_LOCK) rc = buildlockplan((S_LOCK **) stmt, &hplan);
-	else if ((*stmt)->stype == STYPE_UNLOCK) rc = buildunlockplan((S_LOCK **) stmt, &hplan);
-	else if ((*stmt)->stype == STYPE_CREATE || (*stmt)->stype == STYPE_DROP || (*stmt)->stype == STYPE_ALTER) {
-		freestmt(stmt);
-		return 0;
+	rc = getplan(stmtstring, stmtsize, &hplan);
+	if (rc || hplan == NULL) return rc;
+	if ((*hplan)->numparams) {
+		freeplan(hplan);
+		return sqlerrnummsg(SQLERR_EXEC_BADPARM, "parameter values not supplied", NULL);
 	}
-	else {
-		rc = RC_ERROR;
+	if (explainsize) return explainplan(hplan, analyzeflag, rsid);
+	return runplan(hplan, rsid);
+}
+
+/**
+ * prepare a statement for repeated execution with execpreparedstmt
+ * return 0 if statement was prepared, w/ stmtid = statement id, numparams = number of parameter markers
+ * return negative if error
+ *
+ * Called only from sqlprepare in fssql1
+ */
+INT preparestmt(UCHAR *stmtstring, INT stmtsize, INT *stmtid, INT *numparams)
+{
+	INT i1;
+	UCHAR **text;
+	HPLAN hplan;
+
+	*numparams = 0;
+	stmtsize = normalizestmt(stmtstring, stmtsize);
+	if (!ddlstmt(stmtstring, stmtsize)) {
+		/* compile now to report errors and leave the plan in the cache */
+		if (getplan(stmtstring, stmtsize, &hplan)) return RC_ERROR;
+		*numparams = (*hplan)->numparams;
+		freeplan(hplan);
+	}
+	for (i1 = 0; i1 < connection.numprepared && (*connection.hpreparedarray)[i1] != NULL; i1++);
+	if (i1 == connection.numprepared) {
+		if (!connection.numprepared) connection.hpreparedarray = (HBUF **) memalloc(20 * sizeof(HBUF), MEMFLAGS_ZEROFILL);
+		else if (memchange((UCHAR **) connection.hpreparedarray, (connection.numprepared + 20) * sizeof(HBUF), MEMFLAGS_ZEROFILL) == -1) return sqlerrnum(SQLERR_NOMEM);
+		if (connection.hpreparedarray == NULL) return sqlerrnum(SQLERR_NOMEM);
+		connection.numprepared += 20;
+	}
+	text = memalloc(stmtsize + 1, 0);
+	if (text == NULL) return sqlerrnum(SQLERR_NOMEM);
+	memcpy(*text, stmtstring, stmtsize);
+	(*text)[stmtsize] = '\0';
+	(*connection.hpreparedarray)[i1] = text;
+	*stmtid = i1 + 1;
+	return 0;
+}
+
+/**
+ * execute a prepared statement
+ * params are the parameter values, separated by blanks, quoted if they contain blanks
+ * return values are the same as execstmt
+ *
+ * Called only from sqlexecprepared in fssql1
+ */
+INT execpreparedstmt(INT stmtid, UCHAR *params, INT paramsize, INT *rsid)
+{
+	INT rc;
+	HPLAN hplan;
+
+	rc = getpreparedplan(stmtid, &hplan);
+	if (rc || hplan == NULL) return rc;
+
+	rc = bindparams(hplan, params, paramsize);
+	if (rc) {
+		freeplan(hplan);
+		return rc;
 	}
-	freestmt(stmt);
-	if (rc) return rc;
+	return runplan(hplan, rsid);
+}
 
-	sqlexeccode = 0;
-	rc = execplan(hplan, &sqlexeccode, &sqlinfo, NULL);
-	if (!rc) {
-		rc = sqlexeccode;
-		if (rc == 1 || rc == 3) *rsid = sqlinfo;
-		else if (rc >= 5) {
-			/* transfer information from plan to workset */
-			*rsid = (*hplan)->worksetnum;
-			wsinfo = *(*(*connection.hworksetarray + *rsid - 1));
-			wsinfo->corrtable = (*hplan)->corrtable;
-			(*hplan)->corrtable = NULL;
-			if (rc == 7) {  /* except plan is needed for getting rows */
-				/* transfer plan to workset */
-				wsinfo->hplan = hplan;
-				hplan = NULL;
-			}
-			else (*hplan)->worksetnum = 0;  /* prevent freeplan from discarding workset */
+/**
+ * insert rows with a prepared INSERT statement of one row
+ * data has the parameter values of one row on each line, separated and quoted as for execpreparedstmt
+ * the records are written together each time they reach MAX_LOADBATCH bytes, and at the end
+ * return 0 w/ count = number of rows inserted
+ * return negative if error, rows written before the batch with the error stay inserted
+ *
+ * Called only from sqlload in fssql1
+ */
+INT loadstmt(INT stmtid, UCHAR *data, INT datasize, LONG *count)
+{
+	INT i1, end, len, maxrows, nextoffset, offset, rc;
+	LONG sqlexeccode, sqlinfo, rows;
+	PCODE *pcode;
+	HPLAN hplan;
+
+	*count = 0;
+	rc = getpreparedplan(stmtid, &hplan);
+	if (rc || hplan == NULL) return (rc) ? rc : sqlerrnummsg(SQLERR_EXEC_BADPARM, "LOAD requires an INSERT statement of one row", NULL);
+	if (!((*hplan)->flags & PLAN_FLAG_INSERT)) {
+		freeplan(hplan);
+		return sqlerrnummsg(SQLERR_EXEC_BADPARM, "LOAD requires an INSERT statement of one row", NULL);
+	}
+	/* have OP_WRITE save the record instead of writing it */
+	pcode = *(*hplan)->pgm;
+	for (i1 = 0; i1 < (*hplan)->pgmcount && pcode[i1].code != OP_WRITE; i1++);
+	if (i1 < (*hplan)->pgmcount) pcode[i1].op2 = 1;
+	maxrows = MAX_LOADBATCH / tableptr((*hplan)->tablenums[0])->reclength;
+	if (maxrows < 1) maxrows = 1;
+
+	rows = 0;
+	for (offset = 0; offset < datasize; offset = nextoffset) {
+		for (end = offset; end < datasize && data[end] != '\n'; end++);
+		nextoffset = end + 1;
+		len = end - offset;
+		if (len && data[end - 1] == '\r') len--;
+		for (i1 = 0; i1 < len && data[offset + i1] == ' '; i1++);
+		if (i1 == len) continue;  /* empty line */
+		rc = bindparams(hplan, data + offset, len);
+		if (!rc) {
+			sqlexeccode = 0;
+			rc = execplan(hplan, &sqlexeccode, &sqlinfo, NULL);
+			/* run the plan from the beginning for the next row */
+			freeworkset((*hplan)->worksetnum);
+			(*hplan)->worksetnum = 0;
+		}
+		if (!rc && (*hplan)->batchcount >= maxrows) {
+			rows += (*hplan)->batchcount;
+			rc = writebatch(hplan);
+			if (!rc) *count = rows;
 		}
+		if (rc) break;
+	}
+	if (!rc) {
+		rows += (*hplan)->batchcount;
+		rc = writebatch(hplan);
+		if (!rc) *count = rows;
 	}
 	freeplan(hplan);
 	return rc;
 }
 
+/* free a prepared statement */
+INT freepreparedstmt(INT stmtid)
+{
+	if (stmtid <= 0 || stmtid > connection.numprepared || (*connection.hpreparedarray)[stmtid - 1] == NULL) return sqlerrnum(SQLERR_BADSTMTID);
+	memfree((*connection.hpreparedarray)[stmtid - 1]);
+	(*connection.hpreparedarray)[stmtid - 1] = NULL;
+	return 0;
+}
+
+/* forget the lru counters and the last table and alias named in a result column */
+void resetstmtstate()
+{
+	lrucount = planlrucount = 1;
+	lasttable[0] = lastalias[0] = '\0';
+}
+
+/* free all plans in the plan cache */
+void freeplancache()
+{
+	INT i1;
+	PLANCACHE *pc1;
+
+	for (i1 = 0; i1 < connection.numplans; i1++) {
+		pc1 = *connection.hplancache + i1;
+		freeplan(pc1->hplan);
+		pc1 = *connection.hplancache + i1;
+		memfree(pc1->key);
+	}
+	memfree((UCHAR **) connection.hplancache);
+	connection.hplancache = NULL;
+	connection.numplans = 0;
+}
+
 /**
  * return negative if error; otherwise return 0 and data copied in length
  * Called only by sqlexecnone in fssql1
@@ -1040,7 +1191,7 @@ INT getrow(INT rsid, INT type, LONG recnum, UCHAR *row, INT *rowsize)
 
 INT posupdate(INT rsid, UCHAR *stmtstring, INT stmtsize)
 {
-	INT oldpgmcount, rc;
+	INT numparams, oldpgmcount, rc;
 	LONG sqlexeccode, sqlinfo;
 	S_GENERIC **genstmt;
 	S_UPDATE **stmt;
@@ -1055,8 +1206,8 @@ INT posupdate(INT rsid, UCHAR *stmtstring, INT stmtsize)
 		if (!((*hplan)->flags & PLAN_FLAG_FORUPDATE)) return sqlerrnum(SQLERR_PARSE_NOFORUPDATE);
 		ws1 = (*wsinfo)->workset;
 		if (ws1->rowid < 1) return sqlerrnum(SQLERR_BADROWID);
-		if (parsesqlstmt(stmtstring, stmtsize, &genstmt)) return -1;
-		if ((*genstmt)->stype != STYPE_UPDATE) {
+		if (parsesqlstmt(stmtstring, stmtsize, &genstmt, &numparams)) return -1;
+		if ((*genstmt)->stype != STYPE_UPDATE || numparams) {
 			freestmt(genstmt);
 			return sqlerrnum(SQLERR_BADCMD);
 		}
@@ -1232,6 +1383,7 @@ void freeworkset(INT worksetnum)
 		if (ws1->colrefarray != NULL) memfree((UCHAR **) ws1->colrefarray);
 		if (ws1->rows != NULL) memfree(ws1->rows);
 		if (ws1->fileposarray != NULL) memfree((UCHAR **) ws1->fileposarray);
+		if (ws1->hashtable != NULL) memfree((UCHAR **) ws1->hashtable);
 		if (ws1->fiofilenum) fiokill(ws1->fiofilenum);
 	}
 	if ((*wsinfo)->hplan != NULL) {
@@ -1540,6 +1692,92 @@ INT maketablecomplete(INT tablenum)
 	return 0;
 }
 
+/**
+ * collect the statistics used by the planner to cost a table, the
+ * estimated number of rows and for each index an estimate of how many
+ * rows a lookup will return
+ * return 0 if successful, otherwise return negative error
+ */
+INT analyzetable(INT tablenum)
+{
+	INT i1, filenum, indexnum, openfilenum, recsize, reccnt;
+	OFFSET bits, distinct, eofpos, keys, pos, rows, total;
+	TABLE *tab1;
+	INDEX *idx1;
+	OPENFILE *opf1;
+
+	openfilenum = opentabletextfile(tablenum);
+	if (openfilenum < 0) return openfilenum;
+	opf1 = openfileptr(openfilenum);
+	tab1 = tableptr(tablenum);
+	filenum = opf1->textfilenum;
+	recsize = opf1->reclength;
+	i1 = rioeofpos(filenum, &eofpos);
+	if (i1 < 0) goto analyzetable1;
+	if ((tab1->rioopenflags & (RIO_FIX | RIO_UNC)) == (RIO_FIX | RIO_UNC)) rows = eofpos / (recsize + tab1->eorsize);
+	else {
+		/* variable or compressed, estimate from the average size of the first records */
+		riosetpos(filenum, 0);
+		for (reccnt = 0; reccnt < 1000; ) {
+			i1 = rioget(filenum, *opf1->hrecbuf, recsize);
+			if (i1 == -1) break;
+			if (i1 == -2) continue;
+			if (i1 < 0) goto analyzetable1;
+			reccnt++;
+		}
+		rionextpos(filenum, &pos);
+		if (i1 == -1 || !reccnt || pos <= 0) rows = reccnt;
+		else rows = (OFFSET)((double) eofpos * reccnt / pos);
+	}
+
+	for (indexnum = 0; ++indexnum <= tab1->numindexes; ) {
+		i1 = opentableindexfile(openfilenum, indexnum);
+		if (i1) {
+			opf1 = openfileptr(openfilenum);
+			opf1->inuseflag = FALSE;
+			return i1;
+		}
+		opf1 = openfileptr(openfilenum);
+		tab1 = tableptr(tablenum);
+		idx1 = indexptr(tab1, indexnum);
+		filenum = (*opf1->hopenindexarray)[indexnum - 1];
+		if (idx1->type == INDEX_TYPE_ISAM) {
+			i1 = xiostats(filenum, 64, &keys, &distinct);
+			if (i1) goto analyzetable2;
+			tab1 = tableptr(tablenum);
+			idx1 = indexptr(tab1, indexnum);
+			if (!(idx1->flags & INDEX_DUPS) || !keys) idx1->statdistinct = rows;
+			else idx1->statdistinct = (OFFSET)((double) rows * distinct / keys);
+			if (idx1->statdistinct < 1) idx1->statdistinct = 1;
+		}
+		else {
+			i1 = aiostats(filenum, 32, rows, &bits, &total);
+			if (i1) goto analyzetable2;
+			tab1 = tableptr(tablenum);
+			idx1 = indexptr(tab1, indexnum);
+			if (!total) idx1->statdensity = 10000;
+			else idx1->statdensity = (INT)(bits * 10000 / total);
+			if (idx1->statdensity < 1) idx1->statdensity = 1;
+		}
+	}
+	opf1 = openfileptr(openfilenum);
+	tab1 = tableptr(tablenum);
+	opf1->inuseflag = FALSE;
+	tab1->statrows = rows;
+	tab1->flags |= TABLE_FLAGS_STATS | TABLE_FLAGS_ANALYZED;
+	return 0;
+
+analyzetable1:
+	opf1 = openfileptr(openfilenum);
+	opf1->inuseflag = FALSE;
+	return sqlerrnummsg(i1, "error in reading text file", nameptr(tableptr(tablenum)->textfilename));
+
+analyzetable2:
+	opf1 = openfileptr(openfilenum);
+	opf1->inuseflag = FALSE;
+	return sqlerrnummsg(i1, "error in reading index file", nameptr(indexptr(tableptr(tablenum), indexnum)->indexfilename));
+}
+
 /* open the text file of a table */
 /* return the OPENFILE number if successful */
 /* otherwise return ERR_ */
@@ -2016,6 +2254,726 @@ static void replacename(CHAR *srcpattern, CHAR *srcname, CHAR *destpattern, CHAR
 	}
 }
 
+/* collapse white space outside of quotes and remove leading and trailing */
+/* white space, so that statements differing only in spacing share a plan */
+static INT normalizestmt(UCHAR *stmtstring, INT stmtsize)
+{
+	INT i1, i2;
+	UCHAR quote;
+
+	for (i1 = i2 = 0, quote = 0; i1 < stmtsize; i1++) {
+		if (quote) {
+			if (stmtstring[i1] == quote) quote = 0;
+		}
+		else if (isspace(stmtstring[i1])) {
+			if (i2 && stmtstring[i2 - 1] != ' ') stmtstring[i2++] = ' ';
+			continue;
+		}
+		else if (stmtstring[i1] == '\'' || stmtstring[i1] == '"') quote = stmtstring[i1];
+		stmtstring[i2++] = stmtstring[i1];
+	}
+	if (!quote && i2 && stmtstring[i2 - 1] == ' ') i2--;
+	return i2;
+}
+
+/* return TRUE if the statement is a CREATE, DROP, ALTER or ANALYZE */
+/* these are performed by the parser and are never planned */
+static INT ddlstmt(UCHAR *stmtstring, INT stmtsize)
+{
+	INT i1;
+	CHAR work[8];
+
+	for (i1 = 0; i1 < stmtsize && i1 < (INT) sizeof(work) - 1 && isalpha(stmtstring[i1]); i1++) work[i1] = (CHAR) toupper(stmtstring[i1]);
+	if (i1 < stmtsize && isalpha(stmtstring[i1])) return FALSE;
+	work[i1] = '\0';
+	return !strcmp(work, "CREATE") || !strcmp(work, "DROP") || !strcmp(work, "ALTER") || !strcmp(work, "ANALYZE");
+}
+
+/**
+ * get an executable plan for a statement, from the plan cache if the same
+ * statement text has been planned before
+ * return 0 w/ phplan = plan, or NULL if the statement was a CREATE, DROP, ALTER or ANALYZE
+ * return negative if error
+ */
+static INT getplan(UCHAR *stmtstring, INT stmtsize, HPLAN *phplan)
+{
+	INT i1, i2, cachenum, emptynum, numparams, rc;
+	USHORT lowestlru;
+	UCHAR **key;
+	S_GENERIC **stmt;
+	PLANCACHE *pc1;
+	HPLAN hplan, hplan2;
+
+	*phplan = NULL;
+	stmtsize = normalizestmt(stmtstring, stmtsize);
+	lowestlru = planlrucount;
+	for (i1 = cachenum = emptynum = 0; i1 < connection.numplans; i1++) {
+		pc1 = *connection.hplancache + i1;
+		if (pc1->hplan == NULL) {
+			if (!emptynum) emptynum = i1 + 1;
+			continue;
+		}
+		if (pc1->keylength == stmtsize && !memcmp(*pc1->key, stmtstring, stmtsize)) {
+			pc1->lrucount = planlrucount++;
+			if (planlrucount == 0x8000) {
+				planlrucount >>= 1;
+				for (i2 = 0; i2 < connection.numplans; i2++) (*connection.hplancache)[i2].lrucount >>= 1;
+			}
+			return copyplan(pc1->hplan, phplan);
+		}
+		if (pc1->lrucount < lowestlru) {
+			lowestlru = pc1->lrucount;
+			cachenum = i1 + 1;
+		}
+	}
+
+	if (parsesqlstmt(stmtstring, stmtsize, &stmt, &numparams)) {
+		/* a failed CREATE, DROP or ALTER may have changed the tables */
+		freeplancache();
+		return RC_ERROR;
+	}
+	if ((*stmt)->stype == STYPE_SELECT) rc = buildselectplan((S_SELECT **) stmt, &hplan, FALSE);
+	else if ((*stmt)->stype == STYPE_INSERT) rc = buildinsertplan((S_INSERT **) stmt, &hplan);
+	else if ((*stmt)->stype == STYPE_UPDATE) rc = buildupdateplan((S_UPDATE **) stmt, &hplan);
+	else if ((*stmt)->stype == STYPE_DELETE) rc = builddeleteplan((S_DELETE **) stmt, &hplan);
+	else if ((*stmt)->stype == STYPE_LOCK) rc = buildlockplan((S_LOCK **) stmt, &hplan);
+	else if ((*stmt)->stype == STYPE_UNLOCK) rc = buildunlockplan((S_LOCK **) stmt, &hplan);
+	else if ((*stmt)->stype == STYPE_CREATE || (*stmt)->stype == STYPE_DROP || (*stmt)->stype == STYPE_ALTER || (*stmt)->stype == STYPE_ANALYZE) {
+		freestmt(stmt);
+		/* cached plans refer to tables by number and were costed with the old statistics */
+		freeplancache();
+		return 0;
+	}
+	else {
+		rc = RC_ERROR;
+	}
+	freestmt(stmt);
+	if (rc) return rc;
+	(*hplan)->numparams = numparams;
+	for (i1 = 1; i1 <= numparams; i1++) {
+		for (i2 = 0; i2 < (*hplan)->numparamslots && (*(*hplan)->paramslots)[i2].paramnum != i1; i2++);
+		if (i2 == (*hplan)->numparamslots) {
+			freeplan(hplan);
+			return sqlerrnummsg(SQLERR_PARSE_ERROR, "parameter marker not supported in this context", NULL);
+		}
+	}
+
+	/* keep a copy that has never been executed, unless a warning was issued */
+	/* while compiling (the warning would be lost on later executions) */
+	if (sqlisswi()) {
+		*phplan = hplan;
+		return 0;
+	}
+	if (copyplan(hplan, &hplan2)) {
+		sqlsuccess();
+		*phplan = hplan;
+		return 0;
+	}
+	key = memalloc(stmtsize, 0);
+	if (key == NULL) {
+		freeplan(hplan2);
+		*phplan = hplan;
+		return 0;
+	}
+	memcpy(*key, stmtstring, stmtsize);
+	if (emptynum) cachenum = emptynum;
+	else if (connection.numplans < MAX_PLANCACHE) {
+		if (!connection.numplans) connection.hplancache = (HPLANCACHE) memalloc(MAX_PLANCACHE * sizeof(PLANCACHE), MEMFLAGS_ZEROFILL);
+		if (connection.hplancache == NULL) {
+			freeplan(hplan2);
+			memfree(key);
+			*phplan = hplan;
+			return 0;
+		}
+		cachenum = ++connection.numplans;
+	}
+	else if (!cachenum) cachenum = 1;  /* all lru counts equal */
+	pc1 = *connection.hplancache + cachenum - 1;
+	if (pc1->hplan != NULL) {
+		freeplan(pc1->hplan);
+		pc1 = *connection.hplancache + cachenum - 1;
+		memfree(pc1->key);
+		pc1 = *connection.hplancache + cachenum - 1;
+	}
+	pc1->hplan = hplan2;
+	pc1->key = key;
+	pc1->keylength = stmtsize;
+	pc1->lrucount = planlrucount++;
+	if (planlrucount == 0x8000) {
+		planlrucount >>= 1;
+		for (i2 = 0; i2 < connection.numplans; i2++) (*connection.hplancache)[i2].lrucount >>= 1;
+	}
+	*phplan = hplan;
+	return 0;
+}
+
+/**
+ * compile the statement prepared as stmtid, or get a copy of its plan from the cache
+ * return 0 w/ phplan = plan (NULL if the statement has no plan)
+ * return negative if error
+ */
+static INT getpreparedplan(INT stmtid, HPLAN *phplan)
+{
+	INT rc, stmtsize;
+	UCHAR *stmtstring;
+
+	*phplan = NULL;
+	if (stmtid <= 0 || stmtid > connection.numprepared || (*connection.hpreparedarray)[stmtid - 1] == NULL) return sqlerrnum(SQLERR_BADSTMTID);
+	/* the parser needs a buffer that does not move */
+	stmtsize = (INT) strlen((CHAR *) *(*connection.hpreparedarray)[stmtid - 1]);
+	stmtstring = (UCHAR *) malloc(stmtsize + 1);
+	if (stmtstring == NULL) return sqlerrnum(SQLERR_NOMEM);
+	memcpy(stmtstring, *(*connection.hpreparedarray)[stmtid - 1], stmtsize + 1);
+	rc = getplan(stmtstring, stmtsize, phplan);
+	free(stmtstring);
+	return rc;
+}
+
+/**
+ * bind the parameter values into the literals of the plan
+ * params are the parameter values, separated by blanks, quoted if they contain blanks
+ * return 0 if successful, else return negative
+ */
+static INT bindparams(HPLAN hplan, UCHAR *params, INT paramsize)
+{
+	INT i1, i2, i3, len, minus, nextoffset, numparams, offset, rc;
+	UCHAR *value;
+	PARAMSLOT *slot;
+
+	numparams = (*hplan)->numparams;
+	for (i1 = 1, offset = 0; i1 <= numparams; i1++, offset = nextoffset) {
+		len = (paramsize) ? tcpnextdata(params, paramsize, &offset, &nextoffset) : -1;
+		if (len < 0) return sqlerrnummsg(SQLERR_EXEC_BADPARM, "too few parameter values", NULL);
+		value = params + offset;
+		for (i2 = 0; i2 < (*hplan)->numparamslots; i2++) {
+			slot = *(*hplan)->paramslots + i2;
+			if (slot->paramnum != i1) continue;
+			i3 = len;
+			if (slot->type == TYPE_NUM || slot->type == TYPE_POSNUM) {
+				for (value = params + offset; i3 && *value == ' '; i3--, value++);
+				minus = FALSE;
+				if (i3 && (*value == '-' || *value == '+')) {
+					if (*value == '-') minus = TRUE;
+					value++;
+					i3--;
+				}
+				if (i3) {
+					if (minus && slot->type == TYPE_POSNUM) rc = sqlerrnummsg(SQLERR_PARSE_BADNUMERIC, "negative value not allowed", NULL);
+					else rc = formatnumeric(value, i3, minus, slot->size, slot->scale, *(*hplan)->literals + slot->offset + 4);
+					if (rc) return rc;
+					i3 = slot->size;
+				}
+				value = params + offset;
+			}
+			else {
+				if (i3 > slot->size) {
+					if (slot->type != TYPE_CHAR) return sqlerrnummsg(SQLERR_EXEC_BADPARM, "parameter value too long", NULL);
+					i3 = slot->size;
+					sqlswi();
+				}
+				memcpy(*(*hplan)->literals + slot->offset + 4, value, i3);
+			}
+			(*(*hplan)->literals)[slot->offset + 1] = (UCHAR)(i3 >> 8);
+			(*(*hplan)->literals)[slot->offset + 2] = (UCHAR) i3;
+		}
+	}
+	return 0;
+}
+
+/**
+ * execute a plan and free it, or transfer it to the result set
+ * return values are the same as execstmt
+ */
+static INT runplan(HPLAN hplan, INT *rsid)
+{
+	INT rc;
+	LONG sqlexeccode, sqlinfo;
+	WORKSETINFO *wsinfo;
+
+	sqlexeccode = 0;
+	rc = execplan(hplan, &sqlexeccode, &sqlinfo, NULL);
+	if (!rc) {
+		rc = sqlexeccode;
+		if (rc == 1 || rc == 3) *rsid = sqlinfo;
+		else if (rc >= 5) {
+			/* transfer information from plan to workset */
+			*rsid = (*hplan)->worksetnum;
+			wsinfo = *(*(*connection.hworksetarray + *rsid - 1));
+			wsinfo->corrtable = (*hplan)->corrtable;
+			(*hplan)->corrtable = NULL;
+			if (rc == 7) {  /* except plan is needed for getting rows */
+				/* transfer plan to workset */
+				wsinfo->hplan = hplan;
+				hplan = NULL;
+			}
+			else (*hplan)->worksetnum = 0;  /* prevent freeplan from discarding workset */
+		}
+	}
+	freeplan(hplan);
+	return rc;
+}
+
+/**
+ * check for EXPLAIN [ANALYZE] in front of a statement
+ * return the length of the prefix, w/ analyzeflag = TRUE if ANALYZE was given
+ * return 0 if the statement does not begin with EXPLAIN
+ */
+static INT explainprefix(UCHAR *stmtstring, INT stmtsize, INT *analyzeflag)
+{
+	INT i1, i2, i3, word;
+	CHAR work[8];
+
+	*analyzeflag = FALSE;
+	for (i1 = 0; i1 < stmtsize && isspace(stmtstring[i1]); i1++);
+	for (word = 0; word < 2; word++) {
+		for (i2 = 0, i3 = i1; i3 < stmtsize && i2 < (INT) sizeof(work) - 1 && isalpha(stmtstring[i3]); ) work[i2++] = (CHAR) toupper(stmtstring[i3++]);
+		work[i2] = '\0';
+		if (i3 == stmtsize || !isspace(stmtstring[i3])) break;
+		if (!word) {
+			if (strcmp(work, "EXPLAIN")) return 0;
+		}
+		else if (!strcmp(work, "ANALYZE")) *analyzeflag = TRUE;
+		else break;
+		for (i1 = i3; i1 < stmtsize && isspace(stmtstring[i1]); i1++);
+	}
+	return (word) ? i1 : 0;
+}
+
+/**
+ * build the result set of EXPLAIN: one row for each operation of the plan
+ * with ANALYZE, the plan is executed, every row of the result is fetched and
+ * the rows get the counts and times of the operations, followed by the reads
+ * of each table and index, the time spent in each file layer and the total
+ * the plan is freed
+ * return 6 w/ rsid = result id
+ * return negative if error
+ */
+static INT explainplan(HPLAN hplan, INT analyzeflag, INT *rsid)
+{
+	static struct {
+		CHAR *name;
+		INT length;
+		INT type;
+	} fielddefs[] = {
+		"STEP",			5,	TYPE_NUM,
+		"OPERATION",	15,	TYPE_CHAR,
+		"TABLE_NAME",	0,	TYPE_CHAR,
+		"INDEX_NAME",	0,	TYPE_CHAR,
+		"DETAIL",		64,	TYPE_CHAR,
+		"EXECUTIONS",	12,	TYPE_NUM,
+		"ROWS",			12,	TYPE_NUM,
+		"MICROSECONDS",	14,	TYPE_NUM
+	};
+	static CHAR *layernames[EXPLAIN_LAYERS] = {
+		"TOTAL RIO", "TOTAL XIO", "TOTAL AIO", "TOTAL WORKSET", "TOTAL OTHER"
+	};
+	static CHAR *layerdetails[EXPLAIN_LAYERS] = {
+		"text file access", "ISAM index access", "AIM index access", "work sets and sorting", "expressions and control"
+	};
+	INT i1, i2, count, indexnum, indexnum2, layer, numcolumns, offset, pgmcount, rc, rowbytecount, tableref, tableref2, worksetnum;
+	LONG sqlexeccode, sqlinfo, execcount, readcount, rowcount, resultrows, layercount[EXPLAIN_LAYERS];
+	UINT64 elapsed, time, layertime[EXPLAIN_LAYERS];
+	CHAR *operands, detail[128];
+	UCHAR *row, **hrows, **hmem;
+	PLAN *plan;
+	PCODE *pcode;
+	OPPROFILE *prof;
+	TABLE *tab1;
+	WORKSET *wks1;
+	WORKSETINFO *wsinfo;
+	COLREF *crf1;
+	HCOLREF hcrf1;
+	HCORRTABLE hcorr;
+
+	resultrows = 0;
+	elapsed = 0;
+	if (analyzeflag) {
+		hmem = memalloc((*hplan)->pgmcount * sizeof(OPPROFILE), MEMFLAGS_ZEROFILL);
+		if (hmem == NULL) {
+			freeplan(hplan);
+			return sqlerrnum(SQLERR_NOMEM);
+		}
+		(*hplan)->profile = (OPPROFILE **) hmem;
+		elapsed = execclock();
+		sqlexeccode = 0;
+		rc = execplan(hplan, &sqlexeccode, &sqlinfo, NULL);
+		if (!rc) {
+			if (sqlexeccode == 1 || sqlexeccode == 3) resultrows = sqlinfo;
+			else if (sqlexeccode == 5 || sqlexeccode == 6) {
+				wks1 = (*(*(*connection.hworksetarray + (*hplan)->worksetnum - 1)))->workset;
+				resultrows = wks1->rowcount;
+			}
+			else if (sqlexeccode == 7) {
+				/* rows of a dynamic result set are produced as they are fetched */
+				for ( ; ; ) {
+					sqlexeccode = 1;
+					sqlinfo = 0;
+					rc = execplan(hplan, &sqlexeccode, &sqlinfo, NULL);
+					if (rc || sqlexeccode < 6) break;
+					resultrows++;
+				}
+			}
+		}
+		if (rc) {
+			freeplan(hplan);
+			return rc;
+		}
+		elapsed = execclock() - elapsed;
+	}
+
+	/* fill in length of variable length fields */
+	fielddefs[2].length = connection.maxtablename;
+	fielddefs[3].length = connection.maxtableindex;
+	numcolumns = (analyzeflag) ? sizeof(fielddefs) / sizeof(*fielddefs) : 5;
+
+	/* calculate length of rows */
+	for (i1 = 0, rowbytecount = 0; i1 < numcolumns; i1++) rowbytecount += fielddefs[i1].length;
+	/* build column result fields, named by column aliases */
+	hcrf1 = (HCOLREF) memalloc(numcolumns * sizeof(COLREF), 0);
+	if (hcrf1 == NULL) {
+		freeplan(hplan);
+		return sqlerrnum(SQLERR_NOMEM);
+	}
+	hcorr = (HCORRTABLE) memalloc(sizeof(CORRTABLE) + (numcolumns - 1) * sizeof(CORRINFO), MEMFLAGS_ZEROFILL);
+	if (hcorr == NULL) {
+		memfree((UCHAR **) hcrf1);
+		freeplan(hplan);
+		return sqlerrnum(SQLERR_NOMEM);
+	}
+	(*hcorr)->count = (*hcorr)->size = numcolumns;
+	crf1 = *hcrf1;
+	for (i1 = offset = 0; i1 < numcolumns; i1++) {
+		crf1[i1].tabcolnum = 0x00010001 + i1;
+		crf1[i1].offset = offset;
+		crf1[i1].type = fielddefs[i1].type;
+		crf1[i1].length = fielddefs[i1].length;
+		offset += fielddefs[i1].length;
+		crf1[i1].scale = 0;
+		crf1[i1].tablenum = 0;
+		crf1[i1].columnnum = 0;
+		(*hcorr)->info[i1].tabcolnum = crf1[i1].tabcolnum;
+		strcpy((*hcorr)->info[i1].name, fielddefs[i1].name);
+	}
+
+	/* one row per operation, ANALYZE adds one for each table and index */
+	/* read, the layer totals and the total */
+	pgmcount = count = (*hplan)->pgmcount;
+	if (analyzeflag) {
+		for (i1 = 0; i1 < pgmcount; i1++) if (explainread(hplan, i1, &tableref, &indexnum) >= 0) count++;
+		count += EXPLAIN_LAYERS + 1;
+	}
+	hrows = memalloc(count * rowbytecount, 0);
+	if (hrows == NULL) {
+		memfree((UCHAR **) hcorr);
+		memfree((UCHAR **) hcrf1);
+		freeplan(hplan);
+		return sqlerrnum(SQLERR_NOMEM);
+	}
+	/* no memory is allocated below until the plan is freed */
+	plan = *hplan;
+	crf1 = *hcrf1;
+	for (i1 = 0; i1 < EXPLAIN_LAYERS; i1++) {
+		layercount[i1] = 0;
+		layertime[i1] = 0;
+	}
+	for (i1 = count = 0; i1 < pgmcount; i1++) {
+		pcode = *plan->pgm + i1;
+		row = *hrows + count++ * rowbytecount;
+		memset(row, ' ', rowbytecount);
+		explainnum(row, crf1, i1);
+		explaintext(row, crf1 + 1, getopname(pcode->code, &operands));
+		layer = explainaccess(hplan, pcode, &tableref, &indexnum);
+		if (tableref) {
+			tab1 = tableptr(plan->tablenums[tableref - 1]);
+			explaintext(row, crf1 + 2, nameptr(tab1->name));
+			if (indexnum) explaintext(row, crf1 + 3, nameptr(indexptr(tab1, indexnum)->indexfilename));
+		}
+		explaindetail(hplan, pcode, operands, detail);
+		explaintext(row, crf1 + 4, detail);
+		if (analyzeflag) {
+			prof = *plan->profile + i1;
+			explainnum(row, crf1 + 5, prof->count);
+			if (explainisread(pcode) || pcode->code == OP_WORKNEWROW) explainnum(row, crf1 + 6, prof->rows);
+			explainnum(row, crf1 + 7, (OFFSET) prof->time);
+			layercount[layer] += prof->count;
+			layertime[layer] += prof->time;
+		}
+	}
+	if (analyzeflag) {
+		/* records read from each table, through each index, by all of the operations reading it */
+		for (i1 = 0; i1 < pgmcount; i1++) {
+			layer = explainread(hplan, i1, &tableref, &indexnum);
+			if (layer < 0) continue;
+			execcount = readcount = 0;
+			time = 0;
+			for (i2 = i1; i2 < pgmcount; i2++) {
+				pcode = *plan->pgm + i2;
+				if (!explainisread(pcode)) continue;
+				explainaccess(hplan, pcode, &tableref2, &indexnum2);
+				if (tableref2 != tableref || indexnum2 != indexnum) continue;
+				prof = *plan->profile + i2;
+				execcount += prof->count;
+				readcount += prof->rows;
+				time += prof->time;
+			}
+			row = *hrows + count++ * rowbytecount;
+			memset(row, ' ', rowbytecount);
+			explaintext(row, crf1 + 1, "TABLE READS");
+			tab1 = tableptr(plan->tablenums[tableref - 1]);
+			explaintext(row, crf1 + 2, nameptr(tab1->name));
+			if (indexnum) explaintext(row, crf1 + 3, nameptr(indexptr(tab1, indexnum)->indexfilename));
+			explaintext(row, crf1 + 4, layerdetails[layer]);
+			explainnum(row, crf1 + 5, execcount);
+			explainnum(row, crf1 + 6, readcount);
+			explainnum(row, crf1 + 7, (OFFSET) time);
+		}
+		for (i1 = 0, execcount = 0; i1 < EXPLAIN_LAYERS; i1++) {
+			row = *hrows + count++ * rowbytecount;
+			memset(row, ' ', rowbytecount);
+			explaintext(row, crf1 + 1, layernames[i1]);
+			explaintext(row, crf1 + 4, layerdetails[i1]);
+			explainnum(row, crf1 + 5, layercount[i1]);
+			explainnum(row, crf1 + 7, (OFFSET) layertime[i1]);
+			execcount += layercount[i1];
+		}
+		row = *hrows + count++ * rowbytecount;
+		memset(row, ' ', rowbytecount);
+		explaintext(row, crf1 + 1, "TOTAL");
+		explaintext(row, crf1 + 4, "elapsed time, rows returned or changed");
+		explainnum(row, crf1 + 5, execcount);
+		explainnum(row, crf1 + 6, resultrows);
+		explainnum(row, crf1 + 7, (OFFSET) elapsed);
+	}
+	freeplan(hplan);
+
+	worksetnum = allocworkset(1);
+	if (worksetnum < 0) {
+		memfree(hrows);
+		memfree((UCHAR **) hcorr);
+		memfree((UCHAR **) hcrf1);
+		return worksetnum;
+	}
+	wsinfo = *(*(*connection.hworksetarray + worksetnum - 1));
+	wsinfo->corrtable = hcorr;
+	wks1 = wsinfo->workset;
+	wks1->updatable = 'R';
+	wks1->numcolrefs = wks1->rsnumcolumns = numcolumns;
+	wks1->colrefarray = hcrf1;
+	wks1->rsrowbytes = wks1->rowbytes = rowbytecount;
+	wks1->rows = hrows;
+	wks1->rowcount = wks1->memrowalloc = count;
+	*rsid = worksetnum;
+	return 6;
+}
+
+/**
+ * for an operation that reads records, return the file layer it reads through
+ * (EXPLAIN_xxx), w/ tableref and indexnum = table reference and index number
+ * return -1 if the operation does not read records
+ * return -2 if an earlier operation reads the same table through the same index
+ */
+static INT explainread(HPLAN hplan, INT pcount, INT *tableref, INT *indexnum)
+{
+	INT i1, indexnum2, layer, tableref2;
+	PCODE *pcode;
+
+	pcode = *(*hplan)->pgm;
+	if (!explainisread(pcode + pcount)) return -1;
+	layer = explainaccess(hplan, pcode + pcount, tableref, indexnum);
+	if (!*tableref) return -1;
+	for (i1 = 0; i1 < pcount; i1++) {
+		if (!explainisread(pcode + i1)) continue;
+		explainaccess(hplan, pcode + i1, &tableref2, &indexnum2);
+		if (tableref2 == *tableref && indexnum2 == *indexnum) return -2;
+	}
+	return layer;
+}
+
+/* return TRUE if the operation reads records of a table */
+static INT explainisread(PCODE *pcode)
+{
+	return (pcode->code >= OP_READNEXT && pcode->code <= OP_READPOS) || pcode->code == OP_HASHBUILD
+		|| pcode->code == OP_HASHNEXT || pcode->code == OP_HASHPREV;
+}
+
+/**
+ * return the file layer that an operation works through (EXPLAIN_xxx)
+ * w/ tableref and indexnum = table reference and index number used (0 if none)
+ */
+static INT explainaccess(HPLAN hplan, PCODE *pcode, INT *tableref, INT *indexnum)
+{
+	TABLE *tab1;
+
+	*tableref = *indexnum = 0;
+	switch (pcode->code) {
+	case OP_KEYINIT:
+	case OP_SETFIRST:
+	case OP_SETLAST:
+	case OP_READNEXT:
+	case OP_READPREV:
+	case OP_READBYKEY:
+	case OP_READBYKEYREV:
+		*indexnum = pcode->op2;
+		/* fall through */
+	case OP_CLEAR:
+	case OP_READPOS:
+	case OP_UNLOCK:
+	case OP_WRITE:
+	case OP_WRITEBATCH:
+	case OP_UPDATE:
+	case OP_DELETE:
+	case OP_TABLELOCK:
+	case OP_TABLEUNLOCK:
+	case OP_SCANINIT:
+		*tableref = pcode->op1;
+		break;
+	case OP_HASHBUILD:
+	case OP_HASHNEXT:
+	case OP_HASHPREV:
+		*tableref = pcode->op2;
+		break;
+	case OP_WORKINIT:
+	case OP_WORKNEWROW:
+	case OP_WORKFREE:
+	case OP_WORKGETROWID:
+	case OP_WORKSETROWID:
+	case OP_WORKGETROWCOUNT:
+	case OP_WORKSORT:
+	case OP_WORKUNIQUE:
+		return EXPLAIN_WORKSET;
+	default:
+		return EXPLAIN_OTHER;
+	}
+	if (*tableref < 1 || *tableref > (*hplan)->numtables) {
+		*tableref = *indexnum = 0;
+		return EXPLAIN_OTHER;
+	}
+	tab1 = tableptr((*hplan)->tablenums[*tableref - 1]);
+	if (*indexnum < 1 || *indexnum > tab1->numindexes) {
+		*indexnum = 0;
+		/* a batched write only copies the record, OP_WRITEBATCH writes it */
+		if (pcode->code == OP_CLEAR || (pcode->code == OP_WRITE && pcode->op2)) return EXPLAIN_OTHER;
+		return EXPLAIN_RIO;
+	}
+	return (indexptr(tab1, *indexnum)->type == INDEX_TYPE_AIM) ? EXPLAIN_AIO : EXPLAIN_XIO;
+}
+
+/* describe the operands of an operation, other than its table and index */
+static void explaindetail(HPLAN hplan, PCODE *pcode, CHAR *operands, CHAR *detail)
+{
+	INT i1, len, value;
+	CHAR part[2 * MAX_NAME_LENGTH + 32];
+
+	detail[0] = '\0';
+	for (i1 = len = 0; i1 < 3; i1++) {
+		if (!i1) value = pcode->op1;
+		else if (i1 == 1) value = pcode->op2;
+		else value = pcode->op3;
+		switch (operands[i1]) {
+		case 'i':
+			if (value) continue;
+			strcpy(part, "file order");
+			break;
+		case 'v':
+			if (!value) continue;
+			sprintf(part, "var %d", value);
+			break;
+		case 'c':
+			explaincolref(hplan, (UINT) value, part);
+			break;
+		case 'w':
+			sprintf(part, "workset %d", value - (*hplan)->numtables);
+			break;
+		case 'a':
+			sprintf(part, "step %d", value);
+			break;
+		case 'n':
+			sprintf(part, "%d", value);
+			break;
+		case 'o':
+			strcpy(part, getopname(value, NULL));
+			break;
+		default:
+			continue;
+		}
+		if (len + (INT) strlen(part) + 3 > 128) break;
+		if (len) {
+			strcpy(detail + len, ", ");
+			len += 2;
+		}
+		strcpy(detail + len, part);
+		len += (INT) strlen(part);
+	}
+}
+
+/* describe a column reference: a column, a literal, an expression result or a work set column */
+static void explaincolref(HPLAN hplan, UINT colref, CHAR *dest)
+{
+	INT i1, colnum, len, tabref;
+	UCHAR *lit;
+	PLAN *plan;
+	TABLE *tab1;
+	COLREF *crf1;
+
+	plan = *hplan;
+	tabref = gettabref(colref);
+	colnum = getcolnum(colref);
+	if (tabref == TABREF_LITBUF) {
+		if (plan->literals == NULL || colnum + 4 > plan->litsize) strcpy(dest, "literal");
+		else {
+			lit = *plan->literals + colnum;
+			if (lit[0] != TYPE_LITERAL) {
+				strcpy(dest, "expression");
+				return;
+			}
+			len = ((INT) lit[1] << 8) + lit[2];
+			if (len > 2 * MAX_NAME_LENGTH) len = 2 * MAX_NAME_LENGTH;
+			dest[0] = '\'';
+			for (i1 = 0; i1 < len; i1++) dest[i1 + 1] = (lit[i1 + 4] >= ' ' && lit[i1 + 4] < 0x7F) ? (CHAR) lit[i1 + 4] : '?';
+			dest[len + 1] = '\'';
+			dest[len + 2] = '\0';
+		}
+	}
+	else if (tabref == TABREF_WORKVAR) sprintf(dest, "work %d", colnum);
+	else if (tabref >= 1 && tabref <= plan->numtables) {
+		tab1 = tableptr(plan->tablenums[tabref - 1]);
+		if (colnum >= 1 && colnum <= tab1->numcolumns) sprintf(dest, "%s.%s", nameptr(tab1->name), nameptr(columnptr(tab1, colnum)->name));
+		else sprintf(dest, "%s column %d", nameptr(tab1->name), colnum);
+	}
+	else {
+		tabref -= plan->numtables;
+		if (tabref <= plan->numworksets && colnum >= 1 && colnum <= (*plan->worksetcolrefinfo)[(tabref - 1) * 3 + 2]) {
+			crf1 = *plan->colrefarray + (*plan->worksetcolrefinfo)[(tabref - 1) * 3] + colnum - 1;
+			if (crf1->columnnum) {
+				tab1 = tableptr(crf1->tablenum);
+				sprintf(dest, "workset %d %s.%s", tabref, nameptr(tab1->name), nameptr(columnptr(tab1, crf1->columnnum)->name));
+				return;
+			}
+		}
+		sprintf(dest, "workset %d column %d", tabref, colnum);
+	}
+}
+
+/* copy a value into a character column of a result row, truncated to fit */
+static void explaintext(UCHAR *row, COLREF *crf1, CHAR *value)
+{
+	INT len;
+
+	len = (INT) strlen(value);
+	if (len > crf1->length) len = crf1->length;
+	memcpy(row + crf1->offset, value, len);
+}
+
+/* right justify a value in a numeric column of a result row, left null if it does not fit */
+static void explainnum(UCHAR *row, COLREF *crf1, OFFSET value)
+{
+	INT len;
+	CHAR work[32];
+
+	len = mscofftoa(value, work);
+	if (len <= crf1->length) memcpy(row + crf1->offset + crf1->length - len, work, len);
+}
+
 void closetablefiles(INT openfilenum)
 {
 	INT i1, filenum;
@@ -2039,6 +2997,7 @@ void closetablefiles(INT openfilenum)
 		memfree((unsigned char **) opf1->hopenindexarray);
 	}
 	if (opf1->hrecbuf != NULL) memfree(opf1->hrecbuf);
+	freescan(opf1);
 	memset(opf1, 0, sizeof(OPENFILE));
 }
 
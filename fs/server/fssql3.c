@@ -112,6 +112,7 @@
 #define SUPPER			68
 #define SVALUES			69
 #define SWHERE			70
+#define SANALYZE		71
 
 #define SNUMBER			80				/* number */
 #define SLITERAL		81				/* literal */
@@ -205,6 +206,8 @@ static INT sqlcattype;				/* category of scanned symbol */
 static CHAR sqlsymbol[MAX_SYM_SIZE + 1];	/* scanned symbol */
 static UCHAR sqlliteral[MAX_LIT_SIZE + 1];	/* literal or number */
 static INT sqllength;				/* length of sqlsymbol or sqlliteral */
+static INT sqlparamcount;			/* number of parameter markers scanned */
+static INT sqlparamoffset;			/* offset of last parameter marker, to detect rescanning it */
 
 
 /* Table for determining SQL keywords */
@@ -217,6 +220,7 @@ static struct {
 	SAFTER,        5, "AFTER",
 	SALL,          3, "ALL",
 	SALTER,        5, "ALTER",
+	SANALYZE,      7, "ANALYZE",
 	SAND,          3, "AND",
 	SAS,           2, "AS",
 	SASC,          3, "ASC",
@@ -292,6 +296,7 @@ static int parsedelete(S_GENERIC ***);
 static int parsecreate(S_GENERIC ***);
 static int parsedrop(S_GENERIC ***);
 static int parsealter(S_GENERIC ***);
+static int parseanalyze(S_GENERIC ***);
 static int parselock(S_GENERIC ***, INT stype);
 static int scansymbol(INT);
 static int issqlkeyword(void);
@@ -316,14 +321,15 @@ static INT afactor(INT type, HCORRTABLE, INT *, INT *, AEXPWORK **);
 static INT moreaexp(AEXPWORK **, INT);
 static INT validatesqlname(CHAR *, INT, INT isDelimitedIdentifier);
 static INT validatenumeric(COLUMN *, INT, S_VALUE **);
+static S_VALUE **makeparam(INT, INT, INT);
 static void strucpy(CHAR *dest, CHAR *src);
 
 /**
- * Return 0 if success
+ * Return 0 if success, w/ numparams = number of parameter markers
  * otherwise return SQLERR_PARSE_xxxx
- * Called from module fssql2 from two places, execstmt, and posupdate
+ * Called from module fssql2 from two places, parseandplan, and posupdate
  */
-INT parsesqlstmt(UCHAR *stmtstring, INT stmtlen, S_GENERIC ***stmt)
+INT parsesqlstmt(UCHAR *stmtstring, INT stmtlen, S_GENERIC ***stmt, INT *numparams)
 {
 	int rc, symtype;
 
@@ -331,6 +337,8 @@ INT parsesqlstmt(UCHAR *stmtstring, INT stmtlen, S_GENERIC ***stmt)
 	sqlstatement = stmtstring;
 	sqlstmtlength = stmtlen;
 	sqloffset = 0;
+	sqlparamcount = 0;
+	sqlparamoffset = -1;
 	symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);
 	switch (symtype) {
 	case SSELECT:
@@ -360,9 +368,13 @@ INT parsesqlstmt(UCHAR *stmtstring, INT stmtlen, S_GENERIC ***stmt)
 	case SALTER:
 		rc = parsealter(stmt);
 		break;
+	case SANALYZE:
+		rc = parseanalyze(stmt);
+		break;
 	default:
 		return sqlerrnummsg(SQLERR_PARSE_ERROR, "Invalid or unsupported SQL statement", (CHAR *) stmtstring);
 	}
+	*numparams = sqlparamcount;
 	return rc;
 }
 
@@ -378,6 +390,8 @@ INT scanselectstmt(UCHAR *stmtstring, INT stmtlen, S_GENERIC ***stmt)
 	sqlstmtlength = stmtlen;
 	sqloffset = 0;
 	symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);
+	sqlparamcount = 0;
+	sqlparamoffset = -1;
 	if (symtype != SSELECT) return sqlerrnummsg(SQLERR_PARSE_ERROR, "Expecting SQL SELECT statement", (CHAR *) stmtstring);
 	rc = parseselect(stmt, TRUE);
 	return rc;
@@ -426,7 +440,7 @@ void freestmt(S_GENERIC **stmt)
 		memfree((unsigned char **)(*hinsert)->tabcolnumarray);
 		if ((*hinsert)->valuesarray != NULL) {
 			valuesarray = (*hinsert)->valuesarray;
-			for (i1 = 0; i1 < (*hinsert)->numvalues; i1++)
+			for (i1 = 0; i1 < (*hinsert)->numrows * (*hinsert)->numvalues; i1++)
 				memfree((unsigned char **)(*valuesarray)[i1]);
 			memfree((unsigned char **) valuesarray);
 		}
@@ -473,6 +487,7 @@ void freestmt(S_GENERIC **stmt)
 		}
 		break;
 	case STYPE_ALTER:
+	case STYPE_ANALYZE:
 	case STYPE_CREATE:
 	case STYPE_DROP:
 		/* nothing to do */
@@ -828,6 +843,7 @@ static int parseselect(S_GENERIC ***stmt, INT scanonlyflag)
 					(*svalue)->stype = STYPE_VALUE;
 					(*svalue)->length = sqllength;
 					(*svalue)->litoffset = 0;
+					(*svalue)->paramnum = 0;
 					(*svalue)->escape[0] = '\0';
 					memcpy((*svalue)->data, sqlliteral, sqllength);
 					(*workarray)[numcolumns++] = tabcolnum = gettabcolref(TABREF_LITEXP, numspecial);
@@ -1356,7 +1372,7 @@ procerror:	/* an error occurred, undo memory allocation */
 /*
  * parseinsert
  *		Parse an SQL INSERT statement.
- *		INSERT [INTO] table [(column [,column]... )] VALUES (value [,value]...)
+ *		INSERT [INTO] table [(column [,column]... )] VALUES (value [,value]...) [, (value [,value]...)]...
  *	Exit:
  *		statement parsed and described in the STATEMENT structure
  *	Returns:
@@ -1365,7 +1381,7 @@ procerror:	/* an error occurred, undo memory allocation */
  */
 static INT parseinsert(S_GENERIC ***stmt)
 {
-	INT i1, columnnum, maxvalues, minus, numcolumns, numvalues;
+	INT i1, columnnum, maxvalues, minus, numcolumns, numrows, numvalues, rowbase, valuesalloc, valuenum;
 	INT symtype, tablenum, tabcolnum;
 	UINT **tabcolnumsarray;
 	CHAR name[MAX_NAME_LENGTH + 1];
@@ -1375,7 +1391,7 @@ static INT parseinsert(S_GENERIC ***stmt)
 	S_VALUE **valuep, ****valuesarray;
 
 	*stmt = NULL;
-	numvalues = numcolumns = 0;
+	numvalues = numcolumns = valuesalloc = 0;
 	tabcolnumsarray = NULL;
 	valuesarray = NULL;
 
@@ -1466,11 +1482,6 @@ static INT parseinsert(S_GENERIC ***stmt)
 		sqlerrnummsg(SQLERR_PARSE_ERROR, "expected keyword VALUES", NULL);
 		goto procerror;
 	}
-	symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);	/* next symbol must be left parenthesis */
-	if (symtype != SLPAREN) {
-		sqlerrnummsg(SQLERR_PARSE_ERROR, "expected (value list)", NULL);
-		goto procerror;
-	}
 	maxvalues = (numcolumns) ? numcolumns : tab1->numcolumns;
 	valuesarray = (S_VALUE ****) memalloc(maxvalues * sizeof(S_VALUE **), MEMFLAGS_ZEROFILL);
 	tab1 = tableptr(tablenum);
@@ -1478,88 +1489,125 @@ static INT parseinsert(S_GENERIC ***stmt)
 		sqlerrnum(SQLERR_PARSE_NOMEM);
 		goto procerror;
 	}
-	do {  /* process (value [,value]... ) */
-/*** CODE: CHANGING PLUS/MINUS CODE IN NUMERIC SUPPORT COULD PARSE NUMBER IN ONE CALL ***/
-		symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);  /* get next value name */
-		if (symtype == SERROR || symtype == SEND) {  /* error or end of statement */
-			sqlerrnummsg(SQLERR_PARSE_ERROR, "expected column value specification after keyword VALUES", NULL);
-			goto procerror;
-		}
-		if (numvalues >= maxvalues) {
-			sqlerrnummsg(SQLERR_PARSE_ERROR, "too many values specified", NULL);
+	valuesalloc = maxvalues;
+	numrows = 0;
+	do {  /* process (value [,value]... ) [, (value [,value]... )]... */
+		symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);	/* next symbol must be left parenthesis */
+		if (symtype != SLPAREN) {
+			sqlerrnummsg(SQLERR_PARSE_ERROR, "expected (value list)", NULL);
 			goto procerror;
 		}
-		/* get pointer to current column structure */
-		if (tabcolnumsarray != NULL) columnnum = getcolnum((*tabcolnumsarray)[numvalues]);
-		else columnnum = numvalues + 1;
-		col1 = columnptr(tab1, columnnum);
-		if (col1->type == TYPE_CHAR || col1->type == TYPE_DATE ||
-			col1->type == TYPE_TIME || col1->type == TYPE_TIMESTAMP) {
-			if (symtype != SLITERAL) {
-/*** CODE: USE TO ALSO TEST FOR (&& symtype != SQUESTION), BUT IT WAS NOT CORRECTLY SUPPORTED BELOW ***/
-				sqlerrnummsg(SQLERR_PARSE_ERROR, "expected character string for value of column", nameptr(col1->name));
-				goto procerror;
-			}
-			/* allocate the S_VALUE structure for this column value. If it's longer than the column length, truncate it */
-			valuep = (S_VALUE **) memalloc(sizeof(S_VALUE) + min(sqllength, (INT) col1->length) - 1, 0);
-			if (valuep == NULL) {
+		rowbase = numrows * numvalues;
+		if (rowbase + numvalues > valuesalloc) {  /* room for another row */
+			valuesalloc = (numrows + 1) * 2 * numvalues;
+			if (memchange((UCHAR **) valuesarray, valuesalloc * sizeof(S_VALUE **), MEMFLAGS_ZEROFILL) == -1) {
 				sqlerrnum(SQLERR_PARSE_NOMEM);
 				goto procerror;
 			}
 			tab1 = tableptr(tablenum);
-			col1 = columnptr(tab1, columnnum);
-			(*valuesarray)[numvalues] = valuep;
-			(*valuep)->stype = STYPE_VALUE;
-			(*valuep)->length = min(sqllength, (INT) col1->length);
-			(*valuep)->litoffset = 0;
-			(*valuep)->escape[0] = '\0';
-			memcpy((*valuep)->data, sqlliteral, (INT) min(sqllength, (INT) col1->length));
-			/* if the literal is longer than the column, it's truncated. */
-			if (sqllength > (INT) col1->length) sqlswi();
 		}
-		else {  /* NUMERIC column */
-			minus = 0;
-			if (symtype == SMINUS || symtype == SPLUS) {
-				if (symtype == SMINUS) minus = 1;
-				symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);	/* get next value name */
-			}
-			if (symtype != SNUMBER && symtype != SNULL) {
-/*** CODE: USE TO ALSO TEST FOR (&& symtype != SQUESTION), BUT IT WAS NOT CORRECTLY SUPPORTED BELOW ***/
-				sqlerrnummsg(SQLERR_PARSE_ERROR, "expected number for value of column", nameptr(col1->name));
+		valuenum = 0;
+		do {  /* process (value [,value]... ) */
+/*** CODE: CHANGING PLUS/MINUS CODE IN NUMERIC SUPPORT COULD PARSE NUMBER IN ONE CALL ***/
+			symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);  /* get next value name */
+			if (symtype == SERROR || symtype == SEND) {  /* error or end of statement */
+				sqlerrnummsg(SQLERR_PARSE_ERROR, "expected column value specification after keyword VALUES", NULL);
 				goto procerror;
 			}
-			/* Allocate the S_VALUE structure for this column value based on the column length. */
-			/* The value is modified to fit the column size. */
-			if (symtype == SNUMBER) valuep = (S_VALUE **) memalloc(sizeof(S_VALUE) + (INT) col1->length - 1, 0);
-			else valuep = (S_VALUE **) memalloc(sizeof(S_VALUE), 0);
-			if (valuep == NULL) {
-				sqlerrnum(SQLERR_PARSE_NOMEM);
+			if (valuenum >= ((numrows) ? numvalues : maxvalues)) {
+				sqlerrnummsg(SQLERR_PARSE_ERROR, "too many values specified", NULL);
 				goto procerror;
 			}
-			tab1 = tableptr(tablenum);
+			/* get pointer to current column structure */
+			if (tabcolnumsarray != NULL) columnnum = getcolnum((*tabcolnumsarray)[valuenum]);
+			else columnnum = valuenum + 1;
 			col1 = columnptr(tab1, columnnum);
-			(*valuesarray)[numvalues] = valuep;
-			(*valuep)->stype = STYPE_VALUE;
-			if (symtype == SNUMBER) {
-				(*valuep)->length = col1->length;
-				if (validatenumeric(col1, minus, valuep) == SQL_ERROR)
-					goto procerror;  /* invalid or too many integral digits */
+			if (col1->type == TYPE_CHAR || col1->type == TYPE_DATE ||
+				col1->type == TYPE_TIME || col1->type == TYPE_TIMESTAMP) {
+				if (symtype == SQUESTION) {
+					valuep = makeparam(col1->length, TYPE_CHAR, 0);
+					if (valuep == NULL) goto procerror;
+					(*valuesarray)[rowbase + valuenum] = valuep;
+				}
+				else {
+					if (symtype != SLITERAL) {
+						sqlerrnummsg(SQLERR_PARSE_ERROR, "expected character string for value of column", nameptr(col1->name));
+						goto procerror;
+					}
+					/* allocate the S_VALUE structure for this column value. If it's longer than the column length, truncate it */
+					valuep = (S_VALUE **) memalloc(sizeof(S_VALUE) + min(sqllength, (INT) col1->length) - 1, 0);
+					if (valuep == NULL) {
+						sqlerrnum(SQLERR_PARSE_NOMEM);
+						goto procerror;
+					}
+					tab1 = tableptr(tablenum);
+					col1 = columnptr(tab1, columnnum);
+					(*valuesarray)[rowbase + valuenum] = valuep;
+					(*valuep)->stype = STYPE_VALUE;
+					(*valuep)->length = min(sqllength, (INT) col1->length);
+					(*valuep)->litoffset = 0;
+					(*valuep)->paramnum = 0;
+					(*valuep)->escape[0] = '\0';
+					memcpy((*valuep)->data, sqlliteral, (INT) min(sqllength, (INT) col1->length));
+					/* if the literal is longer than the column, it's truncated. */
+					if (sqllength > (INT) col1->length) sqlswi();
+				}
 			}
-			else (*valuep)->length = 0;
-			(*valuep)->litoffset = 0;
+			else if (symtype == SQUESTION) {  /* NUMERIC column, value is formatted when bound */
+				valuep = makeparam(col1->length, col1->type, col1->scale);
+				if (valuep == NULL) goto procerror;
+				(*valuesarray)[rowbase + valuenum] = valuep;
+			}
+			else {  /* NUMERIC column */
+				minus = 0;
+				if (symtype == SMINUS || symtype == SPLUS) {
+					if (symtype == SMINUS) minus = 1;
+					symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);	/* get next value name */
+				}
+				if (symtype != SNUMBER && symtype != SNULL) {
+					sqlerrnummsg(SQLERR_PARSE_ERROR, "expected number for value of column", nameptr(col1->name));
+					goto procerror;
+				}
+				/* Allocate the S_VALUE structure for this column value based on the column length. */
+				/* The value is modified to fit the column size. */
+				if (symtype == SNUMBER) valuep = (S_VALUE **) memalloc(sizeof(S_VALUE) + (INT) col1->length - 1, 0);
+				else valuep = (S_VALUE **) memalloc(sizeof(S_VALUE), 0);
+				if (valuep == NULL) {
+					sqlerrnum(SQLERR_PARSE_NOMEM);
+					goto procerror;
+				}
+				tab1 = tableptr(tablenum);
+				col1 = columnptr(tab1, columnnum);
+				(*valuesarray)[rowbase + valuenum] = valuep;
+				(*valuep)->stype = STYPE_VALUE;
+				if (symtype == SNUMBER) {
+					(*valuep)->length = col1->length;
+					if (validatenumeric(col1, minus, valuep) == SQL_ERROR)
+						goto procerror;  /* invalid or too many integral digits */
+				}
+				else (*valuep)->length = 0;
+				(*valuep)->litoffset = 0;
+				(*valuep)->paramnum = 0;
+			}
+			valuenum++;
+			symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);  /* must be comma or right paren */
+			if (symtype != SCOMMA && symtype != SRPAREN) {
+				sqlerrnummsg(SQLERR_PARSE_ERROR, "expected comma or right parenthesis", NULL);
+				goto procerror;
+			}
+		} while (symtype == SCOMMA);  /* while values */
+		if (valuenum < numcolumns) {
+			sqlerrnummsg(SQLERR_PARSE_ERROR, "too few values, all column values must be specified", NULL);
+			goto procerror;
 		}
-		numvalues++;
-		symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);  /* must be comma or right paren */
-		if (symtype != SCOMMA && symtype != SRPAREN) {
-			sqlerrnummsg(SQLERR_PARSE_ERROR, "expected comma or right parenthesis", NULL);
+		if (!numrows) numvalues = valuenum;
+		else if (valuenum != numvalues) {
+			sqlerrnummsg(SQLERR_PARSE_ERROR, "each row of values must have the same number of values", NULL);
 			goto procerror;
 		}
-	} while (symtype == SCOMMA);  /* while values */
-	if (numvalues < numcolumns) {
-		sqlerrnummsg(SQLERR_PARSE_ERROR, "too few values, all column values must be specified", NULL);
-		goto procerror;
-	}
-	symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);	/* next symbol, must be end of statement */
+		numrows++;
+		symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);	/* comma before next row or end of statement */
+	} while (symtype == SCOMMA);  /* while rows */
 	if (symtype != SEND) {	/* extraneous material at end of statement */
 		sqlerrnummsg(SQLERR_PARSE_ERROR, "extraneous material after right parenthesis", (char *) sqlstatement + sqllastoffset);
 		goto procerror;
@@ -1569,13 +1617,14 @@ static INT parseinsert(S_GENERIC ***stmt)
 	(*insertp)->numcolumns = numcolumns;
 	(*insertp)->tabcolnumarray = tabcolnumsarray;
 	(*insertp)->numvalues = numvalues;
+	(*insertp)->numrows = numrows;
 	(*insertp)->valuesarray = valuesarray;
 	*stmt = (S_GENERIC **) insertp;
 	return 0;
 
 procerror:	/* an error occurred, undo memory allocation */
 	if (valuesarray != NULL) {
-		for (i1 = 0; i1 < maxvalues; i1++) memfree((unsigned char **)(*valuesarray)[i1]);
+		for (i1 = 0; i1 < valuesalloc; i1++) memfree((unsigned char **)(*valuesarray)[i1]);
 		memfree((unsigned char **) valuesarray);
 	}
 	memfree((unsigned char **) tabcolnumsarray);
@@ -1690,6 +1739,13 @@ static int parseupdate(S_GENERIC ***stmt)
 				(*setcolumnarray)[numcolumns].expp = expp;
 				tab1 = tableptr(tablenum);
 			}
+			else if (symtype == SQUESTION) {
+				valuep = makeparam(col1->length, TYPE_CHAR, 0);
+				if (valuep == NULL) goto procerror;
+				tab1 = tableptr(tablenum);
+				(*setcolumnarray)[numcolumns].valuep = valuep;
+				symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);	/* must be comma or next symbol */
+			}
 			else {
 				if (symtype != SLITERAL) {
 					sqlerrnummsg(SQLERR_PARSE_ERROR, "expected character string for value of column", nameptr(col1->name));
@@ -1708,6 +1764,7 @@ static int parseupdate(S_GENERIC ***stmt)
 				(*valuep)->stype = STYPE_VALUE;
 				(*valuep)->length = min(sqllength, (INT) col1->length);
 				(*valuep)->litoffset = 0;
+				(*valuep)->paramnum = 0;
 				(*valuep)->escape[0] = '\0';
 				memcpy((*valuep)->data, sqlliteral, min(sqllength, (INT) col1->length));
 				/* if the literal is longer than the column, it's truncated. */
@@ -1716,7 +1773,15 @@ static int parseupdate(S_GENERIC ***stmt)
 			}
 		}
 		else {  /* NUMERIC column */
-			if (symtype != SNULL) {
+			if (symtype == SQUESTION && ((i1 = peeksymbol()) == SCOMMA || i1 == SWHERE || i1 == SEND)) {
+				/* a lone parameter is formatted for the column when bound, like a literal in INSERT */
+				valuep = makeparam(col1->length, col1->type, col1->scale);
+				if (valuep == NULL) goto procerror;
+				tab1 = tableptr(tablenum);
+				(*setcolumnarray)[numcolumns].valuep = valuep;
+				symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);	/* must be comma or next symbol */
+			}
+			else if (symtype != SNULL) {
 				expp = parseaexp(PARSE_UPDATE, &corrtablep, &symtype);
 				if (expp == NULL) goto procerror;  /* invalid expression */
 				(*setcolumnarray)[numcolumns].expp = expp;
@@ -1734,6 +1799,7 @@ static int parseupdate(S_GENERIC ***stmt)
 				(*valuep)->stype = STYPE_VALUE;
 				(*valuep)->length = 0;
 				(*valuep)->litoffset = 0;
+				(*valuep)->paramnum = 0;
 				(*valuep)->escape[0] = '\0';
 				symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);	/* must be comma or next symbol */
 			}
@@ -2582,6 +2648,43 @@ procerror:
 	return -1;
 }
 
+/**
+ * ANALYZE [table_name]
+ * collect the statistics used by the planner for one or all of the tables
+ * and save them in the statistics file beside the dbd file
+ */
+static INT parseanalyze(S_GENERIC ***stmt) {
+	INT rc, symtype, tablenum, lasttablenum;
+	CHAR name[MAX_NAME_LENGTH + 1];
+	S_GENERIC **analyzep;
+
+	*stmt = NULL;
+	symtype = scansymbol(PARSE_PLUS | PARSE_MINUS);
+	if (symtype == SEND) {
+		tablenum = 1;
+		lasttablenum = connection.numtables;
+	}
+	else {
+		if (sqlcattype != CID) return sqlerrnummsg(SQLERR_PARSE_ERROR, "expected table reference after keyword ANALYZE", NULL);
+		strucpy(name, sqlsymbol);
+		tablenum = lasttablenum = findtablenum(name);
+		if (tablenum == 0) return sqlerrnummsg(SQLERR_PARSE_TABLENOTFOUND, sqlsymbol, NULL);
+		if (scansymbol(PARSE_PLUS | PARSE_MINUS) != SEND) return sqlerrnummsg(SQLERR_PARSE_ERROR, "unexpected symbol after table reference", sqlsymbol);
+	}
+	for ( ; tablenum <= lasttablenum; tablenum++) {
+		if (tableptr(tablenum)->flags & TABLE_FLAGS_TEMPLATE) continue;
+		rc = analyzetable(tablenum);
+		if (rc) return rc;
+	}
+	if (writestatsfile(&connection) != 0) return sqlerrnummsg(SQLERR_PARSE_ERROR, cfggeterror(), NULL);
+
+	analyzep = (S_GENERIC **) memalloc(sizeof(S_GENERIC), MEMFLAGS_ZEROFILL);
+	if (analyzep == NULL) return sqlerrnum(SQLERR_PARSE_NOMEM);
+	(*analyzep)->stype = STYPE_ANALYZE;
+	*stmt = analyzep;
+	return 0;
+}
+
 static INT parsealter(S_GENERIC ***stmt) {
  	INT i1, i2, i3, i4, type;
  	INT filenum, coloffset, symtype, tablenum, aimdex, allowdups;
@@ -3983,6 +4086,7 @@ static INT parsevalues(INT type, HCORRTABLE corrtable,
 		break;
 	case SLITERAL:
 	case SNUMBER:
+	case SQUESTION:
 		if (!MORELEXP(lexpwork, whereheadp->numentries)) return FALSE;
 		ptr = (char *) sqlstatement + sqloffset;
 		while (*ptr == ' ' || *ptr == '\r' || *ptr == '\n') ptr++;
@@ -3993,18 +4097,25 @@ static INT parsevalues(INT type, HCORRTABLE corrtable,
 			(*lexpwork)->lexpentries[whereheadp->numentries].expp = aexpp;
 		}
 		else {
-			valuep = (S_VALUE **) memalloc(sizeof(S_VALUE) + sqllength - 1, 0);
-			if (valuep == NULL) {	/* memory allocation failure */
-				sqlerrnum(SQLERR_PARSE_NOMEM);
-				return FALSE;
+			if (*symtypep == SQUESTION) {
+				valuep = makeparam(MAX_PARAM_SIZE, 0, 0);
+				if (valuep == NULL) return FALSE;
+			}
+			else {
+				valuep = (S_VALUE **) memalloc(sizeof(S_VALUE) + sqllength - 1, 0);
+				if (valuep == NULL) {	/* memory allocation failure */
+					sqlerrnum(SQLERR_PARSE_NOMEM);
+					return FALSE;
+				}
+				(*valuep)->stype = STYPE_VALUE;
+				(*valuep)->length = sqllength;
+				(*valuep)->litoffset = 0;
+				(*valuep)->paramnum = 0;
+				memcpy((*valuep)->data, sqlliteral, sqllength);
+				(*valuep)->escape[0] = '\0';
 			}
 			(*lexpwork)->lexpentries[whereheadp->numentries].type = OPVALUE;
 			(*lexpwork)->lexpentries[whereheadp->numentries].valuep = valuep;
-			(*valuep)->stype = STYPE_VALUE;
-			(*valuep)->length = sqllength;
-			(*valuep)->litoffset = 0;
-			memcpy((*valuep)->data, sqlliteral, sqllength);
-			(*valuep)->escape[0] = '\0';
 			*symtypep = scansymbol(0);  /* get the next symbol */
 			if (*symtypep == SESCAPE) {
 				*symtypep = scansymbol(0);  /* get the next symbol */
@@ -4314,10 +4425,25 @@ static INT afactor(INT type, HCORRTABLE corrtable, INT *symtypep, INT *numentrie
 		(*valuep)->stype = STYPE_VALUE;
 		(*valuep)->length = sqllength;
 		(*valuep)->litoffset = 0;
+		(*valuep)->paramnum = 0;
 		memcpy((*valuep)->data, sqlliteral, sqllength);
 		(*numentriesp)++;
 		*symtypep = scansymbol(PARSE_PLUS | PARSE_MINUS);  /* get the next symbol */
 		break;
+	case SQUESTION:
+		/* the result columns of a select must have a known type and size */
+		if ((type & PARSE_SELECT) && !(type & (PARSE_ON | PARSE_WHERE | PARSE_HAVING))) {
+			sqlerrnummsg(SQLERR_PARSE_ERROR, "parameter marker not supported in select list", NULL);
+			return FALSE;
+		}
+		if (!MOREAEXP(aexpwork, *numentriesp)) return FALSE;
+		valuep = makeparam(MAX_PARAM_SIZE, 0, 0);
+		if (valuep == NULL) return FALSE;
+		(*aexpwork)->aexpentries[*numentriesp].type = OPVALUE;
+		(*aexpwork)->aexpentries[*numentriesp].valuep = valuep;
+		(*numentriesp)++;
+		*symtypep = scansymbol(PARSE_PLUS | PARSE_MINUS);  /* get the next symbol */
+		break;
 	default:
 		i1 = *symtypep;
 		if ((type & PARSE_SELECT) && !(type & (PARSE_ON | PARSE_WHERE)) &&
@@ -4400,6 +4526,7 @@ static INT afactor(INT type, HCORRTABLE corrtable, INT *symtypep, INT *numentrie
 				(*valuep)->stype = STYPE_VALUE;
 				(*valuep)->length = 2;
 				(*valuep)->litoffset = 0;
+				(*valuep)->paramnum = 0;
 				memcpy((*valuep)->data, " \0", 2);
 			}
 			else {
@@ -4459,6 +4586,7 @@ static INT afactor(INT type, HCORRTABLE corrtable, INT *symtypep, INT *numentrie
 			(*valuep)->stype = STYPE_VALUE;
 			(*valuep)->length = sqllength;
 			(*valuep)->litoffset = 0;
+			(*valuep)->paramnum = 0;
 			memcpy((*valuep)->data, sqlliteral, sqllength);
 			/* put substring position operation on expression stack */
 			(*aexpwork)->aexpentries[*numentriesp].type = OPSUBSTRPOS;
@@ -4499,6 +4627,7 @@ static INT afactor(INT type, HCORRTABLE corrtable, INT *symtypep, INT *numentrie
 			(*valuep)->stype = STYPE_VALUE;
 			(*valuep)->length = sqllength;
 			(*valuep)->litoffset = 0;
+			(*valuep)->paramnum = 0;
 			memcpy((*valuep)->data, sqlliteral, sqllength);
 			/* put substring length operation on expression stack */
 			(*aexpwork)->aexpentries[*numentriesp].type = OPSUBSTRLEN;
@@ -4693,6 +4822,39 @@ static INT moreaexp(AEXPWORK **aexpwork, int num)
 	return TRUE;
 }
 
+/*		Allocate the value for the parameter marker just scanned. */
+/* */
+/*	Entry: */
+/*		size, type and scale describe the literal slot the value is bound to */
+/* */
+/*	Returns: */
+/*		handle of the S_VALUE structure, NULL if invalid or unable to allocate memory, error given */
+static S_VALUE **makeparam(INT size, INT type, INT scale)
+{
+	S_VALUE **valuep;
+
+	/* BETWEEN and IN scan the left operand again, a marker there would be counted twice */
+	if (sqllastoffset <= sqlparamoffset) {
+		sqlerrnummsg(SQLERR_PARSE_ERROR, "parameter marker not supported as left operand of BETWEEN or IN", NULL);
+		return NULL;
+	}
+	valuep = (S_VALUE **) memalloc(sizeof(S_VALUE), 0);
+	if (valuep == NULL) {
+		sqlerrnum(SQLERR_PARSE_NOMEM);
+		return NULL;
+	}
+	sqlparamoffset = sqllastoffset;
+	(*valuep)->stype = STYPE_VALUE;
+	(*valuep)->length = 0;
+	(*valuep)->litoffset = 0;
+	(*valuep)->paramnum = ++sqlparamcount;
+	(*valuep)->paramsize = size;
+	(*valuep)->paramtype = type;
+	(*valuep)->paramscale = scale;
+	(*valuep)->escape[0] = '\0';
+	return valuep;
+}
+
 /**
  * If isDelimitedIdentifier is true, allows additional characters defined in SDELIMSTRING2
  * Returns: TRUE if valid, FALSE if invalid
@@ -4731,48 +4893,67 @@ static int validatesqlname(CHAR *stringp, int length, int isDelimitedIdentifier)
  *		SQL_ERROR if invalid or integer digits truncated, error given
  */
 static int validatenumeric(COLUMN *col1, int minus, S_VALUE **valuep) {
+	return formatnumeric(sqlliteral, sqllength, minus, col1->length, col1->scale, (*valuep)->data);
+}
+
+/**
+ * 	formatnumeric
+ *		Format a number for a NUMERIC column, also used to bind parameter values.
+ *	Entry:
+ *		number     = number (without the minus sign if negative)
+ *		numberlen  = length of number
+ *		minus      = 1 if number is negative, 0 if not
+ *		length     = length of column
+ *		scale      = scale of column
+ *	Exit:
+ *		dest       = numeric value adjusted to column precision and scale, if valid
+ *	Returns:
+ *		SQL_SUCCESS if okay
+ *		SQL_ERROR if invalid or integer digits truncated, error given
+ */
+INT formatnumeric(UCHAR *number, INT numberlen, INT minus, INT length, INT scale, UCHAR *dest) {
 	int i1, colintdigits, decpt, fracdigits, intdigits, zeroflag;
 	unsigned char *destp;
 	char work[64];
 
-	colintdigits = (col1->scale) ? col1->length - col1->scale - 1 : col1->length;
+	colintdigits = (scale) ? length - scale - 1 : length;
 	/* check integer digits */
 	zeroflag = TRUE;
-	for (i1 = 0; i1 < sqllength && isdigit(sqlliteral[i1]); i1++)
-		if (sqlliteral[i1] != '0')
+	for (i1 = 0; i1 < numberlen && isdigit(number[i1]); i1++)
+		if (number[i1] != '0')
 			zeroflag = FALSE;
 	intdigits = i1;
 	/* check for too many integer digits */
 	if (intdigits + minus > colintdigits) {
-		sprintf(work, "%.*s", sqllength, sqlliteral);
+		sprintf(work, "%.*s", (int) min(numberlen, 63), number);
 		return sqlerrnummsg(SQLERR_PARSE_BADNUMERIC,
 				"too many digits to the left of the decimal place", work);
 	}
 	/* if not at end of value, check for decimal point */
-	if (i1 < sqllength && sqlliteral[i1] == '.') {
+	if (i1 < numberlen && number[i1] == '.') {
 		i1++;
 		decpt = TRUE;
 	} else
 		decpt = FALSE;
 	/* check fractional digits */
-	for (fracdigits = 0; i1 < sqllength && isdigit(sqlliteral[i1]); fracdigits++, i1++)
-		if (sqlliteral[i1] != '0' && fracdigits < (INT) col1->scale)
+	for (fracdigits = 0; i1 < numberlen && isdigit(number[i1]); fracdigits++, i1++)
+		if (number[i1] != '0' && fracdigits < scale)
 			zeroflag = FALSE;
-	if (i1 < sqllength) { /* didn't process whole value, found an illegal character */
-		sprintf(work, "%.*s", sqllength, sqlliteral);
+	if (i1 < numberlen) { /* didn't process whole value, found an illegal character */
+		sprintf(work, "%.*s", (int) min(numberlen, 63), number);
 		return sqlerrnummsg(SQLERR_PARSE_BADNUMERIC, work, NULL);
 	}
 	/* check for too many fractional digits. This isn't an error, just a warning */
-	if (fracdigits > (INT) col1->scale) {
-		fracdigits = col1->scale; /* truncate excess fractional digits */
+	if (fracdigits > scale) {
+		fracdigits = scale; /* truncate excess fractional digits */
 		if (!fracdigits)
 			decpt = FALSE;
 		sqlswi();
 	}
 	if (zeroflag)
 		minus = 0;
-	/* number valid and not too large, copy the number into the value structure */
-	destp = (*valuep)->data;
+	/* number valid and not too large, copy the number into the destination */
+	destp = dest;
 	/* if integer digits less than column integer digits, set leading blanks */
 	if (intdigits + minus < colintdigits) {
 		memset(destp, ' ', colintdigits - intdigits);
@@ -4781,18 +4962,18 @@ static int validatenumeric(COLUMN *col1, int minus, S_VALUE **valuep) {
 		*destp++ = ' ';
 	i1 = intdigits + fracdigits;
 	if (decpt) i1++;
-	memcpy(destp, sqlliteral, i1);
+	memcpy(destp, number, i1);
 	/* change leading integer zeros to spaces */
-	for (i1 = (decpt || fracdigits < (INT) col1->scale) ? 0 : 1; intdigits > i1 && *destp == '0'; intdigits--)
+	for (i1 = (decpt || fracdigits < scale) ? 0 : 1; intdigits > i1 && *destp == '0'; intdigits--)
 		*destp++ = ' ';
 	if (minus)
 		*(destp - 1) = '-';
 	destp += intdigits + decpt + fracdigits;
 	/* if fractional digits less than column fractional digits, fill with zeros */
-	if (fracdigits < (INT) col1->scale) {
+	if (fracdigits < scale) {
 		if (!decpt)
 			*destp++ = '.';
-		memset(destp, '0', col1->scale - fracdigits);
+		memset(destp, '0', scale - fracdigits);
 	}
 	return 0;
 }
@@ -77,6 +77,8 @@ extern void debugcode(char *str, int pcount, PCODE *pgm);
 #define LBL_WORK2			(LOWESTLABEL + 21)
 #define LBL_WORK3			(LOWESTLABEL + 22)
 #define LBL_WORK4			(LOWESTLABEL + 23)
+#define LBL_WORK5			(LOWESTLABEL + 24)
+#define LBL_WORK6			(LOWESTLABEL + 25)
 #define LBL_RETURN5			(LOWESTLABEL + 30)
 #define LBL_RETURN7			(LOWESTLABEL + 31)
 #define LBL_MOVEUPDATE		(LOWESTLABEL + 100)
@@ -125,6 +127,8 @@ static INT pgmalloc;			/* size of allocated pgm */
 static UCHAR **literals;		/* literals */
 static INT litallocsize;		/* bytes allocated in literals in curren plan */
 static INT litsize;				/* bytes used in literals */
+static PARAMSLOT **paramslots;	/* literals bound to parameter markers */
+static INT numparamslots;		/* number of entries in paramslots */
 static S_WHERE **swhere;		/* handle of the S_WHERE structure used in genlexpcode */
 static HPLAN parseshplan;		/* hplan for and term parsing */
 static S_WHERE **parseswhere;	/* for and term parsing */
@@ -146,13 +150,29 @@ static int labeldefcount;		/* number of labeldefs */
 static int labelrefcount;		/* number of labelrefs */
 
 static int fixupandreordertables(S_SELECT **);
+static INT reorderjoins(S_SELECT **);
+static INT collectjointerms(S_WHERE **, INT, INT *, UINT *, UINT *, INT);
+static double lookuprows(INT, INT);
+static double joinordercost(INT *, INT, INT *, double *, double *, double *, INT, UINT *, UINT *);
+static INT mergewhere(S_WHERE ***, S_WHERE **);
+static void remaptabcolnum(UINT *, INT *, INT);
+static void remapwhere(S_WHERE **, INT *, INT);
+static void remapaexp(S_AEXP **, INT *, INT);
 static INT checkorcondition(S_WHERE ***, HPLAN);
+static INT checkhashjoin(S_WHERE **, INT, HPLAN, UINT *, UINT *);
+static INT checkhashgroup(S_SELECT **, HPLAN, INT);
+static INT checkuniquedistinct(S_SELECT **, HPLAN);
 static void bestindex(S_WHERE **, INT, INT, INT *, INT *, USHORT *, INT *, INT *, INT, UINT **);
 static INT buildindexkey(HPLAN , S_WHERE **, INT, INT, INT, USHORT *, INT, INT);
 static void checkindexrange(HPLAN, S_WHERE **, INT, INT, INT, USHORT *, INT, INT, INT);
 static void startsimpleandtermparse(HPLAN, S_WHERE **, UINT, INT, INT);
 static INT getnextsimpleandterm(INT *, INT *, INT *, INT *);
 static void genlexpcode(INT, HPLAN, EXPSRC *, INT);
+static INT isreccompare(HPLAN, UINT, UINT);
+static void genfiltercode(HPLAN, INT, INT, INT);
+static void genscancode(HPLAN, S_SELECT **, INT, INT);
+static void genscanfilter(HPLAN, S_WHERE **, INT);
+static INT issimplecompare(INT);
 static void genaexpcode(S_AEXP **, HPLAN, EXPSRC *, UINT);
 static void aexptype(S_AEXP **, HPLAN, INT *, INT *, INT *);
 static INT getexptabcolnum(S_AEXP **, INT *, INT);
@@ -175,9 +195,9 @@ INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag)
 	INT length, scale, tableref;
 	INT endoffilelabel, keyflag, orconditionflag, plancolrefsize, varcount;
 	INT lojflag, lojlevel, lojvar, op, prevreadnextlabel, readnextlabel, readtype, type;
-	INT needmovecols, tracecnt, **orderworksetref, **plancolrefinfo;
+	INT needmovecols, tracecnt, hashworksetref, hashgroupref, hashoffvar, **orderworksetref, **plancolrefinfo;
 	USHORT trace[MAX_IDXKEYS];
-	UINT tabcolnum, *tabcolnumptr, **orderarray;
+	UINT tabcolnum, hashinnertabcolnum, hashoutertabcolnum, *tabcolnumptr, **orderarray;
 	HPLAN hplan;
 	TABLE *tab1;
 	COLUMN *col1;
@@ -206,6 +226,8 @@ INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag)
 	/* all errors directed to buildselectplanerror */
 	hpgm = NULL;
 	literals = NULL;
+	paramslots = NULL;
+	numparamslots = 0;
 	plancolrefarray = NULL;
 	plancolrefinfo = NULL;
 	orderworksetref = NULL;
@@ -221,6 +243,9 @@ INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag)
 		pgmcount = litsize = labeldefcount = labelrefcount = 0;
 	}
 
+	/* with statistics for every table, inner joins may be done in a cheaper order */
+	if (!resultonlyflag && (*stmt)->numtables > 1 && reorderjoins(stmt)) goto buildselectplanerror;
+
 	/* move tables to plan and fill in index info */
 	(*hplan)->numtables = numtables = (*stmt)->numtables;
 	for (i1 = 0; i1 < numtables; i1++) {
@@ -477,6 +502,9 @@ INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag)
 	/* column reference information for result workset is now complete */
 	addpgm0(OP_RETURN);
 
+	/* rows holding a whole unique key are already distinct, so they can be returned as read */
+	if ((*stmt)->distinctflag && !(*stmt)->numsetfunctions && !(*stmt)->numgroupcolumns && checkuniquedistinct(stmt, hplan))
+		(*stmt)->distinctflag = FALSE;
 	if ((*stmt)->distinctflag) {
 		/* test if index can be used */
 		orderflag |= ORDER_OTHER | ORDER_TRYINDEX;
@@ -1017,6 +1045,12 @@ INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag)
 		/* load the columns corresponding to the keys */
 		dynamickeyflag = readtype != READ_INDEX_EXACT && dynamicflag && (orconditionflag || tableref > 1);
 		keyflag = buildindexkey(hplan, onclause, tableref, indexnum, readtype, trace, tracecnt, dynamickeyflag);
+		/* without an index, an equi-join to an earlier table is read through a hash of the table */
+		if (!keyflag && !indexnum) {
+			hashworksetref = checkhashjoin(onclause, tableref, hplan, &hashoutertabcolnum, &hashinnertabcolnum);
+			if (hashworksetref < 0) goto buildselectplanerror;
+		}
+		else hashworksetref = 0;
 		if (keyflag) {  /* using index to establish starting position */
 			if (dynamickeyflag) {
 				/* buildindexkey sets var1 if range key can be used for current direction */
@@ -1033,12 +1067,17 @@ INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag)
 			if (readtype != READ_INDEX_RANGE) addpgm1(OP_GOTO, endoffilelabel);
 			else if (dynamickeyflag) addpgm1(OP_GOTO, LBL_WORK3);
 		}
-		if (!keyflag || (readtype == READ_INDEX_RANGE && dynamickeyflag)) {
+		if (hashworksetref) {
+			addpgm3(OP_HASHBUILD, hashworksetref, tableref, hashinnertabcolnum);
+			addpgm2(OP_HASHKEY, hashworksetref, hashoutertabcolnum);
+		}
+		else if (!keyflag || (readtype == READ_INDEX_RANGE && dynamickeyflag)) {
 /* LBL_WORK2 */
 			defpgmlabel(LBL_WORK2);
 			undefpgmlabel(LBL_WORK2);
 			if (dynamickeyflag) addpgm2(OP_GOTOIFNEG, pgmcount + 3, VAR_FORWARD);
 			addpgm2(OP_SETFIRST, tableref, indexnum);
+			if (numtables == 1 && !indexnum && !orconditionflag && !(*stmt)->forupdateflag) genscancode(hplan, stmt, tableref, tablenum);
 			if (dynamickeyflag) {
 				addpgm1(OP_GOTO, pgmcount + 2);
 				addpgm2(OP_SETLAST, tableref, indexnum);
@@ -1052,10 +1091,12 @@ INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag)
 			readnextlabel = LBL_READNEXT + ++looplevel;
 			defpgmlabel(readnextlabel);
 			if (dynamicflag) addpgm2(OP_GOTOIFNEG, pgmcount + 3, VAR_FORWARD);
-			addpgm3(OP_READNEXT, tableref, indexnum, VAR_1);  /* read next */
+			if (hashworksetref) addpgm3(OP_HASHNEXT, hashworksetref, tableref, VAR_1);  /* read next in hash bucket */
+			else addpgm3(OP_READNEXT, tableref, indexnum, VAR_1);  /* read next */
 			if (dynamicflag) {
 				addpgm1(OP_GOTO, pgmcount + 2);
-				addpgm3(OP_READPREV, tableref, indexnum, VAR_1);  /* read previous */
+				if (hashworksetref) addpgm3(OP_HASHPREV, hashworksetref, tableref, VAR_1);  /* read previous in hash bucket */
+				else addpgm3(OP_READPREV, tableref, indexnum, VAR_1);  /* read previous */
 			}
 			addpgm2(OP_GOTOIFFALSE, endoffilelabel, VAR_1);
 		}
@@ -1067,10 +1108,7 @@ INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag)
 		/* break out of read loop when key range is exceeded */
 		checkindexrange(hplan, onclause, tableref, indexnum, readtype, trace, tracecnt, dynamicflag, endoffilelabel);
 		tab1 = tableptr(tablenum);
-		if (tab1->filtercolumnnum) {
-			addpgm3(OP_COLCOMPARE, makelitfromname(tab1->filtervalue), gettabcolref(tableref, tab1->filtercolumnnum), VAR_1);
-			addpgm2(OP_GOTOIFNOTZERO, readnextlabel, VAR_1);  /* skip this row */
-		}				
+		if (tab1->filtercolumnnum) genfiltercode(hplan, tableref, tablenum, readnextlabel);
 		if (onclause != NULL) {
 			swhere = onclause;
 			if (readnextlabel == endoffilelabel) {  /* reduce reference requirements */
@@ -1521,6 +1559,7 @@ INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag)
 		}
 	}
 	else {  /* static: sorting or set functions, get all rows */
+		hashgroupref = 0;
 		if ((*stmt)->forupdateflag && (*stmt)->distinctflag) {
 			/* NOTE: decided to make this limitation as the "distinct" record */
 			/*       could get modified/deleted and we would incorrectly not */
@@ -1568,8 +1607,63 @@ INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag)
 				addpgm1(OP_CALL, LBL_MOVECOLUMNS + 7);
 			}
 			else {
+				hashgroupref = checkhashgroup(stmt, hplan, (*stmt)->numsetfunctions ? worksetinfo[1].planstart : 0);
+				if (hashgroupref < 0) goto buildselectplanerror;
+				if (hashgroupref) {
+					/* accumulate the record into the hash row of its group, */
+					/* start over using the sort if the groups outgrow memory */
+					hashoffvar = ++varcount;
+					addpgm2(OP_GOTOIFNOTZERO, LBL_WORK1, hashoffvar);
+					addpgm3(OP_HASHGROUP, hashgroupref, (*stmt)->numgroupcolumns, VAR_1);
+					addpgm2(OP_GOTOIFNEG, LBL_WORK2, VAR_1);
+					addpgm2(OP_GOTOIFZERO, LBL_WORK3, VAR_1);
+					/* new group */
+					for (i1 = 0, i2 = (*stmt)->numgroupcolumns; i1 < i2; i1++)
+						addpgm2(OP_COLMOVE, (*(*stmt)->grouptabcolnumarray)[i1], gettabcolref(hashgroupref, i1 + 1));
+					for (i1 = 0, i2 = (*stmt)->numsetfunctions; i1 < i2; i1++) {
+						op = (*(*stmt)->setfunctionarray)[i1].type;
+						if (op >= OPSUM && op <= OPMAX)
+							addpgm2(OP_COLMOVE, (*(*stmt)->setfunctionarray)[i1].tabcolnum, gettabcolref(hashgroupref, (*stmt)->numgroupcolumns + i1 + 1));
+					}
+					addpgm1(OP_GOTO, LBL_WORK4);
+/* LBL_WORK3 */
+					/* existing group */
+					defpgmlabel(LBL_WORK3);
+					undefpgmlabel(LBL_WORK3);
+					for (i1 = 0, i2 = (*stmt)->numsetfunctions; i1 < i2; i1++) {
+						op = (*(*stmt)->setfunctionarray)[i1].type;
+						if (op < OPSUM || op > OPMAX) continue;
+						tabcolnum = (*(*stmt)->setfunctionarray)[i1].tabcolnum;
+						i4 = gettabcolref(hashgroupref, (*stmt)->numgroupcolumns + i1 + 1);
+						if (op == OPSUM || op == OPAVG) addpgm3(OP_COLADD, i4, tabcolnum, i4);
+						else {
+							addpgm3(OP_COLCOMPARE, i4, tabcolnum, VAR_1);
+							if (op == OPMIN) addpgm2(OP_GOTOIFNOTPOS, pgmcount + 2, VAR_1);
+							else addpgm2(OP_GOTOIFNOTNEG, pgmcount + 2, VAR_1);
+							addpgm2(OP_COLMOVE, tabcolnum, i4);
+						}
+					}
+					addpgm1(OP_GOTO, LBL_WORK4);
+/* LBL_WORK2 */
+					/* too many groups, rescan and sort */
+					defpgmlabel(LBL_WORK2);
+					undefpgmlabel(LBL_WORK2);
+					addpgm2(OP_SET, hashoffvar, 1);
+					addpgm2(OP_SET, VAR_1, 0);
+					addpgm2(OP_WORKFREE, hashgroupref, VAR_1);
+					addpgm2(OP_SET, VAR_RECNUM, 0);
+					addpgm1(OP_GOTO, LBL_READFIRST);
+/* LBL_WORK1 */
+					defpgmlabel(LBL_WORK1);
+					undefpgmlabel(LBL_WORK1);
+				}
 				addpgm1(OP_WORKNEWROW, worksetinfo[3].workset);
 				addpgm1(OP_CALL, LBL_MOVECOLUMNS + 6);
+				if (hashgroupref) {
+/* LBL_WORK4 */
+					defpgmlabel(LBL_WORK4);
+					undefpgmlabel(LBL_WORK4);
+				}
 			}
 			addpgm2(OP_INCR, VAR_RECNUM, 1);
 		}
@@ -1671,6 +1765,62 @@ INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag)
 			addpgm0(OP_TERMINATE);
 			if ((*stmt)->numgroupcolumns) {
 				if (orderflag & ORDER_OTHER) {  /* non-indexed */
+					if (hashgroupref) {
+						/* groups were aggregated in memory, sort them into the order */
+						/* the sort below would produce and move each one to the result */
+						addpgm2(OP_GOTOIFNOTZERO, LBL_WORK5, hashoffvar);
+						addpgm2(OP_WORKGETROWCOUNT, hashgroupref, VAR_RECCNT);
+						addpgm2(OP_MOVE, VAR_RECCNT, VAR_1);
+						addpgm2(OP_INCR, VAR_1, -1);
+						addpgm2(OP_GOTOIFZERO, LBL_WORK1, VAR_1);
+						addpgm2(OP_SET, VAR_1, 0);
+						for (i1 = 0, i2 = (*stmt)->numgroupcolumns; i1 < i2; i1++) {
+							addpgm2(OP_INCR, VAR_1, 1);
+							addpgm2(OP_SORTSPEC, gettabcolref(hashgroupref, i1 + 1), VAR_1);
+						}
+						addpgm2(OP_WORKSORT, hashgroupref, VAR_1);
+/* LBL_WORK1 */
+						defpgmlabel(LBL_WORK1);
+						undefpgmlabel(LBL_WORK1);
+						addpgm2(OP_SET, VAR_RECNUM, 0);
+/* LBL_WORK3 */
+						defpgmlabel(LBL_WORK3);
+						/* beginning of parse group workset loop */
+						addpgm3(OP_SUB, VAR_RECCNT, VAR_RECNUM, VAR_1);
+						addpgm2(OP_GOTOIFZERO, LBL_WORK4, VAR_1);
+						addpgm2(OP_INCR, VAR_RECNUM, 1);
+						addpgm2(OP_WORKSETROWID, hashgroupref, VAR_RECNUM);
+						worksetinfo[2].tabcolref = gettabcolref(worksetinfo[2].workset, 1);
+						for (i1 = 0, i2 = (*stmt)->numgroupcolumns; i1 < i2; i1++)
+							addpgm2(OP_COLMOVE, gettabcolref(hashgroupref, i1 + 1), worksetinfo[2].tabcolref++);
+						i3 = gettabcolref(hashgroupref, (*stmt)->numgroupcolumns + (*stmt)->numsetfunctions + 1);
+						worksetinfo[1].tabcolref = gettabcolref(worksetinfo[1].workset, 1);
+						for (i1 = 0, i2 = (*stmt)->numsetfunctions; i1 < i2; worksetinfo[1].tabcolref++, i1++) {
+							op = (*(*stmt)->setfunctionarray)[i1].type;
+							if (op == OPCOUNTALL || op == OPCOUNT) addpgm2(OP_COLMOVE, i3, worksetinfo[1].tabcolref);
+							else {
+								addpgm2(OP_COLMOVE, gettabcolref(hashgroupref, (*stmt)->numgroupcolumns + i1 + 1), worksetinfo[1].tabcolref);
+								if (op == OPAVG) addpgm3(OP_COLDIV, worksetinfo[1].tabcolref, i3, worksetinfo[1].tabcolref);
+							}
+						}
+						if ((*stmt)->having != NULL) {  /* generate expression code */
+							swhere = (*stmt)->having;
+							genlexpcode((*swhere)->numentries - 1, hplan, &expsrc, LBL_WORK3);
+						}
+						addpgm1(OP_WORKNEWROW, worksetinfo[0].workset);
+						addpgm1(OP_CALL, LBL_MOVECOLUMNS);
+						addpgm1(OP_GOTO, LBL_WORK3);
+						undefpgmlabel(LBL_WORK3);
+/* LBL_WORK4 */
+						defpgmlabel(LBL_WORK4);
+						undefpgmlabel(LBL_WORK4);
+						addpgm2(OP_SET, VAR_1, 0);
+						addpgm2(OP_WORKFREE, hashgroupref, VAR_1);
+						addpgm1(OP_GOTO, LBL_WORK6);
+/* LBL_WORK5 */
+						defpgmlabel(LBL_WORK5);
+						undefpgmlabel(LBL_WORK5);
+					}
 					orderflag &= ~ORDER_OTHER;
 					(*hplan)->flags |= PLAN_FLAG_SORT;
 					addpgm2(OP_MOVE, VAR_RECCNT, VAR_1);
@@ -1746,6 +1896,11 @@ INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag)
 				addpgm1(OP_CALL, LBL_MOVECOLUMNS);
 /* LBL_WORK1 */
 				defpgmlabel(LBL_WORK1);
+				if (hashgroupref) {
+/* LBL_WORK6 */
+					defpgmlabel(LBL_WORK6);
+					undefpgmlabel(LBL_WORK6);
+				}
 				addpgm2(OP_WORKGETROWCOUNT, worksetinfo[0].workset, VAR_RECCNT);
 				undefpgmlabel(LBL_WORK1);
 				if ((*stmt)->having != NULL) {
@@ -1807,6 +1962,11 @@ INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag)
 			if (worksetinfo[i1].rowcount == 1) addpgm1(OP_WORKNEWROW, worksetinfo[i1].workset);
 			else if (!worksetinfo[i1].rowcount && (*hplan)->multirowcnt < 255) (*hplan)->multirowcnt++;
 		}
+		if (hashgroupref) {
+			/* shares the sort workset memory, only one of them is filled */
+			addpgm2(OP_SET, VAR_1, 0);
+			addpgm2(OP_WORKINIT, hashgroupref, VAR_1);
+		}
 		if (orconditionflag) addpgm1(OP_CALL, LBL_FILLWORKSET);
 		addpgm1(OP_GOTO, LBL_READFIRST);
 
@@ -2103,6 +2263,9 @@ INT buildselectplan(S_SELECT **stmt, HPLAN *phplan, INT resultonlyflag)
 
 	(*hplan)->pgm = hpgm;
 	(*hplan)->literals = literals;
+	(*hplan)->litsize = litsize;
+	(*hplan)->paramslots = paramslots;
+	(*hplan)->numparamslots = numparamslots;
 	(*hplan)->numvars = varcount;
 	(*hplan)->pgmcount = pgmcount;
 	/* transfer the correlation (alias) table from statement to plan */
@@ -2115,6 +2278,7 @@ buildselectplanerror:
 	memfree((UCHAR **) orderworksetref);
 	memfree((UCHAR **)(*hplan)->worksetcolrefinfo);
 	memfree((UCHAR **)(*hplan)->colrefarray);
+	memfree((UCHAR **) paramslots);
 	memfree(literals);
 	memfree((UCHAR **) hpgm);
 	memfree((UCHAR **) hplan);
@@ -2124,7 +2288,7 @@ buildselectplanerror:
 /* build the plan program from the statement */
 INT buildinsertplan(S_INSERT **stmt, HPLAN *phplan)
 {
-	INT i1, i2, tabrefcolnum;
+	INT i1, i2, i3, numrows, numvalues, tabrefcolnum;
 	HPLAN hplan;
 	S_VALUE **svalue;
 
@@ -2139,25 +2303,34 @@ INT buildinsertplan(S_INSERT **stmt, HPLAN *phplan)
 	}
 	pgmalloc = 100;
 	litallocsize = 300;
+	paramslots = NULL;
+	numparamslots = 0;
 
 	execerror = FALSE;
 	pgmcount = labeldefcount = labelrefcount = litsize = 0;
-	addpgm1(OP_CLEAR, 1);
-	if ((*stmt)->numcolumns) {  /* INSERT with column names specified */
-		for (i1 = 0, i2 = (*stmt)->numcolumns; i1 < i2; i1++) {
-			svalue = (*(*stmt)->valuesarray)[i1];
-			addpgm2(OP_COLMOVE, makelitfromsvaldata(svalue), (*(*stmt)->tabcolnumarray)[i1]);
-		}			
-	}
-	else {  /* INSERT without column names specified */
-		tabrefcolnum = gettabcolref(1, 1);
-		for (i1 = 0, i2 = (*stmt)->numvalues; i1 < i2; i1++) {
-			svalue = (*(*stmt)->valuesarray)[i1];
-			addpgm2(OP_COLMOVE, makelitfromsvaldata(svalue), tabrefcolnum++);
+	numrows = (*stmt)->numrows;
+	numvalues = (*stmt)->numvalues;
+	for (i3 = 0; i3 < numrows; i3++) {
+		addpgm1(OP_CLEAR, 1);
+		if ((*stmt)->numcolumns) {  /* INSERT with column names specified */
+			for (i1 = 0, i2 = (*stmt)->numcolumns; i1 < i2; i1++) {
+				svalue = (*(*stmt)->valuesarray)[i3 * numvalues + i1];
+				addpgm2(OP_COLMOVE, makelitfromsvaldata(svalue), (*(*stmt)->tabcolnumarray)[i1]);
+			}
 		}
+		else {  /* INSERT without column names specified */
+			tabrefcolnum = gettabcolref(1, 1);
+			for (i1 = 0; i1 < numvalues; i1++) {
+				svalue = (*(*stmt)->valuesarray)[i3 * numvalues + i1];
+				addpgm2(OP_COLMOVE, makelitfromsvaldata(svalue), tabrefcolnum++);
+			}
+		}
+		/* with more than one row, the records are written together */
+		if (numrows == 1) addpgm1(OP_WRITE, 1);
+		else addpgm2(OP_WRITE, 1, 1);
 	}
-	addpgm1(OP_WRITE, 1);
-	addpgm2(OP_SET, VAR_2, 1);  /* set insert counter to 1 */
+	if (numrows > 1) addpgm1(OP_WRITEBATCH, 1);
+	addpgm2(OP_SET, VAR_2, numrows);  /* set insert counter */
 	addpgm2(OP_SET, VAR_1, 1);  /* return code 1, means count in variable 2 */
 	addpgm0(OP_TERMINATE);
 	if (execerror) goto buildinsertplanerror;
@@ -2167,14 +2340,19 @@ INT buildinsertplan(S_INSERT **stmt, HPLAN *phplan)
 
 	(*hplan)->pgm = hpgm;
 	(*hplan)->literals = literals;
+	(*hplan)->litsize = litsize;
+	(*hplan)->paramslots = paramslots;
+	(*hplan)->numparamslots = numparamslots;
 	(*hplan)->numvars = 2;
 	(*hplan)->pgmcount = pgmcount;
 	(*hplan)->numtables = 1;
 	(*hplan)->tablenums[0] = (*stmt)->tablenum;
+	if (numrows == 1) (*hplan)->flags |= PLAN_FLAG_INSERT;
 	*phplan = hplan;
 	return 0;
 
 buildinsertplanerror:
+	memfree((UCHAR **) paramslots);
 	memfree(literals);
 	memfree((UCHAR **) hpgm);
 	memfree((UCHAR **) hplan);
@@ -2204,6 +2382,8 @@ INT buildupdateplan(S_UPDATE **stmt, HPLAN *phplan)
 	}
 	pgmalloc = 100;
 	litallocsize = 300;
+	paramslots = NULL;
+	numparamslots = 0;
 	pgmcount = litsize = labeldefcount = labelrefcount = 0;
 
 	/* move tables to plan and fill in index info */
@@ -2263,10 +2443,7 @@ INT buildupdateplan(S_UPDATE **stmt, HPLAN *phplan)
 	/* break out of read loop when key range is exceeded */
 	checkindexrange(hplan, (*stmt)->where, 1, indexnum, readtype, trace, tracecnt, FALSE, endoffilelabel);
 	tab1 = tableptr(tablenum);
-	if (tab1->filtercolumnnum) {
-		addpgm3(OP_COLCOMPARE, makelitfromname(tab1->filtervalue), gettabcolref(1, tab1->filtercolumnnum), VAR_1);
-		addpgm2(OP_GOTOIFNOTZERO, readnextlabel, VAR_1);  /* skip this row */
-	}				
+	if (tab1->filtercolumnnum) genfiltercode(hplan, 1, tablenum, readnextlabel);
 	if ((*stmt)->where != NULL) {
 		swhere = (*stmt)->where;
 		if (readnextlabel == endoffilelabel) {  /* reduce reference requirements */
@@ -2306,6 +2483,9 @@ INT buildupdateplan(S_UPDATE **stmt, HPLAN *phplan)
 
 	(*hplan)->pgm = hpgm;
 	(*hplan)->literals = literals;
+	(*hplan)->litsize = litsize;
+	(*hplan)->paramslots = paramslots;
+	(*hplan)->numparamslots = numparamslots;
 	(*hplan)->numvars = varcount;
 	(*hplan)->pgmcount = pgmcount;
 	*phplan = hplan;
@@ -2314,6 +2494,7 @@ INT buildupdateplan(S_UPDATE **stmt, HPLAN *phplan)
 buildupdateplanerror:
 	memfree((UCHAR **)(*hplan)->worksetcolrefinfo);
 	memfree((UCHAR **)(*hplan)->colrefarray);
+	memfree((UCHAR **) paramslots);
 	memfree(literals);
 	memfree((UCHAR **) hpgm);
 	memfree((UCHAR **) hplan);
@@ -2341,6 +2522,8 @@ INT builddeleteplan(S_DELETE **stmt, HPLAN *phplan)
 	}
 	pgmalloc = 100;
 	litallocsize = 300;
+	paramslots = NULL;
+	numparamslots = 0;
 	pgmcount = litsize = labeldefcount = labelrefcount = 0;
 
 	/* move tables to plan and fill in index info */
@@ -2400,10 +2583,7 @@ INT builddeleteplan(S_DELETE **stmt, HPLAN *phplan)
 	/* break out of read loop when key range is exceeded */
 	checkindexrange(hplan, (*stmt)->where, 1, indexnum, readtype, trace, tracecnt, FALSE, endoffilelabel);
 	tab1 = tableptr(tablenum);
-	if (tab1->filtercolumnnum) {
-		addpgm3(OP_COLCOMPARE, makelitfromname(tab1->filtervalue), gettabcolref(1, tab1->filtercolumnnum), VAR_1);
-		addpgm2(OP_GOTOIFNOTZERO, readnextlabel, VAR_1);  /* skip this row */
-	}				
+	if (tab1->filtercolumnnum) genfiltercode(hplan, 1, tablenum, readnextlabel);
 	if ((*stmt)->where != NULL) {
 		swhere = (*stmt)->where;
 		if (readnextlabel == endoffilelabel) {  /* reduce reference requirements */
@@ -2437,6 +2617,9 @@ INT builddeleteplan(S_DELETE **stmt, HPLAN *phplan)
 
 	(*hplan)->pgm = hpgm;
 	(*hplan)->literals = literals;
+	(*hplan)->litsize = litsize;
+	(*hplan)->paramslots = paramslots;
+	(*hplan)->numparamslots = numparamslots;
 	(*hplan)->numvars = varcount;
 	(*hplan)->pgmcount = pgmcount;
 	*phplan = hplan;
@@ -2445,6 +2628,7 @@ INT builddeleteplan(S_DELETE **stmt, HPLAN *phplan)
 builddeleteplanerror:
 	memfree((UCHAR **)(*hplan)->worksetcolrefinfo);
 	memfree((UCHAR **)(*hplan)->colrefarray);
+	memfree((UCHAR **) paramslots);
 	memfree(literals);
 	memfree((UCHAR **) hpgm);
 	memfree((UCHAR **) hplan);
@@ -2584,13 +2768,447 @@ void freeplan(HPLAN hplan)
 			opf1 = openfileptr((*plan->filerefmap)[i1]);
 			if ((plan->flags & (PLAN_FLAG_FORUPDATE | PLAN_FLAG_VALIDREC)) == (PLAN_FLAG_FORUPDATE | PLAN_FLAG_VALIDREC)) riounlock(opf1->textfilenum, -1);
 			opf1->inuseflag = FALSE;
+			freescan(opf1);
 		}
 		memfree((UCHAR **) plan->filerefmap);
 	}
 	memfree((UCHAR **) plan->corrtable);
+	memfree((UCHAR **) plan->paramslots);
+	memfree((UCHAR **) plan->profile);
+	memfree(plan->batch);
 	memfree((UCHAR **) hplan);
 }
 
+/* copy a plan that has not been executed, the copy can be executed and freed */
+/* independently of the original */
+INT copyplan(HPLAN hplan, HPLAN *phplan)
+{
+	INT i1, numcolrefs, size;
+	UCHAR **src, **dest;
+	HPLAN hplan2;
+
+	*phplan = NULL;
+	hplan2 = (HPLAN) memalloc(sizeof(PLAN), 0);
+	if (hplan2 == NULL) return sqlerrnum(SQLERR_NOMEM);
+	**hplan2 = **hplan;
+	(*hplan2)->colrefarray = NULL;
+	(*hplan2)->worksetcolrefinfo = NULL;
+	(*hplan2)->literals = NULL;
+	(*hplan2)->pgm = NULL;
+	(*hplan2)->filerefmap = NULL;
+	(*hplan2)->savevars = NULL;
+	(*hplan2)->corrtable = NULL;
+	(*hplan2)->paramslots = NULL;
+	(*hplan2)->profile = NULL;
+	(*hplan2)->batch = NULL;
+	(*hplan2)->batchcount = (*hplan2)->batchalloc = 0;
+	(*hplan2)->worksetnum = 0;
+
+	/* size of the colref array is the end of the last workset */
+	if ((*hplan)->numworksets && (*hplan)->worksetcolrefinfo != NULL) {
+		i1 = ((*hplan)->numworksets - 1) * 3;
+		numcolrefs = (*(*hplan)->worksetcolrefinfo)[i1] + (*(*hplan)->worksetcolrefinfo)[i1 + 2];
+	}
+	else numcolrefs = 0;
+	for (i1 = 0; i1 < 6; i1++) {
+		switch (i1) {
+		case 0:
+			src = (UCHAR **)(*hplan)->colrefarray;
+			size = numcolrefs * sizeof(COLREF);
+			break;
+		case 1:
+			src = (UCHAR **)(*hplan)->worksetcolrefinfo;
+			size = (*hplan)->numworksets * 3 * sizeof(INT);
+			break;
+		case 2:
+			src = (*hplan)->literals;
+			size = (*hplan)->litsize;
+			break;
+		case 3:
+			src = (UCHAR **)(*hplan)->pgm;
+			size = (*hplan)->pgmcount * sizeof(PCODE);
+			break;
+		case 4:
+			src = (UCHAR **)(*hplan)->corrtable;
+			if (src != NULL) size = sizeof(CORRTABLE) + ((*(*hplan)->corrtable)->size - 1) * sizeof(CORRINFO);
+			break;
+		default:
+			src = (UCHAR **)(*hplan)->paramslots;
+			size = (*hplan)->numparamslots * sizeof(PARAMSLOT);
+			break;
+		}
+		if (src == NULL) continue;
+		dest = memalloc(size, 0);
+		if (dest == NULL) {
+			freeplan(hplan2);
+			return sqlerrnum(SQLERR_NOMEM);
+		}
+		if (size) memcpy(*dest, *src, size);
+		switch (i1) {
+		case 0:
+			(*hplan2)->colrefarray = (HCOLREF) dest;
+			break;
+		case 1:
+			(*hplan2)->worksetcolrefinfo = (INT **) dest;
+			break;
+		case 2:
+			(*hplan2)->literals = dest;
+			break;
+		case 3:
+			(*hplan2)->pgm = (HPCODE) dest;
+			break;
+		case 4:
+			(*hplan2)->corrtable = (HCORRTABLE) dest;
+			break;
+		default:
+			(*hplan2)->paramslots = (PARAMSLOT **) dest;
+			break;
+		}
+	}
+	*phplan = hplan2;
+	return 0;
+}
+
+#define MAX_JOINTERMS 64
+
+/**
+ * Reorder the tables of a select that only has inner joins when the
+ * statistics from ANALYZE estimate the new order to be cheaper. The first
+ * table is the one that reads the fewest rows, then each following table is
+ * the one that adds the least cost given the tables already joined,
+ * preferring tables that can be looked up by an index on a join column.
+ * ON conditions are moved to the where and all table references in the
+ * statement are renumbered; fixupandreordertables moves the comparisons
+ * back to the ON condition of the last table they reference.
+ * return 0 if successful (reordered or not), otherwise return negative error
+ */
+static INT reorderjoins(S_SELECT **stmt)
+{
+	INT i1, i2, i3, cnt, numterms, numtables, tablenum, termref[MAX_JOINTERMS];
+	INT map[MAX_SELECT_TABLES + 1], neworder[MAX_SELECT_TABLES], oldorder[MAX_SELECT_TABLES];
+	INT placed[MAX_SELECT_TABLES + 1], tablenums[MAX_SELECT_TABLES];
+	UINT term1[MAX_JOINTERMS], term2[MAX_JOINTERMS], *tabcolnums;
+	double cost, newcost, oldcost, rows[MAX_SELECT_TABLES + 1], filtered[MAX_SELECT_TABLES + 1], firstread[MAX_SELECT_TABLES + 1];
+	TABLE *tab1;
+	S_GENERIC **sgeneric;
+	HCORRTABLE corrtable;
+
+	numtables = (*stmt)->numtables;
+	if ((*stmt)->forupdateflag) return 0;
+	for (i1 = 0; i1 < numtables - 1; i1++) if ((*stmt)->tablejointypes[i1] != JOIN_INNER) return 0;
+	for (i1 = 0; i1 < numtables; i1++) {
+		tablenum = (*stmt)->tablenums[i1];
+		tab1 = tableptr(tablenum);
+		if (!(tab1->flags & TABLE_FLAGS_STATS)) return 0;
+		if (!(tab1->flags & TABLE_FLAGS_COMPLETE) && maketablecomplete(tablenum)) return RC_ERROR;
+	}
+
+	/* collect the equal comparisons anded together in the where and on conditions */
+	numterms = collectjointerms((*stmt)->where, 0, termref, term1, term2, numtables);
+	for (i1 = 0; i1 < numtables; i1++)
+		numterms = collectjointerms((*stmt)->joinonconditions[i1], numterms, termref, term1, term2, numtables);
+
+	/* rows read when first, and rows that survive comparisons to values */
+	for (i1 = 1; i1 <= numtables; i1++) {
+		tablenum = (*stmt)->tablenums[i1 - 1];
+		rows[i1] = (double) tableptr(tablenum)->statrows;
+		if (rows[i1] < 1) rows[i1] = 1;
+		firstread[i1] = filtered[i1] = rows[i1];
+		for (i2 = 0; i2 < numterms; i2++) {
+			if (termref[i2] != i1 || term2[i2]) continue;
+			cost = lookuprows(tablenum, getcolnum(term1[i2]));
+			if (cost > 0) {
+				if (cost < firstread[i1]) firstread[i1] = cost;
+				filtered[i1] *= cost / rows[i1];
+			}
+			else filtered[i1] /= 10;
+		}
+		if (filtered[i1] < 1) filtered[i1] = 1;
+	}
+
+	/* greedy choice of order */
+	memset(placed, 0, sizeof(placed));
+	for (cnt = 0; cnt < numtables; cnt++) {
+		i3 = 0;
+		cost = 0;
+		for (i1 = 1; i1 <= numtables; i1++) {
+			if (placed[i1]) continue;
+			neworder[cnt] = i1;
+			newcost = joinordercost(neworder, cnt + 1, (*stmt)->tablenums, rows, filtered, firstread, numterms, term1, term2);
+			if (!i3 || newcost < cost) {
+				i3 = i1;
+				cost = newcost;
+			}
+		}
+		neworder[cnt] = i3;
+		placed[i3] = TRUE;
+	}
+	for (i1 = 0; i1 < numtables; i1++) oldorder[i1] = i1 + 1;
+	oldcost = joinordercost(oldorder, numtables, (*stmt)->tablenums, rows, filtered, firstread, numterms, term1, term2);
+	newcost = joinordercost(neworder, numtables, (*stmt)->tablenums, rows, filtered, firstread, numterms, term1, term2);
+	/* only worth disturbing the written order for a clear improvement */
+	if (newcost >= oldcost * 0.9) return 0;
+
+	/* move the on conditions to the where */
+	for (i1 = 0; i1 < numtables; i1++) {
+		if ((*stmt)->joinonconditions[i1] == NULL) continue;
+		if (mergewhere(&(*stmt)->where, (*stmt)->joinonconditions[i1])) return RC_ERROR;
+		(*stmt)->joinonconditions[i1] = NULL;
+	}
+
+	/* renumber table references */
+	map[0] = 0;
+	for (i1 = 0; i1 < numtables; i1++) {
+		map[neworder[i1]] = i1 + 1;
+		tablenums[i1] = (*stmt)->tablenums[neworder[i1] - 1];
+	}
+	memcpy((*stmt)->tablenums, tablenums, numtables * sizeof(INT));
+	if ((*stmt)->numcolumns) {
+		tabcolnums = *(*stmt)->tabcolnumarray;
+		for (i1 = 0; i1 < (*stmt)->numcolumns; i1++) remaptabcolnum(&tabcolnums[i1], map, numtables);
+	}
+	for (i1 = 0; i1 < (*stmt)->numspecialcolumns; i1++) {
+		sgeneric = (*(*stmt)->specialcolumns)[i1];
+		if ((*sgeneric)->stype == STYPE_AEXP) remapaexp((S_AEXP **) sgeneric, map, numtables);
+	}
+	remapwhere((*stmt)->where, map, numtables);
+	remapwhere((*stmt)->having, map, numtables);
+	if ((*stmt)->numordercolumns) {
+		tabcolnums = *(*stmt)->ordertabcolnumarray;
+		for (i1 = 0; i1 < (*stmt)->numordercolumns; i1++) remaptabcolnum(&tabcolnums[i1], map, numtables);
+	}
+	for (i1 = 0; i1 < (*stmt)->numsetfunctions; i1++) remaptabcolnum(&(*(*stmt)->setfunctionarray)[i1].tabcolnum, map, numtables);
+	remaptabcolnum(&(*stmt)->setfuncdistinctcolumn, map, numtables);
+	if ((*stmt)->numgroupcolumns) {
+		tabcolnums = *(*stmt)->grouptabcolnumarray;
+		for (i1 = 0; i1 < (*stmt)->numgroupcolumns; i1++) remaptabcolnum(&tabcolnums[i1], map, numtables);
+	}
+	corrtable = (*stmt)->corrtable;
+	if (corrtable != NULL) {
+		for (i1 = 0; i1 < (*corrtable)->count; i1++) remaptabcolnum(&(*corrtable)->info[i1].tabcolnum, map, numtables);
+	}
+	return 0;
+}
+
+/**
+ * add the column = value and column = column comparisons that are anded
+ * together at the top of a condition to the term arrays, term2 is zero
+ * for a comparison to a value
+ * return the new number of terms
+ */
+static INT collectjointerms(S_WHERE **where, INT numterms, INT *termref, UINT *term1, UINT *term2, INT numtables)
+{
+	INT i1, left, right, wherepos;
+	LEXPENTRY *lexp;
+
+	if (where == NULL || !(*where)->numentries) return numterms;
+	lexp = (*where)->lexpentries;
+	wherepos = (*where)->numentries - 1;
+	for ( ; ; ) {
+		while (lexp[wherepos].type == OPAND) wherepos = lexp[wherepos].left;
+		if (lexp[wherepos].type == OPEQ && numterms < MAX_JOINTERMS) {
+			left = lexp[wherepos].left;
+			right = lexp[wherepos].right;
+			if (lexp[left].type != OPCOLUMN) {
+				i1 = left;
+				left = right;
+				right = i1;
+			}
+			if (lexp[left].type == OPCOLUMN && gettabref(lexp[left].tabcolnum) >= 1 && gettabref(lexp[left].tabcolnum) <= numtables) {
+				if (lexp[right].type == OPVALUE) {
+					termref[numterms] = gettabref(lexp[left].tabcolnum);
+					term1[numterms] = lexp[left].tabcolnum;
+					term2[numterms++] = 0;
+				}
+				else if (lexp[right].type == OPCOLUMN && gettabref(lexp[right].tabcolnum) >= 1 && gettabref(lexp[right].tabcolnum) <= numtables
+						&& gettabref(lexp[right].tabcolnum) != gettabref(lexp[left].tabcolnum)) {
+					termref[numterms] = 0;
+					term1[numterms] = lexp[left].tabcolnum;
+					term2[numterms++] = lexp[right].tabcolnum;
+				}
+			}
+		}
+		for ( ; ; ) {
+			i1 = lexp[wherepos].parent;
+			if (i1 == -1) break;
+			if (lexp[i1].left == wherepos && lexp[i1].type == OPAND) {
+				wherepos = lexp[i1].right;
+				break;
+			}
+			wherepos = i1;
+		}
+		if (i1 == -1) break;
+	}
+	return numterms;
+}
+
+/**
+ * return the estimated number of rows read by an equal lookup on a column
+ * using the best index that has the column first, or 0 if there is none
+ */
+static double lookuprows(INT tablenum, INT colnum)
+{
+	INT i1, i2, nextref, startpos;
+	double best, rows;
+	TABLE *tab1;
+	INDEX *idx1;
+	COLKEY *colkeys;
+	IDXKEY *keys;
+
+	tab1 = tableptr(tablenum);
+	best = 0;
+	for (i1 = 0; i1 < tab1->numindexes; i1++) {
+		idx1 = *tab1->hindexarray + i1;
+		if (idx1->hcolkeys == NULL) continue;
+		rows = 0;
+		if (idx1->type == INDEX_TYPE_ISAM) {
+			if (!idx1->statdistinct) continue;
+			colkeys = *idx1->hcolkeys;
+			for (nextref = 0; nextref != -1 && colkeys[nextref].colnum != colnum; nextref = colkeys[nextref].alt);
+			if (nextref == -1) continue;
+			rows = (double) tab1->statrows / (1 + (double)(idx1->statdistinct - 1) * colkeys[nextref].len / idx1->keylength);
+		}
+		else if (idx1->type == INDEX_TYPE_AIM) {
+			if (!idx1->statdensity) continue;
+			startpos = columnptr(tab1, colnum)->offset;
+			keys = *idx1->hkeys;
+			for (i2 = 0; i2 < idx1->numkeys; i2++)
+				if (startpos >= (INT) keys[i2].pos && startpos < (INT)(keys[i2].pos + keys[i2].len)) break;
+			if (i2 == idx1->numkeys) continue;
+			rows = (double) tab1->statrows * idx1->statdensity / 10000;
+		}
+		if (rows < 1) rows = 1;
+		if (!best || rows < best) best = rows;
+	}
+	return best;
+}
+
+/**
+ * return the estimated number of rows read to join the first cnt table
+ * references in order
+ */
+static double joinordercost(INT *order, INT cnt, INT *tablenums, double *rows, double *filtered, double *firstread, INT numterms, UINT *term1, UINT *term2)
+{
+	INT i1, i2, i3, joinflag, ref1, ref2, tableref;
+	UINT tabcolnum;
+	double cost, outer, probe, work;
+
+	cost = firstread[order[0]];
+	outer = filtered[order[0]];
+	for (i1 = 1; i1 < cnt; i1++) {
+		tableref = order[i1];
+		joinflag = FALSE;
+		probe = 0;
+		for (i2 = 0; i2 < numterms; i2++) {
+			if (!term2[i2]) continue;
+			ref1 = gettabref(term1[i2]);
+			ref2 = gettabref(term2[i2]);
+			if (ref1 == tableref) tabcolnum = term1[i2];
+			else if (ref2 == tableref) {
+				tabcolnum = term2[i2];
+				ref2 = ref1;
+			}
+			else continue;
+			for (i3 = 0; i3 < i1 && order[i3] != ref2; i3++);
+			if (i3 == i1) continue;  /* other table is not joined yet */
+			joinflag = TRUE;
+			work = lookuprows(tablenums[tableref - 1], getcolnum(tabcolnum));
+			if (work > 0 && (!probe || work < probe)) probe = work;
+		}
+		if (probe > 0) {  /* index lookup for each outer row */
+			cost += outer * probe;
+			outer *= probe * filtered[tableref] / rows[tableref];
+		}
+		else if (joinflag) {  /* hash join, one pass of the table */
+			cost += rows[tableref] + outer;
+			outer *= filtered[tableref] / rows[tableref];
+		}
+		else {  /* cross product */
+			cost += outer * rows[tableref];
+			outer *= filtered[tableref];
+		}
+		if (outer < 1) outer = 1;
+	}
+	return cost;
+}
+
+/**
+ * and the src condition into the dest condition, src is consumed
+ * return 0 if successful, otherwise return negative error
+ */
+static INT mergewhere(S_WHERE ***dest, S_WHERE **src)
+{
+	INT i1, destcnt, srccnt;
+	LEXPENTRY *lexp;
+
+	srccnt = (*src)->numentries;
+	if (*dest == NULL || !(**dest)->numentries || !srccnt) {
+		if (!srccnt) {
+			memfree((UCHAR **) src);
+			return 0;
+		}
+		if (*dest != NULL) memfree((UCHAR **) *dest);
+		*dest = src;
+		return 0;
+	}
+	destcnt = (**dest)->numentries;
+	if (memchange((UCHAR **) *dest, sizeof(S_WHERE) + (destcnt + srccnt) * sizeof(LEXPENTRY), 0) == -1)
+		return sqlerrnum(SQLERR_NOMEM);
+	lexp = (**dest)->lexpentries;
+	memcpy(&lexp[destcnt], (*src)->lexpentries, srccnt * sizeof(LEXPENTRY));
+	for (i1 = destcnt; i1 < destcnt + srccnt; i1++) {
+		if (lexp[i1].type != OPCOLUMN && lexp[i1].type != OPVALUE && lexp[i1].type != OPEXP) {
+			if (lexp[i1].left >= 0) lexp[i1].left += destcnt;
+			if (lexp[i1].right >= 0) lexp[i1].right += destcnt;
+		}
+		if (lexp[i1].parent >= 0) lexp[i1].parent += destcnt;
+	}
+	i1 = destcnt + srccnt;
+	lexp[destcnt - 1].parent = i1;
+	lexp[i1 - 1].parent = i1;
+	memset(&lexp[i1], 0, sizeof(LEXPENTRY));
+	lexp[i1].type = OPAND;
+	lexp[i1].left = destcnt - 1;
+	lexp[i1].right = i1 - 1;
+	lexp[i1].parent = -1;
+	(**dest)->numentries = i1 + 1;
+	/* the values and expressions now belong to dest */
+	memfree((UCHAR **) src);
+	return 0;
+}
+
+static void remaptabcolnum(UINT *tabcolnum, INT *map, INT numtables)
+{
+	INT tableref;
+
+	tableref = gettabref(*tabcolnum);
+	if (tableref >= 1 && tableref <= numtables) *tabcolnum = gettabcolref(map[tableref], getcolnum(*tabcolnum));
+}
+
+static void remapwhere(S_WHERE **where, INT *map, INT numtables)
+{
+	INT i1;
+	LEXPENTRY *lexp;
+
+	if (where == NULL) return;
+	for (i1 = 0; i1 < (*where)->numentries; i1++) {
+		lexp = (*where)->lexpentries + i1;
+		if (lexp->type == OPCOLUMN) remaptabcolnum(&lexp->tabcolnum, map, numtables);
+		else if (lexp->type == OPEXP) remapaexp(lexp->expp, map, numtables);
+	}
+}
+
+static void remapaexp(S_AEXP **aexp, INT *map, INT numtables)
+{
+	INT i1, op;
+
+	for (i1 = 0; i1 < (*aexp)->numentries; i1++) {
+		op = (*aexp)->aexpentries[i1].type;
+		if (op == OPCOLUMN || (op >= OPCOUNTALL && op <= OPMAXDISTINCT))
+			remaptabcolnum(&(*aexp)->aexpentries[i1].tabcolnum, map, numtables);
+	}
+}
+
 /* fix up and reorder the tables in the select statement */
 /* the fixup is to move old style join information in the where to */
 /* the appropriate ON condition */
@@ -3008,6 +3626,205 @@ static INT checkorcondition(S_WHERE ***whereptr, HPLAN hplan)
 	return 2;
 }
 
+/**
+ * look for an equi-join term (a.x = b.y) in the ON clause of tableref, where b is
+ * an earlier table.  if found, add a workset to hold the hash join build side
+ * and return its worksetref, else return 0
+ */
+static INT checkhashjoin(S_WHERE **onclause, INT tableref, HPLAN hplan, UINT *outertabcolnum, UINT *innertabcolnum)
+{
+	INT i1, i2, left, numworksets, plancolrefsize, right, type1, type2, worksetref, **plancolrefinfo;
+	UINT tabcolnum1, tabcolnum2;
+	LEXPENTRY *lexp1;
+	TABLE *tab1;
+	COLREF *crf1;
+	HCOLREF plancolrefarray;
+
+	if (onclause == NULL || tableref < 2) return 0;
+	lexp1 = (*onclause)->lexpentries;
+	tabcolnum1 = tabcolnum2 = 0;
+	for (i1 = 0; i1 < (*onclause)->numentries; i1++) {
+		if (lexp1[i1].type != OPEQ) continue;
+		/* term must be reached from the root through AND operators only */
+		for (i2 = lexp1[i1].parent; i2 != -1 && lexp1[i2].type == OPAND; i2 = lexp1[i2].parent);
+		if (i2 != -1) continue;
+		left = lexp1[i1].left;
+		right = lexp1[i1].right;
+		if (lexp1[left].type != OPCOLUMN || lexp1[right].type != OPCOLUMN) continue;
+		tabcolnum1 = lexp1[left].tabcolnum;
+		tabcolnum2 = lexp1[right].tabcolnum;
+		if (gettabref(tabcolnum1) != tableref) {
+			tabcolnum1 = tabcolnum2;
+			tabcolnum2 = lexp1[left].tabcolnum;
+		}
+		if (gettabref(tabcolnum1) != tableref || gettabref(tabcolnum2) < 1 || gettabref(tabcolnum2) >= tableref) continue;
+		tab1 = tableptr((*hplan)->tablenums[tableref - 1]);
+		type1 = columnptr(tab1, getcolnum(tabcolnum1))->type;
+		tab1 = tableptr((*hplan)->tablenums[gettabref(tabcolnum2) - 1]);
+		type2 = columnptr(tab1, getcolnum(tabcolnum2))->type;
+		/* both sides must hash the same way when they compare equal */
+		if (type1 == TYPE_POSNUM) type1 = TYPE_NUM;
+		if (type2 == TYPE_POSNUM) type2 = TYPE_NUM;
+		if (type1 == type2) break;
+	}
+	if (i1 == (*onclause)->numentries) return 0;
+
+	/* calculate worksetref */
+	worksetref = (*hplan)->numtables + (*hplan)->numworksets + 1;
+
+	/* workset row is the 8 hex digit hash value followed by the text file position */
+	numworksets = (*hplan)->numworksets;
+	if (!numworksets) {
+		plancolrefarray = (HCOLREF) memalloc(2 * sizeof(COLREF), MEMFLAGS_ZEROFILL);
+		plancolrefinfo = (INT **) memalloc(3 * sizeof(INT), 0);
+		if (plancolrefarray == NULL || plancolrefinfo == NULL) {
+			memfree((UCHAR **) plancolrefinfo);
+			memfree((UCHAR **) plancolrefarray);
+			return sqlerrnum(SQLERR_NOMEM);
+		}
+		(*hplan)->colrefarray = plancolrefarray;
+		(*hplan)->worksetcolrefinfo = plancolrefinfo;
+		plancolrefsize = 0;
+	}
+	else {
+		plancolrefarray = (*hplan)->colrefarray;
+		plancolrefinfo = (*hplan)->worksetcolrefinfo;
+		plancolrefsize = (*plancolrefinfo)[(numworksets - 1) * 3] + (*plancolrefinfo)[(numworksets - 1) * 3 + 2];
+		if (memchange((UCHAR **) plancolrefarray, (plancolrefsize + 2) * sizeof(COLREF), MEMFLAGS_ZEROFILL) == -1 ||
+			memchange((UCHAR **) plancolrefinfo, (numworksets + 1) * 3 * sizeof(INT), 0) == -1)
+			return sqlerrnum(SQLERR_NOMEM);
+	}
+	(*plancolrefinfo)[numworksets * 3] = plancolrefsize;
+	(*plancolrefinfo)[numworksets * 3 + 1] = 2;
+	(*plancolrefinfo)[numworksets * 3 + 2] = 2;
+	(*hplan)->numworksets++;
+
+	crf1 = *plancolrefarray + plancolrefsize;
+	crf1->tabcolnum = tabcolnum1;
+	crf1->type = TYPE_CHAR;
+	crf1->length = 8;
+	crf1->offset = 0;
+	crf1++;
+	crf1->type = TYPE_POSNUM;
+	crf1->length = 12;
+	crf1->offset = 8;
+
+	*innertabcolnum = tabcolnum1;
+	*outertabcolnum = tabcolnum2;
+	return worksetref;
+}
+
+/**
+ * check if the result columns of a single table 'select distinct' contain
+ * every key byte of a unique ISAM index.  if so, no two rows can be the same
+ * and 'distinct' can be dropped, keeping the plan dynamic instead of sorting
+ * the whole table before the first row.  return TRUE if so
+ */
+static INT checkuniquedistinct(S_SELECT **stmt, HPLAN hplan)
+{
+	INT i1, i2, i3, pos, end, found;
+	UINT tabcolnum;
+	TABLE *tab1;
+	COLUMN *col1;
+	INDEX *idx1;
+	IDXKEY *key1;
+
+	if ((*hplan)->numtables != 1) return FALSE;
+	tab1 = tableptr((*hplan)->tablenums[0]);
+	for (i1 = 1; i1 <= tab1->numindexes; i1++) {
+		idx1 = indexptr(tab1, i1);
+		if (idx1->type != INDEX_TYPE_ISAM || (idx1->flags & INDEX_DUPS) || !idx1->numkeys) continue;
+		for (i2 = 0; i2 < idx1->numkeys; i2++) {
+			key1 = *idx1->hkeys + i2;
+			/* walk the key bytes, skipping past each result column that holds them */
+			for (pos = key1->pos, end = key1->pos + key1->len; pos < end; ) {
+				for (found = FALSE, i3 = 0; i3 < (*stmt)->numcolumns; i3++) {
+					tabcolnum = (*(*stmt)->tabcolnumarray)[i3];
+					if (gettabref(tabcolnum) != 1) continue;
+					col1 = columnptr(tab1, getcolnum(tabcolnum));
+					if (pos >= col1->offset && pos < col1->offset + col1->fieldlen) {
+						pos = col1->offset + col1->fieldlen;
+						found = TRUE;
+						break;
+					}
+				}
+				if (!found) break;
+			}
+			if (pos < end) break;
+		}
+		if (i2 == idx1->numkeys) return TRUE;
+	}
+	return FALSE;
+}
+
+/**
+ * check if a non-indexed 'group by' can be aggregated through a hash table.
+ * if so, add a workset with one row per group: the group columns, an
+ * accumulator for each set function and the record count kept by
+ * OP_HASHGROUP, and return its worksetref, else return 0.  setfuncstart
+ * is the first set function colref
+ */
+static INT checkhashgroup(S_SELECT **stmt, HPLAN hplan, INT setfuncstart)
+{
+	INT i1, numcolrefs, numworksets, offset, plancolrefsize, type, worksetref, **plancolrefinfo;
+	UINT tabcolnum;
+	TABLE *tab1;
+	COLUMN *col1;
+	COLREF *crf1;
+	HCOLREF plancolrefarray;
+
+	if ((*stmt)->setfuncdistinctcolumn) return 0;
+	/* group equality is tested on trimmed text and normalized numbers, */
+	/* so leave any other column types to the sort */
+	for (i1 = 0; i1 < (*stmt)->numgroupcolumns; i1++) {
+		tabcolnum = (*(*stmt)->grouptabcolnumarray)[i1];
+		tab1 = tableptr((*hplan)->tablenums[gettabref(tabcolnum) - 1]);
+		type = columnptr(tab1, getcolnum(tabcolnum))->type;
+		if (type != TYPE_CHAR && type != TYPE_NUM && type != TYPE_POSNUM) return 0;
+	}
+
+	/* calculate worksetref */
+	worksetref = (*hplan)->numtables + (*hplan)->numworksets + 1;
+
+	numcolrefs = (*stmt)->numgroupcolumns + (*stmt)->numsetfunctions + 1;
+	numworksets = (*hplan)->numworksets;
+	plancolrefarray = (*hplan)->colrefarray;
+	plancolrefinfo = (*hplan)->worksetcolrefinfo;
+	plancolrefsize = (*plancolrefinfo)[(numworksets - 1) * 3] + (*plancolrefinfo)[(numworksets - 1) * 3 + 2];
+	if (memchange((UCHAR **) plancolrefarray, (plancolrefsize + numcolrefs) * sizeof(COLREF), MEMFLAGS_ZEROFILL) == -1 ||
+		memchange((UCHAR **) plancolrefinfo, (numworksets + 1) * 3 * sizeof(INT), 0) == -1)
+		return sqlerrnum(SQLERR_NOMEM);
+	(*plancolrefinfo)[numworksets * 3] = plancolrefsize;
+	(*plancolrefinfo)[numworksets * 3 + 1] = (*stmt)->numgroupcolumns;
+	(*plancolrefinfo)[numworksets * 3 + 2] = numcolrefs;
+	(*hplan)->numworksets++;
+
+	/* group columns keep the source tabcolnum, OP_HASHGROUP hashes from it */
+	crf1 = *plancolrefarray + plancolrefsize;
+	offset = 0;
+	for (i1 = 0; i1 < (*stmt)->numgroupcolumns; crf1++, i1++) {
+		tabcolnum = (*(*stmt)->grouptabcolnumarray)[i1];
+		tab1 = tableptr((*hplan)->tablenums[gettabref(tabcolnum) - 1]);
+		col1 = columnptr(tab1, getcolnum(tabcolnum));
+		crf1->tabcolnum = tabcolnum;
+		crf1->type = col1->type;
+		crf1->length = col1->length;
+		crf1->scale = col1->scale;
+		crf1->offset = offset;
+		offset += crf1->length;
+	}
+	/* accumulators are the same as the set function columns */
+	for (i1 = 0; i1 < (*stmt)->numsetfunctions; crf1++, i1++) {
+		*crf1 = (*plancolrefarray)[setfuncstart + i1];
+		crf1->offset = offset;
+		offset += crf1->length;
+	}
+	crf1->type = TYPE_NUM;
+	crf1->length = 10;
+	crf1->offset = offset;
+	return worksetref;
+}
+
 /**
  * indexnum is returned as a ONE-BASED index into the tables index array
  * readtype is returned as one of the READ_INDEX bits defined in this file
@@ -3018,6 +3835,8 @@ static void bestindex(S_WHERE **where, INT tableref, INT tablenum, INT *indexnum
 	INT i1, i2, i3, aimkeytype, checkorderflag, cnt, colref1, colref2, eqflag, index;
 	INT isikeytype, keylen, keytype, left, lefttabcolnum, newcolref1, newcolref2, newtype;
 	INT nextref, op, op1, op2, right, righttabcolnum, startpos, type, wherepos;
+	INT better, cmptype, eqlen, statsflag;
+	double cost, newcost;
 	USHORT tracework[MAX_IDXKEYS];
 	TABLE *tab1;
 	COLUMN *col1;
@@ -3170,8 +3989,17 @@ static void bestindex(S_WHERE **where, INT tableref, INT tablenum, INT *indexnum
 		return;
 	}
 
+	/* with statistics from ANALYZE, usable indexes are compared by the estimated */
+	/* number of rows each will read instead of by the kind of lookup alone */
+	statsflag = (tab1->flags & TABLE_FLAGS_STATS) != 0;
+	for (i1 = 0; statsflag && i1 < tab1->numindexes; i1++) {
+		idx1 = *tab1->hindexarray + i1;
+		if (idx1->type == INDEX_TYPE_ISAM && !idx1->statdistinct) statsflag = FALSE;
+		else if (idx1->type == INDEX_TYPE_AIM && !idx1->statdensity) statsflag = FALSE;
+	}
 	colref1 = colref2 = index = 0;
 	type = READ_INDEX_NONE << 1;
+	cost = 0;
 	for (i1 = 0; i1 < tab1->numindexes; i1++) {
 		idx1 = *tab1->hindexarray + i1;
 		if (idx1->hcolkeys == NULL) continue;
@@ -3186,6 +4014,8 @@ static void bestindex(S_WHERE **where, INT tableref, INT tablenum, INT *indexnum
 
 			newtype = READ_INDEX_NONE << 1;
 			newcolref1 = newcolref2 = 0;
+			cmptype = type;
+			newcost = 0;
 			if (idx1->type == INDEX_TYPE_ISAM) {
 				for ( ; newcolref1 < cnt; newcolref1++)
 					if (!(colkeys[tracework[newcolref1]].keytypes & KEYTYPE_EQ)) break;
@@ -3206,9 +4036,21 @@ static void bestindex(S_WHERE **where, INT tableref, INT tablenum, INT *indexnum
 				}
 				if (newtype == type) {
 					if ((newtype & ~(READ_INDEX_ALLEQUAL | 0x01)) == (READ_INDEX_EXACT << 1) || (newtype & ~(READ_INDEX_ALLEQUAL | 0x01)) == (READ_INDEX_EXACT_DUP << 1)) {
-						if (newcolref1 < colref1) type = READ_INDEX_NONE << 1;
+						if (newcolref1 < colref1) cmptype = READ_INDEX_NONE << 1;
+					}
+					else if (newcolref1 > colref1 || (newcolref1 == colref1 && newcolref2 > colref2)) cmptype = READ_INDEX_NONE << 1;
+				}
+				if (statsflag && newtype) {
+					newcost = (double) tab1->statrows;
+					i2 = (newtype >> 1) & ~READ_INDEX_ALLEQUAL;
+					if (i2 == READ_INDEX_EXACT) newcost = 1;
+					else if (i2 == READ_INDEX_EXACT_DUP) newcost /= (double) idx1->statdistinct;
+					else {
+						/* equal key prefix, assume distinct values spread evenly over the key */
+						for (i2 = eqlen = 0; i2 < newcolref1; i2++) eqlen += colkeys[tracework[i2]].len;
+						newcost /= 1 + (double)(idx1->statdistinct - 1) * eqlen / idx1->keylength;
+						if (newcolref2 > newcolref1) newcost /= 3;
 					}
-					else if (newcolref1 > colref1 || (newcolref1 == colref1 && newcolref2 > colref2)) type = READ_INDEX_NONE << 1;
 				}
 			}
 			else if (idx1->type == INDEX_TYPE_AIM) {
@@ -3227,10 +4069,18 @@ static void bestindex(S_WHERE **where, INT tableref, INT tablenum, INT *indexnum
 					}
 				}
 				if (newtype && (idx1->flags & INDEX_ALLEQUAL) && type <= (READ_INDEX_AIMDEX << 1)) newtype |= READ_INDEX_ALLEQUAL << 1;
-				if (newtype == type && newcolref2 > colref2) type = READ_INDEX_NONE << 1;
+				if (newtype == type && newcolref2 > colref2) cmptype = READ_INDEX_NONE << 1;
+				if (statsflag && newtype) {
+					/* each column looked up ands in another slot */
+					newcost = (double) tab1->statrows;
+					for (i2 = 0; i2 < newcolref2; i2++) newcost = newcost * idx1->statdensity / 10000;
+				}
 			}
-			if (newtype > type) {
+			if (statsflag && newtype) better = !index || newcost < cost || (newcost == cost && newtype > cmptype);
+			else better = newtype > cmptype;
+			if (better) {
 				type = newtype;
+				cost = newcost;
 				colref1 = newcolref1;
 				colref2 = newcolref2;
 				index = i1 + 1;
@@ -3689,12 +4539,29 @@ static void genlexpcode(INT lexpindex, HPLAN hplan, EXPSRC *expsrc, INT failgoto
 		}
 		if (lexp->type == OPLIKE) addpgm3(OP_COLLIKE, i2, i3, VAR_1);
 		else if (lexp->type == OPNULL) addpgm2(OP_COLISNULL, i2, VAR_1);
+		else if (isreccompare(hplan, i2, i3)) addpgm3(OP_RECCOMPARE, i2, i3, VAR_1);
+		else if (isreccompare(hplan, i3, i2)) {
+			/* value is on the left, compare the other way around and reverse the test */
+			addpgm3(OP_RECCOMPARE, i3, i2, VAR_1);
+			if (i1 == OP_GOTOIFNOTNEG) i1 = OP_GOTOIFNOTPOS;
+			else if (i1 == OP_GOTOIFNOTPOS) i1 = OP_GOTOIFNOTNEG;
+			else if (i1 == OP_GOTOIFPOS) i1 = OP_GOTOIFNEG;
+			else if (i1 == OP_GOTOIFNEG) i1 = OP_GOTOIFPOS;
+		}
 		else addpgm3(OP_COLCOMPARE, i2, i3, VAR_1);
 		addpgm2(i1, failgoto, VAR_1);
 	}
 	else if (lexp->type == OPAND) {
-		genlexpcode(left, hplan, expsrc, failgoto);
-		genlexpcode(right, hplan, expsrc, failgoto);
+		/* a column against a value is the cheapest test, so let it reject the row */
+		/* before expressions or LIKE patterns are evaluated */
+		if (!issimplecompare(left) && issimplecompare(right)) {
+			genlexpcode(right, hplan, expsrc, failgoto);
+			genlexpcode(left, hplan, expsrc, failgoto);
+		}
+		else {
+			genlexpcode(left, hplan, expsrc, failgoto);
+			genlexpcode(right, hplan, expsrc, failgoto);
+		}
 	}
 	else if (lexp->type == OPOR) {
 		addpgm1(OP_GOTO, pgmcount + 2);			/* skip around */
@@ -3717,6 +4584,129 @@ static void genlexpcode(INT lexpindex, HPLAN hplan, EXPSRC *expsrc, INT failgoto
 	}
 }
 
+/**
+ * return TRUE if colref is a CHAR or numeric column of a plan table and litref
+ * is a literal, so the comparison can be done by OP_RECCOMPARE
+ */
+static INT isreccompare(HPLAN hplan, UINT colref, UINT litref)
+{
+	INT tabref, type;
+	TABLE *tab1;
+
+	if (execerror) return FALSE;
+	tabref = gettabref(colref);
+	if (tabref < 1 || tabref > (*hplan)->numtables || gettabref(litref) != TABREF_LITBUF) return FALSE;
+	if ((*literals)[getcolnum(litref)] != TYPE_LITERAL) return FALSE;
+	tab1 = tableptr((*hplan)->tablenums[tabref - 1]);
+	if (getcolnum(colref) < 1 || getcolnum(colref) > tab1->numcolumns) return FALSE;
+	type = columnptr(tab1, getcolnum(colref))->type;
+	return type == TYPE_CHAR || type == TYPE_NUM || type == TYPE_POSNUM;
+}
+
+/* generate code to skip the records a table filter leaves out */
+static void genfiltercode(HPLAN hplan, INT tableref, INT tablenum, INT skiplabel)
+{
+	UINT colref, litref;
+	TABLE *tab1;
+
+	tab1 = tableptr(tablenum);
+	colref = gettabcolref(tableref, tab1->filtercolumnnum);
+	litref = makelitfromname(tab1->filtervalue);
+	if (isreccompare(hplan, colref, litref)) addpgm3(OP_RECCOMPARE, colref, litref, VAR_1);
+	else addpgm3(OP_COLCOMPARE, litref, colref, VAR_1);
+	addpgm2(OP_GOTOIFNOTZERO, skiplabel, VAR_1);  /* skip this row */
+}
+
+/**
+ * let the full scan of a single table be read in batches.  the table filter
+ * and the tests of a column against a value that every row must pass are
+ * given to the scan, so records that fail them are not returned at all
+ */
+static void genscancode(HPLAN hplan, S_SELECT **stmt, INT tableref, INT tablenum)
+{
+	UINT colref, litref;
+	TABLE *tab1;
+
+	addpgm1(OP_SCANINIT, tableref);
+	tab1 = tableptr(tablenum);
+	if (tab1->filtercolumnnum) {
+		colref = gettabcolref(tableref, tab1->filtercolumnnum);
+		litref = makelitfromname(tab1->filtervalue);
+		if (isreccompare(hplan, colref, litref)) addpgm3(OP_SCANFILTER, colref, litref, OP_GOTOIFNOTZERO);
+	}
+	if ((*stmt)->joinonconditions[tableref - 1] != NULL)
+		genscanfilter(hplan, (*stmt)->joinonconditions[tableref - 1], (*(*stmt)->joinonconditions[tableref - 1])->numentries - 1);
+	if ((*stmt)->where != NULL) genscanfilter(hplan, (*stmt)->where, (*(*stmt)->where)->numentries - 1);
+}
+
+/* add a scan filter for each column to value test joined by AND at the top of the condition */
+static void genscanfilter(HPLAN hplan, S_WHERE **where, INT lexpindex)
+{
+	INT left, right, test, type;
+	UINT colref, litref;
+	LEXPENTRY *lexp;
+
+	lexp = (*where)->lexpentries + lexpindex;
+	type = lexp->type;
+	left = lexp->left;
+	right = lexp->right;
+	if (type == OPAND) {
+		genscanfilter(hplan, where, left);
+		genscanfilter(hplan, where, right);
+		return;
+	}
+	switch (type) {
+	case OPEQ:
+		test = OP_GOTOIFNOTZERO;
+		break;
+	case OPLT:
+		test = OP_GOTOIFNOTNEG;
+		break;
+	case OPGT:
+		test = OP_GOTOIFNOTPOS;
+		break;
+	case OPLE:
+		test = OP_GOTOIFPOS;
+		break;
+	case OPGE:
+		test = OP_GOTOIFNEG;
+		break;
+	case OPNE:
+		test = OP_GOTOIFZERO;
+		break;
+	default:
+		return;
+	}
+	if ((*where)->lexpentries[left].type == OPCOLUMN && (*where)->lexpentries[right].type == OPVALUE) {
+		colref = (*where)->lexpentries[left].tabcolnum;
+		litref = makelitfromsvaldata((*where)->lexpentries[right].valuep);
+	}
+	else if ((*where)->lexpentries[left].type == OPVALUE && (*where)->lexpentries[right].type == OPCOLUMN) {
+		colref = (*where)->lexpentries[right].tabcolnum;
+		litref = makelitfromsvaldata((*where)->lexpentries[left].valuep);
+		/* value is on the left, reverse the test */
+		if (test == OP_GOTOIFNOTNEG) test = OP_GOTOIFNOTPOS;
+		else if (test == OP_GOTOIFNOTPOS) test = OP_GOTOIFNOTNEG;
+		else if (test == OP_GOTOIFPOS) test = OP_GOTOIFNEG;
+		else if (test == OP_GOTOIFNEG) test = OP_GOTOIFPOS;
+	}
+	else return;
+	if (isreccompare(hplan, colref, litref)) addpgm3(OP_SCANFILTER, colref, litref, test);
+}
+
+/* return TRUE if the logical expression entry compares a column to a value */
+static INT issimplecompare(INT lexpindex)
+{
+	INT op1, op2;
+	LEXPENTRY *lexp;
+
+	lexp = (*swhere)->lexpentries + lexpindex;
+	if (lexp->type < OPEQ || lexp->type > OPNE) return FALSE;
+	op1 = (*swhere)->lexpentries[lexp->left].type;
+	op2 = (*swhere)->lexpentries[lexp->right].type;
+	return (op1 == OPCOLUMN && op2 == OPVALUE) || (op1 == OPVALUE && op2 == OPCOLUMN);
+}
+
 /* generate code for an arithmetic expression */
 static void genaexpcode(S_AEXP **aexp, HPLAN hplan, EXPSRC *expsrc, UINT desttabcolnum)
 {
@@ -3882,6 +4872,7 @@ static void aexptype(S_AEXP **aexp, HPLAN hplan, INT *type, INT *len, INT *scale
 		INT type;
 		INT len;
 		INT scale;
+		INT param;
 	} stack[16];
 
 	*type = *len = *scale = 0;
@@ -3896,15 +4887,22 @@ static void aexptype(S_AEXP **aexp, HPLAN hplan, INT *type, INT *len, INT *scale
 			col1 = columnptr(tab1, getcolnum(entry->tabcolnum));
 			stack[level].type = col1->type;
 			stack[level].len = col1->length;
-			stack[level++].scale = col1->scale;
+			stack[level].scale = col1->scale;
+			stack[level++].param = FALSE;
 		}
 		else if (op == OPVALUE) {
 			if (level == sizeof(stack) / sizeof(*stack)) break;
 			stack[level].type = TYPE_CHAR;
 			stack[level].len = (*entry->valuep)->length;
 			stack[level].scale = 0;
+			stack[level].param = FALSE;
 			ptr = (*entry->valuep)->data;
-			if (stack[level].len && (ptr[0] == '-' || isdigit(ptr[0]))) {
+			if ((*entry->valuep)->paramnum) {
+				/* parameter marker, value is not known until execution */
+				stack[level].len = (*entry->valuep)->paramsize;
+				stack[level].param = TRUE;
+			}
+			else if (stack[level].len && (ptr[0] == '-' || isdigit(ptr[0]))) {
 				/* try to get scale */
 				for (i3 = 1, i4 = stack[level].len; i3 < i4 && isdigit(ptr[i3]); i3++);
 				if (i3 < i4 && ptr[i3] == '.') {
@@ -3930,7 +4928,7 @@ static void aexptype(S_AEXP **aexp, HPLAN hplan, INT *type, INT *len, INT *scale
 				stack[level].len = col1->length;
 				stack[level].scale = col1->scale;
 			}
-			level++;
+			stack[level++].param = FALSE;
 		}
 		else {
 			if (!level) {
@@ -3955,7 +4953,7 @@ static void aexptype(S_AEXP **aexp, HPLAN hplan, INT *type, INT *len, INT *scale
 					stack[level].len = stack[level + 1].len;
 				}
 				stack[level].scale = 0;
-				level++;
+				stack[level++].param = FALSE;
 			}
 			else if (op == OPCAST) {
 				/* NOTE: if length or scale were not specified (-1), */
@@ -3963,6 +4961,7 @@ static void aexptype(S_AEXP **aexp, HPLAN hplan, INT *type, INT *len, INT *scale
 				stack[level - 1].type = entry->info.cast.type;
 				if (entry->info.cast.length != -1) stack[level - 1].len = entry->info.cast.length;
 				if (entry->info.cast.scale != -1) stack[level - 1].scale = entry->info.cast.scale;		
+				stack[level - 1].param = FALSE;
 			}
 			else if (op == OPCONCAT) {
 				if (level < 2) {
@@ -3975,7 +4974,7 @@ static void aexptype(S_AEXP **aexp, HPLAN hplan, INT *type, INT *len, INT *scale
 				stack[level].type = TYPE_CHAR;
 				stack[level].len += stack[level + 1].len;
 				stack[level].scale = 0;
-				level++;
+				stack[level++].param = FALSE;
 			}
 			else if (op != OPNEGATE) {
 				if (level < 2) {
@@ -3984,18 +4983,31 @@ static void aexptype(S_AEXP **aexp, HPLAN hplan, INT *type, INT *len, INT *scale
 					return;
 				}
 				level -= 2;
-				lft1 = stack[level].len;
-				if (stack[level].scale) {
-					rgt1 = stack[level].scale;
-					lft1 -= rgt1 + 1;
+				/* a parameter marker may hold any number, so assume NUM(31,9) */
+				if (stack[level].param) {
+					lft1 = 21;
+					rgt1 = 9;
 				}
-				else rgt1 = 0;
-				lft2 = stack[level + 1].len;
-				if (stack[level + 1].scale) {
-					rgt2 = stack[level + 1].scale;
-					lft2 -= rgt2 + 1;
+				else {
+					lft1 = stack[level].len;
+					if (stack[level].scale) {
+						rgt1 = stack[level].scale;
+						lft1 -= rgt1 + 1;
+					}
+					else rgt1 = 0;
+				}
+				if (stack[level + 1].param) {
+					lft2 = 21;
+					rgt2 = 9;
+				}
+				else {
+					lft2 = stack[level + 1].len;
+					if (stack[level + 1].scale) {
+						rgt2 = stack[level + 1].scale;
+						lft2 -= rgt2 + 1;
+					}
+					else rgt2 = 0;
 				}
-				else rgt2 = 0;
 				if (op == OPADD || op == OPSUB) {
 					if (lft2 > lft1) lft1 = lft2;
 					lft1++;
@@ -4022,7 +5034,8 @@ static void aexptype(S_AEXP **aexp, HPLAN hplan, INT *type, INT *len, INT *scale
 				}
 				stack[level].type = TYPE_NUM;
 				stack[level].len = lft1;
-				stack[level++].scale = rgt1;
+				stack[level].scale = rgt1;
+				stack[level++].param = FALSE;
 			}
 		}
 	}
@@ -4124,7 +5137,24 @@ static INT makelitfromsvaldata(S_VALUE **svalue)
 		execerror = TRUE;
 		return sqlerrnummsg(SQLERR_INTERNAL, "literals too large", NULL);
 	}
-	len = (*svalue)->length;
+	if ((*svalue)->paramnum) {  /* parameter marker, reserve space for the value bound to it */
+		len = (*svalue)->paramsize;
+		if (!numparamslots) paramslots = (PARAMSLOT **) memalloc(sizeof(PARAMSLOT), 0);
+		else if (memchange((UCHAR **) paramslots, (numparamslots + 1) * sizeof(PARAMSLOT), 0)) {
+			execerror = TRUE;
+			return sqlerrnum(SQLERR_NOMEM);
+		}
+		if (paramslots == NULL) {
+			execerror = TRUE;
+			return sqlerrnum(SQLERR_NOMEM);
+		}
+		(*paramslots)[numparamslots].paramnum = (*svalue)->paramnum;
+		(*paramslots)[numparamslots].offset = litsize;
+		(*paramslots)[numparamslots].size = len;
+		(*paramslots)[numparamslots].type = (*svalue)->paramtype;
+		(*paramslots)[numparamslots++].scale = (*svalue)->paramscale;
+	}
+	else len = (*svalue)->length;
 	if (len > 65500) len = 65500;
 	if (litsize + len + 4 > litallocsize) {
 		i1 = ((litsize + len + 4) & ~0xFF) + 0x0100;
@@ -4140,7 +5170,8 @@ static INT makelitfromsvaldata(S_VALUE **svalue)
 	*(*literals + litsize++) = (UCHAR)(len >> 8);
 	*(*literals + litsize++) = (UCHAR) len;
 	*(*literals + litsize++) = 0;
-	memcpy(*literals + litsize, (*svalue)->data, len);
+	if ((*svalue)->paramnum) memset(*literals + litsize, ' ', len);
+	else memcpy(*literals + litsize, (*svalue)->data, len);
 	litsize += len;
 	return gettabcolref(TABREF_LITBUF, i1);
 }
@@ -4259,218 +5290,112 @@ static void undefpgmlabel(int labeldef)
 	labeldefcount = i2;
 }
 
+/*
+ * names of the program operations, indexed by operation code, with the kind of
+ * each of the three operands: t = tableref, i = index number, v = variable,
+ * c = colref, w = worksetref, a = address, n = number, o = operation code,
+ * - = not used
+ */
+static struct {
+	CHAR *name;
+	CHAR *operands;
+} opnames[] = {
+	"UNKNOWN",			"---",
+	"CLEAR",			"t--",
+	"KEYINIT",			"tiv",
+	"KEYLIKE",			"ccc",
+	"SETFIRST",			"ti-",
+	"SETLAST",			"ti-",
+	"READNEXT",			"tiv",
+	"READPREV",			"tiv",
+	"READBYKEY",		"tiv",
+	"READBYKEYREV",		"tiv",
+	"READPOS",			"tcv",
+	"UNLOCK",			"t--",
+	"WRITE",			"tn-",
+	"UPDATE",			"t--",
+	"DELETE",			"t--",
+	"TABLELOCK",		"t--",
+	"TABLEUNLOCK",		"t--",
+	"WORKINIT",			"wv-",
+	"WORKNEWROW",		"w--",
+	"WORKFREE",			"w--",
+	"WORKGETROWID",		"wv-",
+	"WORKSETROWID",		"wv-",
+	"WORKGETROWCOUNT",	"wv-",
+	"UNKNOWN",			"---",
+	"WORKSORT",			"wv-",
+	"WORKUNIQUE",		"wv-",
+	"SORTSPEC",			"cv-",
+	"SORTSPECD",		"cv-",
+	"SET",				"vn-",
+	"INCR",				"vn-",
+	"MOVE",				"vv-",
+	"ADD",				"vvv",
+	"SUB",				"vvv",
+	"MULT",				"vvv",
+	"DIV",				"vvv",
+	"NEGATE",			"vv-",
+	"MOVETOCOL",		"vc-",
+	"FPOSTOCOL",		"c--",
+	"COLMOVE",			"cc-",
+	"COLADD",			"ccc",
+	"COLSUB",			"ccc",
+	"COLMULT",			"ccc",
+	"COLDIV",			"ccc",
+	"COLNEGATE",		"cc-",
+	"COLLOWER",			"cc-",
+	"COLUPPER",			"cc-",
+	"COLNULL",			"c--",
+	"COLTEST",			"cv-",
+	"COLCOMPARE",		"ccv",
+	"COLISNULL",		"cv-",
+	"COLLIKE",			"ccv",
+	"COLBINSET",		"cn-",
+	"COLBININCR",		"cn-",
+	"GOTO",				"a--",
+	"GOTOIFNOTZERO",	"av-",
+	"GOTOIFZERO",		"av-",
+	"GOTOIFPOS",		"av-",
+	"GOTOIFNOTPOS",		"av-",
+	"GOTOIFNEG",		"av-",
+	"GOTOIFNOTNEG",		"av-",
+	"CALL",				"a--",
+	"RETURN",			"---",
+	"FINISH",			"---",
+	"TERMINATE",		"---",
+	"COLCAST",			"cc-",
+	"COLCONCAT",		"ccc",
+	"COLSUBSTR_LEN",	"ccc",
+	"COLSUBSTR_POS",	"ccc",
+	"COLTRIM_L",		"ccc",
+	"COLTRIM_T",		"ccc",
+	"COLTRIM_B",		"ccc",
+	"HASHBUILD",		"wtc",
+	"HASHKEY",			"wc-",
+	"HASHNEXT",			"wtv",
+	"HASHPREV",			"wtv",
+	"HASHGROUP",		"wnv",
+	"RECCOMPARE",		"ccv",
+	"SCANINIT",			"t--",
+	"SCANFILTER",		"cco",
+	"WRITEBATCH",		"t--"
+};
+
+/* return the name of an operation code, w/ operands = kinds of its operands */
+CHAR *getopname(INT code, CHAR **operands)
+{
+	if (code < 0 || code >= (INT)(sizeof(opnames) / sizeof(*opnames))) code = 0;
+	if (operands != NULL) *operands = opnames[code].operands;
+	return opnames[code].name;
+}
+
 /* following code is for debug purposes only */
 void debugcode(char *str, int pcount, PCODE *pgm)
 {
-	char debugarea[256], *ptr;
+	char debugarea[256];
 
-	switch (pgm->code) {
-	case OP_CLEAR:
-		ptr = "OP_CLEAR          ";
-		break;
-	case OP_KEYINIT:
-		ptr = "OP_KEYINIT        ";
-		break;
-	case OP_KEYLIKE:
-		ptr = "OP_KEYLIKE        ";
-		break;
-	case OP_SETFIRST:
-		ptr = "OP_SETFIRST       ";
-		break;
-	case OP_SETLAST:
-		ptr = "OP_SETLAST        ";
-		break;
-	case OP_READNEXT:
-		ptr = "OP_READNEXT       ";
-		break;
-	case OP_READPREV:
-		ptr = "OP_READPREV       ";
-		break;
-	case OP_READBYKEY:
-		ptr = "OP_READBYKEY      ";
-		break;
-	case OP_READBYKEYREV:
-		ptr = "OP_READBYKEYREV   ";
-		break;
-	case OP_READPOS:
-		ptr = "OP_READPOS        ";
-		break;
-	case OP_UNLOCK:
-		ptr = "OP_UNLOCK         ";
-		break;
-	case OP_WRITE:
-		ptr = "OP_WRITE          ";
-		break;
-	case OP_UPDATE:
-		ptr = "OP_UPDATE         ";
-		break;
-	case OP_DELETE:
-		ptr = "OP_DELETE         ";
-		break;
-	case OP_TABLELOCK:
-		ptr = "OP_TABLELOCK      ";
-		break;
-	case OP_TABLEUNLOCK:
-		ptr = "OP_TABLEUNLOCK    ";
-		break;
-	case OP_WORKINIT:
-		ptr = "OP_WORKINIT       ";
-		break;
-	case OP_WORKNEWROW:
-		ptr = "OP_WORKNEWROW     ";
-		break;
-	case OP_WORKFREE:
-		ptr = "OP_WORKFREE       ";
-		break;
-	case OP_WORKGETROWID:
-		ptr = "OP_WORKGETROWID   ";
-		break;
-	case OP_WORKSETROWID:
-		ptr = "OP_WORKSETROWID   ";
-		break;
-	case OP_WORKGETROWCOUNT:
-		ptr = "OP_WORKGETROWCOUNT";
-		break;
-	case OP_WORKSORT:
-		ptr = "OP_WORKSORT       ";
-		break;
-	case OP_WORKUNIQUE:
-		ptr = "OP_WORKUNIQUE     ";
-		break;
-	case OP_SORTSPEC:
-		ptr = "OP_SORTSPEC       ";
-		break;
-	case OP_SORTSPECD:
-		ptr = "OP_SORTSPECD      ";
-		break;
-	case OP_SET:
-		ptr = "OP_SET            ";
-		break;
-	case OP_INCR:
-		ptr = "OP_INCR           ";
-		break;
-	case OP_MOVE:
-		ptr = "OP_MOVE           ";
-		break;
-	case OP_ADD:
-		ptr = "OP_ADD            ";
-		break;
-	case OP_SUB:
-		ptr = "OP_SUB            ";
-		break;
-	case OP_MULT:
-		ptr = "OP_MULT           ";
-		break;
-	case OP_DIV:
-		ptr = "OP_DIV            ";
-		break;
-	case OP_MOVETOCOL:
-		ptr = "OP_MOVETOCOL      ";
-		break;
-	case OP_FPOSTOCOL:
-		ptr = "OP_FPOSTOCOL      ";
-		break;
-	case OP_COLMOVE:
-		ptr = "OP_COLMOVE        ";
-		break;
-	case OP_COLADD:
-		ptr = "OP_COLADD         ";
-		break;
-	case OP_COLSUB:
-		ptr = "OP_COLSUB         ";
-		break;
-	case OP_COLMULT:
-		ptr = "OP_COLMULT        ";
-		break;
-	case OP_COLDIV:
-		ptr = "OP_COLDIV         ";
-		break;
-	case OP_COLNEGATE:
-		ptr = "OP_COLNEGATE      ";
-		break;
-	case OP_COLLOWER:
-		ptr = "OP_COLLOWER       ";
-		break;
-	case OP_COLUPPER:
-		ptr = "OP_COLUPPER       ";
-		break;
-	case OP_COLTRIM_T:
-		ptr = "OP_COLTRIM_T      ";
-		break;		
-	case OP_COLTRIM_B:
-		ptr = "OP_COLTRIM_B      ";
-		break;	
-	case OP_COLTRIM_L:
-		ptr = "OP_COLTRIM_L      ";
-		break;					
-	case OP_COLSUBSTR_LEN:
-		ptr = "OP_COLSUBSTR_LEN  ";
-		break;		
-	case OP_COLSUBSTR_POS:
-		ptr = "OP_COLSUBSTR_POS  ";
-		break;
-	case OP_COLCAST:
-		ptr = "OP_COLCAST        ";
-		break;
-	case OP_COLNULL:
-		ptr = "OP_COLNULL        ";
-		break;
-	case OP_COLTEST:
-		ptr = "OP_COLTEST        ";
-		break;
-	case OP_COLCOMPARE:
-		ptr = "OP_COLCOMPARE     ";
-		break;
-	case OP_COLISNULL:
-		ptr = "OP_COLISNULL      ";
-		break;
-	case OP_COLLIKE:
-		ptr = "OP_COLLIKE        ";
-		break;
-	case OP_COLBININCR:
-		ptr = "OP_COLBININCR     ";
-		break;
-	case OP_COLBINSET:
-		ptr = "OP_COLBINSET      ";
-		break;
-	case OP_GOTO:
-		ptr = "OP_GOTO           ";
-		break;
-	case OP_GOTOIFNOTZERO:
-		ptr = "OP_GOTOIFNOTZERO  ";
-		break;
-	case OP_GOTOIFZERO:
-		ptr = "OP_GOTOIFZERO     ";
-		break;
-	case OP_GOTOIFPOS:
-		ptr = "OP_GOTOIFPOS      ";
-		break;
-	case OP_GOTOIFNOTPOS:
-		ptr = "OP_GOTOIFNOTPOS   ";
-		break;
-	case OP_GOTOIFNEG:
-		ptr = "OP_GOTOIFNEG      ";
-		break;
-	case OP_GOTOIFNOTNEG:
-		ptr = "OP_GOTOIFNOTNEG   ";
-		break;
-	case OP_CALL:
-		ptr = "OP_CALL           ";
-		break;
-	case OP_RETURN:
-		ptr = "OP_RETURN         ";
-		break;
-	case OP_FINISH:
-		ptr = "OP_FINISH         ";
-		break;
-	case OP_TERMINATE:
-		ptr = "OP_TERMINATE      ";
-		break;
-	default:
-		ptr = "UNKNOWN           ";
-		break;
-	}	
-	sprintf(debugarea, "%s: 0x%04X %s 0x%08X 0x%08X 0x%08X", str, pcount, ptr, pgm->op1, pgm->op2, pgm->op3);
+	sprintf(debugarea, "%s: 0x%04X OP_%-15s 0x%08X 0x%08X 0x%08X", str, pcount, getopname(pgm->code, NULL), pgm->op1, pgm->op2, pgm->op3);
 	debug1(debugarea);
 }
 
@@ -30,6 +30,12 @@
 #include "bmath.h"
 #include "sio.h"
 
+#if OS_UNIX
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/time.h>
+#endif
+
 /* following code is for debug purposes only */
 #define FS_DEBUGCODE 1
 
@@ -41,6 +47,52 @@
 
 #define COLREFTOSTR_DIRECT	0x01
 
+/* batched full table scans */
+#define SCANBATCH		(4 << 20)	/* bytes read for each batch */
+#define SCANMINSIZE		(64 << 10)	/* smaller files are read record by record */
+#define SCANTHREADMIN	2048		/* minimum number of records checked by each thread */
+#define SCANMAXTHREADS	16
+#define SCANMAXFILTERS	16
+#define SCANRESUME		64			/* records read by the first batch after a row is returned */
+
+#define SCANREC_SKIP	0			/* record fails a filter */
+#define SCANREC_OK		1			/* record is complete and passes the filters */
+#define SCANREC_READ	2			/* record must be read by rioget */
+
+typedef struct SCANFILTER_STRUCT {
+	INT offset;						/* offset of the column in the record */
+	INT fieldlen;					/* length of the column */
+	INT type;						/* type of the column */
+	INT test;						/* OP_GOTOIF... that rejects the record */
+	INT litoffset;					/* offset of the value in literals */
+	INT litlen;						/* length of the value */
+} SCANFILTER;
+
+struct SCANSTATE_STRUCT {
+	INT rectype;					/* RIO_T_ type of the text file */
+	INT reclength;					/* record length */
+	INT stride;						/* record length plus end of record */
+	INT threads;					/* maximum number of threads checking records */
+	INT numfilters;					/* number of filters */
+	SCANFILTER filters[SCANMAXFILTERS];
+	UCHAR *literals;				/* values of the filters */
+	INT litsize;					/* bytes used in literals */
+	OFFSET bufpos;					/* file position of the first record in buffer */
+	OFFSET nextpos;					/* file position of the next batch */
+	INT bufrecs;					/* number of records in buffer */
+	INT bufnext;					/* next record in buffer to return */
+	INT maxrecs;					/* number of records buffer holds */
+	INT batchrecs;					/* number of records read by the next batch */
+	UCHAR *buffer;					/* records of the batch */
+	UCHAR *recflags;				/* SCANREC_ value of each record in buffer */
+};
+
+typedef struct SCANPART_STRUCT {
+	SCANSTATE *scan;
+	INT first;						/* first record in buffer to check */
+	INT count;						/* number of records to check */
+} SCANPART;
+
 /* global variables */
 extern int fsflags;
 extern CONNECTION connection;
@@ -59,11 +111,30 @@ static UCHAR **updaterecbuf;				/* alternate record buffer for use by update */
 static int updaterecbufsize;			/* size of buffer */
 static char tempnumcolumns[32][64];		/* temporary numeric values for OP_COL arithmethic operations */
 static char work1[1024], work2[1024], work3[128];
+static INT sortkeylength;				/* key length for sortkeycompare */
 
 /* prototypes */
 static void execerror(void);
 static INT writedirtywks(INT worksetnum, INT count);
+static INT newwksrow(INT worksetnum, INT count);
+static INT normcolumn(UINT colrefnum, UCHAR **data, INT *datalen, UCHAR *work);
+static INT reccomparechar(UCHAR *ptr1, INT len1, UCHAR *ptr2, INT len2);
+static INT reccomparenum(UCHAR *ptr1, INT len1, UCHAR *ptr2, INT len2);
+static void scaninit(OPENFILE *opf1);
+static void scanfilter(SCANSTATE *scan, COLUMN *col1, UCHAR *literal, INT test);
+static INT scanget(OPENFILE *opf1, TABLE *tab1);
+static void scandrop(OPENFILE *opf1);
+static INT scanbatch(INT txthandle, SCANSTATE *scan);
+static void scancheck(SCANPART *part);
+static INT scancpus(void);
+static INT profilerow(PCODE *pcode);
+static UINT fnvhash(UINT hash, UCHAR *data, INT len);
+static INT hashcolumn(UINT colrefnum, UINT *hash);
+static INT hashgroup(INT worksetnum, INT count, INT numkeys, INT *found);
 static int sqlaimrec(int, int, int, int, int, int *);
+static INT writerecords(INT openfilenum, UCHAR **records, INT count);
+static INT sortkeys(INT tablenum, INT indexnum, UCHAR **records, INT count, INT reclength, UCHAR ***hkeys, INT *keylength, INT *entrysize);
+static int sortkeycompare(const void *entry1, const void *entry2);
 static void buildkey(INT, INT, UCHAR **, CHAR *);
 static int colreftostr(UINT, INT, UCHAR **, INT *, INT *);
 static int strtocolref(UCHAR *, int, int, int);
@@ -81,7 +152,9 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 	INT pcount, pos, maxpcount, maxvar, worksetnum, retstackindex, openfilenum;
 	INT keyfilerefnum, keyindexnum, numkeys, numsortkeys, idxhandle, txthandle;
 	INT type1, type2, length1, length2, scale1, scale2;
-	INT forupdateflag, nowaitflag;
+	INT forupdateflag, nowaitflag, lastpcount;
+	UINT hash;
+	UINT64 clockstart, clocknow;
 	UCHAR work[16];
 	OFFSET offset;
 	UCHAR c1, *ptr1, *ptr2, **hmem1;
@@ -94,9 +167,8 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 	OPENFILE *opf1;
 	PCODE *pcode;
 	SIOKEY workkey[2], *workkeyptr, **sortkeys;
-#if OS_UNIX
-	CHAR *ptr;
-#endif
+	SIO sio;
+	OPPROFILE **hprofile;
 
 	thishplan = hplan;
 	plan = *hplan;
@@ -181,12 +253,25 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 	nowaitflag = plan->flags & PLAN_FLAG_LOCKNOWAIT;
 	pcount = retstackindex = 0;
 	pcode = *plan->pgm;
+	hprofile = plan->profile;
+	lastpcount = -1;
+	clockstart = 0;
 
 	for ( ; ; ) {  /* main execution loop */
 		op = pcode[pcount].code;
 		op1 = pcode[pcount].op1;
 		op2 = pcode[pcount].op2;
 		op3 = pcode[pcount].op3;
+		if (hprofile != NULL) {  /* EXPLAIN ANALYZE, charge the time since the last operation to it */
+			clocknow = execclock();
+			if (lastpcount >= 0) {
+				(*hprofile)[lastpcount].time += clocknow - clockstart;
+				if (profilerow(pcode + lastpcount)) (*hprofile)[lastpcount].rows++;
+			}
+			(*hprofile)[pcount].count++;
+			lastpcount = pcount;
+			clockstart = clocknow;
+		}
 /* following code is for debug purposes only */
 #if FS_DEBUGCODE
 		if (fsflags & FSFLAGS_DEBUG4) debugcode("EXEC", pcount, &pcode[pcount]);
@@ -347,6 +432,7 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 			opf1 = *connection.hopenfilearray + openfilenum - 1;
 			tab1 = tableptr(opf1->tablenum);
 			txthandle = opf1->textfilenum;
+			freescan(opf1);
 			if (!op2) {
 				if (op == OP_SETFIRST) riosetpos(txthandle, 0);
 				else {
@@ -421,9 +507,12 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 			txthandle = opf1->textfilenum;
 			if (forupdateflag) riounlock(txthandle, -1);
 			plan->flags &= ~PLAN_FLAG_VALIDREC;
+			if (op == OP_READPREV) freescan(opf1);
 			if (!op2) {
 				if (op == OP_READNEXT) {
-					for ( ; ; ) {
+					recsize = -2;
+					if (opf1->scan != NULL) recsize = scanget(opf1, tab1);
+					if (recsize == -2) for ( ; ; ) {
 						if (forupdateflag) {
 							rc = riolock(txthandle, nowaitflag);
 							if (rc != 0) {
@@ -754,6 +843,7 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 				return sqlerrnum(SQLERR_EXEC_BADPGM);
 			}
 			mscntooff(ptr1, &offset, 12);
+			freescan(opf1);
 			riosetpos(txthandle, offset);
 			rc = riolock(txthandle, FALSE);
 			if (rc != 0) {
@@ -776,136 +866,325 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 				plan->flags |= PLAN_FLAG_VALIDREC;
 			}
 			break;
-		case OP_UNLOCK:
-			if (op1 != 1) {
+		case OP_SCANINIT:
+			if (op1 < 1 || op1 > plan->numtables) {
 				execerror();
 				return sqlerrnum(SQLERR_EXEC_BADPGM);
 			}
-			openfilenum = filerefmap[op1 - 1];
-			opf1 = *connection.hopenfilearray + openfilenum - 1;
-			riounlock(opf1->textfilenum, -1);
-			plan->flags &= ~PLAN_FLAG_VALIDREC;
+			if (!forupdateflag) scaninit(*connection.hopenfilearray + filerefmap[op1 - 1] - 1);
 			break;
-		case OP_WRITE:
-			openfilenum = filerefmap[op1 - 1];
+		case OP_SCANFILTER:
+			i1 = gettabref(op1);
+			if (i1 < 1 || i1 > plan->numtables || gettabref(op2) != TABREF_LITBUF || op3 < OP_GOTOIFNOTZERO || op3 > OP_GOTOIFNOTNEG) {
+				execerror();
+				return sqlerrnum(SQLERR_EXEC_BADPGM);
+			}
+			opf1 = *connection.hopenfilearray + filerefmap[i1 - 1] - 1;
+			if (opf1->scan == NULL) break;
+			tab1 = tableptr(opf1->tablenum);
+			i1 = getcolnum(op1);
+			if (i1 < 1 || i1 > tab1->numcolumns) {
+				execerror();
+				return sqlerrnummsg(SQLERR_EXEC_BADCOL, "source column reference invalid", NULL);
+			}
+			col1 = columnptr(tab1, i1);
+			if (col1->type == TYPE_CHAR || col1->type == TYPE_NUM || col1->type == TYPE_POSNUM) scanfilter(opf1->scan, col1, *plan->literals + getcolnum(op2), op3);
+			break;
+		case OP_HASHBUILD:
+			op1 -= (plan->numtables + 1);
+			if (op1 < 0 || op1 >= plan->numworksets || op2 < 1 || op2 > plan->numtables) {
+				execerror();
+				return sqlerrnum(SQLERR_EXEC_BADPGM);
+			}
+			wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + op1;
+			if (wks1->hashbuckets) break;  /* built on first probe, kept for the life of the result set */
+			openfilenum = filerefmap[op2 - 1];
 			opf1 = *connection.hopenfilearray + openfilenum - 1;
 			tab1 = tableptr(opf1->tablenum);
 			txthandle = opf1->textfilenum;
-
-			/* open the indexes */
-			for (i1 = 0; ++i1 <= tab1->numindexes; ) {
-				if (!(*opf1->hopenindexarray)[i1 - 1]) {  /* open the index */
-					if (opentableindexfile(openfilenum, i1)) {
-						execerror();
-						return -1;
-					}
-					/* memory may have shifted */
-					opf1 = *connection.hopenfilearray + openfilenum - 1;
-					tab1 = tableptr(opf1->tablenum);
-				}
-			}
-			rc = fioflck(txthandle);  /* lock the text file */
+			/* size the buckets from the file size, about one for every two records */
+			rc = fioflck(txthandle);
 			if (rc < 0) {
 				execerror();
 				return sqlerrnummsg(rc, "error in locking file", nameptr(tab1->textfilename));
 			}
-
-			/* check for duplicates */
-			for (i1 = 0; ++i1 <= tab1->numindexes; ) {
-				idxhandle = (*opf1->hopenindexarray)[i1 - 1];
-				idx1 = *tab1->hindexarray + i1 - 1;
-				if (idx1->type == INDEX_TYPE_ISAM && !(idx1->flags & INDEX_DUPS)) {  /* if isam and no dups, check for dup */
-					buildkey(opf1->tablenum, i1, opf1->hrecbuf, work1);
-					rc = xiofind(idxhandle, (UCHAR *) work1, idx1->keylength);
-					if (rc == 1) {
-						fiofulk(txthandle);
-						execerror();
-						return sqlerrnummsg(SQLERR_EXEC_DUPKEY, "error in writing record, no duplicate keys allowed", nameptr(idx1->indexfilename));
-					}
-					if (rc < 0) {
-						fiofulk(txthandle);
-						execerror();
-						return sqlerrnummsg(rc, "error in writing record", NULL);
-					}
-					/* memory may have shifted */
-					opf1 = *connection.hopenfilearray + openfilenum - 1;
-					tab1 = tableptr(opf1->tablenum);
-				}
+			rioeofpos(txthandle, &offset);
+			fiofulk(txthandle);
+			offset /= (tab1->reclength + 1) << 1;
+			for (i5 = 64; i5 < offset && i5 < 0x400000; i5 <<= 1);
+			hmem1 = memalloc((i5 + 1) * sizeof(INT), MEMFLAGS_ZEROFILL);
+			wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + op1;
+			if (hmem1 == NULL) {
+				wks1->hashbuckets = -1;
+				break;
 			}
-
-			/* get new record position */
-			rc = 1;
-			if (tab1->reclaimindex) {  /* try to use the space reclaimation index */
-				idxhandle = (*opf1->hopenindexarray)[tab1->reclaimindex - 1];
-				idx1 = indexptr(tab1, tab1->reclaimindex);
-				if (idx1->type == INDEX_TYPE_ISAM) {
-					rc = xiogetrec(idxhandle);
-					if (!rc) offset = filepos;
+			wks1->hashtable = (INT **) hmem1;
+			memfree(wks1->rows);
+			wks1->rows = NULL;
+			/* rows beyond a sixteenth of the result set memory spill to the work file */
+			i1 = (connection.memresultsize << 6) / wks1->rowbytes;
+			if (i1 < 2) i1 = 2;
+			wks1->memrowalloc = i1;
+			wks1->rowid = wks1->memrowoffset = wks1->rowcount = 0;
+			/* build side: one workset row (hash, position) per record, counting rows per bucket */
+			opf1 = *connection.hopenfilearray + openfilenum - 1;
+			tab1 = tableptr(opf1->tablenum);
+			riosetpos(txthandle, 0);
+			for ( ; ; ) {
+				recsize = rioget(txthandle, *opf1->hrecbuf, tab1->reclength);
+				if (recsize == -2) continue;
+				if (recsize == -1) break;
+				if (recsize < 0) {
+					execerror();
+					return sqlerrnummsg(recsize, "error reading data file", nameptr(tab1->textfilename));
 				}
-				else {
-					rc = aiogetrec(idxhandle);
-					if (!rc) offset = filepos * (tab1->reclength + tab1->eorsize);
+				if (recsize < tab1->reclength) memset(*opf1->hrecbuf + recsize, ' ', tab1->reclength - recsize);
+				riolastpos(txthandle, &offset);
+				i1 = hashcolumn(op3, &hash);
+				if (!i1) i1 = newwksrow(worksetnum, op1 + 1);
+				if (i1 < 0) {
+					execerror();
+					return i1;
 				}
 				/* memory may have shifted */
+				wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + op1;
 				opf1 = *connection.hopenfilearray + openfilenum - 1;
 				tab1 = tableptr(opf1->tablenum);
+				ptr1 = *wks1->rows + (wks1->rowid - wks1->memrowoffset - 1) * wks1->rowbytes;
+				for (i1 = 0; i1 < 8; i1++) ptr1[i1] = (UCHAR) "0123456789ABCDEF"[(hash >> (28 - (i1 << 2))) & 0x0F];
+				i1 = mscofftoa(offset, (CHAR *) work);
+				memcpy(ptr1 + 8 + 12 - i1, work, i1);
+				(*wks1->hashtable)[(hash & (i5 - 1)) + 1]++;
+			}
+			/* counting sort of the rowids by bucket, following the bucket starts */
+			i4 = wks1->rowcount;
+			if (hprofile != NULL) (*hprofile)[pcount].rows += i4;
+			i1 = memchange((UCHAR **) wks1->hashtable, (i5 + 1 + i4) * sizeof(INT), 0);
+			wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + op1;
+			if (i1 == -1) {  /* no room for the rowids, fall back to reading the whole table */
+				memfree((UCHAR **) wks1->hashtable);
+				wks1->hashtable = NULL;
+				memfree(wks1->rows);
+				wks1->rows = NULL;
+				if (wks1->fiofilenum) {
+					fiokill(wks1->fiofilenum);
+					wks1->fiofilenum = 0;
+				}
+				wks1->rowid = wks1->memrowoffset = wks1->rowcount = 0;
+				wks1->hashbuckets = -1;
+				/* memory may have shifted */
+				plan = *hplan;
+				pcode = *plan->pgm;
+				break;
 			}
-			if (rc) rioeofpos(txthandle, &offset);
-
-			/* insert keys */
-			rc = 0;
-			for (i1 = 0; ++i1 <= tab1->numindexes; ) {
-				idxhandle = (*opf1->hopenindexarray)[i1 - 1];
-				idx1 = *tab1->hindexarray + i1 - 1;
-				if (idx1->type == INDEX_TYPE_ISAM) {
-					filepos = offset;
-					buildkey(opf1->tablenum, i1, opf1->hrecbuf, work1);
-					rc = xioinsert(idxhandle, (UCHAR *) work1, (INT)strlen(work1));
+			for (i1 = 1; i1 <= i5; i1++) (*wks1->hashtable)[i1] += (*wks1->hashtable)[i1 - 1];
+			if (writedirtywks(worksetnum, op1 + 1) < 0) {
+				execerror();
+				return -1;
+			}
+			for (i2 = 1; i2 <= i4; i2++) {
+				wks1->rowid = i2;
+				if (readwks(worksetnum, op1 + 1) < 0) {
+					execerror();
+					return -1;
 				}
-				else {
-					if (idx1->flags & INDEX_FIXED) {
-						tab1 = tableptr(opf1->tablenum);
-						filepos = offset / (OFFSET)(tab1->reclength + tab1->eorsize);
+				ptr1 = *wks1->rows + (i2 - wks1->memrowoffset - 1) * wks1->rowbytes;
+				for (hash = 0, i1 = 0; i1 < 8; i1++) hash = (hash << 4) + (isdigit(ptr1[i1]) ? ptr1[i1] - '0' : ptr1[i1] - 'A' + 10);
+				i1 = hash & (i5 - 1);
+				(*wks1->hashtable)[i5 + 1 + (*wks1->hashtable)[i1]++] = i2;
+			}
+			/* bucket ends are now the next bucket starts, so shift them back */
+			for (i1 = i5 - 1; i1 > 0; i1--) (*wks1->hashtable)[i1] = (*wks1->hashtable)[i1 - 1];
+			(*wks1->hashtable)[0] = 0;
+			wks1->hashbuckets = i5;
+			wks1->hashpos = -1;
+			/* memory may have shifted */
+			plan = *hplan;
+			pcode = *plan->pgm;
+			break;
+		case OP_HASHKEY:
+			op1 -= (plan->numtables + 1);
+			if (op1 < 0 || op1 >= plan->numworksets) {
+				execerror();
+				return sqlerrnum(SQLERR_EXEC_BADPGM);
+			}
+			if (hashcolumn(op2, &hash) < 0) {
+				execerror();
+				return -1;
+			}
+			wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + op1;
+			if (!wks1->hashbuckets) {
+				execerror();
+				return sqlerrnum(SQLERR_EXEC_BADPGM);
+			}
+			wks1->hashpos = -1;
+			if (wks1->hashbuckets < 0) break;
+			i1 = hash & (wks1->hashbuckets - 1);
+			wks1->hashfirst = (*wks1->hashtable)[i1];
+			wks1->hashcount = (*wks1->hashtable)[i1 + 1] - wks1->hashfirst;
+			wks1->hashvalue = hash;
+			break;
+		case OP_HASHNEXT:
+		case OP_HASHPREV:
+			op1 -= (plan->numtables + 1);
+			if (op1 < 0 || op1 >= plan->numworksets || op2 < 1 || op2 > plan->numtables || op3 < 1 || op3 > maxvar) {
+				execerror();
+				return sqlerrnum(SQLERR_EXEC_BADPGM);
+			}
+			wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + op1;
+			openfilenum = filerefmap[op2 - 1];
+			opf1 = *connection.hopenfilearray + openfilenum - 1;
+			tab1 = tableptr(opf1->tablenum);
+			txthandle = opf1->textfilenum;
+			plan->flags &= ~PLAN_FLAG_VALIDREC;
+			vars[op3 - 1] = FALSE;
+			if (wks1->hashbuckets < 0) {  /* no hash table, read every record as OP_READNEXT does */
+				if (wks1->hashpos < 0) {
+					if (op == OP_HASHNEXT) riosetpos(txthandle, 0);
+					else {
+						rc = fioflck(txthandle);
+						if (rc < 0) {
+							execerror();
+							return sqlerrnummsg(rc, "error in locking file", nameptr(tab1->textfilename));
+						}
+						rioeofpos(txthandle, &offset);
+						fiofulk(txthandle);
+						riosetpos(txthandle, offset);
 					}
-					else if (offset) filepos = (offset - 1) / 256;
-					else filepos = 0;
-					rc = aioinsert(idxhandle, *opf1->hrecbuf);
+					wks1->hashpos = 0;
 				}
+				do {
+					if (op == OP_HASHNEXT) recsize = rioget(txthandle, *opf1->hrecbuf, tab1->reclength);
+					else recsize = rioprev(txthandle, *opf1->hrecbuf, tab1->reclength);
+				} while (recsize == -2);
+				if (recsize <= -3) {
+					execerror();
+					return sqlerrnummsg(recsize, "error reading data file", nameptr(tab1->textfilename));
+				}
+				if (recsize >= 0) {
+					if (recsize < tab1->reclength) memset(*opf1->hrecbuf + recsize, ' ', tab1->reclength - recsize);
+					riolastpos(txthandle, &plan->filepos);
+					vars[op3 - 1] = TRUE;
+					plan->flags |= PLAN_FLAG_VALIDREC;
+				}
+				break;
+			}
+			for (i1 = 0; i1 < 8; i1++) work[i1] = (UCHAR) "0123456789ABCDEF"[(wks1->hashvalue >> (28 - (i1 << 2))) & 0x0F];
+			/* hashpos is 1 to hashcount within the bucket, 0 before first and hashcount + 1 after last */
+			for ( ; ; ) {
 				/* memory may have shifted */
+				wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + op1;
 				opf1 = *connection.hopenfilearray + openfilenum - 1;
-				tab1 = tableptr(opf1->tablenum);
-				if (rc) break;
-			}
-			if (!rc) {  /* write record */
-				riosetpos(txthandle, offset);
-				rc = rioput(txthandle, *opf1->hrecbuf, opf1->reclength);
-			}
-			if (rc) {  /* undo index inserts */
-				filepos = offset;
-				while (--i1) {
-					idxhandle = (*opf1->hopenindexarray)[i1 - 1];
-					idx1 = *tab1->hindexarray + i1 - 1;
-					if (idx1->type == INDEX_TYPE_ISAM) {
-						buildkey(opf1->tablenum, i1, opf1->hrecbuf, work1);
-						xiodelete(idxhandle, (UCHAR *) work1, (INT)strlen(work1), TRUE);
-						/* memory may have shifted */
-						opf1 = *connection.hopenfilearray + openfilenum - 1;
-						tab1 = tableptr(opf1->tablenum);
+				if (op == OP_HASHNEXT) {
+					i1 = (wks1->hashpos < 0) ? 1 : wks1->hashpos + 1;
+					if (i1 > wks1->hashcount) {
+						wks1->hashpos = wks1->hashcount + 1;
+						break;
 					}
 				}
-				fiofulk(txthandle);
-				if (rc < 0) {
+				else {
+					i1 = (wks1->hashpos < 0) ? wks1->hashcount : wks1->hashpos - 1;
+					if (i1 < 1) {
+						wks1->hashpos = 0;
+						break;
+					}
+				}
+				wks1->hashpos = i1;
+				wks1->rowid = (*wks1->hashtable)[wks1->hashbuckets + 1 + wks1->hashfirst + i1 - 1];
+				if (readwks(worksetnum, op1 + 1) < 0) {
+					execerror();
+					return -1;
+				}
+				ptr1 = *wks1->rows + (wks1->rowid - wks1->memrowoffset - 1) * wks1->rowbytes;
+				if (memcmp(ptr1, work, 8)) continue;  /* different hash in the same bucket */
+				mscntooff(ptr1 + 8, &offset, 12);
+				riosetpos(txthandle, offset);
+				recsize = rioget(txthandle, *opf1->hrecbuf, tab1->reclength);
+				if (recsize == -2 || recsize == -1) continue;  /* deleted since the hash was built */
+				if (recsize < 0) {
 					execerror();
-					return sqlerrnummsg(rc, "error in writing record", NULL);
+					return sqlerrnummsg(recsize, "error reading data file", nameptr(tab1->textfilename));
+				}
+				if (recsize < tab1->reclength) memset(*opf1->hrecbuf + recsize, ' ', tab1->reclength - recsize);
+				vars[op3 - 1] = TRUE;
+				plan->filepos = offset;
+				plan->flags |= PLAN_FLAG_VALIDREC;
+				break;
+			}
+			break;
+		case OP_HASHGROUP:
+			op1 -= (plan->numtables + 1);
+			if (op1 < 0 || op1 >= plan->numworksets || op3 < 1 || op3 > maxvar) {
+				execerror();
+				return sqlerrnum(SQLERR_EXEC_BADPGM);
+			}
+			i1 = hashgroup(worksetnum, op1 + 1, op2, &i2);
+			if (i1 < 0) {
+				execerror();
+				return i1;
+			}
+			vars[op3 - 1] = i2;
+			/* memory may have shifted */
+			plan = *hplan;
+			pcode = *plan->pgm;
+			break;
+		case OP_UNLOCK:
+			if (op1 != 1) {
+				execerror();
+				return sqlerrnum(SQLERR_EXEC_BADPGM);
+			}
+			openfilenum = filerefmap[op1 - 1];
+			opf1 = *connection.hopenfilearray + openfilenum - 1;
+			riounlock(opf1->textfilenum, -1);
+			plan->flags &= ~PLAN_FLAG_VALIDREC;
+			break;
+		case OP_WRITE:
+			openfilenum = filerefmap[op1 - 1];
+			if (op2) {  /* save the record for OP_WRITEBATCH */
+				opf1 = *connection.hopenfilearray + openfilenum - 1;
+				recsize = opf1->reclength;
+				if (plan->batchcount == plan->batchalloc) {
+					i1 = (plan->batchalloc) ? plan->batchalloc << 1 : 16;
+					if (plan->batch == NULL) {
+						hmem1 = memalloc(i1 * recsize, 0);
+						plan = *hplan;
+						plan->batch = hmem1;
+					}
+					else hmem1 = (memchange(plan->batch, i1 * recsize, 0)) ? NULL : plan->batch;
+					if (hmem1 == NULL) {
+						execerror();
+						return sqlerrnum(SQLERR_NOMEM);
+					}
+					/* memory may have shifted */
+					plan = *hplan;
+					pcode = *plan->pgm;
+					plan->batchalloc = i1;
+					opf1 = *connection.hopenfilearray + openfilenum - 1;
 				}
+				memcpy(*plan->batch + plan->batchcount++ * recsize, *opf1->hrecbuf, recsize);
+				break;
+			}
+			rc = writerecords(openfilenum, NULL, 1);
+			if (rc) {
 				execerror();
-				return sqlerrnummsg(rc, "error in writing record, unexpected duplicate key", NULL);
+				return rc;
 			}
-			fiofulk(txthandle);
 			/* memory may have shifted */
 			plan = *hplan;
 			pcode = *plan->pgm;
 			break;
+		case OP_WRITEBATCH:
+			if (!plan->batchcount) break;
+			rc = writerecords(filerefmap[op1 - 1], plan->batch, plan->batchcount);
+			/* memory may have shifted */
+			plan = *hplan;
+			pcode = *plan->pgm;
+			plan->batchcount = 0;
+			if (rc) {
+				execerror();
+				return rc;
+			}
+			break;
 		case OP_UPDATE:
 			if (!(plan->flags & PLAN_FLAG_VALIDREC)) {
 				execerror();
@@ -1223,89 +1502,28 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 			wks1->rowid = wks1->memrowoffset = wks1->rowcount = 0;
 			break;
 		case OP_WORKNEWROW:
-			op1 -= (plan->numtables + 1);
-			if (op1 < 0 || op1 >= plan->numworksets) {
-				execerror();
-				return sqlerrnum(SQLERR_EXEC_BADPGM);
-			}
-			wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + op1;
-			i1 = wks1->rowbytes;
-			if (wks1->rows == NULL) {  /* first time */
-				i2 = wks1->memrowalloc;
-				hmem1 = memalloc(i2 * i1, 0);
-				while (hmem1 == NULL) {
-					if ((i2 >>= 1) < 1) {
-						execerror();
-						return sqlerrnum(SQLERR_NOMEM);
-					}
-					hmem1 = memalloc(i2 * i1, 0);
-				}
-				wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + op1;
-				wks1->rows = hmem1;
-				wks1->memrowalloc = i2;
-			}
-			i2 = wks1->rowcount;
-			i3 = wks1->memrowoffset;
-			if (i2 >= wks1->memrowalloc) {
-				if (i2 == wks1->memrowalloc) {
-					if (workdir[0]) strcpy(work2, workdir);
-					else strcpy(work2, ".");
-#if OS_WIN32
-					if (!GetTempFileName(work2, "fs6", 0, work1)) sqlerrnummsg(SQLERR_EXEC_BADWORKSET, "unable to create workfile name", NULL);
-					i4 = fioopen(work1, FIO_M_PRP | FIO_P_WRK);
-#endif
-#if OS_UNIX
-					for (i5 = 0; i5 < 1000; i5++) {
-						ptr = tempnam(work2, "fs6");
-						if (ptr == NULL) sqlerrnummsg(SQLERR_EXEC_BADWORKSET, "unable to create workfile name", NULL);
-						strcpy(work1, ptr);
-						free(ptr);
-						i4 = fioopen(work1, FIO_M_EFC | FIO_P_WRK);
-						if (i4 != ERR_EXIST) break;
-					}
-#endif
-					if (i4 < 0) {
-#if OS_WIN32
-						DeleteFile(work1);
-#endif
-						execerror();
-						return sqlerrnummsg(i4, "working set error during file creation", NULL);
-					}
-					wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + op1;
-					wks1->fiofilenum = i4;
-					wks1->bufdirtyflag = TRUE;
-					if (writedirtywks(worksetnum, op1 + 1) < 0) {
-						execerror();
-						return -1;
-					}
-					wks1->memrowoffset = wks1->memrowalloc;
-				}
-				else if (i2 > i3 && i2 < i3 + wks1->memrowalloc) {
-					if (wks1->rowdirtyflag) wks1->bufdirtyflag = TRUE;
-				}
-				else {
-					if (writedirtywks(worksetnum, op1 + 1) < 0) {
-						execerror();
-						return -1;
-					}
-					wks1->memrowoffset = i2;
-				}
-			}
-			wks1->rowid = wks1->rowcount = i2 + 1;
-			memset(*wks1->rows + (wks1->rowid - wks1->memrowoffset - 1) * i1, ' ', i1);
-			wks1->rowdirtyflag = TRUE;
-			/* memory may have shifted */
-			plan = *hplan;
-			pcode = *plan->pgm;
-			break;
-		case OP_WORKFREE:
-/*** NOTE: COULD PROBABLY JUST PUT THIS CODE AT OP_FINISH AND OP_TERMINATE, ***/
-/***       BUT THIS GIVES MORE FLEXIBILITY TO POSSIBLE FUTURE SUPPORT FOR COMBINED ***/
-/***       DYNAMIC/STATIC WORKSETS ***/
-			if (op2 < 1 || op2 > maxvar) {
-				execerror();
-				return sqlerrnum(SQLERR_EXEC_BADPGM);
-			}
+			op1 -= (plan->numtables + 1);
+			if (op1 < 0 || op1 >= plan->numworksets) {
+				execerror();
+				return sqlerrnum(SQLERR_EXEC_BADPGM);
+			}
+			i1 = newwksrow(worksetnum, op1 + 1);
+			if (i1 < 0) {
+				execerror();
+				return i1;
+			}
+			/* memory may have shifted */
+			plan = *hplan;
+			pcode = *plan->pgm;
+			break;
+		case OP_WORKFREE:
+/*** NOTE: COULD PROBABLY JUST PUT THIS CODE AT OP_FINISH AND OP_TERMINATE, ***/
+/***       BUT THIS GIVES MORE FLEXIBILITY TO POSSIBLE FUTURE SUPPORT FOR COMBINED ***/
+/***       DYNAMIC/STATIC WORKSETS ***/
+			if (op2 < 1 || op2 > maxvar) {
+				execerror();
+				return sqlerrnum(SQLERR_EXEC_BADPGM);
+			}
 			op1 -= (plan->numtables + 1);
 			if (op1 < 0 || op1 >= plan->numworksets) {
 				execerror();
@@ -1321,6 +1539,11 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 						fiokill(wks1->fiofilenum);
 						wks1->fiofilenum = 0;
 					}
+					if (wks1->hashbuckets > 0) {  /* hash group rowids are no longer valid */
+						memfree((UCHAR **) wks1->hashtable);
+						wks1->hashtable = NULL;
+						wks1->hashbuckets = 0;
+					}
 				}
 				else memchange(wks1->rows, wks1->memrowalloc * wks1->rowbytes, 0);
 			}
@@ -1434,49 +1657,50 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 				(*sortkeys)[numkeys].end = wks1->rowbytes;
 				(*sortkeys)[numkeys++].typeflg = SIO_POSITION | SIO_ASCEND;
 
-				if (sioinit(wks1->rowbytes, numkeys, sortkeys, workdir, NULL, 0, 0, NULL)) {
+				if (sioxinit(&sio, wks1->rowbytes, numkeys, sortkeys, workdir, NULL, 0, 0, NULL)) {
 					memfree((UCHAR **) hsortkeys);
 					hsortkeys = NULL;
 					execerror();
-					return sqlerrnummsg(SQLERR_INTERNAL, "sort initialization failed", siogeterr());
+					return sqlerrnummsg(SQLERR_INTERNAL, "sort initialization failed", sioxgeterr(&sio));
 				}
 				for (i1 = 0; i1 < wks1->rowcount; i1++) {
 					if (i1 < wks1->memrowoffset || i1 >= wks1->memrowoffset + wks1->memrowalloc) {
 						wks1->rowid = i1 + 1;
 						if (readwks(worksetnum, op1 + 1) < 0) {
+							sioxexit(&sio);
 							execerror();
 							return -1;
 						}
 					}
-					ptr1 = sioputstart();
+					ptr1 = sioxputstart(&sio);
 					memcpy(ptr1, *wks1->rows + (i1 - wks1->memrowoffset) * wks1->rowbytes, wks1->rowbytes);
 					mscoffto6x(i1, ptr1 + wks1->rowbytes - 6);
-					if (sioputend()) {
-						sioexit();
+					if (sioxputend(&sio)) {
+						sioxexit(&sio);
 						memfree((UCHAR **) hsortkeys);
 						hsortkeys = NULL;
 						execerror();
-						return sqlerrnummsg(SQLERR_INTERNAL, "sort writing failed", siogeterr());
+						return sqlerrnummsg(SQLERR_INTERNAL, "sort writing failed", sioxgeterr(&sio));
 					}
 					/* sioputend may call fioopen */
 					wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + op1;
 				}
 				wks1->rowcount = wks1->memrowoffset = 0;
 				for (i1 = 0; ; ) {
-					i2 = sioget(&ptr1);
+					i2 = sioxget(&sio, &ptr1);
 					if (i2) {
-						sioexit();
+						sioxexit(&sio);
 						if (i2 == 1) break;
 						memfree((UCHAR **) hsortkeys);
 						hsortkeys = NULL;
 						execerror();
-						return sqlerrnummsg(SQLERR_INTERNAL, "sort reading failed", siogeterr());
+						return sqlerrnummsg(SQLERR_INTERNAL, "sort reading failed", sioxgeterr(&sio));
 					}
 					if (op == OP_WORKUNIQUE && i1 &&
 						!memcmp(ptr1, *wks1->rows + (i1 - 1 - wks1->memrowoffset) * wks1->rowbytes, wks1->rsrowbytes)) continue;
 					if (i1 >= wks1->memrowoffset + wks1->memrowalloc) {
 						if (writedirtywks(worksetnum, op1 + 1) < 0) {
-							sioexit();
+							sioxexit(&sio);
 							memfree((UCHAR **) hsortkeys);
 							hsortkeys = NULL;
 							execerror();
@@ -1488,7 +1712,7 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 					wks1->rowid = wks1->rowcount = ++i1;
 					wks1->bufdirtyflag = TRUE;
 				}
-				sioexit();
+				sioxexit(&sio);
 				if (vars[op2 - 1] && sortkeys != hsortkeys) {
 					/* first sort was to create unique result set, now do the real sort */
 					if (wks1->rowcount > wks1->memrowalloc && writedirtywks(worksetnum, op1 + 1) < 0) {
@@ -1502,47 +1726,48 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 					(*hsortkeys)[numkeys].end = wks1->rowbytes;
 					(*hsortkeys)[numkeys++].typeflg = SIO_POSITION;
 
-					if (sioinit(wks1->rowbytes, numkeys, hsortkeys, workdir, NULL, 0, 0, NULL)) {
+					if (sioxinit(&sio, wks1->rowbytes, numkeys, hsortkeys, workdir, NULL, 0, 0, NULL)) {
 						memfree((UCHAR **) hsortkeys);
 						hsortkeys = NULL;
 						execerror();
-						return sqlerrnummsg(SQLERR_INTERNAL, "sort initialization failed", siogeterr());
+						return sqlerrnummsg(SQLERR_INTERNAL, "sort initialization failed", sioxgeterr(&sio));
 					}
 					for (i1 = 0; i1 < wks1->rowcount; i1++) {
 						if (i1 < wks1->memrowoffset || i1 >= wks1->memrowoffset + wks1->memrowalloc) {
 							wks1->rowid = i1 + 1;
 							if (readwks(worksetnum, op1 + 1) < 0) {
+								sioxexit(&sio);
 								execerror();
 								return -1;
 							}
 						}
-						ptr1 = sioputstart();
+						ptr1 = sioxputstart(&sio);
 						memcpy(ptr1, *wks1->rows + (i1 - wks1->memrowoffset) * wks1->rowbytes, wks1->rowbytes);
 						mscoffto6x(i1, ptr1 + wks1->rowbytes - 6);
-						if (sioputend()) {
-							sioexit();
+						if (sioxputend(&sio)) {
+							sioxexit(&sio);
 							memfree((UCHAR **) hsortkeys);
 							hsortkeys = NULL;
 							execerror();
-							return sqlerrnummsg(SQLERR_INTERNAL, "sort writing failed", siogeterr());
+							return sqlerrnummsg(SQLERR_INTERNAL, "sort writing failed", sioxgeterr(&sio));
 						}
 						/* sioputend may call fioopen */
 						wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + op1;
 					}
 					wks1->rowcount = wks1->memrowoffset = 0;
 					for (i1 = 0; ; ) {
-						i2 = sioget(&ptr1);
+						i2 = sioxget(&sio, &ptr1);
 						if (i2) {
-							sioexit();
+							sioxexit(&sio);
 							if (i2 == 1) break;
 							memfree((UCHAR **) hsortkeys);
 							hsortkeys = NULL;
 							execerror();
-							return sqlerrnummsg(SQLERR_INTERNAL, "sort reading failed", siogeterr());
+							return sqlerrnummsg(SQLERR_INTERNAL, "sort reading failed", sioxgeterr(&sio));
 						}
 						if (i1 >= wks1->memrowoffset + wks1->memrowalloc) {
 							if (writedirtywks(worksetnum, op1 + 1) < 0) {
-								sioexit();
+								sioxexit(&sio);
 								memfree((UCHAR **) hsortkeys);
 								hsortkeys = NULL;
 								execerror();
@@ -1554,7 +1779,7 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 						wks1->rowid = wks1->rowcount = ++i1;
 						wks1->bufdirtyflag = TRUE;
 					}
-					sioexit();
+					sioxexit(&sio);
 				}
 			}
 			memfree((UCHAR **) hsortkeys);
@@ -2610,6 +2835,39 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 			}
 			vars[op3 - 1] = i4;
 			break;
+		case OP_RECCOMPARE:
+			/* same result as OP_COLCOMPARE, but the column is compared where it */
+			/* sits in the record buffer and nothing is copied or converted */
+			if (op3 < 1 || op3 > maxvar || gettabref(op2) != TABREF_LITBUF) {
+				execerror();
+				return sqlerrnum(SQLERR_EXEC_BADPGM);
+			}
+			i1 = gettabref(op1);
+			if (i1 < 1 || i1 > plan->numtables) {
+				execerror();
+				return sqlerrnummsg(SQLERR_EXEC_BADCOL, "source column reference invalid", NULL);
+			}
+			opf1 = *connection.hopenfilearray + filerefmap[i1 - 1] - 1;
+			tab1 = tableptr(opf1->tablenum);
+			i1 = getcolnum(op1);
+			if (i1 < 1 || i1 > tab1->numcolumns) {
+				execerror();
+				return sqlerrnummsg(SQLERR_EXEC_BADCOL, "source column reference invalid", NULL);
+			}
+			col1 = columnptr(tab1, i1);
+			ptr1 = *opf1->hrecbuf + col1->offset;
+			i1 = col1->fieldlen;
+			ptr2 = *plan->literals + getcolnum(op2);
+			i2 = ((INT) ptr2[1] << 8) + ptr2[2];
+			ptr2 += 4;
+			if (col1->type == TYPE_CHAR) i4 = reccomparechar(ptr1, i1, ptr2, i2);
+			else if (col1->type == TYPE_NUM || col1->type == TYPE_POSNUM) i4 = reccomparenum(ptr1, i1, ptr2, i2);
+			else {
+				execerror();
+				return sqlerrnum(SQLERR_EXEC_BADPGM);
+			}
+			vars[op3 - 1] = i4;
+			break;
 		case OP_COLISNULL:
 			if (op2 < 1 || op2 > maxvar) {
 				execerror();
@@ -2758,6 +3016,10 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 				}
 				for (i1 = 0; i1 < plan->numvars; i1++) (*plan->savevars)[i1] = vars[i1];
 			}
+			for (i1 = 0; i1 < plan->numtables; i1++) {  /* the next call must not see records read by this one */
+				opf1 = openfileptr(filerefmap[i1]);
+				if (opf1->scan != NULL) scandrop(opf1);
+			}
 			if (arg1 != NULL) *arg1 = vars[0];
 			if (arg2 != NULL) *arg2 = vars[1];
 			if (arg3 != NULL) *arg3 = vars[2];
@@ -2773,6 +3035,7 @@ INT execplan(HPLAN hplan, LONG *arg1, LONG *arg2, LONG *arg3) // @suppress("No r
 			for (i1 = 0; i1 < plan->numtables; i1++) {  /* flag open files as not in use */
 			 	opf1 = openfileptr(filerefmap[i1]);
 				opf1->inuseflag = FALSE;
+				freescan(opf1);
 				if (forupdateflag) riounlock(opf1->textfilenum, -1);
 			}
 			memfree((UCHAR **) plan->savevars);
@@ -2869,6 +3132,644 @@ static INT writedirtywks(INT worksetnum, INT count)
 	return 0;
 }
 
+static INT newwksrow(INT worksetnum, INT count)
+{
+	INT i1, i2, i3, i4, i5;
+	UCHAR **hmem1;
+	WORKSET *wks1;
+#if OS_UNIX
+	CHAR *ptr;
+#endif
+
+	wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + count - 1;
+	i1 = wks1->rowbytes;
+	if (wks1->rows == NULL) {  /* first time */
+		i2 = wks1->memrowalloc;
+		hmem1 = memalloc(i2 * i1, 0);
+		while (hmem1 == NULL) {
+			if ((i2 >>= 1) < 1) return sqlerrnum(SQLERR_NOMEM);
+			hmem1 = memalloc(i2 * i1, 0);
+		}
+		wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + count - 1;
+		wks1->rows = hmem1;
+		wks1->memrowalloc = i2;
+	}
+	i2 = wks1->rowcount;
+	i3 = wks1->memrowoffset;
+	if (i2 >= wks1->memrowalloc) {
+		if (i2 == wks1->memrowalloc) {
+			if (workdir[0]) strcpy(work2, workdir);
+			else strcpy(work2, ".");
+#if OS_WIN32
+			if (!GetTempFileName(work2, "fs6", 0, work1)) sqlerrnummsg(SQLERR_EXEC_BADWORKSET, "unable to create workfile name", NULL);
+			i4 = fioopen(work1, FIO_M_PRP | FIO_P_WRK);
+#endif
+#if OS_UNIX
+			for (i5 = 0; i5 < 1000; i5++) {
+				ptr = tempnam(work2, "fs6");
+				if (ptr == NULL) sqlerrnummsg(SQLERR_EXEC_BADWORKSET, "unable to create workfile name", NULL);
+				strcpy(work1, ptr);
+				free(ptr);
+				i4 = fioopen(work1, FIO_M_EFC | FIO_P_WRK);
+				if (i4 != ERR_EXIST) break;
+			}
+#endif
+			if (i4 < 0) {
+#if OS_WIN32
+				DeleteFile(work1);
+#endif
+				return sqlerrnummsg(i4, "working set error during file creation", NULL);
+			}
+			wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + count - 1;
+			wks1->fiofilenum = i4;
+			wks1->bufdirtyflag = TRUE;
+			if (writedirtywks(worksetnum, count) < 0) return -1;
+			wks1->memrowoffset = wks1->memrowalloc;
+		}
+		else if (i2 > i3 && i2 < i3 + wks1->memrowalloc) {
+			if (wks1->rowdirtyflag) wks1->bufdirtyflag = TRUE;
+		}
+		else {
+			if (writedirtywks(worksetnum, count) < 0) return -1;
+			wks1->memrowoffset = i2;
+		}
+	}
+	wks1->rowid = wks1->rowcount = i2 + 1;
+	memset(*wks1->rows + (wks1->rowid - wks1->memrowoffset - 1) * i1, ' ', i1);
+	wks1->rowdirtyflag = TRUE;
+	return 0;
+}
+
+/**
+ * reduce a column value to the text that is hashed for the hash join and
+ * hash group.  values that OP_COLCOMPARE considers equal must come out the
+ * same, so trailing blanks are ignored and numbers are reduced to sign,
+ * significant digits and fraction.  work must hold 64 bytes
+ */
+static INT normcolumn(UINT colrefnum, UCHAR **data, INT *datalen, UCHAR *work)
+{
+	INT i1, i2, len, scale, type;
+	UCHAR *ptr;
+
+	if (colreftostr(colrefnum, 0, &ptr, &len, &scale)) return -1;
+	type = getcoltype(colrefnum);
+	if (type < 0) return type;
+	if (type == TYPE_NUM || type == TYPE_POSNUM) {
+		for (i1 = 0; i1 < len && ptr[i1] == ' '; i1++);
+		i2 = 0;
+		if (i1 < len && ptr[i1] == '-') work[i2++] = ptr[i1++];
+		else if (i1 < len && ptr[i1] == '+') i1++;
+		while (i1 < len && ptr[i1] == '0') i1++;
+		for ( ; i1 < len && isdigit(ptr[i1]) && i2 < 64 - 1; ) work[i2++] = ptr[i1++];
+		if (i1 < len && ptr[i1] == '.') {
+			work[i2++] = ptr[i1++];
+			for ( ; i1 < len && isdigit(ptr[i1]) && i2 < 64; ) work[i2++] = ptr[i1++];
+			while (work[i2 - 1] == '0') i2--;
+			if (work[i2 - 1] == '.') i2--;
+		}
+		if (i2 && work[i2 - 1] == '-') i2--;  /* negative zero */
+		if (!i2 && len) work[i2++] = '0';
+		ptr = work;
+		len = i2;
+	}
+	else while (len && ptr[len - 1] == ' ') len--;
+	*data = ptr;
+	*datalen = len;
+	return 0;
+}
+
+/* compare a character field to a literal as OP_COLCOMPARE does */
+static INT reccomparechar(UCHAR *ptr1, INT len1, UCHAR *ptr2, INT len2)
+{
+	INT cmp;
+
+	cmp = memcmp(ptr1, ptr2, min(len1, len2));
+	if (!cmp && len1 != len2) {
+		while (len2 < len1 && ptr1[len2] == ' ') len2++;
+		while (len1 < len2 && ptr2[len1] == ' ') len1++;
+		cmp = len1 - len2;
+	}
+	return cmp;
+}
+
+/**
+ * compare a numeric field to a literal for OP_RECCOMPARE without copying
+ * either one.  the result has the sign OP_COLCOMPARE would give: a blank
+ * field is null and less than anything, and if either value is not a valid
+ * number they compare as equal, as bcomp does
+ */
+static INT reccomparenum(UCHAR *ptr1, INT len1, UCHAR *ptr2, INT len2)
+{
+	INT i1, cmp, len, neg[2], intlen[2], fraclen[2];
+	UCHAR *ptr, *intptr[2], *fracptr[2];
+
+	for (i1 = 0; i1 < len1 && ptr1[i1] == ' '; i1++);
+	if (i1 == len1) return -1;
+	for (cmp = 0; cmp < 2; cmp++) {
+		if (!cmp) {
+			ptr = ptr1;
+			len = len1;
+		}
+		else {
+			ptr = ptr2;
+			len = len2;
+		}
+		for (i1 = 0; i1 < len && ptr[i1] == ' '; i1++);
+		neg[cmp] = FALSE;
+		if (i1 < len && (ptr[i1] == '-' || ptr[i1] == '+')) neg[cmp] = (ptr[i1++] == '-');
+		if (i1 == len) return 0;
+		while (i1 < len && ptr[i1] == '0') i1++;
+		intptr[cmp] = ptr + i1;
+		while (i1 < len && isdigit(ptr[i1])) i1++;
+		intlen[cmp] = (INT)(ptr + i1 - intptr[cmp]);
+		fracptr[cmp] = ptr + i1;
+		fraclen[cmp] = 0;
+		if (i1 < len) {
+			if (ptr[i1] != '.' || i1 + 1 == len) return 0;
+			fracptr[cmp] = ptr + ++i1;
+			while (i1 < len && isdigit(ptr[i1])) i1++;
+			if (i1 < len) return 0;
+			for (fraclen[cmp] = (INT)(ptr + i1 - fracptr[cmp]); fraclen[cmp] && fracptr[cmp][fraclen[cmp] - 1] == '0'; fraclen[cmp]--);
+		}
+		if (!intlen[cmp] && !fraclen[cmp]) neg[cmp] = FALSE;  /* negative zero */
+	}
+
+	if (neg[0] != neg[1]) return neg[0] ? -1 : 1;
+	if (intlen[0] != intlen[1]) cmp = intlen[0] - intlen[1];
+	else {
+		cmp = memcmp(intptr[0], intptr[1], intlen[0]);
+		if (!cmp) {
+			cmp = memcmp(fracptr[0], fracptr[1], min(fraclen[0], fraclen[1]));
+			if (!cmp) cmp = fraclen[0] - fraclen[1];
+		}
+	}
+	return neg[0] ? -cmp : cmp;
+}
+
+/**
+ * start reading the full scan of a text file in batches.  only fixed length
+ * uncompressed files of a known type qualify, as their records can be found
+ * and checked without rio.  the first OP_READNEXT reads the first batch
+ */
+static void scaninit(OPENFILE *opf1)
+{
+	INT eorsize, rectype, size;
+	OFFSET eofpos, pos;
+	TABLE *tab1;
+	SCANSTATE *scan;
+
+	freescan(opf1);
+	tab1 = tableptr(opf1->tablenum);
+	if ((tab1->rioopenflags & (RIO_FIX | RIO_UNC)) != (RIO_FIX | RIO_UNC) || tab1->reclength < 1) return;
+	rectype = riotype(opf1->textfilenum);
+	if (rectype != RIO_T_STD && rectype != RIO_T_TXT && rectype != RIO_T_DAT && rectype != RIO_T_DOS && rectype != RIO_T_MAC) return;
+	eorsize = rioeorsize(opf1->textfilenum);
+	if (eorsize < 1) return;
+	rionextpos(opf1->textfilenum, &pos);
+	if (rioeofpos(opf1->textfilenum, &eofpos) || eofpos - pos < SCANMINSIZE) return;
+
+	scan = (SCANSTATE *) malloc(sizeof(SCANSTATE));
+	if (scan == NULL) return;
+	memset(scan, 0, sizeof(SCANSTATE));
+	scan->rectype = rectype;
+	scan->reclength = tab1->reclength;
+	scan->stride = tab1->reclength + eorsize;
+	size = (eofpos - pos < SCANBATCH) ? (INT)(eofpos - pos) : SCANBATCH;
+	scan->maxrecs = size / scan->stride;
+	if (scan->maxrecs < 1) scan->maxrecs = 1;
+	scan->batchrecs = scan->maxrecs;
+	scan->buffer = (UCHAR *) malloc((size_t) scan->maxrecs * scan->stride);
+	scan->recflags = (UCHAR *) malloc(scan->maxrecs);
+	if (scan->buffer == NULL || scan->recflags == NULL) {
+		free(scan->buffer);
+		free(scan->recflags);
+		free(scan);
+		return;
+	}
+	scan->nextpos = pos;
+	scan->threads = connection.scanthreads;
+	if (scan->threads <= 0) scan->threads = scancpus();
+	if (scan->threads > SCANMAXTHREADS) scan->threads = SCANMAXTHREADS;
+	opf1->scan = scan;
+}
+
+void freescan(OPENFILE *opf1)
+{
+	if (opf1->scan == NULL) return;
+	free(opf1->scan->buffer);
+	free(opf1->scan->recflags);
+	free(opf1->scan->literals);
+	free(opf1->scan);
+	opf1->scan = NULL;
+}
+
+/**
+ * release the alternate record buffer used by update, called when the
+ * connection is freed as its memory does not survive the connection
+ */
+void freeupdaterecbuf()
+{
+	if (updaterecbuf == NULL) return;
+	memfree(updaterecbuf);
+	updaterecbuf = NULL;
+	updaterecbufsize = 0;
+}
+
+/**
+ * add a test of a column against a literal to the batched scan.  records
+ * that fail it are skipped without being returned.  the plan still applies
+ * the test to the records that are returned, so a filter that can not be
+ * added is simply left out
+ */
+static void scanfilter(SCANSTATE *scan, COLUMN *col1, UCHAR *literal, INT test)
+{
+	INT len;
+	UCHAR *ptr;
+	SCANFILTER *flt;
+
+	if (scan->numfilters == SCANMAXFILTERS || col1->offset + col1->fieldlen > scan->reclength) return;
+	len = ((INT) literal[1] << 8) + literal[2];
+	ptr = (UCHAR *) realloc(scan->literals, scan->litsize + len + 1);
+	if (ptr == NULL) return;
+	scan->literals = ptr;
+	memcpy(ptr + scan->litsize, literal + 4, len);
+	flt = scan->filters + scan->numfilters++;
+	flt->offset = col1->offset;
+	flt->fieldlen = col1->fieldlen;
+	flt->type = col1->type;
+	flt->test = test;
+	flt->litoffset = scan->litsize;
+	flt->litlen = len;
+	scan->litsize += len;
+}
+
+/**
+ * get the next record of a batched scan into the record buffer and position
+ * rio at it.  return the record size, -2 when the batches are done and the
+ * rest of the file is to be read by rioget, or an error
+ */
+static INT scanget(OPENFILE *opf1, TABLE *tab1)
+{
+	INT i1, recsize, txthandle;
+	OFFSET offset, pos;
+	SCANSTATE *scan;
+
+	scan = opf1->scan;
+	txthandle = opf1->textfilenum;
+	for ( ; ; ) {
+		if (scan->bufnext == scan->bufrecs) {
+			recsize = scanbatch(txthandle, scan);
+			if (recsize <= 0) {
+				riosetpos(txthandle, scan->nextpos);
+				freescan(opf1);
+				return recsize ? recsize : -2;
+			}
+		}
+		i1 = scan->bufnext++;
+		if (scan->recflags[i1] == SCANREC_SKIP) continue;
+		pos = scan->bufpos + (OFFSET) i1 * scan->stride;
+		riosetpos(txthandle, pos);
+		if (scan->recflags[i1] == SCANREC_OK) {
+			memcpy(*opf1->hrecbuf, scan->buffer + (size_t) i1 * scan->stride, scan->reclength);
+			fiosetlpos(txthandle, pos);
+			return scan->reclength;
+		}
+		/* deleted or unusual record */
+		recsize = rioget(txthandle, *opf1->hrecbuf, tab1->reclength);
+		if (recsize < -2) {
+			freescan(opf1);
+			return recsize;
+		}
+		rionextpos(txthandle, &offset);
+		if (recsize == -1 || offset != pos + scan->stride) {
+			/* end of file mark or the records are not where expected */
+			freescan(opf1);
+			return (recsize >= 0) ? recsize : -2;
+		}
+		if (recsize >= 0) return recsize;
+	}
+}
+
+/**
+ * discard the records of the batch not yet returned, as they were read before
+ * the row went back to the caller.  the next batch starts with the first of
+ * them and reads few records, growing again as the scan continues
+ */
+static void scandrop(OPENFILE *opf1)
+{
+	SCANSTATE *scan;
+
+	scan = opf1->scan;
+	if (scan->bufnext < scan->bufrecs) scan->nextpos = scan->bufpos + (OFFSET) scan->bufnext * scan->stride;
+	scan->bufrecs = scan->bufnext = 0;
+	if (scan->batchrecs > SCANRESUME) scan->batchrecs = SCANRESUME;
+}
+
+#if OS_WIN32
+static DWORD WINAPI scanthread(LPVOID arg)
+{
+	scancheck((SCANPART *) arg);
+	return 0;
+}
+#else
+static void *scanthread(void *arg)
+{
+	scancheck((SCANPART *) arg);
+	return NULL;
+}
+#endif
+
+/**
+ * read the next batch of a batched scan and check its records, splitting
+ * large batches between threads.  return the number of records, 0 if no
+ * more whole records follow, or an error
+ */
+static INT scanbatch(INT txthandle, SCANSTATE *scan)
+{
+	INT i1, cnt, count, rc, size;
+	OFFSET eofpos;
+	SCANPART parts[SCANMAXTHREADS];
+#if OS_WIN32
+	HANDLE threads[SCANMAXTHREADS];
+#else
+	pthread_t threads[SCANMAXTHREADS];
+	INT started[SCANMAXTHREADS];
+#endif
+
+	rc = fioflck(txthandle);
+	if (rc < 0) return rc;
+	rc = rioeofpos(txthandle, &eofpos);
+	fiofulk(txthandle);
+	if (rc < 0) return rc;
+	if (eofpos - scan->nextpos < scan->stride) return 0;
+	if ((eofpos - scan->nextpos) / scan->stride < scan->batchrecs) count = (INT)((eofpos - scan->nextpos) / scan->stride);
+	else count = scan->batchrecs;
+	rc = fioread(txthandle, scan->nextpos, scan->buffer, count * scan->stride);
+	if (rc < 0) return rc;
+	count = rc / scan->stride;
+	if (!count) return 0;
+	scan->bufpos = scan->nextpos;
+	scan->nextpos += (OFFSET) count * scan->stride;
+	scan->bufrecs = count;
+	scan->bufnext = 0;
+	if (scan->batchrecs < scan->maxrecs) {
+		scan->batchrecs <<= 1;
+		if (scan->batchrecs > scan->maxrecs) scan->batchrecs = scan->maxrecs;
+	}
+
+	cnt = count / SCANTHREADMIN;
+	if (cnt > scan->threads) cnt = scan->threads;
+	if (cnt < 1) cnt = 1;
+	size = count / cnt;
+	for (i1 = 0; i1 < cnt; i1++) {
+		parts[i1].scan = scan;
+		parts[i1].first = i1 * size;
+		parts[i1].count = (i1 == cnt - 1) ? count - i1 * size : size;
+	}
+	for (i1 = 1; i1 < cnt; i1++) {
+#if OS_WIN32
+		threads[i1] = CreateThread(NULL, 0, scanthread, &parts[i1], 0, NULL);
+		if (threads[i1] == NULL) scancheck(&parts[i1]);
+#else
+		started[i1] = !pthread_create(&threads[i1], NULL, scanthread, &parts[i1]);
+		if (!started[i1]) scancheck(&parts[i1]);
+#endif
+	}
+	scancheck(&parts[0]);
+	for (i1 = 1; i1 < cnt; i1++) {
+#if OS_WIN32
+		if (threads[i1] != NULL) {
+			WaitForSingleObject(threads[i1], INFINITE);
+			CloseHandle(threads[i1]);
+		}
+#else
+		if (started[i1]) pthread_join(threads[i1], NULL);
+#endif
+	}
+	return count;
+}
+
+/**
+ * set the flag of each record in a part of the batch.  runs on its own
+ * thread, so it must not call rio or fio or allocate memory
+ */
+static void scancheck(SCANPART *part)
+{
+	INT i1, i2, cmp, end, reclength, valid;
+	UCHAR *rec;
+	SCANSTATE *scan;
+	SCANFILTER *flt;
+
+	scan = part->scan;
+	reclength = scan->reclength;
+	for (i1 = part->first, end = part->first + part->count; i1 < end; i1++) {
+		rec = scan->buffer + (size_t) i1 * scan->stride;
+		/* rioget returns the bytes as they are only if they hold no control, */
+		/* delete or compression characters and the end of record follows */
+		if (scan->rectype == RIO_T_STD) {
+			for (i2 = 0; i2 < reclength && rec[i2] < 0x80; i2++);
+			valid = (i2 == reclength && rec[i2] == DBCEOR);
+		}
+		else {
+			for (i2 = 0; i2 < reclength && rec[i2] > 0x1A && rec[i2] != 0x7F; i2++);
+			if (i2 < reclength) valid = FALSE;
+			else if (scan->rectype == RIO_T_DOS) valid = (rec[i2] == 0x0D && rec[i2 + 1] == 0x0A);
+			else if (scan->rectype == RIO_T_MAC) valid = (rec[i2] == 0x0D);
+			else valid = (rec[i2] == 0x0A);
+		}
+		if (!valid) {
+			scan->recflags[i1] = SCANREC_READ;
+			continue;
+		}
+		scan->recflags[i1] = SCANREC_OK;
+		for (i2 = 0; i2 < scan->numfilters; i2++) {
+			flt = scan->filters + i2;
+			if (flt->type == TYPE_CHAR) cmp = reccomparechar(rec + flt->offset, flt->fieldlen, scan->literals + flt->litoffset, flt->litlen);
+			else cmp = reccomparenum(rec + flt->offset, flt->fieldlen, scan->literals + flt->litoffset, flt->litlen);
+			switch (flt->test) {
+			case OP_GOTOIFNOTZERO: valid = !cmp; break;
+			case OP_GOTOIFZERO: valid = cmp; break;
+			case OP_GOTOIFPOS: valid = cmp <= 0; break;
+			case OP_GOTOIFNOTPOS: valid = cmp > 0; break;
+			case OP_GOTOIFNEG: valid = cmp >= 0; break;
+			case OP_GOTOIFNOTNEG: valid = cmp < 0; break;
+			}
+			if (!valid) {
+				scan->recflags[i1] = SCANREC_SKIP;
+				break;
+			}
+		}
+	}
+}
+
+static INT scancpus()
+{
+	INT i1;
+#if OS_WIN32
+	SYSTEM_INFO sysinfo;
+
+	GetSystemInfo(&sysinfo);
+	i1 = (INT) sysinfo.dwNumberOfProcessors;
+#elif defined(_SC_NPROCESSORS_ONLN)
+	i1 = (INT) sysconf(_SC_NPROCESSORS_ONLN);
+#else
+	i1 = 1;
+#endif
+	if (i1 < 1) i1 = 1;
+	return i1;
+}
+
+/* return a time in microseconds, used to time operations for EXPLAIN ANALYZE */
+UINT64 execclock()
+{
+#if OS_WIN32
+	LARGE_INTEGER count, freq;
+
+	if (!QueryPerformanceFrequency(&freq) || !QueryPerformanceCounter(&count)) return 0;
+	return (UINT64)(count.QuadPart / freq.QuadPart) * 1000000
+		+ (UINT64)(count.QuadPart % freq.QuadPart) * 1000000 / freq.QuadPart;
+#else
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return (UINT64) tv.tv_sec * 1000000 + tv.tv_usec;
+#endif
+}
+
+/* return TRUE if the operation that just ran read a record or produced a row */
+static INT profilerow(PCODE *pcode)
+{
+	INT var;
+
+	if (pcode->code == OP_WORKNEWROW) return TRUE;
+	if ((pcode->code < OP_READNEXT || pcode->code > OP_READPOS) && pcode->code != OP_HASHNEXT && pcode->code != OP_HASHPREV) return FALSE;
+	var = pcode->op3;
+	return var >= 1 && var <= MAXVARS && vars[var - 1] == TRUE;
+}
+
+/* FNV-1a */
+static UINT fnvhash(UINT hash, UCHAR *data, INT len)
+{
+	while (len-- > 0) {
+		hash ^= *data++;
+		hash *= 16777619U;
+	}
+	return hash;
+}
+
+static INT hashcolumn(UINT colrefnum, UINT *hash)
+{
+	INT len;
+	UCHAR *ptr, work[64];
+
+	if (normcolumn(colrefnum, &ptr, &len, work)) return -1;
+	*hash = fnvhash(2166136261U, ptr, len);
+	return 0;
+}
+
+/**
+ * find the row of the group of the current record in the hash group
+ * workset count, adding a row for a new group, and count the record in
+ * the last column of the row.  *found is set to 0 if the group was found,
+ * 1 if it was added or -1 if the groups no longer fit in memory, in which
+ * case the hash table is released for good
+ */
+static INT hashgroup(INT worksetnum, INT count, INT numkeys, INT *found)
+{
+	INT i1, i2, i3, i4, len1, len2, numbuckets, rowid, tabref;
+	UINT hash;
+	UCHAR *ptr1, *ptr2, work1[64], work2[64];
+	INT **hmem1;
+	WORKSET *wks1;
+	COLREF *crf1;
+
+	*found = -1;
+	tabref = (*thishplan)->numtables + count;
+	wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + count - 1;
+	if (wks1->hashbuckets < 0) return 0;
+	if (!wks1->hashbuckets) {
+		hmem1 = (INT **) memalloc(64 * 2 * sizeof(INT), MEMFLAGS_ZEROFILL);
+		wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + count - 1;
+		if (hmem1 == NULL) {
+			wks1->hashbuckets = -1;
+			return 0;
+		}
+		wks1->hashtable = hmem1;
+		wks1->hashbuckets = 64;
+	}
+	for (hash = 2166136261U, i1 = 0; i1 < numkeys; i1++) {
+		if (normcolumn((*wks1->colrefarray)[i1].tabcolnum, &ptr1, &len1, work1)) return -1;
+		hash = fnvhash(hash, ptr1, len1);
+		hash = fnvhash(hash, (UCHAR *) "", 1);  /* keep ("ab", "c") apart from ("a", "bc") */
+	}
+
+	/* open addressing with linear probing, rowid 0 is an empty bucket */
+	numbuckets = wks1->hashbuckets;
+	for (i2 = hash & (numbuckets - 1); ; i2 = (i2 + 1) & (numbuckets - 1)) {
+		rowid = (*wks1->hashtable)[i2];
+		if (!rowid) break;
+		if ((UINT) (*wks1->hashtable)[numbuckets + i2] != hash) continue;
+		wks1->rowid = rowid;
+		for (i1 = 0; i1 < numkeys; i1++) {
+			if (normcolumn((*wks1->colrefarray)[i1].tabcolnum, &ptr1, &len1, work1)) return -1;
+			if (normcolumn(gettabcolref(tabref, i1 + 1), &ptr2, &len2, work2)) return -1;
+			if (len1 != len2 || memcmp(ptr1, ptr2, len1)) break;
+		}
+		if (i1 == numkeys) {
+			*found = 0;
+			break;
+		}
+	}
+
+	if (*found) {
+		/* new group, the group rows are updated in place so they must all stay in memory */
+		if (wks1->rowcount >= wks1->memrowalloc) {
+			memfree((UCHAR **) wks1->hashtable);
+			wks1->hashtable = NULL;
+			wks1->hashbuckets = -1;
+			return 0;
+		}
+		i1 = newwksrow(worksetnum, count);
+		if (i1 < 0) return i1;
+		wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + count - 1;
+		(*wks1->hashtable)[i2] = wks1->rowid;
+		(*wks1->hashtable)[numbuckets + i2] = (INT) hash;
+		*found = 1;
+
+		/* keep the table at most half full */
+		if (wks1->rowcount << 1 > numbuckets) {
+			hmem1 = (INT **) memalloc(numbuckets * 4 * sizeof(INT), MEMFLAGS_ZEROFILL);
+			wks1 = (*(*(*connection.hworksetarray + worksetnum - 1)))->workset + count - 1;
+			if (hmem1 == NULL) {
+				memfree((UCHAR **) wks1->hashtable);
+				wks1->hashtable = NULL;
+				wks1->hashbuckets = -1;
+				*found = -1;
+				return 0;
+			}
+			for (i1 = 0; i1 < numbuckets; i1++) {
+				rowid = (*wks1->hashtable)[i1];
+				if (!rowid) continue;
+				i4 = (*wks1->hashtable)[numbuckets + i1];
+				for (i3 = (UINT) i4 & ((numbuckets << 1) - 1); (*hmem1)[i3]; i3 = (i3 + 1) & ((numbuckets << 1) - 1));
+				(*hmem1)[i3] = rowid;
+				(*hmem1)[(numbuckets << 1) + i3] = i4;
+			}
+			memfree((UCHAR **) wks1->hashtable);
+			wks1->hashtable = hmem1;
+			wks1->hashbuckets = numbuckets << 1;
+		}
+	}
+
+	/* the last column counts the records of the group */
+	crf1 = *wks1->colrefarray + wks1->numcolrefs - 1;
+	ptr1 = *wks1->rows + (wks1->rowid - wks1->memrowoffset - 1) * wks1->rowbytes + crf1->offset;
+	for (i1 = crf1->length; --i1 >= 0 && ptr1[i1] == '9'; ) ptr1[i1] = '0';
+	if (i1 >= 0) ptr1[i1] = (UCHAR) ((ptr1[i1] == ' ') ? '1' : ptr1[i1] + 1);
+	wks1->rowdirtyflag = TRUE;
+	return 0;
+}
+
 static int sqlaimrec(int filenum, int lockflag, int nowaitflag, int indexnum, int aionextflag, int *errhandle) // @suppress("No return")
 {
 #define AIMREC_FLAGS_FORWARD	0x01
@@ -3034,6 +3935,270 @@ static int sqlaimrec(int filenum, int lockflag, int nowaitflag, int indexnum, in
 #undef AIMREC_FLAGS_CHECKPOS
 }
 
+/**
+ * write count records to the text file of an open table and insert their keys
+ * records is a handle of the records one after the other, or NULL to write the record buffer
+ * the text file is locked once for all of the records and unique keys are checked before
+ * anything is written. records that do not reuse deleted space are appended one after
+ * the other, then the keys of each ISAM index are inserted in key order
+ * return 0 if successful, else return negative with the error message set
+ */
+static INT writerecords(INT openfilenum, UCHAR **records, INT count)
+{
+	INT i1, i2, i3, appendflag, entrysize, idxhandle, keylength, rc, reclength, txthandle;
+	OFFSET offset, **hfilepos;
+	UCHAR *ptr1, **hkeys;
+	TABLE *tab1;
+	INDEX *idx1;
+	OPENFILE *opf1;
+
+	opf1 = *connection.hopenfilearray + openfilenum - 1;
+	tab1 = tableptr(opf1->tablenum);
+	txthandle = opf1->textfilenum;
+	reclength = opf1->reclength;
+	if (records == NULL) {
+		records = opf1->hrecbuf;
+		count = 1;
+	}
+
+	/* open the indexes */
+	for (i1 = 0; ++i1 <= tab1->numindexes; ) {
+		if (!(*opf1->hopenindexarray)[i1 - 1]) {  /* open the index */
+			if (opentableindexfile(openfilenum, i1)) return -1;
+			/* memory may have shifted */
+			opf1 = *connection.hopenfilearray + openfilenum - 1;
+			tab1 = tableptr(opf1->tablenum);
+		}
+	}
+	hfilepos = (OFFSET **) memalloc(count * sizeof(OFFSET), 0);
+	if (hfilepos == NULL) return sqlerrnum(SQLERR_NOMEM);
+	hkeys = NULL;
+	/* memory may have shifted */
+	opf1 = *connection.hopenfilearray + openfilenum - 1;
+	tab1 = tableptr(opf1->tablenum);
+	rc = fioflck(txthandle);  /* lock the text file */
+	if (rc < 0) {
+		memfree((UCHAR **) hfilepos);
+		return sqlerrnummsg(rc, "error in locking file", nameptr(tab1->textfilename));
+	}
+
+	/* check for duplicates, in the index and between the records */
+	for (i1 = 0; ++i1 <= tab1->numindexes; ) {
+		idx1 = *tab1->hindexarray + i1 - 1;
+		if (idx1->type != INDEX_TYPE_ISAM || (idx1->flags & INDEX_DUPS)) continue;
+		rc = sortkeys(opf1->tablenum, i1, records, count, reclength, &hkeys, &keylength, &entrysize);
+		if (rc) goto writerecordserror;
+		for (i2 = 0; i2 < count; i2++) {
+			ptr1 = *hkeys + i2 * entrysize + sizeof(INT);
+			if (i2 && !memcmp(ptr1 - entrysize, ptr1, keylength)) rc = 1;
+			else {
+				memcpy(work1, ptr1, keylength);
+				work1[keylength] = '\0';
+				/* memory may have shifted */
+				opf1 = *connection.hopenfilearray + openfilenum - 1;
+				tab1 = tableptr(opf1->tablenum);
+				idx1 = *tab1->hindexarray + i1 - 1;
+				rc = xiofind((*opf1->hopenindexarray)[i1 - 1], (UCHAR *) work1, idx1->keylength);
+			}
+			if (rc == 1) {
+				/* memory may have shifted */
+				opf1 = *connection.hopenfilearray + openfilenum - 1;
+				tab1 = tableptr(opf1->tablenum);
+				rc = sqlerrnummsg(SQLERR_EXEC_DUPKEY, "error in writing record, no duplicate keys allowed", nameptr(indexptr(tab1, i1)->indexfilename));
+				goto writerecordserror;
+			}
+			if (rc < 0) {
+				rc = sqlerrnummsg(rc, "error in writing record", NULL);
+				goto writerecordserror;
+			}
+		}
+		memfree(hkeys);
+		hkeys = NULL;
+		/* memory may have shifted */
+		opf1 = *connection.hopenfilearray + openfilenum - 1;
+		tab1 = tableptr(opf1->tablenum);
+	}
+
+	/* write the records */
+	for (i1 = 0, appendflag = FALSE; i1 < count; i1++) {
+		rc = 1;
+		if (tab1->reclaimindex) {  /* try to use the space reclaimation index */
+			idxhandle = (*opf1->hopenindexarray)[tab1->reclaimindex - 1];
+			idx1 = indexptr(tab1, tab1->reclaimindex);
+			if (idx1->type == INDEX_TYPE_ISAM) {
+				rc = xiogetrec(idxhandle);
+				if (!rc) offset = filepos;
+			}
+			else {
+				rc = aiogetrec(idxhandle);
+				if (!rc) offset = filepos * (tab1->reclength + tab1->eorsize);
+			}
+			/* memory may have shifted */
+			opf1 = *connection.hopenfilearray + openfilenum - 1;
+			tab1 = tableptr(opf1->tablenum);
+		}
+		if (!rc) {
+			riosetpos(txthandle, offset);
+			appendflag = FALSE;
+		}
+		else if (!appendflag) {  /* following records are written after this one */
+			rioeofpos(txthandle, &offset);
+			riosetpos(txthandle, offset);
+			appendflag = TRUE;
+		}
+		rc = rioput(txthandle, *records + i1 * reclength, reclength);
+		if (rc) {
+			count = i1;
+			rc = sqlerrnummsg(rc, "error in writing record", NULL);
+			goto writerecordsundo;
+		}
+		riolastpos(txthandle, *hfilepos + i1);
+	}
+
+	/* insert keys */
+	for (i1 = 0; ++i1 <= tab1->numindexes; ) {
+		idx1 = *tab1->hindexarray + i1 - 1;
+		if (idx1->type == INDEX_TYPE_ISAM) {
+			rc = sortkeys(opf1->tablenum, i1, records, count, reclength, &hkeys, &keylength, &entrysize);
+			if (rc) goto writerecordsundo;
+			for (i2 = 0; i2 < count; i2++) {
+				ptr1 = *hkeys + i2 * entrysize;
+				memcpy(&i3, ptr1, sizeof(INT));
+				memcpy(work1, ptr1 + sizeof(INT), keylength);
+				filepos = (*hfilepos)[i3];
+				/* memory may have shifted */
+				opf1 = *connection.hopenfilearray + openfilenum - 1;
+				rc = xioinsert((*opf1->hopenindexarray)[i1 - 1], (UCHAR *) work1, keylength);
+				if (rc) break;
+			}
+			memfree(hkeys);
+			hkeys = NULL;
+		}
+		else {
+			for (i2 = 0; i2 < count; i2++) {
+				offset = (*hfilepos)[i2];
+				/* memory may have shifted */
+				opf1 = *connection.hopenfilearray + openfilenum - 1;
+				tab1 = tableptr(opf1->tablenum);
+				idx1 = *tab1->hindexarray + i1 - 1;
+				if (idx1->flags & INDEX_FIXED) filepos = offset / (OFFSET)(tab1->reclength + tab1->eorsize);
+				else if (offset) filepos = (offset - 1) / 256;
+				else filepos = 0;
+				rc = aioinsert((*opf1->hopenindexarray)[i1 - 1], *records + i2 * reclength);
+				if (rc) break;
+			}
+		}
+		/* memory may have shifted */
+		opf1 = *connection.hopenfilearray + openfilenum - 1;
+		tab1 = tableptr(opf1->tablenum);
+		if (rc) {
+			if (rc < 0) rc = sqlerrnummsg(rc, "error in writing record", NULL);
+			else rc = sqlerrnummsg(SQLERR_EXEC_DUPKEY, "error in writing record, unexpected duplicate key", NULL);
+			goto writerecordsundo;
+		}
+	}
+	fiofulk(txthandle);
+	memfree((UCHAR **) hfilepos);
+	return 0;
+
+writerecordsundo:  /* remove the ISAM keys and the records that were written */
+	memfree(hkeys);
+	hkeys = NULL;
+	opf1 = *connection.hopenfilearray + openfilenum - 1;
+	tab1 = tableptr(opf1->tablenum);
+	for (i1 = 0; i1 < count; i1++) {
+		filepos = (*hfilepos)[i1];
+		for (i2 = 0; ++i2 <= tab1->numindexes; ) {
+			idx1 = *tab1->hindexarray + i2 - 1;
+			if (idx1->type != INDEX_TYPE_ISAM) continue;
+			ptr1 = *records + i1 * reclength;
+			buildkey(opf1->tablenum, i2, &ptr1, work1);
+			xiodelete((*opf1->hopenindexarray)[i2 - 1], (UCHAR *) work1, (INT) strlen(work1), TRUE);
+			/* memory may have shifted */
+			opf1 = *connection.hopenfilearray + openfilenum - 1;
+			tab1 = tableptr(opf1->tablenum);
+		}
+		riosetpos(txthandle, (*hfilepos)[i1]);
+		riodelete(txthandle, reclength);
+	}
+
+writerecordserror:
+	fiofulk(txthandle);
+	memfree(hkeys);
+	memfree((UCHAR **) hfilepos);
+	return rc;
+}
+
+/**
+ * build the keys of an ISAM index for count records and sort them
+ * *hkeys is returned with entrysize bytes for each record, the record number (INT)
+ * followed by the key of keylength bytes
+ * return 0 if successful, else return negative with the error message set
+ */
+static INT sortkeys(INT tablenum, INT indexnum, UCHAR **records, INT count, INT reclength, UCHAR ***hkeys, INT *keylength, INT *entrysize)
+{
+	INT i1, i2;
+	UCHAR *ptr1, *ptr2;
+	TABLE *tab1;
+	INDEX *idx1;
+
+	tab1 = tableptr(tablenum);
+	idx1 = *tab1->hindexarray + indexnum - 1;
+	for (i1 = i2 = 0; i1 < idx1->numkeys; i1++) i2 += (*idx1->hkeys)[i1].len;
+	*keylength = i2;
+	*entrysize = (INT)((sizeof(INT) + i2 + sizeof(INT) - 1) & ~(sizeof(INT) - 1));
+	*hkeys = memalloc(count * *entrysize, 0);
+	if (*hkeys == NULL) return sqlerrnum(SQLERR_NOMEM);
+	tab1 = tableptr(tablenum);
+	idx1 = *tab1->hindexarray + indexnum - 1;
+	for (i1 = 0; i1 < count; i1++) {
+		ptr1 = **hkeys + i1 * *entrysize;
+		memcpy(ptr1, &i1, sizeof(INT));
+		ptr1 += sizeof(INT);
+		ptr2 = *records + i1 * reclength;
+		for (i2 = 0; i2 < idx1->numkeys; i2++) {
+			memcpy(ptr1, ptr2 + (*idx1->hkeys)[i2].pos, (*idx1->hkeys)[i2].len);
+			ptr1 += (*idx1->hkeys)[i2].len;
+		}
+	}
+	if (count > 1) {
+		sortkeylength = *keylength;
+		qsort(**hkeys, count, *entrysize, sortkeycompare);
+	}
+	return 0;
+}
+
+/* qsort compare of two entries built by sortkeys, equal keys stay in record order */
+static int sortkeycompare(const void *entry1, const void *entry2)
+{
+	INT i1, recnum1, recnum2;
+
+	i1 = memcmp((UCHAR *) entry1 + sizeof(INT), (UCHAR *) entry2 + sizeof(INT), sortkeylength);
+	if (i1) return i1;
+	memcpy(&recnum1, entry1, sizeof(INT));
+	memcpy(&recnum2, entry2, sizeof(INT));
+	return recnum1 - recnum2;
+}
+
+/**
+ * write the records saved in the batch of a plan that is not executing
+ * return 0 if successful, else return negative with the error message set
+ *
+ * Called only from loadstmt in fssql2, which runs an INSERT plan once for each row
+ */
+INT writebatch(HPLAN hplan)
+{
+	INT openfilenum, rc;
+
+	if (!(*hplan)->batchcount) return 0;
+	openfilenum = opentabletextfile((*hplan)->tablenums[0]);
+	if (openfilenum < 1) return (openfilenum) ? openfilenum : sqlerrnum(SQLERR_INTERNAL);
+	rc = writerecords(openfilenum, (*hplan)->batch, (*hplan)->batchcount);
+	openfileptr(openfilenum)->inuseflag = FALSE;
+	(*hplan)->batchcount = 0;
+	return rc;
+}
+
 static void buildkey(INT tablenum, INT indexnum, UCHAR **buffer, CHAR *key)
 {
 	int i1, i2;